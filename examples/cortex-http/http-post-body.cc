@@ -43,7 +43,9 @@ class HttpEcho : public HttpInputListener {
     response_->setStatus(HttpStatus::Ok);
 
     for (const HeaderField& field : request_->headers()) {
-      printf("[Header] %s: %s\n", field.name().c_str(), field.value().c_str());
+      printf("[Header] %.*s: %.*s\n",
+             (int) field.name().size(), field.name().data(),
+             (int) field.value().size(), field.value().data());
     }
   }
 
@@ -0,0 +1,65 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/Arena.h>
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+using namespace cortex;
+
+TEST(Arena, lazy) {
+  Arena arena;
+  ASSERT_EQ(0, arena.capacity());
+  ASSERT_EQ(0, arena.bytesUsed());
+}
+
+TEST(Arena, alignment) {
+  Arena arena(64);
+  arena.allocate(1, 1);
+  void* p = arena.allocate(8, 8);
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(p) % 8);
+}
+
+TEST(Arena, copy) {
+  Arena arena(16);
+  BufferRef a = arena.copy("Hello");
+  BufferRef b = arena.copy("a string larger than one block");
+
+  ASSERT_EQ("Hello", a);
+  ASSERT_EQ("a string larger than one block", b);
+  ASSERT_EQ(5 + 30, arena.bytesUsed());
+}
+
+TEST(Arena, resetKeepsBlocks) {
+  Arena arena(64);
+  for (int i = 0; i < 10; ++i)
+    arena.allocate(40, 1);
+
+  const size_t capacity = arena.capacity();
+  arena.reset();
+  ASSERT_EQ(0, arena.bytesUsed());
+
+  for (int i = 0; i < 10; ++i)
+    arena.allocate(40, 1);
+
+  ASSERT_EQ(capacity, arena.capacity());
+}
+
+TEST(Arena, stats) {
+  Arena arena(64);
+  arena.allocate(40, 1);
+  arena.allocate(40, 1);
+  ASSERT_EQ(2, arena.spills());
+
+  arena.reset();
+  arena.allocate(40, 1);
+  arena.allocate(40, 1);
+  ASSERT_EQ(2, arena.spills());
+  ASSERT_EQ(1, arena.resets());
+}
@@ -0,0 +1,131 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/Arena.h>
+#include <algorithm>
+#include <new>
+#include <stdint.h>
+#include <string.h>
+
+namespace cortex {
+
+static inline char* alignUp(char* p, size_t alignment) {
+  const uintptr_t v = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<char*>((v + alignment - 1) & ~(alignment - 1));
+}
+
+Arena::Arena(size_t blockSize)
+    : blockSize_(blockSize),
+      blocks_(),
+      current_(0),
+      cursor_(nullptr),
+      end_(nullptr),
+      used_(0),
+      resets_(0),
+      spills_(0) {
+}
+
+Arena::Arena(Arena&& other)
+    : Arena(other.blockSize_) {
+  swap(other);
+}
+
+Arena& Arena::operator=(Arena&& other) {
+  Arena(std::move(other)).swap(*this);
+  return *this;
+}
+
+Arena::~Arena() {
+  for (Block& block: blocks_)
+    ::operator delete(block.data);
+}
+
+void Arena::swap(Arena& other) {
+  std::swap(blockSize_, other.blockSize_);
+  std::swap(blocks_, other.blocks_);
+  std::swap(current_, other.current_);
+  std::swap(cursor_, other.cursor_);
+  std::swap(end_, other.end_);
+  std::swap(used_, other.used_);
+  std::swap(resets_, other.resets_);
+  std::swap(spills_, other.spills_);
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+  char* p = alignUp(cursor_, alignment);
+
+  if (cursor_ == nullptr || p + size > end_) {
+    if (!nextBlock(size, alignment))
+      throw std::bad_alloc();
+
+    p = alignUp(cursor_, alignment);
+  }
+
+  cursor_ = p + size;
+  used_ += size;
+  return p;
+}
+
+/**
+ * Moves on to the next block with room for @p size bytes, reusing blocks
+ * kept by reset() before allocating a new one.
+ */
+bool Arena::nextBlock(size_t size, size_t alignment) {
+  const size_t required = size + alignment - 1;
+  const size_t next = cursor_ ? current_ + 1 : 0;
+  size_t i = next;
+
+  while (i < blocks_.size() && blocks_[i].size < required)
+    ++i;
+
+  if (i == blocks_.size()) {
+    const size_t blockSize = std::max(blockSize_, required);
+    char* data = static_cast<char*>(::operator new(blockSize, std::nothrow));
+    if (!data)
+      return false;
+
+    blocks_.push_back(Block{data, blockSize});
+    spills_++;
+  }
+
+  // keep skipped, smaller blocks behind the current one for later use
+  if (i != next)
+    std::swap(blocks_[next], blocks_[i]);
+
+  current_ = next;
+  cursor_ = blocks_[next].data;
+  end_ = cursor_ + blocks_[next].size;
+  return true;
+}
+
+BufferRef Arena::copy(const BufferRef& data) {
+  if (data.empty())
+    return BufferRef();
+
+  char* p = static_cast<char*>(allocate(data.size(), 1));
+  memcpy(p, data.data(), data.size());
+  return BufferRef(p, data.size());
+}
+
+void Arena::reset() {
+  current_ = 0;
+  cursor_ = nullptr;
+  end_ = nullptr;
+  used_ = 0;
+  resets_++;
+}
+
+size_t Arena::capacity() const noexcept {
+  size_t n = 0;
+  for (const Block& block: blocks_)
+    n += block.size;
+  return n;
+}
+
+}  // namespace cortex
@@ -0,0 +1,94 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cortex-base/Api.h>
+#include <cortex-base/Buffer.h>
+#include <cstddef>
+#include <vector>
+
+namespace cortex {
+
+/**
+ * Monotonic (bump pointer) allocator.
+ *
+ * Hands out memory from a list of blocks and never releases individual
+ * allocations. All memory is released at once by reset(), which keeps
+ * the blocks for reuse, so that a steady workload, such as one request
+ * after another, stops hitting the heap after warm-up.
+ *
+ * Blocks are only allocated upon first use, so an unused arena is free.
+ */
+class CORTEX_API Arena {
+ public:
+  static constexpr size_t DefaultBlockSize = 1024;
+
+  explicit Arena(size_t blockSize = DefaultBlockSize);
+  Arena(Arena&& other);
+  Arena& operator=(Arena&& other);
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  ~Arena();
+
+  /**
+   * Allocates @p size bytes aligned to @p alignment, a power of two.
+   */
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * Copies @p data into the arena.
+   *
+   * @return reference to the copy, valid until the next reset().
+   */
+  BufferRef copy(const BufferRef& data);
+
+  /**
+   * Releases all allocations at once, keeping the blocks for reuse.
+   */
+  void reset();
+
+  /** Number of bytes handed out since the last reset(). */
+  size_t bytesUsed() const noexcept { return used_; }
+
+  /** Number of bytes held by all blocks. */
+  size_t capacity() const noexcept;
+
+  /** Number of reset() calls so far. */
+  size_t resets() const noexcept { return resets_; }
+
+  /**
+   * Number of blocks requested from the heap so far.
+   *
+   * Once the arena got warmed up, this should not increase any further.
+   */
+  size_t spills() const noexcept { return spills_; }
+
+  void swap(Arena& other);
+
+ private:
+  struct Block {
+    char* data;
+    size_t size;
+  };
+
+  bool nextBlock(size_t size, size_t alignment);
+
+ private:
+  size_t blockSize_;
+  std::vector<Block> blocks_;
+  size_t current_;  //!< index of the block currently bumped
+  char* cursor_;
+  char* end_;
+  size_t used_;
+  size_t resets_;
+  size_t spills_;
+};
+
+}  // namespace cortex
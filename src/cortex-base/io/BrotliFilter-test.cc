@@ -0,0 +1,81 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <cortex-base/io/BrotliFilter.h>
+#include <cortex-base/Buffer.h>
+#include <cortex-base/sysconfig.h>
+
+#if defined(HAVE_BROTLI_ENCODE_H)
+#include <brotli/decode.h>
+
+using namespace cortex;
+
+static std::string decompress(const Buffer& input) {
+  BrotliDecoderState* state =
+      BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+  const uint8_t* nextIn = (const uint8_t*) input.data();
+  size_t availIn = input.size();
+  std::string output;
+  BrotliDecoderResult rv;
+
+  do {
+    uint8_t buf[1024];
+    uint8_t* nextOut = buf;
+    size_t availOut = sizeof(buf);
+    rv = BrotliDecoderDecompressStream(state, &availIn, &nextIn,
+                                       &availOut, &nextOut, nullptr);
+    output.append((const char*) buf, sizeof(buf) - availOut);
+  } while (rv == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT);
+
+  BrotliDecoderDestroyInstance(state);
+  EXPECT_EQ(BROTLI_DECODER_RESULT_SUCCESS, rv);
+  return output;
+}
+
+TEST(BrotliFilter, single) {
+  std::string text;
+  for (int i = 0; i < 1000; ++i)
+    text += "{\"id\": " + std::to_string(i) + ", \"name\": \"item\"},";
+
+  BrotliFilter filter(5);
+  Buffer output;
+  filter.filter(BufferRef(text), &output, true);
+
+  EXPECT_GT(text.size() / 10, output.size());
+  EXPECT_EQ(text, decompress(output));
+}
+
+TEST(BrotliFilter, streaming) {
+  BrotliFilter filter(5);
+  Buffer output;
+  std::string text;
+
+  for (int i = 0; i < 100; ++i) {
+    const std::string chunk = "chunk " + std::to_string(i) + "\n";
+    text += chunk;
+    filter.filter(BufferRef(chunk), &output, false);
+
+    // each chunk is flushed right away
+    EXPECT_LT(0, output.size());
+  }
+  filter.filter(BufferRef(), &output, true);
+
+  EXPECT_EQ(text, decompress(output));
+}
+
+TEST(BrotliFilter, empty) {
+  BrotliFilter filter(5);
+  Buffer output;
+  filter.filter(BufferRef(), &output, true);
+
+  EXPECT_EQ("", decompress(output));
+}
+
+#endif
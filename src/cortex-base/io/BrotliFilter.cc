@@ -0,0 +1,62 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/io/BrotliFilter.h>
+#include <cortex-base/Buffer.h>
+#include <stdexcept>
+#include <new>
+
+#if defined(HAVE_BROTLI_ENCODE_H)
+
+namespace cortex {
+
+BrotliFilter::BrotliFilter(int quality)
+    : state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr)) {
+  if (!state_)
+    throw std::bad_alloc();
+
+  BrotliEncoderSetParameter(state_, BROTLI_PARAM_QUALITY, quality);
+  BrotliEncoderSetParameter(state_, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+}
+
+BrotliFilter::~BrotliFilter() {
+  BrotliEncoderDestroyInstance(state_);
+}
+
+void BrotliFilter::filter(const BufferRef& input, Buffer* output, bool last) {
+  const BrotliEncoderOperation op = last ? BROTLI_OPERATION_FINISH
+                                         : BROTLI_OPERATION_FLUSH;
+
+  const uint8_t* nextIn = (const uint8_t*) input.cbegin();
+  size_t availIn = input.size();
+
+  output->reserve(output->size() + input.size() / 2 + 64);
+
+  for (;;) {
+    if (output->size() == output->capacity())
+      output->reserve(output->capacity() + Buffer::CHUNK_SIZE);
+
+    uint8_t* nextOut = (uint8_t*) output->end();
+    size_t availOut = output->capacity() - output->size();
+
+    if (!BrotliEncoderCompressStream(state_, op, &availIn, &nextIn,
+                                     &availOut, &nextOut, nullptr))
+      throw std::runtime_error("Brotli compression failed.");
+
+    output->resize(output->capacity() - availOut);
+
+    if (availIn == 0 && !BrotliEncoderHasMoreOutput(state_) &&
+        (!last || BrotliEncoderIsFinished(state_)))
+      break;
+  }
+}
+
+} // namespace cortex
+
+#endif
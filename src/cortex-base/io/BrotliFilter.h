@@ -0,0 +1,45 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cortex-base/Api.h>
+#include <cortex-base/io/Filter.h>
+#include <cortex-base/sysconfig.h>
+
+#if defined(HAVE_BROTLI_ENCODE_H)
+#include <brotli/encode.h>
+
+namespace cortex {
+
+/**
+ * Brotli encoding filter.
+ *
+ * Each non-last chunk is flushed, so that the receiver can decode
+ * everything written so far.
+ */
+class CORTEX_API BrotliFilter : public Filter {
+ public:
+  /**
+   * Initializes the encoder.
+   *
+   * @param quality compression quality, from 0 (fastest) to 11 (smallest).
+   */
+  explicit BrotliFilter(int quality);
+  ~BrotliFilter();
+
+  void filter(const BufferRef& input, Buffer* output, bool last) override;
+
+ private:
+  BrotliEncoderState* state_;
+};
+
+} // namespace cortex
+
+#endif
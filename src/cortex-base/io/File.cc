@@ -45,6 +45,10 @@ std::string File::filename() const {
   return n != std::string::npos ? path_.substr(n + 1) : path_;
 }
 
+int File::sharedHandle() const {
+  return -1;
+}
+
 const std::string& File::lastModified() const {
   // build Last-Modified response header value on-demand
   if (lastModified_.empty()) {
@@ -80,6 +80,16 @@ class CORTEX_API File {
    */
   virtual int createPosixChannel(OpenFlags oflags) = 0;
 
+  /**
+   * Retrieves a read-only POSIX file handle shared by all users of this
+   * file, or -1 if there is none.
+   *
+   * The handle is owned by this file and must not be closed, nor read
+   * from by other means than positional reads (such as @c pread or
+   * @c sendfile with an explicit offset).
+   */
+  virtual int sharedHandle() const;
+
   /** Creates an input stream for given file. */
   virtual std::unique_ptr<std::istream> createInputChannel() = 0;
 
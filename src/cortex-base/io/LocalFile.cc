@@ -31,11 +31,15 @@ LocalFile::LocalFile(LocalFileRepository& repo,
     : File(path, mimetype),
       repo_(repo),
       stat_(),
-      etag_() {
+      etag_(),
+      handle_(-1) {
   update();
 }
 
 LocalFile::~LocalFile() {
+  if (handle_ >= 0) {
+    ::close(handle_);
+  }
 }
 
 size_t LocalFile::size() const CORTEX_NOEXCEPT {
@@ -105,6 +109,32 @@ int LocalFile::createPosixChannel(OpenFlags oflags) {
   return ::open(path().c_str(), to_posix(oflags));
 }
 
+int LocalFile::sharedHandle() const {
+  return handle_;
+}
+
+bool LocalFile::makeShareable() {
+  if (handle_ < 0) {
+    handle_ = createPosixChannel(File::Read | File::NonBlocking);
+    if (handle_ < 0)
+      return false;
+
+    if (fstat(handle_, &stat_) < 0) {
+      ::close(handle_);
+      handle_ = -1;
+      return false;
+    }
+
+    etag_.clear();
+    lastModified_.clear();
+  }
+
+  etag();
+  lastModified();
+
+  return true;
+}
+
 std::unique_ptr<std::istream> LocalFile::createInputChannel() {
   return std::unique_ptr<std::istream>(
       new std::ifstream(path(), std::ios::binary));
@@ -38,16 +38,30 @@ class CORTEX_API LocalFile : public File {
   bool isDirectory() const CORTEX_NOEXCEPT override;
   bool isExecutable() const CORTEX_NOEXCEPT override;
   int createPosixChannel(OpenFlags flags) override;
+  int sharedHandle() const override;
   std::unique_ptr<std::istream> createInputChannel() override;
   std::unique_ptr<std::ostream> createOutputChannel() override;
   std::unique_ptr<MemoryMap> createMemoryMap(bool rw = true) override;
 
   void update();
 
+  /**
+   * Prepares this file for being shared across requests and threads.
+   *
+   * Opens the file for sharedHandle(), refreshes its status from that
+   * very handle, and computes all lazily derived values, so that they
+   * can be read concurrently from now on.
+   *
+   * @retval true the file is shareable now.
+   * @retval false the file could not be opened for reading.
+   */
+  bool makeShareable();
+
  private:
   LocalFileRepository& repo_;
   struct stat stat_;
   mutable std::string etag_;
+  int handle_;
 };
 
 } // namespace cortex
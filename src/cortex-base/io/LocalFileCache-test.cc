@@ -0,0 +1,161 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <cortex-base/io/LocalFileCache.h>
+#include <cortex-base/io/LocalFileRepository.h>
+#include <cortex-base/io/LocalFile.h>
+#include <cortex-base/io/FileUtil.h>
+#include <cortex-base/MimeTypes.h>
+#include <cortex-base/WallClock.h>
+#include <cortex-base/Buffer.h>
+#include <unistd.h>
+
+using namespace cortex;
+
+class ManualClock : public WallClock {
+ public:
+  DateTime get() const override { return now; }
+
+  DateTime now;
+};
+
+class LocalFileCacheTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    basedir_ = FileUtil::createTempDirectory();
+    repo_.reset(new LocalFileRepository(mimetypes_, basedir_,
+                                        true, true, true));
+  }
+
+  void TearDown() override {
+    for (const char* name: {"a.txt", "b.txt", "c.txt"})
+      if (FileUtil::exists(path(name)))
+        FileUtil::rm(path(name));
+
+    ::rmdir(basedir_.c_str());
+  }
+
+  std::string path(const std::string& name) {
+    return FileUtil::joinPaths(basedir_, name);
+  }
+
+  std::shared_ptr<LocalFile> create(const std::string& name,
+                                    const std::string& contents) {
+    FileUtil::write(path(name), Buffer(contents));
+    std::shared_ptr<LocalFile> file(
+        new LocalFile(*repo_, path(name), "text/plain"));
+    EXPECT_TRUE(file->makeShareable());
+    return file;
+  }
+
+ protected:
+  MimeTypes mimetypes_;
+  std::string basedir_;
+  std::unique_ptr<LocalFileRepository> repo_;
+};
+
+TEST_F(LocalFileCacheTest, hitAndMiss) {
+  ManualClock clock;
+  LocalFileCache cache(8, TimeSpan::fromSeconds(60), &clock);
+
+  EXPECT_EQ(nullptr, cache.get(path("a.txt")));
+  EXPECT_EQ(1, cache.misses());
+
+  std::shared_ptr<LocalFile> a = create("a.txt", "hello");
+  cache.put(a);
+
+  EXPECT_EQ(a, cache.get(path("a.txt")));
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(1, cache.size());
+  EXPECT_LE(0, a->sharedHandle());
+}
+
+TEST_F(LocalFileCacheTest, evictsLeastRecentlyUsed) {
+  ManualClock clock;
+  LocalFileCache cache(2, TimeSpan::fromSeconds(60), &clock);
+
+  cache.put(create("a.txt", "a"));
+  cache.put(create("b.txt", "b"));
+  cache.get(path("a.txt"));  // b is now the least recently used one
+  cache.put(create("c.txt", "c"));
+
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(1, cache.evictions());
+  EXPECT_NE(nullptr, cache.get(path("a.txt")));
+  EXPECT_EQ(nullptr, cache.get(path("b.txt")));
+  EXPECT_NE(nullptr, cache.get(path("c.txt")));
+}
+
+TEST_F(LocalFileCacheTest, expiresAfterTTL) {
+  ManualClock clock;
+  clock.now = DateTime(1000.0);
+  LocalFileCache cache(8, TimeSpan::fromSeconds(10), &clock);
+
+  cache.put(create("a.txt", "hello"));
+
+  clock.now = DateTime(1009.0);
+  EXPECT_NE(nullptr, cache.get(path("a.txt")));
+
+  clock.now = DateTime(1010.0);
+  EXPECT_EQ(nullptr, cache.get(path("a.txt")));
+  EXPECT_EQ(1, cache.invalidations());
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST_F(LocalFileCacheTest, invalidatesOnChange) {
+  ManualClock clock;
+  LocalFileCache cache(8, TimeSpan::Zero, &clock);
+
+  if (cache.inotifyHandle() < 0)
+    return;  // changes are not watched on this platform
+
+  cache.put(create("a.txt", "hello"));
+  ASSERT_NE(nullptr, cache.get(path("a.txt")));
+
+  // same size, and most likely within the same mtime second
+  FileUtil::write(path("a.txt"), Buffer("world"));
+
+  EXPECT_EQ(nullptr, cache.get(path("a.txt")));
+  EXPECT_EQ(1, cache.invalidations());
+}
+
+TEST_F(LocalFileCacheTest, invalidatesOnDelete) {
+  ManualClock clock;
+  LocalFileCache cache(8, TimeSpan::Zero, &clock);
+
+  if (cache.inotifyHandle() < 0)
+    return;  // changes are not watched on this platform
+
+  cache.put(create("a.txt", "hello"));
+  FileUtil::rm(path("a.txt"));
+  cache.processEvents();
+
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST_F(LocalFileCacheTest, repositorySharesCachedFiles) {
+  ManualClock clock;
+  repo_->setCache(std::unique_ptr<LocalFileCache>(
+      new LocalFileCache(8, TimeSpan::fromSeconds(60), &clock)));
+
+  FileUtil::write(path("a.txt"), Buffer("hello"));
+
+  std::shared_ptr<File> first = repo_->getFile("a.txt", "/");
+  std::shared_ptr<File> second = repo_->getFile("a.txt", "/");
+
+  EXPECT_EQ(first, second);
+  EXPECT_LE(0, second->sharedHandle());
+  EXPECT_EQ(1, repo_->cache()->hits());
+
+  // missing files are never cached
+  std::shared_ptr<File> missing = repo_->getFile("b.txt", "/");
+  EXPECT_FALSE(missing->exists());
+  EXPECT_EQ(1, repo_->cache()->size());
+}
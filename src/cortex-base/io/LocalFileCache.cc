@@ -0,0 +1,236 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/io/LocalFileCache.h>
+#include <cortex-base/io/LocalFile.h>
+#include <cortex-base/WallClock.h>
+#include <cortex-base/RuntimeError.h>
+#include <cortex-base/sysconfig.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+#if defined(HAVE_SYS_INOTIFY_H)
+#include <sys/inotify.h>
+#endif
+
+namespace cortex {
+
+LocalFileCache::LocalFileCache(size_t capacity, TimeSpan ttl,
+                               WallClock* clock, Scheduler* scheduler)
+    : capacity_(capacity),
+      ttl_(ttl),
+      clock_(clock),
+      scheduler_(scheduler),
+      schedulerHandle_(),
+      inotify_(-1),
+      lock_(),
+      lru_(),
+      entries_(),
+      watches_(),
+      hits_(0),
+      misses_(0),
+      evictions_(0),
+      invalidations_(0) {
+#if defined(HAVE_SYS_INOTIFY_H)
+  inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_ < 0)
+    RAISE_ERRNO(errno);
+
+  watchEvents();
+#endif
+}
+
+LocalFileCache::~LocalFileCache() {
+  if (schedulerHandle_)
+    schedulerHandle_->cancel();
+
+  if (inotify_ >= 0)
+    ::close(inotify_);
+}
+
+std::shared_ptr<LocalFile> LocalFileCache::get(const std::string& path) {
+  std::lock_guard<std::mutex> _l(lock_);
+
+  if (inotify_ >= 0 && !scheduler_)
+    drainEvents();
+
+  auto i = entries_.find(path);
+  if (i == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+
+  EntryList::iterator entry = i->second;
+
+  if (ttl_ && clock_->get() >= entry->expires) {
+    erase(entry);
+    invalidations_++;
+    misses_++;
+    return nullptr;
+  }
+
+  lru_.splice(lru_.begin(), lru_, entry);
+  hits_++;
+
+  return entry->file;
+}
+
+void LocalFileCache::put(std::shared_ptr<LocalFile> file) {
+  if (capacity_ == 0)
+    return;
+
+  const std::string& path = file->path();
+  int watch = -1;
+
+  std::lock_guard<std::mutex> _l(lock_);
+
+  auto i = entries_.find(path);
+  if (i != entries_.end())
+    erase(i->second);
+
+#if defined(HAVE_SYS_INOTIFY_H)
+  watch = inotify_add_watch(inotify_, path.c_str(),
+                            IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE |
+                            IN_MOVE_SELF | IN_DELETE_SELF);
+#endif
+
+  // without a watch we cannot tell when the file changes
+  if (watch < 0 && !ttl_)
+    return;
+
+  // the file might have changed before the watch got installed
+  struct stat st;
+  if (stat(path.c_str(), &st) < 0 ||
+      static_cast<size_t>(st.st_ino) != file->inode() ||
+      static_cast<size_t>(st.st_size) != file->size() ||
+      st.st_mtime != file->mtime()) {
+    if (watch >= 0 && watches_.count(watch) == 0) {
+#if defined(HAVE_SYS_INOTIFY_H)
+      inotify_rm_watch(inotify_, watch);
+#endif
+    }
+    return;
+  }
+
+  // register the watch before evicting, as the evicted entry may be the
+  // last other holder of the very same watch (another path to this inode)
+  if (watch >= 0) {
+    watches_.emplace(watch, path);
+  }
+
+  if (lru_.size() >= capacity_) {
+    erase(std::prev(lru_.end()));
+    evictions_++;
+  }
+
+  lru_.push_front(Entry{file, ttl_ ? clock_->get() + ttl_ : DateTime(), watch});
+  entries_[path] = lru_.begin();
+}
+
+void LocalFileCache::invalidate(const std::string& path) {
+  std::lock_guard<std::mutex> _l(lock_);
+
+  auto i = entries_.find(path);
+  if (i != entries_.end()) {
+    erase(i->second);
+    invalidations_++;
+  }
+}
+
+void LocalFileCache::clear() {
+  std::lock_guard<std::mutex> _l(lock_);
+
+  while (!lru_.empty())
+    erase(lru_.begin());
+}
+
+size_t LocalFileCache::size() const {
+  std::lock_guard<std::mutex> _l(lock_);
+  return entries_.size();
+}
+
+void LocalFileCache::erase(EntryList::iterator entry) {
+  const std::string path = entry->file->path();
+  const int watch = entry->watch;
+
+  entries_.erase(path);
+  lru_.erase(entry);
+
+  if (watch < 0)
+    return;
+
+  auto range = watches_.equal_range(watch);
+  for (auto i = range.first; i != range.second; ++i) {
+    if (i->second == path) {
+      watches_.erase(i);
+      break;
+    }
+  }
+
+  // the same watch is shared by all paths to the same inode
+  if (watches_.count(watch) == 0) {
+#if defined(HAVE_SYS_INOTIFY_H)
+    inotify_rm_watch(inotify_, watch);
+#endif
+  }
+}
+
+void LocalFileCache::watchEvents() {
+  if (scheduler_ && inotify_ >= 0) {
+    schedulerHandle_ = scheduler_->executeOnReadable(inotify_, [this]() {
+      processEvents();
+      watchEvents();
+    });
+  }
+}
+
+void LocalFileCache::processEvents() {
+  std::lock_guard<std::mutex> _l(lock_);
+  drainEvents();
+}
+
+void LocalFileCache::drainEvents() {
+#if defined(HAVE_SYS_INOTIFY_H)
+  alignas(struct inotify_event) char buf[4096];
+
+  for (;;) {
+    ssize_t n = ::read(inotify_, buf, sizeof(buf));
+    if (n <= 0)
+      break;
+
+    for (const char* p = buf; p < buf + n;) {
+      const struct inotify_event* event =
+          reinterpret_cast<const struct inotify_event*>(p);
+
+      if (!(event->mask & IN_IGNORED))
+        invalidateWatch(event->wd);
+
+      p += sizeof(struct inotify_event) + event->len;
+    }
+  }
+#endif
+}
+
+void LocalFileCache::invalidateWatch(int watch) {
+  auto i = watches_.find(watch);
+
+  while (i != watches_.end()) {
+    auto entry = entries_.find(i->second);
+    if (entry != entries_.end()) {
+      erase(entry->second);
+      invalidations_++;
+    } else {
+      watches_.erase(i);
+    }
+    i = watches_.find(watch);
+  }
+}
+
+}  // namespace cortex
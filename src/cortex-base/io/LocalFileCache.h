@@ -0,0 +1,125 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cortex-base/Api.h>
+#include <cortex-base/DateTime.h>
+#include <cortex-base/TimeSpan.h>
+#include <cortex-base/executor/Scheduler.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cortex {
+
+class LocalFile;
+class WallClock;
+
+/**
+ * Bounded, thread-safe cache of LocalFile objects keyed by their path.
+ *
+ * Cached files keep their stat() result, derived header values and an
+ * open file descriptor, so that serving a cache hit takes no syscalls.
+ *
+ * Entries are invalidated as soon as the file changes on disk, observed
+ * via inotify where available, and otherwise after a time-to-live.
+ * The least recently used entry is evicted when the cache is full.
+ *
+ * inotify events are processed upon readability of the inotify handle
+ * if a scheduler was given, or else upon each lookup.
+ */
+class CORTEX_API LocalFileCache {
+ public:
+  /**
+   * Initializes the cache.
+   *
+   * @param capacity maximum number of files to cache.
+   * @param ttl time-to-live of each entry, or TimeSpan::Zero for no expiry.
+   * @param clock clock for evaluating the time-to-live.
+   * @param scheduler optional scheduler to watch the inotify handle with.
+   */
+  LocalFileCache(size_t capacity, TimeSpan ttl, WallClock* clock,
+                 Scheduler* scheduler = nullptr);
+  ~LocalFileCache();
+
+  /**
+   * Retrieves the cached file at @p path, or @c nullptr if not cached.
+   */
+  std::shared_ptr<LocalFile> get(const std::string& path);
+
+  /**
+   * Caches @p file, replacing any older entry of the same path.
+   *
+   * The file must be shareable already.
+   *
+   * @see LocalFile::makeShareable()
+   */
+  void put(std::shared_ptr<LocalFile> file);
+
+  /** Removes the entry for @p path, if any. */
+  void invalidate(const std::string& path);
+
+  /** Removes all entries. */
+  void clear();
+
+  /**
+   * Processes pending inotify events, invalidating the entries of the
+   * files that changed.
+   */
+  void processEvents();
+
+  /** The inotify handle or -1 if changes are not watched. */
+  int inotifyHandle() const noexcept { return inotify_; }
+
+  size_t capacity() const noexcept { return capacity_; }
+  size_t size() const;
+
+  size_t hits() const noexcept { return hits_; }
+  size_t misses() const noexcept { return misses_; }
+  size_t evictions() const noexcept { return evictions_; }
+  size_t invalidations() const noexcept { return invalidations_; }
+
+ private:
+  struct Entry {
+    std::shared_ptr<LocalFile> file;
+    DateTime expires;
+    int watch;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  void watchEvents();
+  void drainEvents();
+  void invalidateWatch(int watch);
+  void erase(EntryList::iterator i);
+
+ private:
+  size_t capacity_;
+  TimeSpan ttl_;
+  WallClock* clock_;
+  Scheduler* scheduler_;
+  Scheduler::HandleRef schedulerHandle_;
+  int inotify_;
+
+  mutable std::mutex lock_;
+  EntryList lru_;  //!< most recently used entry first
+  std::unordered_map<std::string, EntryList::iterator> entries_;
+  std::unordered_multimap<int, std::string> watches_;
+
+  std::atomic<size_t> hits_;
+  std::atomic<size_t> misses_;
+  std::atomic<size_t> evictions_;
+  std::atomic<size_t> invalidations_;
+};
+
+}  // namespace cortex
@@ -9,6 +9,7 @@
 
 #include <cortex-base/io/LocalFileRepository.h>
 #include <cortex-base/io/LocalFile.h>
+#include <cortex-base/io/LocalFileCache.h>
 #include <cortex-base/io/FileUtil.h>
 #include <cortex-base/MimeTypes.h>
 
@@ -23,7 +24,11 @@ LocalFileRepository::LocalFileRepository(MimeTypes& mt,
       basedir_(FileUtil::realpath(basedir)),
       etagConsiderMTime_(etagMtime),
       etagConsiderSize_(etagSize),
-      etagConsiderINode_(etagInode) {
+      etagConsiderINode_(etagInode),
+      cache_() {
+}
+
+LocalFileRepository::~LocalFileRepository() {
 }
 
 std::shared_ptr<File> LocalFileRepository::getFile(
@@ -32,8 +37,20 @@ std::shared_ptr<File> LocalFileRepository::getFile(
 
   std::string path = FileUtil::joinPaths(FileUtil::joinPaths(basedir_, docroot), requestPath);
 
-  return std::shared_ptr<File>(new LocalFile(
+  if (cache_) {
+    if (std::shared_ptr<LocalFile> file = cache_->get(path)) {
+      return file;
+    }
+  }
+
+  std::shared_ptr<LocalFile> file(new LocalFile(
         *this, path, mimetypes_.getMimeType(requestPath)));
+
+  // only regular files are worth caching; missing ones may appear any time
+  if (cache_ && file->exists() && file->isRegular() && file->makeShareable())
+    cache_->put(file);
+
+  return file;
 }
 
 void LocalFileRepository::listFiles(
@@ -63,6 +80,14 @@ void LocalFileRepository::configureETag(bool mtime, bool size, bool inode) {
   etagConsiderMTime_ = mtime;
   etagConsiderSize_ = size;
   etagConsiderINode_ = inode;
+
+  // cached files carry entity tags of the old configuration
+  if (cache_)
+    cache_->clear();
+}
+
+void LocalFileRepository::setCache(std::unique_ptr<LocalFileCache> cache) {
+  cache_ = std::move(cache);
 }
 
 }  // namespace cortex
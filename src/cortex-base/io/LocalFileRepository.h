@@ -12,12 +12,14 @@
 #include <cortex-base/Api.h>
 #include <cortex-base/io/FileRepository.h>
 #include <functional>
+#include <memory>
 #include <string>
 
 namespace cortex {
 
 class MimeTypes;
 class LocalFile;
+class LocalFileCache;
 
 class CORTEX_API LocalFileRepository : public FileRepository {
  public:
@@ -35,6 +37,8 @@ class CORTEX_API LocalFileRepository : public FileRepository {
       const std::string& basedir,
       bool etagMtime, bool etagSize, bool etagInode);
 
+  ~LocalFileRepository();
+
   const std::string baseDirectory() const { return basedir_; }
 
   std::shared_ptr<File> getFile(
@@ -58,6 +62,19 @@ class CORTEX_API LocalFileRepository : public FileRepository {
   bool etagConsiderSize() const noexcept { return etagConsiderSize_; }
   bool etagConsiderINode() const noexcept { return etagConsiderINode_; }
 
+  /**
+   * Enables caching of file status and open file descriptors.
+   *
+   * Files served from the cache are shared by all their users, and
+   * provide a File::sharedHandle() to read from.
+   *
+   * @param cache the cache to use, or @c nullptr to disable caching.
+   */
+  void setCache(std::unique_ptr<LocalFileCache> cache);
+
+  /** Retrieves the file cache, if enabled, or @c nullptr otherwise. */
+  LocalFileCache* cache() const noexcept { return cache_.get(); }
+
  private:
   friend class LocalFile;
 
@@ -66,6 +83,7 @@ class CORTEX_API LocalFileRepository : public FileRepository {
   bool etagConsiderMTime_;
   bool etagConsiderSize_;
   bool etagConsiderINode_;
+  std::unique_ptr<LocalFileCache> cache_;
 };
 
 }  // namespace cortex
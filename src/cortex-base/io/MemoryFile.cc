@@ -42,8 +42,10 @@ MemoryFile::MemoryFile()
     : File("", ""),
       mtime_(0),
       inode_(0),
+      size_(0),
       etag_(),
-      fspath_() {
+      fspath_(),
+      fd_(-1) {
 }
 
 MemoryFile::MemoryFile(
@@ -99,6 +101,7 @@ MemoryFile::~MemoryFile() {
 #if defined(CORTEX_MEMORYFILE_USE_TMPFILE)
   if (fd_ >= 0) {
     ::close(fd_);
+    ::unlink(fspath_.c_str());
   }
 #else
   shm_unlink(fspath_.c_str());
@@ -133,6 +136,10 @@ bool MemoryFile::isExecutable() const CORTEX_NOEXCEPT {
   return false;
 }
 
+int MemoryFile::sharedHandle() const {
+  return fd_;
+}
+
 int MemoryFile::createPosixChannel(OpenFlags oflags) {
 #if defined(CORTEX_MEMORYFILE_USE_TMPFILE)
   if (fd_ < 0) {
@@ -36,6 +36,7 @@ class CORTEX_API MemoryFile : public File {
   bool isDirectory() const CORTEX_NOEXCEPT override;
   bool isExecutable() const CORTEX_NOEXCEPT override;
   int createPosixChannel(OpenFlags flags) override;
+  int sharedHandle() const override;
   std::unique_ptr<std::istream> createInputChannel() override;
   std::unique_ptr<std::ostream> createOutputChannel() override;
   std::unique_ptr<MemoryMap> createMemoryMap(bool rw = true) override;
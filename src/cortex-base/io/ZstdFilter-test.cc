@@ -0,0 +1,74 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <cortex-base/io/ZstdFilter.h>
+#include <cortex-base/Buffer.h>
+#include <cortex-base/sysconfig.h>
+
+#if defined(HAVE_ZSTD_H)
+
+using namespace cortex;
+
+static std::string decompress(const Buffer& input) {
+  ZSTD_DStream* stream = ZSTD_createDStream();
+  ZSTD_inBuffer in = { input.data(), input.size(), 0 };
+  std::string output;
+  size_t rv;
+
+  do {
+    char buf[1024];
+    ZSTD_outBuffer out = { buf, sizeof(buf), 0 };
+    rv = ZSTD_decompressStream(stream, &out, &in);
+    output.append(buf, out.pos);
+  } while (!ZSTD_isError(rv) && (in.pos < in.size || rv != 0));
+
+  ZSTD_freeDStream(stream);
+  EXPECT_EQ(0, rv);
+  return output;
+}
+
+TEST(ZstdFilter, single) {
+  std::string text;
+  for (int i = 0; i < 1000; ++i)
+    text += "{\"id\": " + std::to_string(i) + ", \"name\": \"item\"},";
+
+  ZstdFilter filter(3);
+  Buffer output;
+  filter.filter(BufferRef(text), &output, true);
+
+  EXPECT_GT(text.size() / 10, output.size());
+  EXPECT_EQ(text, decompress(output));
+}
+
+TEST(ZstdFilter, streaming) {
+  ZstdFilter filter(3);
+  Buffer output;
+  std::string text;
+
+  for (int i = 0; i < 100; ++i) {
+    const std::string chunk = "chunk " + std::to_string(i) + "\n";
+    text += chunk;
+    filter.filter(BufferRef(chunk), &output, false);
+    EXPECT_LT(0, output.size());
+  }
+  filter.filter(BufferRef(), &output, true);
+
+  EXPECT_EQ(text, decompress(output));
+}
+
+TEST(ZstdFilter, empty) {
+  ZstdFilter filter(3);
+  Buffer output;
+  filter.filter(BufferRef(), &output, true);
+
+  EXPECT_EQ("", decompress(output));
+}
+
+#endif
@@ -0,0 +1,58 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/io/ZstdFilter.h>
+#include <cortex-base/Buffer.h>
+#include <stdexcept>
+#include <new>
+
+#if defined(HAVE_ZSTD_H)
+
+namespace cortex {
+
+ZstdFilter::ZstdFilter(int level)
+    : cctx_(ZSTD_createCCtx()) {
+  if (!cctx_)
+    throw std::bad_alloc();
+
+  ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level);
+}
+
+ZstdFilter::~ZstdFilter() {
+  ZSTD_freeCCtx(cctx_);
+}
+
+void ZstdFilter::filter(const BufferRef& input, Buffer* output, bool last) {
+  const ZSTD_EndDirective mode = last ? ZSTD_e_end : ZSTD_e_flush;
+  ZSTD_inBuffer in = { input.cbegin(), input.size(), 0 };
+
+  output->reserve(output->size() + input.size() / 2 + 64);
+
+  for (;;) {
+    if (output->size() == output->capacity())
+      output->reserve(output->capacity() + Buffer::CHUNK_SIZE);
+
+    ZSTD_outBuffer out = { output->end(),
+                           output->capacity() - output->size(), 0 };
+
+    // the number of bytes yet to be flushed, or an error code
+    const size_t pending = ZSTD_compressStream2(cctx_, &out, &in, mode);
+    if (ZSTD_isError(pending))
+      throw std::runtime_error(ZSTD_getErrorName(pending));
+
+    output->resize(output->size() + out.pos);
+
+    if (pending == 0)
+      break;
+  }
+}
+
+} // namespace cortex
+
+#endif
@@ -9,6 +9,7 @@
 
 #include <cortex-base/net/EndPoint.h>
 #include <cortex-base/net/Connection.h>
+#include <cortex-base/Buffer.h>
 #include <cassert>
 
 namespace cortex {
@@ -26,6 +27,20 @@ void EndPoint::setConnection(Connection* connection) {
   connection_ = connection;
 }
 
+size_t EndPoint::flush(const BufferRef* sources, size_t count) {
+  size_t total = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    size_t n = flush(sources[i]);
+    total += n;
+
+    if (n < sources[i].size())
+      break;
+  }
+
+  return total;
+}
+
 Option<IPAddress> EndPoint::remoteIP() const {
   return None();
 }
@@ -91,6 +91,21 @@ class EndPoint : public RefCounted {
    */
   virtual size_t flush(const BufferRef& source) = 0;
 
+  /**
+   * Flushes the given @p count buffers in @p sources into this endpoint,
+   * in order, as if they were one contiguous buffer.
+   *
+   * The default implementation flushes buffer by buffer until either all
+   * have been flushed or a buffer could only be flushed partially.
+   * Implementations are encouraged to use a single gather-write instead.
+   *
+   * @param sources array of buffers to flush into this endpoint.
+   * @param count number of buffers in @p sources.
+   *
+   * @return Number of actual bytes flushed, summed over all buffers.
+   */
+  virtual size_t flush(const BufferRef* sources, size_t count);
+
   /**
    * Flushes file contents behind filedescriptor @p fd into this endpoint.
    *
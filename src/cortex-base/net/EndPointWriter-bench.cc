@@ -0,0 +1,116 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/net/EndPointWriter.h>
+#include <cortex-base/net/InetEndPoint.h>
+#include <cortex-base/executor/NativeScheduler.h>
+#include <cortex-base/WallClock.h>
+#include <cortex-base/Buffer.h>
+#include <chrono>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <stdio.h>
+
+using namespace cortex;
+
+/**
+ * InetEndPoint that counts its write syscalls and optionally disables
+ * the gather-write path, falling back to one write per buffer.
+ */
+class CountingEndPoint : public InetEndPoint {
+ public:
+  CountingEndPoint(int fd, Scheduler* scheduler, bool gather)
+      : InetEndPoint(fd, AF_UNIX, TimeSpan::Zero, TimeSpan::Zero,
+                     WallClock::monotonic(), scheduler),
+        gather_(gather),
+        syscalls_(0) {}
+
+  size_t syscalls() const { return syscalls_; }
+
+  size_t flush(const BufferRef& source) override {
+    syscalls_++;
+    return InetEndPoint::flush(source);
+  }
+
+  size_t flush(const BufferRef* sources, size_t count) override {
+    if (!gather_)
+      return EndPoint::flush(sources, count);
+
+    syscalls_++;
+    return InetEndPoint::flush(sources, count);
+  }
+
+  size_t flush(int fd, off_t offset, size_t size) override {
+    syscalls_++;
+    return InetEndPoint::flush(fd, offset, size);
+  }
+
+ private:
+  bool gather_;
+  size_t syscalls_;
+};
+
+/**
+ * Writes @p pipelined small chunked-encoded HTTP/1 responses per round,
+ * each consisting of header, chunk framing, body and trailer, and drains
+ * them on the peer socket.
+ */
+static void benchmarkPipelined(bool gather, size_t pipelined, size_t rounds) {
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+    perror("socketpair");
+    return;
+  }
+
+  NativeScheduler scheduler;
+  RefPtr<CountingEndPoint> endpoint(new CountingEndPoint(sv[0], &scheduler,
+                                                         gather));
+  const BufferRef body = "Hello, World!\n";
+  char drain[64 * 1024];
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t round = 0; round < rounds; ++round) {
+    EndPointWriter writer;
+    for (size_t i = 0; i < pipelined; ++i) {
+      writer.write(Buffer("HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/plain\r\n"
+                          "Transfer-Encoding: chunked\r\n\r\n"));
+      writer.write(Buffer("e\r\n"));
+      writer.write(body);
+      writer.write(Buffer("\r\n0\r\n\r\n"));
+    }
+
+    while (!writer.flush(endpoint.get())) {
+      ::read(sv[1], drain, sizeof(drain));
+    }
+    ::read(sv[1], drain, sizeof(drain));
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  const size_t responses = pipelined * rounds;
+  const double nanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+  printf("%-10s %4zu pipelined: %8.1f ns/response, %5.2f syscalls/response\n",
+         gather ? "writev" : "write", pipelined, nanos / responses,
+         static_cast<double>(endpoint->syscalls()) / responses);
+
+  endpoint->close();
+  ::close(sv[1]);
+}
+
+int main() {
+  for (size_t pipelined: {1, 4, 16, 64}) {
+    benchmarkPipelined(false, pipelined, 10000);
+    benchmarkPipelined(true, pipelined, 10000);
+  }
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/net/EndPointWriter.h>
+#include <cortex-base/net/ByteArrayEndPoint.h>
+#include <cortex-base/Buffer.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+
+using namespace cortex;
+
+/**
+ * ByteArrayEndPoint that accepts at most @c limit bytes per flush() call,
+ * like a socket with a nearly full send buffer.
+ */
+class ShortWriteEndPoint : public ByteArrayEndPoint {
+ public:
+  explicit ShortWriteEndPoint(size_t limit)
+      : ByteArrayEndPoint(nullptr), limit_(limit), calls_(0), gathers_(0) {}
+
+  size_t calls() const { return calls_; }
+  size_t gathers() const { return gathers_; }
+
+  using ByteArrayEndPoint::flush;
+
+  size_t flush(const BufferRef& source) override {
+    calls_++;
+    return ByteArrayEndPoint::flush(
+        source.ref(0, std::min(source.size(), limit_)));
+  }
+
+  size_t flush(const BufferRef* sources, size_t count) override {
+    calls_++;
+    gathers_++;
+
+    size_t total = 0;
+    for (size_t i = 0; i < count && total < limit_; ++i) {
+      const size_t n = std::min(sources[i].size(), limit_ - total);
+      total += ByteArrayEndPoint::flush(sources[i].ref(0, n));
+    }
+    return total;
+  }
+
+ private:
+  size_t limit_;
+  size_t calls_;
+  size_t gathers_;
+};
+
+static const char* chunks[] = { "HTTP/1.1 200 Ok\r\n", "\r\n", "5\r\n",
+                                "Hello", "\r\n", "0\r\n\r\n" };
+
+static std::string writeAll(EndPointWriter* writer) {
+  std::string expected;
+  for (size_t i = 0; i < sizeof(chunks) / sizeof(*chunks); ++i) {
+    if (i % 2)
+      writer->write(BufferRef(chunks[i]));
+    else
+      writer->write(Buffer(chunks[i]));
+    expected += chunks[i];
+  }
+  return expected;
+}
+
+TEST(EndPointWriter, gatheredAtOnce) {
+  EndPointWriter writer;
+  ShortWriteEndPoint sink(1024);
+  std::string expected = writeAll(&writer);
+
+  ASSERT_TRUE(writer.flush(&sink));
+  EXPECT_EQ(expected, sink.output().str());
+  EXPECT_EQ(1, sink.calls());
+}
+
+TEST(EndPointWriter, gatheredPartialWrites) {
+  // short counts ending within chunks as well as right on their boundaries
+  for (size_t limit = 1; limit <= 24; ++limit) {
+    EndPointWriter writer;
+    ShortWriteEndPoint sink(limit);
+    std::string expected = writeAll(&writer);
+
+    size_t rounds = 0;
+    while (!writer.flush(&sink)) {
+      ASSERT_GT(expected.size(), sink.output().size()) << "limit " << limit;
+      ASSERT_EQ(expected.substr(0, sink.output().size()), sink.output().str())
+          << "limit " << limit;
+      ASSERT_LT(++rounds, expected.size()) << "limit " << limit;
+    }
+
+    EXPECT_EQ(expected, sink.output().str()) << "limit " << limit;
+    EXPECT_LT(0, sink.gathers()) << "limit " << limit;
+  }
+}
+
+TEST(EndPointWriter, flushAfterDone) {
+  EndPointWriter writer;
+  ShortWriteEndPoint sink(4);
+  std::string expected = writeAll(&writer);
+
+  while (!writer.flush(&sink)) {}
+
+  const size_t calls = sink.calls();
+  EXPECT_TRUE(writer.flush(&sink));
+  EXPECT_EQ(calls, sink.calls());
+  EXPECT_EQ(expected, sink.output().str());
+}
@@ -11,6 +11,11 @@
 #include <cortex-base/net/EndPoint.h>
 #include <cortex-base/logging.h>
 #include <unistd.h>
+#include <limits.h>
+
+#if !defined(IOV_MAX)
+#define IOV_MAX 1024
+#endif
 
 #ifndef NDEBUG
 #define TRACE(msg...) logTrace("net.EndPointWriter", msg)
@@ -21,7 +26,8 @@
 namespace cortex {
 
 EndPointWriter::EndPointWriter()
-    : chunks_() {
+    : chunks_(),
+      gathered_() {
 }
 
 EndPointWriter::~EndPointWriter() {
@@ -47,9 +53,42 @@ void EndPointWriter::write(FileRef&& chunk) {
 bool EndPointWriter::flush(EndPoint* sink) {
   TRACE("write: flushing %zu chunks", chunks_.size());
   while (!chunks_.empty()) {
-    if (!chunks_.front()->transferTo(sink))
+    BufferRef data;
+    size_t count = 0;
+    gathered_.clear();
+
+    while (count < chunks_.size() && count < IOV_MAX &&
+           chunks_[count]->pending(&data)) {
+      gathered_.push_back(data);
+      count++;
+    }
+
+    if (count > 1) {
+      if (!flushGathered(sink, count))
+        return false;
+    } else {
+      if (!chunks_.front()->transferTo(sink))
+        return false;
+
+      chunks_.pop_front();
+    }
+  }
+
+  return true;
+}
+
+bool EndPointWriter::flushGathered(EndPoint* sink, size_t count) {
+  size_t n = sink->flush(gathered_.data(), count);
+  TRACE("flushGathered: %zu bytes written from %zu chunks", n, count);
+
+  for (size_t i = 0; i < count; ++i) {
+    const size_t size = gathered_[i].size();
+    if (n < size) {
+      chunks_.front()->advance(n);
       return false;
+    }
 
+    n -= size;
     chunks_.pop_front();
   }
 
@@ -66,6 +105,11 @@ bool EndPointWriter::BufferChunk::transferTo(EndPoint* sink) {
 
   return offset_ == data_.size();
 }
+
+bool EndPointWriter::BufferChunk::pending(BufferRef* result) const {
+  *result = data_.ref(offset_);
+  return true;
+}
 // }}}
 // {{{ EndPointWriter::BufferRefChunk
 bool EndPointWriter::BufferRefChunk::transferTo(EndPoint* sink) {
@@ -75,6 +119,11 @@ bool EndPointWriter::BufferRefChunk::transferTo(EndPoint* sink) {
   offset_ += n;
   return offset_ == data_.size();
 }
+
+bool EndPointWriter::BufferRefChunk::pending(BufferRef* result) const {
+  *result = data_.ref(offset_);
+  return true;
+}
 // }}}
 // {{{ EndPointWriter::FileChunk
 EndPointWriter::FileChunk::~FileChunk() {
@@ -13,6 +13,7 @@
 #include <cortex-base/Buffer.h>
 #include <cortex-base/io/FileRef.h>
 #include <memory>
+#include <vector>
 #include <deque>
 
 namespace cortex {
@@ -25,7 +26,10 @@ class EndPoint;
 /**
  * Composable EndPoint Writer API.
  *
- * @todo 2 consecutive buffer writes should merge.
+ * Consecutive memory chunks are flushed with a single gather-write
+ * (see EndPoint::flush(const BufferRef*, size_t)), file chunks are
+ * transferred on their own.
+ *
  * @todo consider managing its own BufferPool
  */
 class CORTEX_API EndPointWriter {
@@ -64,7 +68,16 @@ class CORTEX_API EndPointWriter {
   class BufferRefChunk;
   class FileChunk;
 
+  /**
+   * Gathers the leading memory chunks into one EndPoint::flush() call.
+   *
+   * @retval true all gathered chunks have been transferred.
+   * @retval false the sink accepted only part of the gathered data.
+   */
+  bool flushGathered(EndPoint* sink, size_t count);
+
   std::deque<std::unique_ptr<Chunk>> chunks_;
+  std::vector<BufferRef> gathered_;
 };
 
 // {{{ Chunk API
@@ -73,6 +86,19 @@ class CORTEX_API EndPointWriter::Chunk {
   virtual ~Chunk() {}
 
   virtual bool transferTo(EndPoint* sink) = 0;
+
+  /**
+   * Retrieves the yet untransferred data of a memory-backed chunk.
+   *
+   * @retval true this chunk is memory-backed and @p result was set.
+   * @retval false this chunk is not memory-backed.
+   */
+  virtual bool pending(BufferRef* result) const { return false; }
+
+  /**
+   * Marks the first @p n bytes of pending() as transferred.
+   */
+  virtual void advance(size_t n) {}
 };
 
 class CORTEX_API EndPointWriter::BufferChunk : public Chunk {
@@ -87,6 +113,8 @@ class CORTEX_API EndPointWriter::BufferChunk : public Chunk {
       : data_(copy), offset_(0) {}
 
   bool transferTo(EndPoint* sink) override;
+  bool pending(BufferRef* result) const override;
+  void advance(size_t n) override { offset_ += n; }
 
  private:
   Buffer data_;
@@ -99,6 +127,8 @@ class CORTEX_API EndPointWriter::BufferRefChunk : public Chunk {
       : data_(buffer), offset_(0) {}
 
   bool transferTo(EndPoint* sink) override;
+  bool pending(BufferRef* result) const override;
+  void advance(size_t n) override { offset_ += n; }
 
  private:
   BufferRef data_;
@@ -510,6 +510,11 @@ std::list<RefPtr<EndPoint>> InetConnector::connectedEndPoints() {
   return result;
 }
 
+size_t InetConnector::connectedEndPointCount() const {
+  std::lock_guard<std::mutex> _lk(mutex_);
+  return connectedEndPoints_.size();
+}
+
 void InetConnector::onEndPointClosed(EndPoint* endpoint) {
   assert(endpoint != nullptr);
   assert(endpoint->connection() != nullptr);
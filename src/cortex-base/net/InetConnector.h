@@ -235,6 +235,11 @@ class CORTEX_API InetConnector : public Connector {
   void stop() override;
   std::list<RefPtr<EndPoint>> connectedEndPoints() override;
 
+  /**
+   * Retrieves the number of currently connected endpoints.
+   */
+  size_t connectedEndPointCount() const;
+
  private:
   /**
    * Registers to the Scheduler API for new incoming connections.
@@ -296,7 +301,7 @@ class CORTEX_API InetConnector : public Connector {
   SafeCall safeCall_;
 
   std::list<RefPtr<EndPoint>> connectedEndPoints_;
-  std::mutex mutex_;
+  mutable std::mutex mutex_;
   int socket_;
   int addressFamily_;
   int typeMask_;
@@ -16,16 +16,23 @@
 #include <cortex-base/Buffer.h>
 #include <cortex-base/sysconfig.h>
 #include <cortex-base/RefPtr.h>
+#include <algorithm>
 #include <stdexcept>
 #include <netinet/tcp.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <limits.h>
 
 #if defined(HAVE_SYS_SENDFILE_H)
 #include <sys/sendfile.h>
 #endif
 
+#if !defined(IOV_MAX)
+#define IOV_MAX 1024
+#endif
+
 namespace cortex {
 
 #define ERROR(msg...) logError("net.InetEndPoint", msg)
@@ -247,6 +254,28 @@ size_t InetEndPoint::flush(const BufferRef& source) {
   return rv;
 }
 
+size_t InetEndPoint::flush(const BufferRef* sources, size_t count) {
+  if (count == 1)
+    return flush(sources[0]);
+
+  iovec vec[IOV_MAX];
+  count = std::min(count, static_cast<size_t>(IOV_MAX));
+
+  for (size_t i = 0; i < count; ++i) {
+    vec[i].iov_base = const_cast<char*>(sources[i].data());
+    vec[i].iov_len = sources[i].size();
+  }
+
+  ssize_t rv = writev(handle(), vec, count);
+
+  TRACE("flush(%zu buffers) -> %zi", count, rv);
+
+  if (rv < 0)
+    RAISE_ERRNO(errno);
+
+  return rv;
+}
+
 size_t InetEndPoint::flush(int fd, off_t offset, size_t size) {
 #if defined(__APPLE__)
   off_t len = 0;
@@ -80,6 +80,7 @@ class CORTEX_API InetEndPoint : public EndPoint {
   std::string toString() const override;
   size_t fill(Buffer* result) override;
   size_t flush(const BufferRef& source) override;
+  size_t flush(const BufferRef* sources, size_t count) override;
   size_t flush(int fd, off_t offset, size_t size) override;
   void wantFill() override;
   void wantFlush() override;
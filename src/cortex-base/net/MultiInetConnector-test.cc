@@ -0,0 +1,117 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/net/MultiInetConnector.h>
+#include <cortex-base/net/ConnectionFactory.h>
+#include <cortex-base/net/Connection.h>
+#include <cortex-base/net/IPAddress.h>
+#include <cortex-base/RuntimeError.h>
+#include <cortex-base/WallClock.h>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace cortex;
+
+class IdleConnection : public Connection { // {{{
+ public:
+  IdleConnection(EndPoint* endpoint, Executor* executor)
+      : Connection(endpoint, executor) {}
+
+  void onOpen() override {
+    Connection::onOpen();
+    wantFill();
+  }
+
+  void onFillable() override {}
+  void onFlushable() override {}
+};
+// }}}
+class IdleConnectionFactory : public ConnectionFactory { // {{{
+ public:
+  IdleConnectionFactory() : ConnectionFactory("idle") {}
+
+  Connection* create(Connector* connector, EndPoint* endpoint) override {
+    return configure(new IdleConnection(endpoint, connector->executor()),
+                     connector);
+  }
+};
+// }}}
+
+static sockaddr_in loopbackAddress(int port) {
+  sockaddr_in sin;
+  memset(&sin, 0, sizeof(sin));
+  sin.sin_family = AF_INET;
+  sin.sin_port = htons(port);
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return sin;
+}
+
+static int findUnusedPort() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in sin = loopbackAddress(0);
+  socklen_t len = sizeof(sin);
+
+  bind(fd, (sockaddr*) &sin, sizeof(sin));
+  getsockname(fd, (sockaddr*) &sin, &len);
+  close(fd);
+
+  return ntohs(sin.sin_port);
+}
+
+TEST(MultiInetConnector, distributesAcrossLoops) {
+  const size_t loopCount = 4;
+  const size_t clientCount = 64;
+  const int port = findUnusedPort();
+
+  MultiInetConnector connector(
+      "test", WallClock::monotonic(),
+      TimeSpan::fromSeconds(30), TimeSpan::fromSeconds(30), TimeSpan::Zero,
+      &logAndPass, IPAddress("127.0.0.1"), port, 128, true,
+      loopCount, false);
+  connector.addConnectionFactory<IdleConnectionFactory>();
+  connector.start();
+
+  std::vector<int> clients;
+  for (size_t i = 0; i < clientCount; ++i) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sin = loopbackAddress(port);
+    ASSERT_EQ(0, connect(fd, (sockaddr*) &sin, sizeof(sin)));
+    clients.push_back(fd);
+  }
+
+  // the loops accept asynchronously
+  std::vector<size_t> counts;
+  for (int retry = 0; retry < 200; ++retry) {
+    counts = connector.connectedEndPointCounts();
+    if (std::accumulate(counts.begin(), counts.end(), 0u) == clientCount)
+      break;
+    usleep(10 * 1000);
+  }
+
+  ASSERT_EQ(loopCount, counts.size());
+  EXPECT_EQ(clientCount, std::accumulate(counts.begin(), counts.end(), 0u));
+  for (size_t i = 0; i < loopCount; ++i) {
+    EXPECT_EQ(counts[i], connector.connectedEndPointCount(i));
+
+    // all loops idle at once, so the kernel spreads the connections
+    // over all of them (failing with a chance of 4 * (3/4)^64)
+    EXPECT_LT(0, counts[i]);
+  }
+
+  for (int fd: clients)
+    close(fd);
+
+  connector.stop();
+}
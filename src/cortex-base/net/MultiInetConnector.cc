@@ -0,0 +1,207 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cortex-base/net/MultiInetConnector.h>
+#include <cortex-base/net/InetConnector.h>
+#include <cortex-base/net/ConnectionFactory.h>
+#include <cortex-base/executor/NativeScheduler.h>
+#include <cortex-base/executor/ThreadPool.h>
+#include <cortex-base/RuntimeError.h>
+#include <cortex-base/logging.h>
+#include <cortex-base/sysconfig.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdio.h>
+
+#if !defined(NDEBUG)
+#define TRACE(msg...) logTrace("MultiInetConnector", msg)
+#else
+#define TRACE(msg...) do {} while (0)
+#endif
+
+namespace cortex {
+
+static void setCpuAffinity(size_t cpu) {
+#if defined(HAVE_PTHREAD_SETAFFINITY_NP)
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  int rv = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (rv != 0) {
+    logWarning("MultiInetConnector",
+               "Could not set CPU affinity to core %zu. %s",
+               cpu, strerror(rv));
+  }
+#endif
+}
+
+MultiInetConnector::MultiInetConnector(
+    const std::string& name, WallClock* clock,
+    TimeSpan readTimeout, TimeSpan writeTimeout, TimeSpan tcpFinTimeout,
+    std::function<void(const std::exception&)> eh,
+    const IPAddress& ipaddress, int port, int backlog,
+    bool reuseAddr, size_t loopCount, bool cpuAffinity)
+    : Connector(name, nullptr, clock),
+      loops_(),
+      threads_(),
+      cpuAffinity_(cpuAffinity),
+      isStarted_(false) {
+
+  if (loopCount == 0)
+    loopCount = ThreadPool::processorCount();
+
+  loops_.resize(loopCount);
+
+  for (Loop& loop: loops_) {
+    loop.scheduler.reset(new NativeScheduler());
+
+    // every loop has its own listener socket, so that the kernel can
+    // distribute new connections among them without any locking involved.
+    loop.connector.reset(new InetConnector(
+        name, loop.scheduler.get(), loop.scheduler.get(), clock,
+        readTimeout, writeTimeout, tcpFinTimeout, eh,
+        ipaddress, port, backlog, reuseAddr, true));
+
+    loop.connector->setBlocking(false);
+  }
+}
+
+MultiInetConnector::~MultiInetConnector() {
+  TRACE("~MultiInetConnector");
+
+  if (isStarted()) {
+    stop();
+  }
+
+  // the connectors must be gone before the schedulers they are bound to
+  for (Loop& loop: loops_) {
+    loop.connector.reset();
+  }
+}
+
+Scheduler* MultiInetConnector::scheduler(size_t i) const {
+  return loops_[i].scheduler.get();
+}
+
+InetConnector* MultiInetConnector::connector(size_t i) const {
+  return loops_[i].connector.get();
+}
+
+void MultiInetConnector::each(std::function<void(InetConnector*)> callback) {
+  for (Loop& loop: loops_) {
+    callback(loop.connector.get());
+  }
+}
+
+size_t MultiInetConnector::connectedEndPointCount(size_t i) const {
+  return loops_[i].connector->connectedEndPointCount();
+}
+
+std::vector<size_t> MultiInetConnector::connectedEndPointCounts() const {
+  std::vector<size_t> result;
+  result.reserve(loops_.size());
+
+  for (const Loop& loop: loops_) {
+    result.push_back(loop.connector->connectedEndPointCount());
+  }
+
+  return result;
+}
+
+void MultiInetConnector::start() {
+  if (isStarted()) {
+    return;
+  }
+
+  TRACE("start: %s with %zu loops", name().c_str(), loops_.size());
+
+  for (Loop& loop: loops_) {
+    InetConnector* connector = loop.connector.get();
+
+    connector->setServer(server());
+
+    for (const auto& factory: connectionFactories()) {
+      connector->addConnectionFactory(factory);
+    }
+
+    if (defaultConnectionFactory()) {
+      connector->setDefaultConnectionFactory(defaultConnectionFactory());
+    }
+
+    for (ConnectionListener* listener: listeners()) {
+      connector->addListener(listener);
+    }
+
+    connector->start();
+  }
+
+  isStarted_ = true;
+
+  for (size_t i = 0; i < loops_.size(); ++i) {
+    char threadName[16];
+    snprintf(threadName, sizeof(threadName), "cortex-io/%zu", i);
+    threads_.execute(threadName, std::bind(&MultiInetConnector::runLoop, this, i));
+  }
+}
+
+void MultiInetConnector::runLoop(size_t i) {
+  TRACE("runLoop: %zu enter", i);
+
+  if (cpuAffinity_) {
+    setCpuAffinity(i % ThreadPool::processorCount());
+  }
+
+  Scheduler* scheduler = loops_[i].scheduler.get();
+
+  while (isStarted_) {
+    scheduler->runLoopOnce();
+  }
+
+  TRACE("runLoop: %zu leave", i);
+}
+
+bool MultiInetConnector::isStarted() const CORTEX_NOEXCEPT {
+  return isStarted_;
+}
+
+void MultiInetConnector::stop() {
+  TRACE("stop: %s", name().c_str());
+
+  if (!isStarted()) {
+    return;
+  }
+
+  isStarted_ = false;
+
+  for (Loop& loop: loops_) {
+    loop.scheduler->breakLoop();
+  }
+
+  threads_.joinAll();
+
+  // now that no loop is running anymore, the listeners can be
+  // stopped without racing against their accept handlers.
+  for (Loop& loop: loops_) {
+    loop.connector->stop();
+  }
+}
+
+std::list<RefPtr<EndPoint>> MultiInetConnector::connectedEndPoints() {
+  std::list<RefPtr<EndPoint>> result;
+
+  for (Loop& loop: loops_) {
+    result.splice(result.end(), loop.connector->connectedEndPoints());
+  }
+
+  return result;
+}
+
+}  // namespace cortex
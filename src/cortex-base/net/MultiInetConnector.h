@@ -0,0 +1,128 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cortex-base/Api.h>
+#include <cortex-base/sysconfig.h>
+#include <cortex-base/net/Connector.h>
+#include <cortex-base/net/IPAddress.h>
+#include <cortex-base/executor/Scheduler.h>
+#include <cortex-base/executor/ThreadedExecutor.h>
+#include <cortex-base/TimeSpan.h>
+#include <cortex-base/RefPtr.h>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <list>
+
+namespace cortex {
+
+class InetConnector;
+
+/**
+ * Multi-reactor TCP/IP Internet Connector.
+ *
+ * Opens one @c SO_REUSEPORT enabled InetConnector per event loop, all bound
+ * to the same address, and lets the kernel distribute incoming connections
+ * across them. Every event loop is driven by its own scheduler thread,
+ * optionally pinned to a dedicated CPU core, and every endpoint accepted by
+ * a loop stays on that loop for its whole lifetime, including its
+ * connection's handlers.
+ *
+ * Connection factories and listeners registered on this connector are
+ * propagated to each loop's InetConnector upon start().
+ *
+ * @see InetConnector
+ */
+class CORTEX_API MultiInetConnector : public Connector {
+ public:
+  /**
+   * Initializes this connector.
+   *
+   * @param name Describing name for this connector.
+   * @param clock Wall clock used for timeout management.
+   * @param readTimeout timespan indicating how long a connection may for read
+   *                    readiness.
+   * @param writeTimeout timespan indicating how long a connection wait for
+   *                     write readiness.
+   * @param tcpFinTimeout Timespan to leave client sockets in FIN_WAIT2 state.
+   *                      A value of 0 means to leave it at system default.
+   * @param eh exception handler for errors in hooks or during events.
+   * @param ipaddress TCP/IP address to listen on
+   * @param port TCP/IP port number to listen on
+   * @param backlog TCP backlog for each listener.
+   * @param reuseAddr Flag indicating @c SO_REUSEADDR.
+   * @param loopCount number of event loops to spawn, or 0 to spawn one
+   *                  per CPU core.
+   * @param cpuAffinity whether or not to pin each event loop thread to
+   *                    a CPU core.
+   *
+   * @throw std::runtime_error on any kind of runtime error.
+   */
+  MultiInetConnector(const std::string& name, WallClock* clock,
+                     TimeSpan readTimeout, TimeSpan writeTimeout,
+                     TimeSpan tcpFinTimeout,
+                     std::function<void(const std::exception&)> eh,
+                     const IPAddress& ipaddress, int port, int backlog,
+                     bool reuseAddr, size_t loopCount, bool cpuAffinity);
+
+  ~MultiInetConnector();
+
+  /** Retrieves the number of event loops. */
+  size_t loopCount() const CORTEX_NOEXCEPT { return loops_.size(); }
+
+  /** Retrieves the scheduler driving the @p i-th event loop. */
+  Scheduler* scheduler(size_t i) const;
+
+  /** Retrieves the listener owned by the @p i-th event loop. */
+  InetConnector* connector(size_t i) const;
+
+  /** Invokes @p callback for each event loop's listener. */
+  void each(std::function<void(InetConnector*)> callback);
+
+  /** Retrieves the number of endpoints connected to the @p i-th loop. */
+  size_t connectedEndPointCount(size_t i) const;
+
+  /** Retrieves the number of connected endpoints, one entry per loop. */
+  std::vector<size_t> connectedEndPointCounts() const;
+
+  /**
+   * Tests whether or not event loop threads are pinned to CPU cores.
+   */
+  bool cpuAffinity() const CORTEX_NOEXCEPT { return cpuAffinity_; }
+
+  void start() override;
+  bool isStarted() const CORTEX_NOEXCEPT override;
+  void stop() override;
+
+  /**
+   * Retrieves the endpoints connected to any of the event loops.
+   *
+   * The endpoints are grouped by loop, in loop order.
+   */
+  std::list<RefPtr<EndPoint>> connectedEndPoints() override;
+
+ private:
+  struct Loop {
+    std::unique_ptr<Scheduler> scheduler;
+    std::unique_ptr<InetConnector> connector;
+  };
+
+  void runLoop(size_t i);
+
+ private:
+  std::vector<Loop> loops_;
+  ThreadedExecutor threads_;
+  bool cpuAffinity_;
+  std::atomic<bool> isStarted_;
+};
+
+}  // namespace cortex
@@ -10,6 +10,7 @@
 #include <cortex-base/net/SslConnector.h>
 #include <cortex-base/net/SslContext.h>
 #include <cortex-base/net/Connection.h>
+#include <cortex-base/net/ConnectionFactory.h>
 #include <cortex-base/sysconfig.h>
 #include <cortex-base/RuntimeError.h>
 #include <openssl/bio.h>
@@ -19,6 +20,8 @@
 #include <openssl/x509v3.h>
 #include <openssl/objects.h>
 #include <algorithm>
+#include <vector>
+#include <string.h>
 
 namespace cortex {
 
@@ -181,27 +184,32 @@ int SslContext::onAppLayerProtoNegotiation(SSL* ssl,
     const unsigned char **out, unsigned char *outlen,
     const unsigned char *in, unsigned int inlen, void *pself) {
 #ifdef TLSEXT_TYPE_application_layer_protocol_negotiation
-  TRACE("SSL ALPN callback");
-
-  for (int i = 0; i < inlen; i += in[i] + 1) {
-    std::string proto((char*)&in[i + 1], in[i]);
-    printf("SSL ALPN client support [%d]: (%d) %s\n", i, in[i], proto.c_str());
+  SslContext* self = (SslContext*) pself;
+  TRACE("%p SSL ALPN callback", self);
+
+  // our preference: h2 first, then whatever else the connector speaks
+  std::vector<std::string> protocols;
+  for (const auto& factory: self->connector_->connectionFactories())
+    protocols.push_back(factory->protocolName());
+
+  std::stable_partition(protocols.begin(), protocols.end(),
+                        [](const std::string& name) { return name == "h2"; });
+
+  // select from the client's list, so that *out stays valid after we return
+  for (const std::string& proto: protocols) {
+    for (unsigned int i = 0; i + 1 <= inlen && i + 1 + in[i] <= inlen;
+         i += in[i] + 1) {
+      if (proto.size() == in[i] &&
+          memcmp(proto.data(), &in[i + 1], in[i]) == 0) {
+        *out = &in[i + 1];
+        *outlen = in[i];
+        TRACE("SSL ALPN selected: \"%s\"", proto.c_str());
+        return SSL_TLSEXT_ERR_OK;
+      }
+    }
   }
 
-  const unsigned char* srv = (const unsigned char*) NPN_HTTP_1_1;
-  unsigned int srvlen = sizeof(NPN_HTTP_1_1) - 1;
-
-  int rv = SSL_select_next_proto(
-      (unsigned char**) out, outlen,
-      srv, srvlen,
-      in, inlen);
-
-  if (rv != OPENSSL_NPN_NEGOTIATED)
-    return SSL_TLSEXT_ERR_NOACK;
-
-  TRACE("SSL ALPN selected: \"%*s\"", *outlen, *out);
-
-  return SSL_TLSEXT_ERR_OK;
+  return SSL_TLSEXT_ERR_NOACK;
 #else
   return SSL_TLSEXT_ERR_NOACK;
 #endif
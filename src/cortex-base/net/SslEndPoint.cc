@@ -187,7 +187,8 @@ size_t SslEndPoint::flush(const BufferRef& source) {
 size_t SslEndPoint::flush(int fd, off_t offset, size_t size) {
   Buffer buf;
   buf.reserve(size);
-  ssize_t rv = ::read(fd, buf.data(), buf.capacity());
+  // positional read, so that shared file handles keep their file offset
+  ssize_t rv = ::pread(fd, buf.data(), buf.capacity(), offset);
   if (rv < 0) {
     switch (errno) {
       case EBUSY:
@@ -356,8 +357,8 @@ void SslEndPoint::onHandshake() {
     std::string protocol = nextProtocolNegotiated().str();
     auto factory = connector_->connectionFactory(protocol);
     if (!factory) {
-      TRACE("%p using connection factory: default (\"%s\")", this, factory->protocolName().c_str());
       factory = connector_->defaultConnectionFactory();
+      TRACE("%p using connection factory: default (\"%s\")", this, factory->protocolName().c_str());
     } else {
       TRACE("%p using connection factory: \"%s\"", this, factory->protocolName().c_str());
     }
@@ -0,0 +1,38 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#define CORTEX_BASE_VERSION "@CORTEX_BASE_VERSION@"
+
+// --------------------------------------------------------------------------
+// feature tests
+
+#cmakedefine ENABLE_ACCEPT4
+
+#cmakedefine CORTEX_ENABLE_NOEXCEPT
+
+// --------------------------------------------------------------------------
+// header tests
+
+#cmakedefine HAVE_SYS_INOTIFY_H
+#cmakedefine HAVE_SYS_SENDFILE_H
+#cmakedefine HAVE_EXECINFO_H
+#cmakedefine HAVE_UNISTD_H
+#cmakedefine HAVE_BROTLI_ENCODE_H
+#cmakedefine HAVE_ZSTD_H
+
+// --------------------------------------------------------------------------
+// functional tests
+
+#cmakedefine HAVE_INOTIFY_INIT1
+#cmakedefine HAVE_POSIX_FADVISE
+#cmakedefine HAVE_PREAD
+#cmakedefine HAVE_ACCEPT4
+#cmakedefine HAVE_PTHREAD_SETAFFINITY_NP
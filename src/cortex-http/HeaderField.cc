@@ -12,8 +12,175 @@
 namespace cortex {
 namespace http {
 
+KnownHeader toKnownHeader(const BufferRef& name) {
+  switch (name.size()) {
+    case 2:
+      if (iequals(name, "TE")) return KnownHeader::TE;
+      break;
+    case 4:
+      if (iequals(name, "Date")) return KnownHeader::Date;
+      if (iequals(name, "ETag")) return KnownHeader::ETag;
+      if (iequals(name, "Host")) return KnownHeader::Host;
+      if (iequals(name, "Vary")) return KnownHeader::Vary;
+      break;
+    case 5:
+      if (iequals(name, "Range")) return KnownHeader::Range;
+      break;
+    case 6:
+      if (iequals(name, "Accept")) return KnownHeader::Accept;
+      if (iequals(name, "Cookie")) return KnownHeader::Cookie;
+      if (iequals(name, "Expect")) return KnownHeader::Expect;
+      if (iequals(name, "Server")) return KnownHeader::Server;
+      break;
+    case 7:
+      if (iequals(name, "Referer")) return KnownHeader::Referer;
+      if (iequals(name, "Trailer")) return KnownHeader::Trailer;
+      if (iequals(name, "Upgrade")) return KnownHeader::Upgrade;
+      break;
+    case 8:
+      if (iequals(name, "If-Match")) return KnownHeader::IfMatch;
+      if (iequals(name, "If-Range")) return KnownHeader::IfRange;
+      if (iequals(name, "Location")) return KnownHeader::Location;
+      break;
+    case 10:
+      if (iequals(name, "Connection")) return KnownHeader::Connection;
+      if (iequals(name, "Keep-Alive")) return KnownHeader::KeepAlive;
+      if (iequals(name, "Set-Cookie")) return KnownHeader::SetCookie;
+      if (iequals(name, "User-Agent")) return KnownHeader::UserAgent;
+      break;
+    case 12:
+      if (iequals(name, "Content-Type")) return KnownHeader::ContentType;
+      break;
+    case 13:
+      if (iequals(name, "Authorization")) return KnownHeader::Authorization;
+      if (iequals(name, "Cache-Control")) return KnownHeader::CacheControl;
+      if (iequals(name, "If-None-Match")) return KnownHeader::IfNoneMatch;
+      if (iequals(name, "Last-Modified")) return KnownHeader::LastModified;
+      break;
+    case 14:
+      if (iequals(name, "Content-Length")) return KnownHeader::ContentLength;
+      break;
+    case 15:
+      if (iequals(name, "Accept-Encoding")) return KnownHeader::AcceptEncoding;
+      if (iequals(name, "Accept-Language")) return KnownHeader::AcceptLanguage;
+      break;
+    case 16:
+      if (iequals(name, "Content-Encoding")) return KnownHeader::ContentEncoding;
+      break;
+    case 17:
+      if (iequals(name, "If-Modified-Since")) return KnownHeader::IfModifiedSince;
+      if (iequals(name, "Transfer-Encoding")) return KnownHeader::TransferEncoding;
+      break;
+    case 19:
+      if (iequals(name, "If-Unmodified-Since")) return KnownHeader::IfUnmodifiedSince;
+      break;
+    default:
+      break;
+  }
+  return KnownHeader::Unknown;
+}
+
+const char* to_string(KnownHeader id) {
+  static const char* names[KnownHeaderCount] = {
+    "",
+    "Accept",
+    "Accept-Encoding",
+    "Accept-Language",
+    "Authorization",
+    "Cache-Control",
+    "Connection",
+    "Content-Encoding",
+    "Content-Length",
+    "Content-Type",
+    "Cookie",
+    "Date",
+    "ETag",
+    "Expect",
+    "Host",
+    "If-Match",
+    "If-Modified-Since",
+    "If-None-Match",
+    "If-Range",
+    "If-Unmodified-Since",
+    "Keep-Alive",
+    "Last-Modified",
+    "Location",
+    "Range",
+    "Referer",
+    "Server",
+    "Set-Cookie",
+    "TE",
+    "Trailer",
+    "Transfer-Encoding",
+    "Upgrade",
+    "User-Agent",
+    "Vary",
+  };
+  return names[static_cast<size_t>(id)];
+}
+
+HeaderField::HeaderField()
+    : storage_(), data_(nullptr), nameLength_(0), valueLength_(0),
+      id_(KnownHeader::Unknown) {
+}
+
 HeaderField::HeaderField(const std::string& name, const std::string& value)
-  : name_(name), value_(value) {
+    : HeaderField() {
+  assign(BufferRef(name), BufferRef(value));
+}
+
+HeaderField::HeaderField(const char* data, size_t nameLength,
+                         size_t valueLength, KnownHeader id)
+    : storage_(),
+      data_(data),
+      nameLength_(nameLength),
+      valueLength_(valueLength),
+      id_(id) {
+}
+
+HeaderField::HeaderField(const HeaderField& other)
+    : HeaderField() {
+  assign(other.name(), other.value());
+}
+
+HeaderField& HeaderField::operator=(const HeaderField& other) {
+  if (this != &other)
+    assign(other.name(), other.value());
+
+  return *this;
+}
+
+void HeaderField::assign(const BufferRef& name, const BufferRef& value) {
+  std::string storage;
+  storage.reserve(name.size() + value.size());
+  storage.append(name.data(), name.size());
+  storage.append(value.data(), value.size());
+
+  storage_.swap(storage);
+  data_ = nullptr;
+  nameLength_ = name.size();
+  valueLength_ = value.size();
+  id_ = toKnownHeader(name);
+}
+
+void HeaderField::setName(const std::string& name) {
+  assign(BufferRef(name), value());
+}
+
+void HeaderField::setValue(const std::string& value) {
+  assign(name(), BufferRef(value));
+}
+
+void HeaderField::appendValue(const std::string& value,
+                              const std::string& delim) {
+  if (valueLength_ == 0) {
+    setValue(value);
+  } else {
+    assign(name(), this->value());
+    storage_ += delim;
+    storage_ += value;
+    valueLength_ += delim.size() + value.size();
+  }
 }
 
 bool HeaderField::operator==(const HeaderField& other) const {
@@ -26,8 +193,8 @@ bool HeaderField::operator!=(const HeaderField& other) const {
 
 std::string inspect(const HeaderField& field) {
   return StringUtil::format("HeaderField(\"$0\", \"$1\")",
-                            field.name(),
-                            field.value());
+                            field.name().str(),
+                            field.value().str());
 }
 
 } // namespace http
@@ -8,37 +8,93 @@
 #pragma once
 
 #include <cortex-http/Api.h>
+#include <cortex-base/Buffer.h>
 #include <string>
+#include <stdint.h>
 
 namespace cortex {
 namespace http {
 
+/**
+ * Header fields looked up often enough to deserve a fixed slot
+ * in HeaderFieldList.
+ */
+enum class KnownHeader : uint8_t {
+  Unknown = 0,
+  Accept,
+  AcceptEncoding,
+  AcceptLanguage,
+  Authorization,
+  CacheControl,
+  Connection,
+  ContentEncoding,
+  ContentLength,
+  ContentType,
+  Cookie,
+  Date,
+  ETag,
+  Expect,
+  Host,
+  IfMatch,
+  IfModifiedSince,
+  IfNoneMatch,
+  IfRange,
+  IfUnmodifiedSince,
+  KeepAlive,
+  LastModified,
+  Location,
+  Range,
+  Referer,
+  Server,
+  SetCookie,
+  TE,
+  Trailer,
+  TransferEncoding,
+  Upgrade,
+  UserAgent,
+  Vary,
+};
+
+constexpr size_t KnownHeaderCount = static_cast<size_t>(KnownHeader::Vary) + 1;
+
+/**
+ * Maps a (case-insensitive) header field name to its KnownHeader.
+ */
+CORTEX_HTTP_API KnownHeader toKnownHeader(const BufferRef& name);
+
+/**
+ * Retrieves the canonical spelling of given known header field name.
+ */
+CORTEX_HTTP_API const char* to_string(KnownHeader id);
+
 /**
  * Represents a single HTTP message header name/value pair.
+ *
+ * A field either owns its name and value or, as entries of a
+ * HeaderFieldList, refers to the list's arena.
  */
 class CORTEX_HTTP_API HeaderField {
  public:
-  HeaderField() = default;
+  HeaderField();
   HeaderField(HeaderField&&) = default;
-  HeaderField(const HeaderField&) = default;
   HeaderField& operator=(HeaderField&&) = default;
-  HeaderField& operator=(const HeaderField&) = default;
+
+  /** Copies always own their name and value. */
+  HeaderField(const HeaderField& other);
+  HeaderField& operator=(const HeaderField& other);
+
   HeaderField(const std::string& name, const std::string& value);
 
-  const std::string& name() const { return name_; }
-  void setName(const std::string& name) { name_ = name; }
+  BufferRef name() const { return BufferRef(data(), nameLength_); }
+  void setName(const std::string& name);
+
+  BufferRef value() const { return BufferRef(data() + nameLength_, valueLength_); }
+  void setValue(const std::string& value);
 
-  const std::string& value() const { return value_; }
-  void setValue(const std::string& value) { value_ = value; }
+  void appendValue(const std::string& value, const std::string& delim = "");
 
-  void appendValue(const std::string& value, const std::string& delim = "") {
-    if (value_.empty()) {
-      value_ = value;
-    } else {
-      value_ += delim;
-      value_ += value;
-    }
-  }
+  /** The well-known header this field's name denotes, if any. */
+  KnownHeader id() const { return id_; }
 
   /** Performs an case-insensitive compare on name and value for equality. */
   bool operator==(const HeaderField& other) const;
@@ -47,8 +103,21 @@ class CORTEX_HTTP_API HeaderField {
   bool operator!=(const HeaderField& other) const;
 
  private:
-  std::string name_;
-  std::string value_;
+  friend class HeaderFieldList;
+
+  // refers to name and value stored contiguously elsewhere
+  HeaderField(const char* data, size_t nameLength, size_t valueLength,
+              KnownHeader id);
+
+  const char* data() const { return data_ ? data_ : storage_.data(); }
+  void assign(const BufferRef& name, const BufferRef& value);
+
+ private:
+  std::string storage_;  //!< name and value, unless referring elsewhere
+  const char* data_;
+  uint32_t nameLength_;
+  uint32_t valueLength_;
+  KnownHeader id_;
 };
 
 CORTEX_HTTP_API std::string inspect(const HeaderField& field);
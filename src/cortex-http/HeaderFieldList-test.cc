@@ -119,3 +119,91 @@ TEST(http_HeaderFieldList, reset) {
 
   ASSERT_TRUE(a.empty());
 }
+
+TEST(http_HeaderFieldList, knownHeaders) {
+  HeaderFieldList a = {{"host", "example.com"},
+                       {"X-Custom", "one"},
+                       {"Accept-Encoding", "gzip"},
+                       {"Host", "duplicate"}};
+
+  ASSERT_TRUE(a.contains(KnownHeader::Host));
+  ASSERT_EQ("example.com", a.get(KnownHeader::Host));
+  ASSERT_EQ("example.com", a.get("HOST"));
+  ASSERT_EQ("gzip", a.get(KnownHeader::AcceptEncoding));
+  ASSERT_FALSE(a.contains(KnownHeader::ContentLength));
+  ASSERT_EQ("one", a.get("x-custom"));
+
+  // slots follow removal of earlier fields
+  a.remove("X-Custom");
+  ASSERT_EQ("gzip", a.get(KnownHeader::AcceptEncoding));
+
+  a.remove("Host");
+  ASSERT_FALSE(a.contains(KnownHeader::Host));
+  ASSERT_EQ(1, a.size());
+}
+
+TEST(http_HeaderFieldList, copyIsIndependent) {
+  HeaderFieldList a = {{"foo", "bar"}};
+  HeaderFieldList b(a);
+
+  a.reset();
+  a.push_back("foo", "overwritten");
+
+  ASSERT_EQ("bar", b.get("foo"));
+
+  // fields copied out of a list own their storage, too
+  HeaderField field = *b.begin();
+  b.reset();
+  ASSERT_EQ("bar", field.value());
+}
+
+TEST(http_HeaderFieldList, reuseAfterReset) {
+  HeaderFieldList a;
+
+  for (int round = 0; round < 3; ++round) {
+    a.push_back("Content-Type", "text/plain");
+    a.append("Vary", "Accept");
+    a.append("Vary", "Accept-Encoding", ", ");
+    ASSERT_EQ("Accept, Accept-Encoding", a.get(KnownHeader::Vary));
+    ASSERT_EQ(2, a.size());
+    a.reset();
+  }
+}
+
+TEST(http_HeaderFieldList, borrowedArena) {
+  Arena arena;
+  HeaderFieldList a(&arena);
+
+  a.push_back("Host", "example.com");
+  a.push_back("X-Custom", "one");
+  ASSERT_LT(0, arena.bytesUsed());
+
+  // resetting the arena is up to its owner
+  a.reset();
+  ASSERT_LT(0, arena.bytesUsed());
+  arena.reset();
+
+  for (int i = 0; i < 20; ++i)
+    a.push_back("X-Number", BufferRef(std::to_string(i)));
+
+  ASSERT_EQ(20, a.size());
+  ASSERT_EQ("0", a.get("x-number"));
+}
+
+TEST(http_HeaderFieldList, swapWithBorrowedArena) {
+  Arena arena;
+  HeaderFieldList a(&arena);
+  HeaderFieldList b = {{"foo", "bar"}};
+
+  a.push_back("Host", "example.com");
+  a.swap(b);
+
+  ASSERT_EQ("bar", a.get("foo"));
+  ASSERT_EQ("example.com", b.get(KnownHeader::Host));
+
+  // b's copy does not refer to the borrowed arena's storage
+  a.reset();
+  arena.reset();
+  a.push_back("overwrite", "all the bytes in the arena");
+  ASSERT_EQ("example.com", b.get(KnownHeader::Host));
+}
@@ -8,70 +8,206 @@
 #include <cortex-http/HeaderFieldList.h>
 #include <cortex-base/Buffer.h>
 #include <algorithm>
+#include <new>
+#include <string.h>
 
 namespace cortex {
 namespace http {
 
+//! number of fields to make room for once a list gets its first one
+static constexpr size_t InitialCapacity = 8;
+
+HeaderFieldList::HeaderFieldList()
+    : HeaderFieldList(nullptr) {
+}
+
+HeaderFieldList::HeaderFieldList(Arena* arena)
+    : ownArena_(),
+      arena_(arena ? arena : &ownArena_),
+      entries_(nullptr),
+      size_(0),
+      capacity_(0) {
+  clearSlots();
+}
+
+HeaderFieldList::~HeaderFieldList() {
+  clear();
+}
+
+HeaderFieldList::HeaderFieldList(HeaderFieldList&& other)
+    : HeaderFieldList() {
+  swap(other);
+}
+
+HeaderFieldList::HeaderFieldList(const HeaderFieldList& other)
+    : HeaderFieldList() {
+  *this = other;
+}
+
+HeaderFieldList& HeaderFieldList::operator=(HeaderFieldList&& other) {
+  reset();
+  swap(other);
+  return *this;
+}
+
+HeaderFieldList& HeaderFieldList::operator=(const HeaderFieldList& other) {
+  if (this != &other) {
+    reset();
+    reserve(other.size());
+    for (const HeaderField& field: other)
+      push_back(field.name(), field.value());
+  }
+  return *this;
+}
+
 HeaderFieldList::HeaderFieldList(
-    const std::initializer_list<std::pair<std::string, std::string>>& init) {
+    const std::initializer_list<std::pair<std::string, std::string>>& init)
+    : HeaderFieldList() {
 
   for (const auto& field : init) {
-    push_back(field.first, field.second);
+    push_back(BufferRef(field.first), BufferRef(field.second));
   }
 }
 
-void HeaderFieldList::push_back(const std::string& name,
-                                const std::string& value) {
-  entries_.emplace_back(name, value);
+HeaderField HeaderFieldList::makeField(const BufferRef& name,
+                                       const BufferRef& value,
+                                       KnownHeader id) {
+  // name and value are stored contiguously, as HeaderField expects
+  char* data = static_cast<char*>(
+      arena_->allocate(name.size() + value.size(), 1));
+  memcpy(data, name.data(), name.size());
+  memcpy(data + name.size(), value.data(), value.size());
+
+  return HeaderField(data, name.size(), value.size(), id);
+}
+
+void HeaderFieldList::push_back(const BufferRef& name,
+                                const BufferRef& value) {
+  const KnownHeader id = toKnownHeader(name);
+
+  if (size_ == capacity_)
+    reserve(size_ + 1);
+
+  new (entries_ + size_) HeaderField(makeField(name, value, id));
+  size_++;
+
+  uint32_t& slot = slots_[static_cast<size_t>(id)];
+  if (id != KnownHeader::Unknown && slot == 0)
+    slot = size_;
 }
 
-void HeaderFieldList::overwrite(const std::string& name,
-                                const std::string& value) {
+/**
+ * Moves the fields into a new array with room for at least @p n of them.
+ *
+ * The old array is left behind in the arena until it gets reset.
+ */
+void HeaderFieldList::reserve(size_t n) {
+  if (n <= capacity_)
+    return;
+
+  const size_t capacity = std::max(n, std::max(InitialCapacity,
+                                               2 * size_t(capacity_)));
+
+  HeaderField* entries = static_cast<HeaderField*>(
+      arena_->allocate(capacity * sizeof(HeaderField), alignof(HeaderField)));
+
+  for (size_t i = 0; i < size_; ++i) {
+    new (entries + i) HeaderField(std::move(entries_[i]));
+    entries_[i].~HeaderField();
+  }
+
+  entries_ = entries;
+  capacity_ = capacity;
+}
+
+void HeaderFieldList::overwrite(const BufferRef& name,
+                                const BufferRef& value) {
   remove(name);
   push_back(name, value);
 }
 
-void HeaderFieldList::append(const std::string& name,
-                             const std::string& value,
-                             const std::string& delim) {
-  for (HeaderField& field : entries_) {
-    if (iequals(field.name(), name)) {
-      field.appendValue(value, delim);
-      return;
-    }
+void HeaderFieldList::append(const BufferRef& name,
+                             const BufferRef& value,
+                             const BufferRef& delim) {
+  HeaderField* field = find(name);
+  if (!field) {
+    push_back(name, value);
+    return;
   }
 
-  push_back(name, value);
+  // re-materialize the field in the arena, keeping its position
+  const BufferRef sep = field->value().empty() ? BufferRef() : delim;
+  const BufferRef head = field->name();
+  const BufferRef tail = field->value();
+  const size_t valueLength = tail.size() + sep.size() + value.size();
+  char* data = static_cast<char*>(
+      arena_->allocate(head.size() + valueLength, 1));
+  char* p = data;
+
+  memcpy(p, head.data(), head.size());
+  p += head.size();
+  memcpy(p, tail.data(), tail.size());
+  p += tail.size();
+  memcpy(p, sep.data(), sep.size());
+  p += sep.size();
+  memcpy(p, value.data(), value.size());
+
+  *field = HeaderField(data, head.size(), valueLength, field->id());
 }
 
-void HeaderFieldList::remove(const std::string& name) {
-  auto start = begin();
-  while (start != end()) {
-    auto i = std::find_if(begin(), end(), [&](const HeaderField& field) {
-      return iequals(field.name(), name);
-    });
+void HeaderFieldList::remove(const BufferRef& name) {
+  const KnownHeader id = toKnownHeader(name);
 
-    if (i != end()) {
-      entries_.erase(i);
-    }
-    start = i;
+  if (id != KnownHeader::Unknown && !contains(id))
+    return;
+
+  HeaderField* i = std::remove_if(begin(), end(),
+                                  [&](const HeaderField& field) {
+    return field.id() == id && iequals(field.name(), name);
+  });
+
+  if (i != end()) {
+    for (HeaderField* k = i; k != end(); ++k)
+      k->~HeaderField();
+
+    size_ = i - entries_;
+    rebuildSlots();
   }
 }
 
-bool HeaderFieldList::contains(const std::string& name) const {
-  for (const HeaderField& field : entries_) {
-    if (iequals(field.name(), name)) {
-      return true;
+const HeaderField* HeaderFieldList::find(const BufferRef& name) const {
+  const KnownHeader id = toKnownHeader(name);
+
+  if (id != KnownHeader::Unknown) {
+    const uint32_t slot = slots_[static_cast<size_t>(id)];
+    return slot != 0 ? &entries_[slot - 1] : nullptr;
+  }
+
+  for (const HeaderField& field : *this) {
+    if (field.id() == KnownHeader::Unknown && iequals(field.name(), name)) {
+      return &field;
     }
   }
 
-  return false;
+  return nullptr;
+}
+
+HeaderField* HeaderFieldList::find(const BufferRef& name) {
+  return const_cast<HeaderField*>(
+      static_cast<const HeaderFieldList*>(this)->find(name));
+}
+
+bool HeaderFieldList::contains(const BufferRef& name) const {
+  return find(name) != nullptr;
 }
 
-bool HeaderFieldList::contains(const std::string& name,
-                               const std::string& value) const {
-  for (const HeaderField& field : entries_) {
-    if (iequals(field.name(), name) && iequals(field.value(), value)) {
+bool HeaderFieldList::contains(const BufferRef& name,
+                               const BufferRef& value) const {
+  const KnownHeader id = toKnownHeader(name);
+
+  for (const HeaderField& field : *this) {
+    if (field.id() == id && iequals(field.name(), name) &&
+        iequals(field.value(), value)) {
       return true;
     }
   }
@@ -79,22 +215,59 @@ bool HeaderFieldList::contains(const std::string& name,
   return false;
 }
 
-const std::string& HeaderFieldList::get(const std::string& name) const {
-  for (const HeaderField& field : entries_) {
-    if (iequals(field.name(), name)) {
-      return field.value();
-    }
+BufferRef HeaderFieldList::get(const BufferRef& name) const {
+  const HeaderField* field = find(name);
+  return field ? field->value() : BufferRef();
+}
+
+void HeaderFieldList::clearSlots() {
+  std::fill(std::begin(slots_), std::end(slots_), 0);
+}
+
+void HeaderFieldList::rebuildSlots() {
+  clearSlots();
+
+  for (size_t i = size_; i > 0; --i) {
+    const KnownHeader id = entries_[i - 1].id();
+    if (id != KnownHeader::Unknown)
+      slots_[static_cast<size_t>(id)] = i;
   }
-  static std::string notfound;
-  return notfound;
 }
 
-const std::string& HeaderFieldList::operator[](const std::string& name) const {
-  return get(name);
+void HeaderFieldList::clear() {
+  for (HeaderField& field : *this)
+    field.~HeaderField();
+
+  size_ = 0;
 }
 
 void HeaderFieldList::reset() {
-  entries_.clear();
+  clear();
+  clearSlots();
+
+  // the fields array is handed out anew from the (reset) arena
+  entries_ = nullptr;
+  capacity_ = 0;
+
+  if (ownsArena())
+    ownArena_.reset();
+}
+
+void HeaderFieldList::swap(HeaderFieldList& other) {
+  if (this == &other)
+    return;
+
+  if (ownsArena() && other.ownsArena()) {
+    ownArena_.swap(other.ownArena_);
+    std::swap(entries_, other.entries_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(slots_, other.slots_);
+  } else {
+    HeaderFieldList copy(other);
+    other = *this;
+    *this = copy;
+  }
 }
 
 }  // namespace http
@@ -9,70 +9,136 @@
 
 #include <cortex-http/Api.h>
 #include <cortex-http/HeaderField.h>
+#include <cortex-base/Arena.h>
+#include <cortex-base/Buffer.h>
+#include <initializer_list>
 #include <string>
-#include <list>
+#include <utility>
 
 namespace cortex {
 namespace http {
 
 /**
  * Represents a list of headers (key/value pairs) for an HTTP message.
+ *
+ * The fields, along with their names and values, are stored in an arena,
+ * so that a recycled list serves a new message without touching the heap.
+ * The arena is either owned by the list or, for lists living as long as
+ * some bigger unit of work (such as an HttpChannel), borrowed from it.
+ *
+ * Well-known headers (see KnownHeader) are additionally tracked in fixed
+ * slots, making their lookup O(1).
  */
 class CORTEX_HTTP_API HeaderFieldList {
  public:
-  HeaderFieldList() = default;
-  HeaderFieldList(HeaderFieldList&&) = default;
-  HeaderFieldList(const HeaderFieldList&) = default;
-  HeaderFieldList& operator=(HeaderFieldList&&) = default;
-  HeaderFieldList& operator=(const HeaderFieldList&) = default;
+  HeaderFieldList();
+
+  /**
+   * Initializes an empty list allocating from a borrowed @p arena.
+   *
+   * The list's reset() then leaves it to the arena's owner to reset the
+   * arena, after resetting all lists borrowing it.
+   */
+  explicit HeaderFieldList(Arena* arena);
+
+  ~HeaderFieldList();
+  HeaderFieldList(HeaderFieldList&& other);
+  HeaderFieldList(const HeaderFieldList& other);
+  HeaderFieldList& operator=(HeaderFieldList&& other);
+  HeaderFieldList& operator=(const HeaderFieldList& other);
   HeaderFieldList(const std::initializer_list<std::pair<std::string, std::string>>& init);
 
-  void push_back(const std::string& name, const std::string& value);
-  void overwrite(const std::string& name, const std::string& value);
-  void append(const std::string& name, const std::string& value,
-              const std::string& delim = "");
-  void remove(const std::string& name);
+  void push_back(const BufferRef& name, const BufferRef& value);
+  void overwrite(const BufferRef& name, const BufferRef& value);
+  void append(const BufferRef& name, const BufferRef& value,
+              const BufferRef& delim = BufferRef());
+  void remove(const BufferRef& name);
 
   bool empty() const;
   size_t size() const;
-  bool contains(const std::string& name) const;
-  bool contains(const std::string& name, const std::string& value) const;
-  const std::string& get(const std::string& name) const;
-  const std::string& operator[](const std::string& name) const;
+  bool contains(KnownHeader id) const;
+  bool contains(const BufferRef& name) const;
+  bool contains(const BufferRef& name, const BufferRef& value) const;
 
-  typedef std::list<HeaderField>::iterator iterator;
-  typedef std::list<HeaderField>::const_iterator const_iterator;
+  /**
+   * Retrieves the value of the first field of given name, or an empty
+   * reference if there is none.
+   *
+   * The returned reference is valid until the list is modified.
+   */
+  BufferRef get(KnownHeader id) const;
+  BufferRef get(const BufferRef& name) const;
+  BufferRef operator[](const BufferRef& name) const;
 
-  iterator begin() { return entries_.begin(); }
-  iterator end() { return entries_.end(); }
+  typedef HeaderField* iterator;
+  typedef const HeaderField* const_iterator;
 
-  const_iterator begin() const { return entries_.cbegin(); }
-  const_iterator end() const { return entries_.cend(); }
+  iterator begin() { return entries_; }
+  iterator end() { return entries_ + size_; }
 
-  const_iterator cbegin() const { return entries_.cbegin(); }
-  const_iterator cend() const { return entries_.cend(); }
+  const_iterator begin() const { return entries_; }
+  const_iterator end() const { return entries_ + size_; }
+
+  const_iterator cbegin() const { return entries_; }
+  const_iterator cend() const { return entries_ + size_; }
 
   /**
    * Completely removes all entries from this header list.
+   *
+   * Keeps the allocated storage for reuse.
    */
   void reset();
 
+  /**
+   * Exchanges the fields of both lists.
+   *
+   * This is O(1) unless one of them borrows its arena, in which case the
+   * fields are copied, as they must stay in the arena they were
+   * allocated from.
+   */
   void swap(HeaderFieldList& other);
 
  private:
-  std::list<HeaderField> entries_;
+  bool ownsArena() const { return arena_ == &ownArena_; }
+  const HeaderField* find(const BufferRef& name) const;
+  HeaderField* find(const BufferRef& name);
+  HeaderField makeField(const BufferRef& name, const BufferRef& value,
+                        KnownHeader id);
+  void reserve(size_t n);
+  void clear();
+  void clearSlots();
+  void rebuildSlots();
+
+ private:
+  Arena ownArena_;
+  Arena* arena_;
+  HeaderField* entries_;
+  uint32_t size_;
+  uint32_t capacity_;
+
+  //! 1-based index into entries_ of the first field per KnownHeader, or 0
+  uint32_t slots_[KnownHeaderCount];
 };
 
 inline bool HeaderFieldList::empty() const {
-  return entries_.empty();
+  return size_ == 0;
 }
 
 inline size_t HeaderFieldList::size() const {
-  return entries_.size();
+  return size_;
+}
+
+inline bool HeaderFieldList::contains(KnownHeader id) const {
+  return slots_[static_cast<size_t>(id)] != 0;
+}
+
+inline BufferRef HeaderFieldList::get(KnownHeader id) const {
+  const uint32_t slot = slots_[static_cast<size_t>(id)];
+  return slot != 0 ? entries_[slot - 1].value() : BufferRef();
 }
 
-inline void HeaderFieldList::swap(HeaderFieldList& other) {
-  entries_.swap(other.entries_);
+inline BufferRef HeaderFieldList::operator[](const BufferRef& name) const {
+  return get(name);
 }
 
 }  // namespace http
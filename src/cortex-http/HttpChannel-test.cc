@@ -155,3 +155,35 @@ TEST(http_HttpChannel, trailer1) {
   ASSERT_EQ("one", transport.responseInfo().trailers().get("Word-Count"));
   ASSERT_EQ("Happy", transport.responseInfo().trailers().get("Mood"));
 }
+
+TEST(http_HttpChannel, timings) {
+  DirectExecutor executor;
+  mock::Transport transport(&executor, &handlerOk);
+  transport.run(HttpVersion::VERSION_1_1, "GET", "/", {{"Host", "test"}}, "");
+
+  const HttpChannelTimings& timings = transport.channel()->timings();
+  ASSERT_TRUE(timings.begin <= timings.messageBegin);
+  ASSERT_TRUE(timings.messageBegin <= timings.headerEnd);
+  ASSERT_TRUE(timings.headerEnd <= timings.completed);
+
+  // not sent yet
+  ASSERT_EQ(HttpChannelTimings::Clock::time_point(), timings.responseEnd);
+  ASSERT_EQ(HttpChannelTimings::Clock::duration::zero(), timings.flushTime());
+
+  int calls = 0;
+  transport.channel()->onTimings([&](const HttpChannelTimings& t) {
+    calls++;
+    ASSERT_TRUE(t.completed <= t.responseEnd);
+    ASSERT_EQ(t.responseEnd - t.messageBegin, t.requestTime());
+    ASSERT_EQ(t.headerTime() + t.handlerTime() + t.flushTime(),
+              t.requestTime());
+  });
+
+  transport.channel()->responseEnd();
+  ASSERT_EQ(1, calls);
+
+  // nothing to report for a connection that got closed while idle
+  transport.channel()->reset();
+  transport.channel()->responseEnd();
+  ASSERT_EQ(1, calls);
+}
@@ -48,6 +48,9 @@ std::string to_string(HttpChannelState state) {
   }
 }
 
+//! fits the headers of a typical request and its response
+static constexpr size_t ArenaBlockSize = 4096;
+
 HttpChannel::HttpChannel(HttpTransport* transport, const HttpHandler& handler,
                          std::unique_ptr<HttpInput>&& input,
                          size_t maxRequestUriLength,
@@ -58,13 +61,14 @@ HttpChannel::HttpChannel(HttpTransport* transport, const HttpHandler& handler,
       maxRequestBodyLength_(maxRequestBodyLength),
       state_(HttpChannelState::READING),
       transport_(transport),
-      request_(new HttpRequest(std::move(input))),
-      response_(new HttpResponse(this, createOutput())),
+      arena_(ArenaBlockSize),
+      request_(new HttpRequest(std::move(input), &arena_)),
+      response_(new HttpResponse(this, createOutput(), &arena_)),
       dateGenerator_(dateGenerator),
       outputFilters_(),
       outputCompressor_(outputCompressor),
       handler_(handler) {
-  //.
+  timings_.begin = HttpChannelTimings::Clock::now();
 }
 
 HttpChannel::~HttpChannel() {
@@ -77,6 +81,12 @@ void HttpChannel::reset() {
   request_->recycle();
   response_->recycle();
   outputFilters_.clear();
+
+  timings_ = HttpChannelTimings();
+  timings_.begin = HttpChannelTimings::Clock::now();
+
+  // only after all headers referring to it got reset
+  arena_.reset();
 }
 
 void HttpChannel::setState(HttpChannelState newState) {
@@ -112,9 +122,9 @@ void HttpChannel::send(const BufferRef& data, CompletionHandler onComplete) {
   if (outputFilters_.empty()) {
     if (!response_->isCommitted()) {
       HttpResponseInfo info(commitInline());
-      transport_->send(std::move(info), data, onComplete);
+      transport_->send(std::move(info), data, std::move(onComplete));
     } else {
-      transport_->send(data, onComplete);
+      transport_->send(data, std::move(onComplete));
     }
   } else {
     Buffer filtered;
@@ -122,9 +132,10 @@ void HttpChannel::send(const BufferRef& data, CompletionHandler onComplete) {
 
     if (!response_->isCommitted()) {
       HttpResponseInfo info(commitInline());
-      transport_->send(std::move(info), std::move(filtered), onComplete);
+      transport_->send(std::move(info), std::move(filtered),
+                       std::move(onComplete));
     } else {
-      transport_->send(std::move(filtered), onComplete);
+      transport_->send(std::move(filtered), std::move(onComplete));
     }
   }
 }
@@ -140,9 +151,9 @@ void HttpChannel::send(Buffer&& data, CompletionHandler onComplete) {
 
   if (!response_->isCommitted()) {
     HttpResponseInfo info(commitInline());
-    transport_->send(std::move(info), std::move(data), onComplete);
+    transport_->send(std::move(info), std::move(data), std::move(onComplete));
   } else {
-    transport_->send(std::move(data), onComplete);
+    transport_->send(std::move(data), std::move(onComplete));
   }
 }
 
@@ -153,11 +164,11 @@ void HttpChannel::send(FileRef&& file, CompletionHandler onComplete) {
     if (!response_->isCommitted()) {
       HttpResponseInfo info(commitInline());
       transport_->send(std::move(info), BufferRef(), nullptr);
-      transport_->send(std::move(file), onComplete);
+      transport_->send(std::move(file), std::move(onComplete));
       // transport_->send(std::move(info), BufferRef(),
       //     std::bind(&HttpTransport::send, transport_, file, onComplete));
     } else {
-      transport_->send(std::move(file), onComplete);
+      transport_->send(std::move(file), std::move(onComplete));
     }
   } else {
     Buffer filtered;
@@ -165,9 +176,10 @@ void HttpChannel::send(FileRef&& file, CompletionHandler onComplete) {
 
     if (!response_->isCommitted()) {
       HttpResponseInfo info(commitInline());
-      transport_->send(std::move(info), std::move(filtered), onComplete);
+      transport_->send(std::move(info), std::move(filtered),
+                       std::move(onComplete));
     } else {
-      transport_->send(std::move(filtered), onComplete);
+      transport_->send(std::move(filtered), std::move(onComplete));
     }
   }
 }
@@ -211,15 +223,16 @@ HttpResponseInfo HttpChannel::commitInline() {
                         response_->reason(), isHeadReq,
                         response_->contentLength(),
                         response_->headers(),
-                        response_->trailers());
+                        response_->trailers(),
+                        &arena_);
 
-  if (!info.headers().contains("Server"))
+  if (!info.headers().contains(KnownHeader::Server))
     info.headers().push_back("Server", "cortex-base/" CORTEX_HTTP_VERSION);
 
   if (dateGenerator_ && static_cast<int>(response_->status()) >= 200) {
     Buffer date;
     dateGenerator_->fill(&date);
-    info.headers().push_back("Date", date.str());
+    info.headers().push_back("Date", date.ref());
   }
 
   return info;
@@ -227,7 +240,7 @@ HttpResponseInfo HttpChannel::commitInline() {
 
 void HttpChannel::commit(CompletionHandler onComplete) {
   TRACE("commit()");
-  send(BufferRef(), onComplete);
+  send(BufferRef(), std::move(onComplete));
 }
 
 void HttpChannel::send100Continue(CompletionHandler onComplete) {
@@ -240,16 +253,18 @@ void HttpChannel::send100Continue(CompletionHandler onComplete) {
                         "Continue", false, 0, {}, {});
 
   TRACE("send100Continue(): sending it");
-  transport_->send(std::move(info), BufferRef(), onComplete);
+  transport_->send(std::move(info), BufferRef(), std::move(onComplete));
 }
 
 void HttpChannel::onMessageBegin(const BufferRef& method,
                                  const BufferRef& entity,
                                  HttpVersion version) {
+  timings_.messageBegin = HttpChannelTimings::Clock::now();
+
   response_->setVersion(version);
   request_->setVersion(version);
   request_->setMethod(method.str());
-  if (!request_->setUri(entity.str())) {
+  if (!request_->setUri(entity)) {
     RAISE_EXCEPTION(BadMessage, HttpStatus::BadRequest);
   }
 
@@ -259,7 +274,7 @@ void HttpChannel::onMessageBegin(const BufferRef& method,
 
 void HttpChannel::onMessageHeader(const BufferRef& name,
                                   const BufferRef& value) {
-  request_->headers().push_back(name.str(), value.str());
+  request_->headers().push_back(name, value);
 
   if (iequals(name, "Expect") && iequals(value, "100-continue"))
     request_->setExpect100Continue(true);
@@ -267,7 +282,7 @@ void HttpChannel::onMessageHeader(const BufferRef& name,
   // rfc7230, Section 5.4, p2
   if (iequals(name, "Host")) {
     if (request_->host().empty())
-      request_->setHost(value.str());
+      request_->setHost(value);
     else {
       setState(HttpChannelState::HANDLING);
       RAISE_HTTP_REASON(BadRequest, "Multiple host headers are illegal.");
@@ -278,10 +293,11 @@ void HttpChannel::onMessageHeader(const BufferRef& name,
 void HttpChannel::onMessageHeaderEnd() {
   if (state() != HttpChannelState::HANDLING) {
     setState(HttpChannelState::HANDLING);
+    timings_.headerEnd = HttpChannelTimings::Clock::now();
 
     // rfc7230, Section 5.4, p2
     if (request_->version() == HttpVersion::VERSION_1_1) {
-      if (!request_->headers().contains("Host")) {
+      if (!request_->headers().contains(KnownHeader::Host)) {
         RAISE_HTTP_REASON(BadRequest, "No Host header given.");
       }
     }
@@ -334,6 +350,8 @@ void HttpChannel::completed() {
     RAISE(IllegalStateError, "HttpChannel.completed invoked but state is not in HANDLING.");
   }
 
+  timings_.completed = HttpChannelTimings::Clock::now();
+
   if (!outputFilters_.empty()) {
     TRACE("%p completed: send(applyFilters(EOS))", this);
     Buffer filtered;
@@ -363,10 +381,22 @@ void HttpChannel::onResponseEnd(std::function<void()> callback) {
   onResponseEnd_.connect(callback);
 }
 
+void HttpChannel::onTimings(
+    std::function<void(const HttpChannelTimings&)> callback) {
+  onTimings_.connect(callback);
+}
+
 void HttpChannel::responseEnd() {
+  timings_.responseEnd = HttpChannelTimings::Clock::now();
+
   auto cb = std::move(onResponseEnd_);
   onResponseEnd_.clear();
   cb();
+
+  // an idle connection that is closed did not serve a request
+  if (!onTimings_.empty() &&
+      timings_.messageBegin != HttpChannelTimings::Clock::time_point())
+    onTimings_(timings_);
 }
 
 }  // namespace http
@@ -14,6 +14,8 @@
 #include <cortex-http/HttpHandler.h>
 #include <cortex-http/HttpVersion.h>
 #include <cortex-base/io/Filter.h>
+#include <cortex-base/Arena.h>
+#include <chrono>
 #include <list>
 #include <memory>
 
@@ -41,6 +43,58 @@ enum class HttpChannelState {
 
 CORTEX_HTTP_API std::string to_string(HttpChannelState state);
 
+/**
+ * Points in time a single request passed on its way through an HttpChannel.
+ *
+ * Points that were not reached (yet) are left at the clock's epoch and the
+ * durations depending on them are zero.
+ */
+struct CORTEX_HTTP_API HttpChannelTimings {
+  typedef std::chrono::steady_clock Clock;
+
+  //! channel got ready to read a request: accept or keep-alive reuse
+  Clock::time_point begin;
+
+  //! the request line got parsed
+  Clock::time_point messageBegin;
+
+  //! all request headers got parsed and the handler is invoked
+  Clock::time_point headerEnd;
+
+  //! the handler completed the response
+  Clock::time_point completed;
+
+  //! the transport finished sending the response
+  Clock::time_point responseEnd;
+
+  Clock::duration firstByteTime() const {
+    return between(begin, messageBegin);
+  }
+
+  Clock::duration headerTime() const {
+    return between(messageBegin, headerEnd);
+  }
+
+  Clock::duration handlerTime() const {
+    return between(headerEnd, completed);
+  }
+
+  Clock::duration flushTime() const {
+    return between(completed, responseEnd);
+  }
+
+  Clock::duration requestTime() const {
+    return between(messageBegin, responseEnd);
+  }
+
+  static Clock::duration between(Clock::time_point from, Clock::time_point to) {
+    if (from == Clock::time_point() || to == Clock::time_point())
+      return Clock::duration::zero();
+
+    return to - from;
+  }
+};
+
 /**
  * Semantic HTTP message exchange layer.
  *
@@ -62,10 +116,24 @@ class CORTEX_HTTP_API HttpChannel : public HttpListener {
   /**
    * Resets the channel state.
    *
-   * After invokation this channel is as it would have been just instanciated.
+   * After invokation this channel is as it would have been just instanciated,
+   * except for the storage kept for serving the next request.
    */
   virtual void reset();
 
+  /**
+   * Retrieves the arena the current request and response allocate from.
+   *
+   * It is reset along with the channel, so its statistics tell how much
+   * memory a single request took and whether it still hits the heap.
+   */
+  const Arena& arena() const noexcept { return arena_; }
+
+  /**
+   * Retrieves the phase timings of the current request.
+   */
+  const HttpChannelTimings& timings() const noexcept { return timings_; }
+
   /**
    * Sends a response body chunk @p data.
    *
@@ -161,6 +229,15 @@ class CORTEX_HTTP_API HttpChannel : public HttpListener {
   void onPostProcess(std::function<void()> callback);
   void onResponseEnd(std::function<void()> callback);
 
+  /**
+   * Registers a @p callback that is invoked with the phase timings of every
+   * request this channel served once its response got sent.
+   *
+   * Unlike the per-request hooks above it stays connected across requests,
+   * so it can feed latency statistics for the whole connection.
+   */
+  void onTimings(std::function<void(const HttpChannelTimings&)> callback);
+
   // event, only to be invoked by transport implementors
   void responseEnd(); // no, via cb functor instead
 
@@ -175,6 +252,7 @@ class CORTEX_HTTP_API HttpChannel : public HttpListener {
   size_t maxRequestBodyLength_;
   HttpChannelState state_;
   HttpTransport* transport_;
+  Arena arena_;
   std::unique_ptr<HttpRequest> request_;
   std::unique_ptr<HttpResponse> response_;
   HttpDateGenerator* dateGenerator_;
@@ -184,6 +262,9 @@ class CORTEX_HTTP_API HttpChannel : public HttpListener {
 
   Signal<void()> onPostProcess_;
   Signal<void()> onResponseEnd_;
+
+  HttpChannelTimings timings_;
+  Signal<void(const HttpChannelTimings&)> onTimings_;
 };
 
 }  // namespace http
@@ -15,12 +15,14 @@
 #include <cortex-http/HttpOutput.h>
 #include <cortex-http/BadMessage.h>
 #include <cortex-http/HttpFileHandler.h>
+#include <cortex-http/HttpOutputCompressor.h>
 #include <cortex-base/io/LocalFileRepository.h>
 #include <cortex-base/executor/DirectExecutor.h>
 #include <cortex-base/io/FileUtil.h>
 #include <cortex-base/MimeTypes.h>
 #include <cortex-base/Buffer.h>
 #include <gtest/gtest.h>
+#include <unistd.h>
 
 using namespace cortex;
 using namespace cortex::http;
@@ -54,3 +56,113 @@ TEST(http_HttpFileHandler, GET_FileNotFound) {
   ASSERT_EQ(404, static_cast<int>(transport.responseInfo().status()));
 }
 
+
+class http_HttpFileHandlerVariants : public ::testing::Test {
+ public:
+  void SetUp() override {
+    mimetypes_.setDefaultMimeType("text/plain");
+    docroot_ = FileUtil::createTempDirectory();
+    compressor_.setPrecompressedLookup([this](const std::string& path) {
+      return repo_.getFile(path);
+    });
+    staticfile_.setOutputCompressor(&compressor_);
+
+    std::string text;
+    for (int i = 0; i < 100; ++i)
+      text += "The quick brown fox jumps over the lazy dog.\n";
+    FileUtil::write(FileUtil::joinPaths(docroot_, "fox.txt"), Buffer(text));
+  }
+
+  void TearDown() override {
+    for (const char* name: {"fox.txt", "fox.txt.gz"})
+      if (FileUtil::exists(FileUtil::joinPaths(docroot_, name)))
+        FileUtil::rm(FileUtil::joinPaths(docroot_, name));
+
+    ::rmdir(docroot_.c_str());
+  }
+
+  void handle(HttpRequest* request, HttpResponse* response) {
+    if (staticfile_.handle(request, response,
+                           repo_.getFile(request->path(), docroot_)))
+      return;
+
+    response->setStatus(HttpStatus::NotFound);
+    response->completed();
+  }
+
+  void run(const HeaderFieldList& headers) {
+    DirectExecutor executor;
+    mock::Transport transport(&executor,
+        std::bind(&http_HttpFileHandlerVariants::handle, this,
+                  std::placeholders::_1, std::placeholders::_2));
+    transport.run(HttpVersion::VERSION_1_1, "GET", "/fox.txt", headers, "");
+    status_ = static_cast<int>(transport.responseInfo().status());
+    headers_ = transport.responseInfo().headers();
+    body_ = transport.responseBody().str();
+  }
+
+ protected:
+  MimeTypes mimetypes_;
+  LocalFileRepository repo_{mimetypes_, "/", true, true, true};
+  HttpOutputCompressor compressor_;
+  HttpFileHandler staticfile_{&generateBoundaryID};
+  std::string docroot_;
+
+  int status_ = 0;
+  HeaderFieldList headers_;
+  std::string body_;
+};
+
+TEST_F(http_HttpFileHandlerVariants, identity) {
+  run({{"Host", "test"}});
+
+  EXPECT_EQ(200, status_);
+  EXPECT_FALSE(headers_.contains("Content-Encoding"));
+  EXPECT_EQ("Accept-Encoding", headers_.get("Vary"));
+  EXPECT_EQ(4500, body_.size());
+}
+
+TEST_F(http_HttpFileHandlerVariants, compressedOnce) {
+  run({{"Host", "test"}, {"Accept-Encoding", "deflate, gzip"}});
+
+  EXPECT_EQ(200, status_);
+  EXPECT_EQ("gzip", headers_.get("Content-Encoding"));
+  EXPECT_EQ("Accept-Encoding", headers_.get("Vary"));
+  EXPECT_EQ("text/plain", headers_.get("Content-Type"));
+  EXPECT_GT(4500, body_.size());
+
+  const std::string compressed = body_;
+  const size_t usage = compressor_.variantCacheUsage();
+  EXPECT_LT(compressed.size(), usage);
+
+  run({{"Host", "test"}, {"Accept-Encoding", "gzip"}});
+  EXPECT_EQ(compressed, body_);
+  EXPECT_EQ(usage, compressor_.variantCacheUsage());
+}
+
+TEST_F(http_HttpFileHandlerVariants, precompressed) {
+  FileUtil::write(FileUtil::joinPaths(docroot_, "fox.txt.gz"),
+                  Buffer("precompressed fox"));
+
+  run({{"Host", "test"}, {"Accept-Encoding", "gzip"}});
+
+  EXPECT_EQ(200, status_);
+  EXPECT_EQ("gzip", headers_.get("Content-Encoding"));
+  EXPECT_EQ("text/plain", headers_.get("Content-Type"));
+  EXPECT_EQ("precompressed fox", body_);
+  EXPECT_EQ(0, compressor_.variantCacheUsage());
+}
+
+TEST_F(http_HttpFileHandlerVariants, rangeOfVariant) {
+  FileUtil::write(FileUtil::joinPaths(docroot_, "fox.txt.gz"),
+                  Buffer("precompressed fox"));
+
+  run({{"Host", "test"},
+       {"Accept-Encoding", "gzip"},
+       {"Range", "bytes=14-"}});
+
+  EXPECT_EQ(206, status_);
+  EXPECT_EQ("gzip", headers_.get("Content-Encoding"));
+  EXPECT_EQ("bytes 14-16/17", headers_.get("Content-Range"));
+  EXPECT_EQ("fox", body_);
+}
@@ -10,6 +10,7 @@
 #include <cortex-http/HttpResponse.h>
 #include <cortex-http/HttpOutput.h>
 #include <cortex-http/HttpRangeDef.h>
+#include <cortex-http/HttpOutputCompressor.h>
 #include <cortex-http/HeaderFieldList.h>
 #include <cortex-base/io/File.h>
 #include <cortex-base/io/FileRef.h>
@@ -76,12 +77,17 @@ HttpFileHandler::HttpFileHandler()
 }
 
 HttpFileHandler::HttpFileHandler(std::function<std::string()> generateBoundaryID)
-    : generateBoundaryID_(generateBoundaryID) {
+    : generateBoundaryID_(generateBoundaryID),
+      outputCompressor_(nullptr) {
 }
 
 HttpFileHandler::~HttpFileHandler() {
 }
 
+void HttpFileHandler::setOutputCompressor(HttpOutputCompressor* compressor) {
+  outputCompressor_ = compressor;
+}
+
 bool HttpFileHandler::handle(
     HttpRequest* request,
     HttpResponse* response,
@@ -90,6 +96,23 @@ bool HttpFileHandler::handle(
   if (!transferFile->isRegular())
     return false;
 
+  // the original file's type applies to any of its encoded variants
+  const std::shared_ptr<File> original = transferFile;
+  const std::string& mimetype = original->mimetype();
+
+  if (outputCompressor_ && transferFile->exists() &&
+      outputCompressor_->isCompressible(*transferFile)) {
+    // the identity body is a variant, too, so caches must key on it either way
+    response->appendHeader("Vary", "Accept-Encoding", ",");
+
+    std::string encoding;
+    if (std::shared_ptr<File> variant =
+            outputCompressor_->getVariant(request, transferFile, &encoding)) {
+      response->addHeader("Content-Encoding", encoding);
+      transferFile = variant;
+    }
+  }
+
   if (handleClientCache(*transferFile, request, response))
     return true;
 
@@ -110,15 +133,23 @@ bool HttpFileHandler::handle(
   }
 
   int fd = -1;
+  bool closeFd = true;
   if (request->method() == HttpMethod::GET) {
-    fd = transferFile->createPosixChannel(File::Read | File::NonBlocking);
-    if (fd < 0) {
-      if (errno != EPERM && errno != EACCES)
-        RAISE_ERRNO(transferFile->errorCode());
-
-      response->setStatus(HttpStatus::Forbidden);
-      response->completed();
-      return true;
+    fd = transferFile->sharedHandle();
+    if (fd >= 0) {
+      // keep the file, and with it the handle, open until fully sent
+      response->onResponseEnd([transferFile]() {});
+      closeFd = false;
+    } else {
+      fd = transferFile->createPosixChannel(File::Read | File::NonBlocking);
+      if (fd < 0) {
+        if (errno != EPERM && errno != EACCES)
+          RAISE_ERRNO(transferFile->errorCode());
+
+        response->setStatus(HttpStatus::Forbidden);
+        response->completed();
+        return true;
+      }
     }
   } else if (request->method() != HttpMethod::HEAD) {
     response->setStatus(HttpStatus::MethodNotAllowed);
@@ -130,20 +161,22 @@ bool HttpFileHandler::handle(
   response->addHeader("Last-Modified", transferFile->lastModified());
   response->addHeader("ETag", transferFile->etag());
 
-  if (handleRangeRequest(*transferFile, fd, request, response))
+  if (handleRangeRequest(*transferFile, mimetype, fd, closeFd,
+                         request, response))
     return true;
 
   response->setStatus(HttpStatus::Ok);
   response->addHeader("Accept-Ranges", "bytes");
-  response->addHeader("Content-Type", transferFile->mimetype());
+  response->addHeader("Content-Type", mimetype);
 
   response->setContentLength(transferFile->size());
 
   if (fd >= 0) {  // GET request
 #if defined(HAVE_POSIX_FADVISE)
-    posix_fadvise(fd, 0, transferFile->size(), POSIX_FADV_SEQUENTIAL);
+    if (closeFd)
+      posix_fadvise(fd, 0, transferFile->size(), POSIX_FADV_SEQUENTIAL);
 #endif
-    response->output()->write(FileRef(fd, 0, transferFile->size(), true),
+    response->output()->write(FileRef(fd, 0, transferFile->size(), closeFd),
         std::bind(&HttpResponse::completed, response));
   } else {
     response->completed();
@@ -157,7 +190,7 @@ bool HttpFileHandler::handleClientCache(const File& transferFile,
                                         HttpResponse* response) {
   // If-None-Match
   do {
-    const std::string& value = request->headers().get("If-None-Match");
+    const BufferRef value = request->headers().get(KnownHeader::IfNoneMatch);
     if (value.empty()) continue;
 
     // XXX: on static files we probably don't need the token-list support
@@ -170,10 +203,10 @@ bool HttpFileHandler::handleClientCache(const File& transferFile,
 
   // If-Modified-Since
   do {
-    const std::string& value = request->headers().get("If-Modified-Since");
+    const BufferRef value = request->headers().get(KnownHeader::IfModifiedSince);
     if (value.empty()) continue;
 
-    DateTime dt(value);
+    DateTime dt(value.str());
     if (!dt.valid()) continue;
 
     if (transferFile.mtime() > dt.unixtime()) continue;
@@ -185,7 +218,7 @@ bool HttpFileHandler::handleClientCache(const File& transferFile,
 
   // If-Match
   do {
-    const std::string& value = request->headers().get("If-Match");
+    const BufferRef value = request->headers().get(KnownHeader::IfMatch);
     if (value.empty()) continue;
 
     if (value == "*") continue;
@@ -200,10 +233,10 @@ bool HttpFileHandler::handleClientCache(const File& transferFile,
 
   // If-Unmodified-Since
   do {
-    const std::string& value = request->headers().get("If-Unmodified-Since");
+    const BufferRef value = request->headers().get(KnownHeader::IfUnmodifiedSince);
     if (value.empty()) continue;
 
-    DateTime dt(value);
+    DateTime dt(value.str());
     if (!dt.valid()) continue;
 
     if (transferFile.mtime() <= dt.unixtime()) continue;
@@ -230,11 +263,13 @@ static size_t numdigits(size_t number) {
   return result;
 }
 
-bool HttpFileHandler::handleRangeRequest(const File& transferFile, int fd,
+bool HttpFileHandler::handleRangeRequest(const File& transferFile,
+                                         const std::string& mimetype,
+                                         int fd, bool closeFd,
                                          HttpRequest* request,
                                          HttpResponse* response) {
   const bool isHeadReq = fd < 0;
-  BufferRef range_value(request->headers().get("Range"));
+  BufferRef range_value(request->headers().get(KnownHeader::Range));
   HttpRangeDef range;
 
   // if no range request or range request was invalid (by syntax) we fall back
@@ -242,7 +277,7 @@ bool HttpFileHandler::handleRangeRequest(const File& transferFile, int fd,
   if (range_value.empty() || !range.parse(range_value))
     return false;
 
-  std::string ifRangeCond = request->headers().get("If-Range");
+  BufferRef ifRangeCond = request->headers().get(KnownHeader::IfRange);
   if (!ifRangeCond.empty()
         && !equals(ifRangeCond, transferFile.etag())
         && !equals(ifRangeCond, transferFile.lastModified()))
@@ -267,7 +302,7 @@ bool HttpFileHandler::handleRangeRequest(const File& transferFile, int fd,
       const size_t headerLen = sizeof("\r\n--") - 1
                              + boundary.size()
                              + sizeof("\r\nContent-Type: ") - 1
-                             + transferFile.mimetype().size()
+                             + mimetype.size()
                              + sizeof("\r\nContent-Range: bytes ") - 1
                              + numdigits(offsets.first)
                              + sizeof("-") - 1
@@ -307,7 +342,7 @@ bool HttpFileHandler::handleRangeRequest(const File& transferFile, int fd,
       buf.push_back("\r\n--");
       buf.push_back(boundary);
       buf.push_back("\r\nContent-Type: ");
-      buf.push_back(transferFile.mimetype());
+      buf.push_back(mimetype);
 
       buf.push_back("\r\nContent-Range: bytes ");
       buf.push_back(offsets.first);
@@ -320,7 +355,8 @@ bool HttpFileHandler::handleRangeRequest(const File& transferFile, int fd,
       if (!isHeadReq) {
         bool last = i + 1 == numRanges;
         response->output()->write(std::move(buf));
-        response->output()->write(FileRef(fd, offsets.first, partLength, last));
+        response->output()->write(
+            FileRef(fd, offsets.first, partLength, last && closeFd));
       }
     }
 
@@ -339,7 +375,7 @@ bool HttpFileHandler::handleRangeRequest(const File& transferFile, int fd,
       return true;
     }
 
-    response->addHeader("Content-Type", transferFile.mimetype());
+    response->addHeader("Content-Type", mimetype);
 
     size_t length = 1 + offsets.second - offsets.first;
     response->setContentLength(length);
@@ -351,9 +387,10 @@ bool HttpFileHandler::handleRangeRequest(const File& transferFile, int fd,
 
     if (fd >= 0) {
 #if defined(HAVE_POSIX_FADVISE)
-      posix_fadvise(fd, offsets.first, length, POSIX_FADV_SEQUENTIAL);
+      if (closeFd)
+        posix_fadvise(fd, offsets.first, length, POSIX_FADV_SEQUENTIAL);
 #endif
-      response->output()->write(FileRef(fd, offsets.first, length, true));
+      response->output()->write(FileRef(fd, offsets.first, length, closeFd));
     }
   }
 
@@ -22,10 +22,19 @@ namespace http {
 
 class HttpRequest;
 class HttpResponse;
+class HttpOutputCompressor;
 
 /**
  * Handles GET/HEAD requests to local files.
  *
+ * Files providing a File::sharedHandle(), such as those served from a
+ * LocalFileCache, are transferred from that handle, kept open by the file
+ * until the response has been fully sent, sparing the open() and close()
+ * per request.
+ *
+ * With an output compressor set, clients accepting it are served a
+ * compressed variant of the file instead, which also honors range requests.
+ *
  * @note this class is not meant to be thread safe.
  */
 class CORTEX_HTTP_API HttpFileHandler {
@@ -45,6 +54,14 @@ class CORTEX_HTTP_API HttpFileHandler {
 
   ~HttpFileHandler();
 
+  /**
+   * Sets the output compressor to retrieve compressed file variants from.
+   *
+   * @param compressor the compressor or @c nullptr to always serve files
+   *                   as they are.
+   */
+  void setOutputCompressor(HttpOutputCompressor* compressor);
+
   /**
    * Handles given @p request if a local file (based on @p docroot) exists.
    *
@@ -78,7 +95,9 @@ class CORTEX_HTTP_API HttpFileHandler {
    * Fully processes the ranged requests, if one, or does nothing.
    *
    * @param transferFile
+   * @param mimetype the Content-Type of the file, regardless of its encoding.
    * @param fd open file descriptor in case of a GET request.
+   * @param closeFd whether or not @p fd is to be closed once transferred.
    * @param request HTTP request handle.
    * @param response HTTP response handle.
    *
@@ -88,14 +107,14 @@ class CORTEX_HTTP_API HttpFileHandler {
    *
    * @note if this is no ranged request. nothing is done on it.
    */
-  bool handleRangeRequest(const File& transferFile, int fd,
+  bool handleRangeRequest(const File& transferFile,
+                          const std::string& mimetype,
+                          int fd, bool closeFd,
                           HttpRequest* request, HttpResponse* response);
 
  private:
   std::function<std::string()> generateBoundaryID_;
-
-  // TODO stat cache
-  // TODO fd cache
+  HttpOutputCompressor* outputCompressor_;
 };
 
 } // namespace http
@@ -24,9 +24,14 @@ namespace http {
  */
 class CORTEX_HTTP_API HttpInfo {
  public:
+  /**
+   * Initializes the message info with copies of @p headers and
+   * @p trailers, allocated from @p arena if given.
+   */
   HttpInfo(HttpVersion version, size_t contentLength,
            const HeaderFieldList& headers,
-           const HeaderFieldList& trailers);
+           const HeaderFieldList& trailers,
+           Arena* arena = nullptr);
 
   /** Retrieves the HTTP message version. */
   HttpVersion version() const CORTEX_NOEXCEPT { return version_; }
@@ -61,12 +66,14 @@ class CORTEX_HTTP_API HttpInfo {
 
 inline HttpInfo::HttpInfo(HttpVersion version, size_t contentLength,
                           const HeaderFieldList& headers,
-                          const HeaderFieldList& trailers)
+                          const HeaderFieldList& trailers,
+                          Arena* arena)
     : version_(version),
       contentLength_(contentLength),
-      headers_(headers),
-      trailers_(trailers) {
-  //.
+      headers_(arena),
+      trailers_(arena) {
+  headers_ = headers;
+  trailers_ = trailers;
 }
 
 }  // namespace http
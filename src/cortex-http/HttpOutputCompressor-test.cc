@@ -0,0 +1,76 @@
+// This file is part of the "x0" project, http://cortex.io/
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/HttpOutputCompressor.h>
+#include <cortex-base/Buffer.h>
+#include <cortex-base/sysconfig.h>
+#include <gtest/gtest.h>
+
+using namespace cortex;
+using namespace cortex::http;
+
+TEST(http_HttpOutputCompressor, encodings) {
+  HttpOutputCompressor compressor;
+  std::vector<std::string> encodings = compressor.encodings();
+
+  ASSERT_FALSE(encodings.empty());
+  EXPECT_EQ("gzip", encodings.back());
+}
+
+TEST(http_HttpOutputCompressor, selectEncodingGzip) {
+  HttpOutputCompressor compressor;
+
+  EXPECT_EQ("", compressor.selectEncoding(BufferRef()));
+  EXPECT_EQ("", compressor.selectEncoding("identity"));
+  EXPECT_EQ("gzip", compressor.selectEncoding("gzip"));
+  EXPECT_EQ("gzip", compressor.selectEncoding("deflate, GZip"));
+  EXPECT_EQ("gzip", compressor.selectEncoding("gzip;q=0.001"));
+  EXPECT_EQ("", compressor.selectEncoding("gzip;q=0"));
+  EXPECT_EQ("", compressor.selectEncoding("gzip ; q=0.000, deflate"));
+  EXPECT_EQ("", compressor.selectEncoding("gzip2, xgzip"));
+}
+
+TEST(http_HttpOutputCompressor, selectEncodingWildcard) {
+  HttpOutputCompressor compressor;
+  const std::string preferred = compressor.encodings().front();
+
+  EXPECT_EQ(preferred, compressor.selectEncoding("*"));
+  EXPECT_EQ("", compressor.selectEncoding("*;q=0"));
+  EXPECT_EQ("gzip", compressor.selectEncoding("*;q=0, gzip"));
+}
+
+TEST(http_HttpOutputCompressor, selectEncodingByQValue) {
+  HttpOutputCompressor compressor;
+
+#if defined(HAVE_BROTLI_ENCODE_H)
+  EXPECT_EQ("br", compressor.selectEncoding("gzip, deflate, br"));
+  EXPECT_EQ("gzip", compressor.selectEncoding("gzip;q=1.0, br;q=0.8"));
+  EXPECT_EQ("br", compressor.selectEncoding("gzip;q=0.5,br;q=0.51"));
+#endif
+
+#if defined(HAVE_ZSTD_H)
+  EXPECT_EQ("zstd", compressor.selectEncoding("gzip;q=0.9, zstd"));
+  EXPECT_EQ("gzip", compressor.selectEncoding("gzip, zstd;q=0.9"));
+#endif
+
+#if defined(HAVE_BROTLI_ENCODE_H) && defined(HAVE_ZSTD_H)
+  EXPECT_EQ("br", compressor.selectEncoding("zstd, br, gzip"));
+  EXPECT_EQ("zstd", compressor.selectEncoding("zstd, br;q=0.9, gzip"));
+#endif
+}
+
+TEST(http_HttpOutputCompressor, setCompressionLevel) {
+  HttpOutputCompressor compressor;
+
+  compressor.setCompressionLevel(6);
+  EXPECT_EQ(6, compressor.compressionLevel());
+
+  EXPECT_TRUE(compressor.setCompressionLevel("gzip", 1));
+  EXPECT_EQ(1, compressor.compressionLevel());
+
+  EXPECT_FALSE(compressor.setCompressionLevel("bzip2", 1));
+}
@@ -11,12 +11,18 @@
 #include <cortex-http/HttpResponse.h>
 #include <cortex-base/io/Filter.h>
 #include <cortex-base/io/GzipFilter.h>
-#include <cortex-base/Tokenizer.h>
+#include <cortex-base/io/BrotliFilter.h>
+#include <cortex-base/io/ZstdFilter.h>
+#include <cortex-base/io/MemoryFile.h>
+#include <cortex-base/io/FileUtil.h>
+#include <cortex-base/DateTime.h>
 #include <cortex-base/Buffer.h>
 #include <algorithm>
 #include <system_error>
 #include <stdexcept>
 #include <cstdlib>
+#include <cctype>
+#include <strings.h>
 
 #include <cortex-base/sysconfig.h>
 
@@ -26,14 +32,29 @@ namespace http {
 HttpOutputCompressor::HttpOutputCompressor()
     : minSize_(256),                // 256 byte
       maxSize_(128 * 1024 * 1024),  // 128 MB
-      level_(9),                    // best compression
-      contentTypes_() {             // no types
+      contentTypes_(),              // no types
+      encoders_(),
+      precompressedLookup_(),
+      variantCacheSize_(16 * 1024 * 1024),  // 16 MB
+      variantCacheUsage_(0),
+      variantLock_(),
+      variants_(),
+      variantIndex_() {
   addMimeType("text/plain");
   addMimeType("text/html");
   addMimeType("text/css");
   addMimeType("application/xml");
   addMimeType("application/xhtml+xml");
   addMimeType("application/javascript");
+
+  // in order of preference, by compression ratio at the default levels
+#if defined(HAVE_BROTLI_ENCODE_H)
+  addEncoder<BrotliFilter>("br", ".br", 5);
+#endif
+#if defined(HAVE_ZSTD_H)
+  addEncoder<ZstdFilter>("zstd", ".zst", 3);
+#endif
+  addEncoder<GzipFilter>("gzip", ".gz", 9);
 }
 
 HttpOutputCompressor::~HttpOutputCompressor() {
@@ -47,6 +68,45 @@ void HttpOutputCompressor::setMaxSize(size_t value) {
   maxSize_ = value;
 }
 
+template<typename EncoderFilter>
+void HttpOutputCompressor::addEncoder(const std::string& name,
+                                      const std::string& suffix,
+                                      int level) {
+  encoders_.emplace_back(Encoder{name, suffix, level, [](int level) {
+    return std::make_shared<EncoderFilter>(level);
+  }});
+}
+
+void HttpOutputCompressor::setCompressionLevel(int value) {
+  setCompressionLevel("gzip", value);
+}
+
+int HttpOutputCompressor::compressionLevel() const {
+  for (const Encoder& encoder: encoders_)
+    if (encoder.name == "gzip")
+      return encoder.level;
+
+  return 0;
+}
+
+bool HttpOutputCompressor::setCompressionLevel(const std::string& encoding,
+                                               int value) {
+  for (Encoder& encoder: encoders_) {
+    if (encoder.name == encoding) {
+      encoder.level = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<std::string> HttpOutputCompressor::encodings() const {
+  std::vector<std::string> result;
+  for (const Encoder& encoder: encoders_)
+    result.push_back(encoder.name);
+  return result;
+}
+
 void HttpOutputCompressor::addMimeType(const std::string& value) {
   contentTypes_[value] = 0;
 }
@@ -55,25 +115,201 @@ bool HttpOutputCompressor::containsMimeType(const std::string& value) const {
   return contentTypes_.find(value) != contentTypes_.end();
 }
 
-template<typename Encoder>
-bool tryEncode(const std::string& encoding,
-               int level,
-               const std::vector<BufferRef>& accepts,
-               HttpRequest* request,
-               HttpResponse* response) {
-  if (std::find(accepts.begin(), accepts.end(), encoding) == accepts.end())
+void HttpOutputCompressor::setPrecompressedLookup(FileLookup lookup) {
+  precompressedLookup_ = lookup;
+}
+
+void HttpOutputCompressor::setVariantCacheSize(size_t value) {
+  std::lock_guard<std::mutex> _l(variantLock_);
+
+  variantCacheSize_ = value;
+  evictVariants();
+}
+
+size_t HttpOutputCompressor::variantCacheUsage() const {
+  std::lock_guard<std::mutex> _l(variantLock_);
+  return variantCacheUsage_;
+}
+
+void HttpOutputCompressor::evictVariants() {
+  while (variantCacheUsage_ > variantCacheSize_) {
+    const Variant& victim = variants_.back();
+    variantCacheUsage_ -= victim.cost;
+    variantIndex_.erase(victim.key);
+    variants_.pop_back();
+  }
+}
+
+static inline bool isws(char ch) {
+  return ch == ' ' || ch == '\t';
+}
+
+/**
+ * Parses a qvalue, such as "0.5", into thousandths.
+ */
+static int parseQValue(const char** i, const char* e) {
+  const char* p = *i;
+  if (p == e || (*p != '0' && *p != '1'))
+    return 1000;  // be lenient on garbage
+
+  int value = (*p++ - '0') * 1000;
+  if (p != e && *p == '.') {
+    ++p;
+    for (int scale = 100; scale > 0 && p != e && std::isdigit(*p); scale /= 10)
+      value += (*p++ - '0') * scale;
+  }
+
+  *i = p;
+  return std::min(value, 1000);
+}
+
+/**
+ * Retrieves the q-value, in thousandths, that given Accept-Encoding
+ * header value assigns to @p coding, either explicitly or by wildcard.
+ */
+static int qvalueOf(const BufferRef& accept, const std::string& coding) {
+  int wildcard = 0;
+  const char* i = accept.cbegin();
+  const char* e = accept.cend();
+
+  while (i != e) {
+    while (i != e && (isws(*i) || *i == ','))
+      ++i;
+
+    const char* name = i;
+    while (i != e && *i != ',' && *i != ';' && !isws(*i))
+      ++i;
+    const size_t nameLength = i - name;
+
+    int q = 1000;
+    while (i != e && *i != ',') {
+      if (*i++ != ';')
+        continue;
+
+      while (i != e && isws(*i))
+        ++i;
+
+      if (e - i > 2 && (*i == 'q' || *i == 'Q') && i[1] == '=') {
+        i += 2;
+        q = parseQValue(&i, e);
+      }
+    }
+
+    if (nameLength == coding.size() &&
+        strncasecmp(name, coding.data(), nameLength) == 0)
+      return q;
+
+    if (nameLength == 1 && *name == '*')
+      wildcard = q;
+  }
+
+  return wildcard;
+}
+
+const HttpOutputCompressor::Encoder* HttpOutputCompressor::selectEncoder(
+    const BufferRef& acceptEncoding) const {
+  const Encoder* best = nullptr;
+  int bestQ = 0;
+
+  if (acceptEncoding.empty())
+    return nullptr;
+
+  for (const Encoder& encoder: encoders_) {
+    const int q = qvalueOf(acceptEncoding, encoder.name);
+    if (q > bestQ) {
+      best = &encoder;
+      bestQ = q;
+    }
+  }
+
+  return best;
+}
+
+const std::string& HttpOutputCompressor::selectEncoding(
+    const BufferRef& acceptEncoding) const {
+  static const std::string identity;
+
+  const Encoder* encoder = selectEncoder(acceptEncoding);
+  return encoder ? encoder->name : identity;
+}
+
+bool HttpOutputCompressor::isCompressible(const File& file) const {
+  if (file.size() < minSize_ || file.size() > maxSize_)
     return false;
 
-  // response might change according to Accept-Encoding
-  response->appendHeader("Vary", "Accept-Encoding", ",");
+  return containsMimeType(file.mimetype());
+}
 
-  // removing content-length implicitely enables chunked encoding
-  response->resetContentLength();
+std::shared_ptr<File> HttpOutputCompressor::getVariant(
+    HttpRequest* request,
+    const std::shared_ptr<File>& file,
+    std::string* encoding) {
+  if (!isCompressible(*file))
+    return nullptr;
 
-  response->addHeader("Content-Encoding", encoding);
-  response->output()->addFilter(std::make_shared<Encoder>(level));
+  const Encoder* encoder =
+      selectEncoder(request->headers().get(KnownHeader::AcceptEncoding));
+  if (!encoder)
+    return nullptr;
+
+  if (precompressedLookup_) {
+    std::shared_ptr<File> pre = precompressedLookup_(file->path() +
+                                                     encoder->suffix);
+    if (pre && pre->exists() && pre->isRegular() &&
+        pre->mtime() >= file->mtime()) {
+      *encoding = encoder->name;
+      return pre;
+    }
+  }
 
-  return true;
+  if (file->size() > variantCacheSize_)
+    return nullptr;
+
+  std::string key = file->path();
+  key += '\0';
+  key += file->etag();
+  key += '\0';
+  key += encoder->name;
+
+  {
+    std::lock_guard<std::mutex> _l(variantLock_);
+    auto i = variantIndex_.find(key);
+    if (i != variantIndex_.end()) {
+      variants_.splice(variants_.begin(), variants_, i->second);
+      if (!i->second->file)
+        return nullptr;
+
+      *encoding = encoder->name;
+      return i->second->file;
+    }
+  }
+
+  // compress outside the lock, as that may take a while
+  Buffer compressed;
+  encoder->create(encoder->level)->filter(FileUtil::read(*file),
+                                         &compressed, true);
+
+  std::shared_ptr<File> variant;
+  if (compressed.size() < file->size()) {
+    variant = std::make_shared<MemoryFile>(
+        file->path(), file->mimetype(), compressed,
+        DateTime(static_cast<double>(file->mtime())));
+  }
+
+  std::lock_guard<std::mutex> _l(variantLock_);
+  if (variantIndex_.find(key) == variantIndex_.end()) {
+    const size_t cost = key.size() + (variant ? variant->size() : 0);
+    variants_.push_front(Variant{key, variant, cost});
+    variantIndex_[key] = variants_.begin();
+    variantCacheUsage_ += cost;
+    evictVariants();
+  }
+
+  if (!variant)
+    return nullptr;
+
+  *encoding = encoder->name;
+  return variant;
 }
 
 void HttpOutputCompressor::inject(HttpRequest* request,
@@ -84,7 +320,7 @@ void HttpOutputCompressor::inject(HttpRequest* request,
 
 void HttpOutputCompressor::postProcess(HttpRequest* request,
                                        HttpResponse* response) {
-  if (response->headers().contains("Content-Encoding"))
+  if (response->headers().contains(KnownHeader::ContentEncoding))
     return;  // do not double-encode content
 
   bool chunked = !response->hasContentLength();
@@ -93,20 +329,22 @@ void HttpOutputCompressor::postProcess(HttpRequest* request,
   if (!chunked && (size < minSize_ || size > maxSize_))
     return;
 
-  if (!containsMimeType(response->headers().get("Content-Type")))
+  if (!containsMimeType(response->headers().get(KnownHeader::ContentType).str()))
     return;
 
-  const std::string& acceptEncoding = request->headers().get("Accept-Encoding");
-  BufferRef r(acceptEncoding);
-  if (!r.empty()) {
-    const auto items = Tokenizer<BufferRef, BufferRef>::tokenize(r, ", ");
+  const Encoder* encoder =
+      selectEncoder(request->headers().get(KnownHeader::AcceptEncoding));
+  if (!encoder)
+    return;
 
-    // if (tryEncode<Bzip2Filter>("bzip2", level_, items, request, response))
-    //   return;
+  // response might change according to Accept-Encoding
+  response->appendHeader("Vary", "Accept-Encoding", ",");
 
-    if (tryEncode<GzipFilter>("gzip", level_, items, request, response))
-      return;
-  }
+  // removing content-length implicitely enables chunked encoding
+  response->resetContentLength();
+
+  response->addHeader("Content-Encoding", encoder->name);
+  response->output()->addFilter(encoder->create(encoder->level));
 }
 
 } // namespace http
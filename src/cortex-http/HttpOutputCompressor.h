@@ -10,9 +10,19 @@
 #include <cortex-http/Api.h>
 #include <cortex-base/sysconfig.h>
 #include <unordered_map>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <list>
 
 namespace cortex {
+
+class BufferRef;
+class File;
+class Filter;
+
 namespace http {
 
 class HttpRequest;
@@ -20,9 +30,22 @@ class HttpResponse;
 
 /**
  * HTTP response output compression.
+ *
+ * The content-coding is negotiated by the q-values of the request's
+ * Accept-Encoding header among all encoders available in this build:
+ * "br" (Brotli) and "zstd" (Zstandard), if available, and "gzip".
+ *
+ * Besides compressing arbitrary responses on the fly, it provides
+ * compressed variants of static files, either precompressed ones that
+ * reside next to the original file, or ones compressed only once and
+ * then kept in a size-bounded cache.
+ *
+ * @see HttpFileHandler::setOutputCompressor()
  */
 class CORTEX_HTTP_API HttpOutputCompressor {
  public:
+  typedef std::function<std::shared_ptr<File>(const std::string&)> FileLookup;
+
   HttpOutputCompressor();
   ~HttpOutputCompressor();
 
@@ -35,8 +58,81 @@ class CORTEX_HTTP_API HttpOutputCompressor {
   void setMaxSize(size_t value);
   size_t maxSize() const CORTEX_NOEXCEPT { return maxSize_; }
 
-  void setCompressionLevel(int value) { level_ = value; }
-  int compressionLevel() const CORTEX_NOEXCEPT { return level_; }
+  /** Sets the compression level of the gzip encoder. */
+  void setCompressionLevel(int value);
+  int compressionLevel() const;
+
+  /**
+   * Sets the compression level of the encoder for given content-coding.
+   *
+   * @param encoding content-coding, such as "br", "zstd" or "gzip".
+   * @param value encoder specific compression level.
+   *
+   * @retval true level set.
+   * @retval false no such encoder available.
+   */
+  bool setCompressionLevel(const std::string& encoding, int value);
+
+  /** Retrieves all available content-codings, most preferred first. */
+  std::vector<std::string> encodings() const;
+
+  /**
+   * Selects the content-coding to respond with.
+   *
+   * Picks the available encoding with the highest q-value in
+   * @p acceptEncoding, preferring the earlier one in encodings() on ties.
+   *
+   * @param acceptEncoding value of the request's Accept-Encoding header.
+   *
+   * @return the selected content-coding or an empty string for none.
+   */
+  const std::string& selectEncoding(const BufferRef& acceptEncoding) const;
+
+  /**
+   * Enables serving precompressed files, such as "app.js.br", "app.js.zst"
+   * or "app.js.gz" in place of "app.js", unless older than the original.
+   *
+   * @param lookup retrieves the file at the given local path, or
+   *               @c nullptr to disable looking for precompressed files.
+   */
+  void setPrecompressedLookup(FileLookup lookup);
+
+  /**
+   * Limits the total size of compressed file variants to keep around.
+   *
+   * @param value size in bytes, or 0 to disable caching of variants.
+   */
+  void setVariantCacheSize(size_t value);
+  size_t variantCacheSize() const CORTEX_NOEXCEPT { return variantCacheSize_; }
+
+  /** Total size of all currently cached compressed file variants. */
+  size_t variantCacheUsage() const;
+
+  /**
+   * Tests whether @p file is eligible for compression at all, that is, its
+   * mimetype is listed and its size is within minSize() and maxSize().
+   *
+   * Responses carrying such a file depend on the request's Accept-Encoding
+   * header, whether or not a compressed variant is served in the end.
+   */
+  bool isCompressible(const File& file) const;
+
+  /**
+   * Retrieves a compressed variant of @p file acceptable to @p request.
+   *
+   * Compressed variants are keyed by the file's path and entity tag, and
+   * are thus compressed only once per file revision.
+   *
+   * @param request the request to retrieve a variant for.
+   * @param file the file to retrieve a variant of.
+   * @param encoding receives the content-coding of the returned variant.
+   *
+   * @return the compressed variant or @c nullptr if the file is to be
+   *         served as is.
+   */
+  std::shared_ptr<File> getVariant(HttpRequest* request,
+                                   const std::shared_ptr<File>& file,
+                                   std::string* encoding);
 
   /**
    * Injects a preCommit handler to automatically add output compression.
@@ -49,10 +145,39 @@ class CORTEX_HTTP_API HttpOutputCompressor {
   void postProcess(HttpRequest* request, HttpResponse* response);
 
  private:
+  struct Encoder {
+    std::string name;    //!< content-coding, such as "gzip"
+    std::string suffix;  //!< file name suffix of precompressed files
+    int level;
+    std::function<std::shared_ptr<Filter>(int level)> create;
+  };
+
+  template<typename EncoderFilter>
+  void addEncoder(const std::string& name, const std::string& suffix,
+                  int level);
+
+  const Encoder* selectEncoder(const BufferRef& acceptEncoding) const;
+
   size_t minSize_;
   size_t maxSize_;
-  int level_;
   std::unordered_map<std::string, int> contentTypes_;
+  std::vector<Encoder> encoders_;  //!< most preferred first
+
+  struct Variant {
+    std::string key;
+    std::shared_ptr<File> file;  //!< nullptr if not worth compressing
+    size_t cost;
+  };
+  typedef std::list<Variant> VariantList;
+
+  void evictVariants();
+
+  FileLookup precompressedLookup_;
+  size_t variantCacheSize_;
+  size_t variantCacheUsage_;
+  mutable std::mutex variantLock_;
+  VariantList variants_;  //!< most recently used variant first
+  std::unordered_map<std::string, VariantList::iterator> variantIndex_;
 };
 
 } // namespace http
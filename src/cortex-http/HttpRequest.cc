@@ -24,8 +24,16 @@ HttpRequest::HttpRequest()
   // .
 }
 
-HttpRequest::HttpRequest(std::unique_ptr<HttpInput>&& input)
-    : HttpRequest("", "", HttpVersion::UNKNOWN, false, {}, std::move(input)) {
+HttpRequest::HttpRequest(std::unique_ptr<HttpInput>&& input, Arena* arena)
+    : method_(HttpMethod::UNKNOWN_METHOD),
+      unparsedMethod_(),
+      path_(),
+      version_(HttpVersion::UNKNOWN),
+      secure_(false),
+      expect100Continue_(false),
+      headers_(arena),
+      input_(std::move(input)),
+      username_() {
   // .
 }
 
@@ -73,7 +81,11 @@ void HttpRequest::recycle() {
 }
 
 bool HttpRequest::setUri(const std::string& uri) {
-  unparsedUri_ = uri;
+  return setUri(BufferRef(uri));
+}
+
+bool HttpRequest::setUri(const BufferRef& uri) {
+  unparsedUri_.assign(uri.data(), uri.size());
 
   if (unparsedUri_ == "*") {
     path_ = "*";
@@ -347,5 +359,9 @@ void HttpRequest::setHost(const std::string& value) {
   host_ = value;
 }
 
+void HttpRequest::setHost(const BufferRef& value) {
+  host_.assign(value.data(), value.size());
+}
+
 }  // namespace http
 }  // namespace cortex
@@ -28,7 +28,8 @@ namespace http {
 class CORTEX_HTTP_API HttpRequest {
  public:
   HttpRequest();
-  explicit HttpRequest(std::unique_ptr<HttpInput>&& input);
+  explicit HttpRequest(std::unique_ptr<HttpInput>&& input,
+                       Arena* arena = nullptr);
   HttpRequest(const std::string& method, const std::string& path,
               HttpVersion version, bool secure, const HeaderFieldList& headers,
               std::unique_ptr<HttpInput>&& input);
@@ -44,6 +45,7 @@ class CORTEX_HTTP_API HttpRequest {
   void setMethod(const std::string& value);
 
   bool setUri(const std::string& uri);
+  bool setUri(const BufferRef& uri);
   const std::string& unparsedUri() const CORTEX_NOEXCEPT { return unparsedUri_; }
   const std::string& path() const CORTEX_NOEXCEPT { return path_; }
   const std::string& query() const CORTEX_NOEXCEPT { return query_; }
@@ -57,6 +59,7 @@ class CORTEX_HTTP_API HttpRequest {
 
   const std::string& host() const CORTEX_NOEXCEPT { return host_; }
   void setHost(const std::string& value);
+  void setHost(const BufferRef& value);
 
   bool isSecure() const CORTEX_NOEXCEPT { return secure_; }
   void setSecure(bool secured) { secure_ = secured; }
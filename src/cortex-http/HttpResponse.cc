@@ -16,14 +16,15 @@ namespace cortex {
 namespace http {
 
 HttpResponse::HttpResponse(HttpChannel* channel,
-                           std::unique_ptr<HttpOutput>&& output)
+                           std::unique_ptr<HttpOutput>&& output,
+                           Arena* arena)
     : channel_(channel),
       output_(std::move(output)),
       version_(HttpVersion::UNKNOWN),
       status_(HttpStatus::Undefined),
       contentLength_(static_cast<size_t>(-1)),
-      headers_(),
-      trailers_(),
+      headers_(arena),
+      trailers_(arena),
       committed_(false),
       bytesTransmitted_(0) {
   //.
@@ -121,7 +122,7 @@ void HttpResponse::addHeader(const std::string& name,
   requireMutableInfo();
   requireValidHeader(name);
 
-  headers_.push_back(name, value);
+  headers_.push_back(BufferRef(name), BufferRef(value));
 }
 
 void HttpResponse::appendHeader(const std::string& name,
@@ -130,7 +131,7 @@ void HttpResponse::appendHeader(const std::string& name,
   requireMutableInfo();
   requireValidHeader(name);
 
-  headers_.append(name, value, delim);
+  headers_.append(BufferRef(name), BufferRef(value), BufferRef(delim));
 }
 
 void HttpResponse::setHeader(const std::string& name,
@@ -138,13 +139,13 @@ void HttpResponse::setHeader(const std::string& name,
   requireMutableInfo();
   requireValidHeader(name);
 
-  headers_.overwrite(name, value);
+  headers_.overwrite(BufferRef(name), BufferRef(value));
 }
 
 void HttpResponse::removeHeader(const std::string& name) {
   requireMutableInfo();
 
-  headers_.remove(name);
+  headers_.remove(BufferRef(name));
 }
 
 void HttpResponse::removeAllHeaders() {
@@ -153,8 +154,8 @@ void HttpResponse::removeAllHeaders() {
   headers_.reset();
 }
 
-const std::string& HttpResponse::getHeader(const std::string& name) const {
-  return headers_.get(name);
+BufferRef HttpResponse::getHeader(const std::string& name) const {
+  return headers_.get(BufferRef(name));
 }
 
 void HttpResponse::send100Continue(CompletionHandler onComplete) {
@@ -202,11 +203,11 @@ void HttpResponse::registerTrailer(const std::string& name) {
   requireMutableInfo();
   requireValidHeader(name);
 
-  if (trailers_.contains(name))
+  if (trailers_.contains(BufferRef(name)))
     // "Trailer already registered."
     RAISE(InvalidArgumentError);
 
-  trailers_.push_back(name, "");
+  trailers_.push_back(BufferRef(name), "");
 }
 
 void HttpResponse::appendTrailer(const std::string& name,
@@ -215,20 +216,20 @@ void HttpResponse::appendTrailer(const std::string& name,
   requireNotSendingAlready();
   requireValidHeader(name);
 
-  if (!trailers_.contains(name))
+  if (!trailers_.contains(BufferRef(name)))
     RAISE(IllegalStateError, "Trailer not registered yet.");
 
-  trailers_.append(name, value, delim);
+  trailers_.append(BufferRef(name), BufferRef(value), BufferRef(delim));
 }
 
 void HttpResponse::setTrailer(const std::string& name, const std::string& value) {
   requireNotSendingAlready();
   requireValidHeader(name);
 
-  if (!trailers_.contains(name))
+  if (!trailers_.contains(BufferRef(name)))
     RAISE(IllegalStateError, "Trailer not registered yet.");
 
-  trailers_.overwrite(name, value);
+  trailers_.overwrite(BufferRef(name), BufferRef(value));
 }
 // }}}
 
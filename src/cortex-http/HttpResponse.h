@@ -36,7 +36,13 @@ class CORTEX_HTTP_API HttpResponse {
   HttpResponse& operator=(HttpResponse&) = delete;
 
  public:
-  HttpResponse(HttpChannel* channel, std::unique_ptr<HttpOutput>&& output);
+  /**
+   * @param channel the channel this response belongs to.
+   * @param output the output stream for the response body.
+   * @param arena optional arena to allocate headers and trailers from.
+   */
+  HttpResponse(HttpChannel* channel, std::unique_ptr<HttpOutput>&& output,
+               Arena* arena = nullptr);
 
   void recycle();
 
@@ -69,7 +75,7 @@ class CORTEX_HTTP_API HttpResponse {
   void setHeader(const std::string& name, const std::string& value);
   void removeHeader(const std::string& name);
   void removeAllHeaders();
-  const std::string& getHeader(const std::string& name) const;
+  BufferRef getHeader(const std::string& name) const;
   const HeaderFieldList& headers() const CORTEX_NOEXCEPT { return headers_; }
   HeaderFieldList& headers() CORTEX_NOEXCEPT { return headers_; }
 
@@ -29,7 +29,8 @@ class CORTEX_HTTP_API HttpResponseInfo : public HttpInfo {
                    const std::string& reason, bool isHeadResponse,
                    size_t contentLength,
                    const HeaderFieldList& headers,
-                   const HeaderFieldList& trailers);
+                   const HeaderFieldList& trailers,
+                   Arena* arena = nullptr);
 
   /** Retrieves the HTTP response status code. */
   HttpStatus status() const CORTEX_NOEXCEPT { return status_; }
@@ -79,8 +80,9 @@ inline HttpResponseInfo::HttpResponseInfo(HttpVersion version,
                                           bool isHeadResponse,
                                           size_t contentLength,
                                           const HeaderFieldList& headers,
-                                          const HeaderFieldList& trailers)
-    : HttpInfo(version, contentLength, headers, trailers),
+                                          const HeaderFieldList& trailers,
+                                          Arena* arena)
+    : HttpInfo(version, contentLength, headers, trailers, arena),
       status_(status),
       reason_(reason),
       isHeadResponse_(isHeadResponse) {
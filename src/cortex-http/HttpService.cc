@@ -10,6 +10,7 @@
 #include <cortex-http/HttpResponse.h>
 #include <cortex-http/HttpInputListener.h>
 #include <cortex-http/http1/ConnectionFactory.h>
+#include <cortex-http/http2/ConnectionFactory.h>
 #include <cortex-http/fastcgi/ConnectionFactory.h>
 #include <cortex-base/net/LocalConnector.h>
 #include <cortex-base/net/InetConnector.h>
@@ -78,6 +79,12 @@ HttpService::Protocol HttpService::getDefaultProtocol() {
   if (strcmp(env, "http1") == 0)
     return HttpService::HTTP1;
 
+  if (strcmp(env, "http2") == 0)
+    return HttpService::HTTP2;
+
+  if (strcmp(env, "h2c") == 0)
+    return HttpService::HTTP2;
+
   RAISE(RuntimeError,
         "Invalid value for environment variable HTTP_TRANSPORT: \"%s\".",
         env);
@@ -131,6 +138,9 @@ void HttpService::attachProtocol(Connector* connector) {
     case HTTP1:
       attachHttp1(connector);
       break;
+    case HTTP2:
+      attachHttp2(connector);
+      break;
     case FCGI:
       attachFCGI(connector);
       break;
@@ -156,6 +166,29 @@ void HttpService::attachHttp1(Connector* connector) {
                    std::placeholders::_1, std::placeholders::_2));
 }
 
+void HttpService::attachHttp2(Connector* connector) {
+  WallClock* clock = WallClock::system();
+  size_t maxRequestUriLength = 1024;
+  size_t maxRequestBodyLength = 64 * 1024 * 1024;
+  size_t maxConcurrentStreams = 100;
+  size_t initialWindowSize = 64 * 1024;
+
+  // the first factory added is the connector's default, that is, plaintext
+  // clients are expected to speak h2c with prior knowledge, whereas TLS
+  // clients may still negotiate http/1.1 via ALPN.
+  auto h2 = connector->addConnectionFactory<cortex::http::http2::ConnectionFactory>(
+      clock,
+      maxRequestUriLength,
+      maxRequestBodyLength,
+      maxConcurrentStreams,
+      initialWindowSize);
+
+  h2->setHandler(std::bind(&HttpService::handleRequest, this,
+                 std::placeholders::_1, std::placeholders::_2));
+
+  attachHttp1(connector);
+}
+
 void HttpService::attachFCGI(Connector* connector) {
   WallClock* clock = WallClock::system();
   size_t maxRequestUriLength = 1024;
@@ -44,6 +44,7 @@ class CORTEX_HTTP_API HttpService {
 
   enum Protocol {
     HTTP1,
+    HTTP2,
     FCGI,
   };
 
@@ -95,6 +96,7 @@ class CORTEX_HTTP_API HttpService {
   static Protocol getDefaultProtocol();
   void attachProtocol(Connector* connector);
   void attachHttp1(Connector* connector);
+  void attachHttp2(Connector* connector);
   void attachFCGI(Connector* connector);
   void handleRequest(HttpRequest* request, HttpResponse* response);
   void onAllDataRead(HttpRequest* request, HttpResponse* response);
@@ -44,8 +44,8 @@ void Generator::generateRequest(const HttpRequestInfo& info) {
   paramsWriter.encode("GATEWAY_INTERFACE", "CGI/1.1");
   paramsWriter.encode("SERVER_SOFTWARE", "cortex-http");
   paramsWriter.encode("SERVER_PROTOCOL", to_string(info.version()));
-  if (info.headers().contains("Host"))
-    paramsWriter.encode("SERVER_NAME", info.headers().get("Host"));
+  if (info.headers().contains(KnownHeader::Host))
+    paramsWriter.encode("SERVER_NAME", info.headers().get(KnownHeader::Host));
   paramsWriter.encode("REQUEST_METHOD", info.method());
   paramsWriter.encode("REQUEST_URI", info.entity());
 
@@ -99,7 +99,7 @@ void Generator::generateResponse(const HttpResponseInfo& info) {
   payload.push_back("\r\n");
 
   for (const HeaderField& header: info.headers()) {
-    TRACE("  %s: %s", header.name().c_str(), header.value().c_str());
+    TRACE("  %s: %s", header.name().str().c_str(), header.value().str().c_str());
     payload.push_back(header.name());
     payload.push_back(": ");
     payload.push_back(header.value());
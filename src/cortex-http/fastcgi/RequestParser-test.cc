@@ -77,7 +77,7 @@ void RequestListener::onMessageBegin() {
 }
 
 void RequestListener::onMessageHeader(const BufferRef& name, const BufferRef& value) {
-  this->headers.push_back(name.str(), value.str());
+  this->headers.push_back(name, value);
 }
 
 void RequestListener::onMessageHeaderEnd() {
@@ -58,12 +58,12 @@ void RequestParser::StreamState::onParam(
     nam = nam.substr(5);
     StringUtil::replaceAll(&nam, "_", "-");
 
-    headers.push_back(nam, val);
+    headers.push_back(BufferRef(nam), BufferRef(val));
     return;
   }
 
   // non-HTTP-header parameters
-  params.push_back(nam, val);
+  params.push_back(BufferRef(nam), BufferRef(val));
 
   // SERVER_PORT
   // SERVER_ADDR
@@ -204,13 +204,13 @@ void RequestParser::streamParams(const fastcgi::Record* record) {
   stream->paramsFullyReceived = true;
 
   for (const auto& param: stream->params)
-    TRACE("  %s: %s", param.name().c_str(), param.value().c_str());
+    TRACE("  %s: %s", param.name().str().c_str(), param.value().str().c_str());
 
   BufferRef method(stream->params.get("REQUEST_METHOD"));
   BufferRef entity(stream->params.get("REQUEST_URI"));
 
   HttpVersion version = HttpVersion::UNKNOWN;
-  const std::string& serverProtocol = stream->params.get("SERVER_PROTOCOL");
+  const BufferRef serverProtocol = stream->params.get("SERVER_PROTOCOL");
   if (serverProtocol == "HTTP/1.1")
     version = HttpVersion::VERSION_1_1;
   else if (serverProtocol == "HTTP/1.0")
@@ -221,8 +221,7 @@ void RequestParser::streamParams(const fastcgi::Record* record) {
   stream->listener->onMessageBegin(method, entity, version);
 
   for (const auto& header: stream->headers) {
-    stream->listener->onMessageHeader(BufferRef(header.name()),
-                                      BufferRef(header.value()));
+    stream->listener->onMessageHeader(header.name(), header.value());
   }
 
   stream->listener->onMessageHeaderEnd();
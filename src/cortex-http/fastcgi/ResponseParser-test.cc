@@ -69,7 +69,7 @@ void ResponseListener::onMessageBegin() {
 }
 
 void ResponseListener::onMessageHeader(const BufferRef& name, const BufferRef& value) {
-  this->headers.push_back(name.str(), value.str());
+  this->headers.push_back(name, value);
 }
 
 void ResponseListener::onMessageHeaderEnd() {
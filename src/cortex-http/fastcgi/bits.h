@@ -168,6 +168,11 @@ class CgiParamStreamWriter {
     encodeHeader(name.data(), name.size(), value.data(), value.size());
   }
 
+  void encodeHeader(const cortex::BufferRef& name,
+                    const cortex::BufferRef& value) {
+    encodeHeader(name.data(), name.size(), value.data(), value.size());
+  }
+
   void encode(const char *name, size_t nameLength,
               const char *value, size_t valueLength);
 
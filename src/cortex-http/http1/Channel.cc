@@ -90,7 +90,7 @@ void Channel::onMessageHeaderEnd() {
   // hide transport-level header fields
   request_->headers().remove("Connection");
   for (const auto& name: connectionOptions_)
-    request_->headers().remove(name);
+    request_->headers().remove(BufferRef(name));
 
   HttpChannel::onMessageHeaderEnd();
 }
@@ -348,3 +348,40 @@ TEST(http_http1_Parser, pipelined1) {
   EXPECT_EQ("/bar", listener.entity);
   EXPECT_EQ(HttpVersion::VERSION_0_9, listener.version);
 }
+
+TEST(http_http1_Parser, requestWithLongLines) {
+  // long enough for the bulk scanners to process multiple blocks
+  ParserListener listener;
+  Parser parser(Parser::REQUEST, &listener);
+  parser.parseFragment(
+      "GET /api/v1/users/12345/orders?page=2&sort=desc%20date HTTP/1.1\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64)\tGecko/20100101\r\n"
+      "Accept-Language: en-US,en;q=0.8,\r\n"
+      "  de;q=0.5\r\n"
+      "\r\n");
+
+  ASSERT_EQ("GET", listener.method);
+  ASSERT_EQ("/api/v1/users/12345/orders?page=2&sort=desc%20date",
+            listener.entity);
+  ASSERT_EQ(HttpVersion::VERSION_1_1, listener.version);
+  ASSERT_EQ(2, listener.headers.size());
+
+  ASSERT_EQ("User-Agent", listener.headers[0].first);
+  ASSERT_EQ("Mozilla/5.0 (X11; Linux x86_64)\tGecko/20100101",
+            listener.headers[0].second);
+
+  ASSERT_EQ("Accept-Language", listener.headers[1].first);
+  ASSERT_EQ("en-US,en;q=0.8,\r\n  de;q=0.5", listener.headers[1].second);
+  ASSERT_TRUE(listener.messageEnd);
+}
+
+TEST(http_http1_Parser, invalidHeaderValueControlChar) {
+  ParserListener listener;
+  Parser parser(Parser::MESSAGE, &listener);
+  size_t n = parser.parseFragment("X-Long: abcdefghijklmnopqrstuvwxyz\x01xyz\r\n"
+                                  "\r\n");
+
+  ASSERT_EQ(HttpStatus::BadRequest, listener.errorCode);
+  ASSERT_EQ(34, n);
+  ASSERT_EQ(0, listener.headers.size());
+}
@@ -11,6 +11,11 @@
 #include <cortex-http/BadMessage.h>
 #include <cortex-base/logging.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CORTEX_HTTP1_PARSER_SSE42 1
+#include <nmmintrin.h>
+#endif
+
 namespace cortex {
 namespace http {
 namespace http1 {
@@ -21,6 +26,52 @@ namespace http1 {
 #define TRACE(msg...) do {} while (0)
 #endif
 
+#if defined(CORTEX_HTTP1_PARSER_SSE42)
+/**
+ * Skips input 16 bytes at a time until a byte within any of the
+ * given byte @p ranges is found or less than 16 bytes are left.
+ *
+ * @param i input begin
+ * @param e input end
+ * @param ranges up to 8 pairs of inclusive lower and upper byte bounds,
+ *               padded to 16 bytes.
+ * @param rangesLength number of bytes used in @p ranges.
+ *
+ * @return number of bytes skipped.
+ */
+__attribute__((target("sse4.2")))
+static size_t skipUntilRanges(const char* i, const char* e,
+                              const char* ranges, int rangesLength) {
+  const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranges));
+  const char* p = i;
+
+  while (e - p >= 16) {
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const int n = _mm_cmpestri(r, rangesLength, b, 16,
+                               _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                               _SIDD_LEAST_SIGNIFICANT);
+    p += n;
+    if (n != 16)
+      break;
+  }
+
+  return p - i;
+}
+
+static bool detectSSE42() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2");
+}
+
+static const bool hasSSE42 = detectSSE42();
+
+// CTLs except HT, that is, everything that terminates *TEXT
+static const char textStopRanges[16] = "\x00\x08\x0a\x1f\x7f\x7f";
+
+// SP, CTLs and non-ASCII, that is, everything that terminates a Request-URI
+static const char entityStopRanges[16] = "\x00\x20\x7f\xff";
+#endif
+
 std::string to_string(Parser::State state) {
   switch (state) {
     // artificial
@@ -338,8 +389,9 @@ std::size_t Parser::parseFragment(const BufferRef& chunk) {
           state_ = REQUEST_ENTITY_BEGIN;
           nextChar();
         } else if (isToken(*i)) {
-          method_.shr();
-          nextChar();
+          const size_t n = scanToken(i, e);
+          method_.shr(n);
+          nextChar(n);
         } else {
           onProtocolError(HttpStatus::BadRequest);
           state_ = PROTOCOL_ERROR;
@@ -360,8 +412,9 @@ std::size_t Parser::parseFragment(const BufferRef& chunk) {
           state_ = REQUEST_PROTOCOL_BEGIN;
           nextChar();
         } else if (std::isprint(*i)) {
-          entity_.shr();
-          nextChar();
+          const size_t n = scanEntity(i, e);
+          entity_.shr(n);
+          nextChar(n);
         } else if (*i == CR) {
           state_ = REQUEST_0_9_LF;
           nextChar();
@@ -571,8 +624,9 @@ std::size_t Parser::parseFragment(const BufferRef& chunk) {
         break;
       case STATUS_MESSAGE:
         if (isText(*i) && *i != CR && *i != LF) {
-          message_.shr();
-          nextChar();
+          const size_t n = scanText(i, e);
+          message_.shr(n);
+          nextChar(n);
         } else if (*i == CR) {
           state_ = STATUS_MESSAGE_LF;
           nextChar();
@@ -610,8 +664,9 @@ std::size_t Parser::parseFragment(const BufferRef& chunk) {
         break;
       case HEADER_NAME:
         if (isToken(*i)) {
-          name_.shr();
-          nextChar();
+          const size_t n = scanToken(i, e);
+          name_.shr(n);
+          nextChar(n);
         } else if (*i == ':') {
           state_ = LWS_BEGIN;
           lwsNext_ = HEADER_VALUE_BEGIN;
@@ -707,8 +762,9 @@ std::size_t Parser::parseFragment(const BufferRef& chunk) {
           nextChar();
         }
         else if (isText(*i)) {
-          value_.shr();
-          nextChar();
+          const size_t n = scanText(i, e);
+          value_.shr(n);
+          nextChar(n);
         } else {
           onProtocolError(HttpStatus::BadRequest);
           state_ = PROTOCOL_ERROR;
@@ -988,6 +1044,39 @@ inline bool Parser::isText(char value) {
   return !isControl(value) || value == SP || value == HT;
 }
 
+inline size_t Parser::scanToken(const char* i, const char* e) {
+  // tokens are short and need more ranges than SSE4.2 can match at once
+  const char* p = i;
+  while (p != e && isToken(*p))
+    ++p;
+
+  return p - i;
+}
+
+inline size_t Parser::scanEntity(const char* i, const char* e) {
+  const char* p = i;
+#if defined(CORTEX_HTTP1_PARSER_SSE42)
+  if (hasSSE42)
+    p += skipUntilRanges(p, e, entityStopRanges, 4);
+#endif
+  while (p != e && *p != SP && std::isprint(*p))
+    ++p;
+
+  return p - i;
+}
+
+inline size_t Parser::scanText(const char* i, const char* e) {
+  const char* p = i;
+#if defined(CORTEX_HTTP1_PARSER_SSE42)
+  if (hasSSE42)
+    p += skipUntilRanges(p, e, textStopRanges, 6);
+#endif
+  while (p != e && isText(*p) && *p != CR && *p != LF)
+    ++p;
+
+  return p - i;
+}
+
 inline HttpVersion make_version(int versionMajor, int versionMinor) {
   if (versionMajor == 0) {
     if (versionMinor == 9)
@@ -164,6 +164,12 @@ class CORTEX_HTTP_API Parser {
   static inline bool isToken(char value);
   static inline bool isText(char value);
 
+  // bulk scanners, each returning the length of the longest prefix of
+  // [i, e) that the respective state would consume byte by byte
+  static inline size_t scanToken(const char* i, const char* e);
+  static inline size_t scanEntity(const char* i, const char* e);
+  static inline size_t scanText(const char* i, const char* e);
+
   void onMessageBegin(const BufferRef& method, const BufferRef& entity,
                       int versionMajor, int versionMinor);
   void onMessageBegin(int versionMajor, int versionMinor, int code,
@@ -0,0 +1,302 @@
+// This file is part of the "x0" project, http://cortex.io/
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+// HTTP/2 transport protocol tests
+
+#include <cortex-http/http2/ConnectionFactory.h>
+#include <cortex-http/http2/FrameGenerator.h>
+#include <cortex-http/http2/FrameListener.h>
+#include <cortex-http/http2/FrameParser.h>
+#include <cortex-http/http2/hpack.h>
+#include <cortex-http/HttpRequest.h>
+#include <cortex-http/HttpResponse.h>
+#include <cortex-http/HttpOutput.h>
+#include <cortex-base/executor/DirectExecutor.h>
+#include <cortex-base/net/Server.h>
+#include <cortex-base/net/LocalConnector.h>
+#include <cortex-base/net/EndPointWriter.h>
+#include <cortex-base/net/ByteArrayEndPoint.h>
+#include <cortex-base/Buffer.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace cortex;
+using namespace cortex::http;
+using namespace cortex::http::http2;
+
+static const size_t maxRequestUriLength = 64;
+static const size_t maxRequestBodyLength = 128;
+static const size_t maxConcurrentStreams = 4;
+static const size_t initialWindowSize = DefaultWindowSize;
+
+#define MOCK_HTTP2_SERVER(server, localConnector, executor)                     \
+  cortex::Server server;                                                        \
+  cortex::DirectExecutor executor(false);                                       \
+  cortex::WallClock* clock = nullptr;                                           \
+  auto localConnector = server.addConnector<cortex::LocalConnector>(&executor); \
+  auto http = localConnector->addConnectionFactory<                             \
+                                 cortex::http::http2::ConnectionFactory>(       \
+      clock, maxRequestUriLength, maxRequestBodyLength, maxConcurrentStreams,   \
+      initialWindowSize);                                                       \
+  http->setHandler([&](HttpRequest* request, HttpResponse* response) {          \
+      response->setStatus(HttpStatus::Ok);                                      \
+      response->setContentLength(request->path().size() + 1);                  \
+      response->setHeader("Content-Type", "text/plain");                        \
+      response->output()->write(Buffer(request->path() + "\n"),                \
+          std::bind(&HttpResponse::completed, response));                       \
+  });                                                                           \
+  server.start();
+
+/**
+ * Client side of the wire, generating requests and decoding the responses
+ * into one human readable line per frame.
+ */
+class MockClient : public FrameListener { // {{{
+ public:
+  MockClient() : writer_(), generator_(&writer_), encoder_(), decoder_() {
+    writer_.write(BufferRef(ConnectionPreface, ConnectionPrefaceSize));
+  }
+
+  FrameGenerator* generator() { return &generator_; }
+
+  void request(StreamID sid,
+               const std::vector<std::pair<std::string, std::string>>& fields,
+               bool last) {
+    Buffer block;
+    encoder_.beginHeaderBlock(&block);
+    for (const auto& field: fields)
+      encoder_.encode(&block, BufferRef(field.first), BufferRef(field.second));
+    generator_.generateHeaders(sid, block, last);
+  }
+
+  void get(StreamID sid, const std::string& path) {
+    request(sid, {{":method", "GET"},
+                  {":scheme", "http"},
+                  {":path", path},
+                  {":authority", "localhost"}}, true);
+  }
+
+  std::string wire() {
+    ByteArrayEndPoint ep(nullptr);
+    writer_.flush(&ep);
+    return ep.output().str();
+  }
+
+  std::vector<std::string> parse(const Buffer& output) {
+    events.clear();
+    FrameParser parser(this);
+    parser.parseFragment(output.ref());
+    return events;
+  }
+
+  std::vector<std::string> events;
+
+  // FrameListener overrides
+  void onData(StreamID sid, const BufferRef& data, bool last,
+              size_t flowControlled) override {
+    events.push_back("DATA " + std::to_string(sid) + " " + data.str() +
+                     (last ? " END_STREAM" : ""));
+  }
+
+  void onHeaders(StreamID sid, const BufferRef& headerBlock,
+                 bool last) override {
+    std::string s = "HEADERS " + std::to_string(sid);
+    decoder_.decode(headerBlock, [&](const BufferRef& name,
+                                     const BufferRef& value, bool) {
+      if (name != "date" && name != "server")
+        s += " " + name.str() + "=" + value.str();
+    });
+    events.push_back(s + (last ? " END_STREAM" : ""));
+  }
+
+  void onPriority(StreamID sid, StreamID dependency, bool exclusive,
+                  unsigned weight) override {}
+
+  void onResetStream(StreamID sid, ErrorCode errorCode) override {
+    events.push_back("RST_STREAM " + std::to_string(sid) + " " +
+                     to_string(errorCode));
+  }
+
+  void onSettings(const SettingsList& settings) override {
+    events.push_back("SETTINGS");
+  }
+
+  void onSettingsAck() override {
+    events.push_back("SETTINGS ACK");
+  }
+
+  void onPushPromise(StreamID sid, StreamID promisedStreamID,
+                     const BufferRef& headerBlock) override {}
+
+  void onPing(const BufferRef& data) override {}
+
+  void onPingAck(const BufferRef& data) override {
+    events.push_back("PING ACK " + data.str());
+  }
+
+  void onGoAway(StreamID lastStreamID, ErrorCode errorCode,
+                const BufferRef& debugData) override {
+    events.push_back("GOAWAY " + std::to_string(lastStreamID) + " " +
+                     to_string(errorCode));
+  }
+
+  void onWindowUpdate(StreamID sid, uint32_t increment) override {
+    events.push_back("WINDOW_UPDATE " + std::to_string(sid));
+  }
+
+  void onConnectionError(ErrorCode errorCode,
+                         const std::string& message) override {
+    events.push_back("connection error " + message);
+  }
+
+  void onStreamError(StreamID sid, ErrorCode errorCode,
+                     const std::string& message) override {
+    events.push_back("stream error " + message);
+  }
+
+ private:
+  EndPointWriter writer_;
+  FrameGenerator generator_;
+  hpack::Encoder encoder_;
+  hpack::Decoder decoder_;
+};
+// }}}
+
+static std::string dump(const std::vector<std::string>& events) {
+  std::string s;
+  for (const std::string& event: events)
+    s += event + "\n";
+  return s;
+}
+
+TEST(http_http2_Connection, get) {
+  MOCK_HTTP2_SERVER(server, connector, executor);
+
+  MockClient client;
+  client.generator()->generateSettings({});
+  client.get(1, "/hello");
+
+  cortex::RefPtr<LocalEndPoint> ep;
+  executor.execute([&] {
+    ep = connector->createClient(client.wire());
+  });
+
+  std::vector<std::string> events = client.parse(ep->output());
+  ASSERT_EQ(5, events.size()) << dump(events);
+  EXPECT_EQ("SETTINGS", events[0]);
+  EXPECT_EQ("SETTINGS ACK", events[1]);
+  EXPECT_EQ("HEADERS 1 :status=200 content-type=text/plain content-length=7",
+            events[2]);
+  EXPECT_EQ("DATA 1 /hello\n", events[3]);
+  EXPECT_EQ("DATA 1  END_STREAM", events[4]);
+}
+
+TEST(http_http2_Connection, multiplexed) {
+  MOCK_HTTP2_SERVER(server, connector, executor);
+
+  MockClient client;
+  client.generator()->generateSettings({});
+  client.get(1, "/one");
+  client.generator()->generatePing(BufferRef("pingpong"));
+  client.get(3, "/two");
+
+  cortex::RefPtr<LocalEndPoint> ep;
+  executor.execute([&] {
+    ep = connector->createClient(client.wire());
+  });
+
+  std::vector<std::string> events = client.parse(ep->output());
+  ASSERT_EQ(9, events.size()) << dump(events);
+  EXPECT_EQ("HEADERS 1 :status=200 content-type=text/plain content-length=5",
+            events[2]);
+  EXPECT_EQ("DATA 1 /one\n", events[3]);
+  EXPECT_EQ("PING ACK pingpong", events[4]);
+  EXPECT_EQ("HEADERS 3 :status=200 content-type=text/plain content-length=5",
+            events[5]);
+  EXPECT_EQ("DATA 3 /two\n", events[6]);
+
+  // the handler completes once its body got flushed
+  EXPECT_EQ("DATA 1  END_STREAM", events[7]);
+  EXPECT_EQ("DATA 3  END_STREAM", events[8]);
+}
+
+TEST(http_http2_Connection, flowControl) {
+  MOCK_HTTP2_SERVER(server, connector, executor);
+
+  // the response body must be held back until the window gets opened
+  MockClient client;
+  client.generator()->generateSettings(
+      {{SettingsParameter::InitialWindowSize, 4}});
+  client.get(1, "/hello");
+  client.generator()->generateWindowUpdate(1, 16);
+
+  cortex::RefPtr<LocalEndPoint> ep;
+  executor.execute([&] {
+    ep = connector->createClient(client.wire());
+  });
+
+  std::vector<std::string> events = client.parse(ep->output());
+  ASSERT_EQ(6, events.size()) << dump(events);
+  EXPECT_EQ("DATA 1 /hel", events[3]);
+  EXPECT_EQ("DATA 1 lo\n", events[4]);
+  EXPECT_EQ("DATA 1  END_STREAM", events[5]);
+}
+
+TEST(http_http2_Connection, malformedRequest) {
+  MOCK_HTTP2_SERVER(server, connector, executor);
+
+  MockClient client;
+  client.generator()->generateSettings({});
+  client.request(1, {{":method", "GET"}, {":scheme", "http"}}, true);
+
+  cortex::RefPtr<LocalEndPoint> ep;
+  executor.execute([&] {
+    ep = connector->createClient(client.wire());
+  });
+
+  std::vector<std::string> events = client.parse(ep->output());
+  ASSERT_EQ(3, events.size()) << dump(events);
+  EXPECT_EQ("RST_STREAM 1 PROTOCOL_ERROR", events[2]);
+}
+
+TEST(http_http2_Connection, refusedStream) {
+  MOCK_HTTP2_SERVER(server, connector, executor);
+
+  // streams count against the limit until their response got flushed
+  MockClient client;
+  client.generator()->generateSettings({});
+  for (StreamID sid = 1; sid <= 2 * maxConcurrentStreams + 1; sid += 2)
+    client.request(sid, {{":method", "POST"},
+                         {":scheme", "http"},
+                         {":path", "/"}}, false);
+
+  cortex::RefPtr<LocalEndPoint> ep;
+  executor.execute([&] {
+    ep = connector->createClient(client.wire());
+  });
+
+  std::vector<std::string> events = client.parse(ep->output());
+  EXPECT_EQ(1, std::count(events.begin(), events.end(),
+                          "RST_STREAM 9 REFUSED_STREAM")) << dump(events);
+}
+
+TEST(http_http2_Connection, invalidPreface) {
+  MOCK_HTTP2_SERVER(server, connector, executor);
+
+  cortex::RefPtr<LocalEndPoint> ep;
+  executor.execute([&] {
+    ep = connector->createClient("GET / HTTP/1.1\r\n\r\n");
+  });
+
+  MockClient client;
+  std::vector<std::string> events = client.parse(ep->output());
+  ASSERT_EQ(2, events.size()) << dump(events);
+  EXPECT_EQ("SETTINGS", events[0]);
+  EXPECT_EQ("GOAWAY 0 PROTOCOL_ERROR", events[1]);
+}
@@ -0,0 +1,656 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/Connection.h>
+#include <cortex-http/http2/Stream.h>
+#include <cortex-http/HttpChannel.h>
+#include <cortex-http/HttpRequest.h>
+#include <cortex-http/HeaderFieldList.h>
+#include <cortex-base/net/EndPoint.h>
+#include <cortex-base/executor/Executor.h>
+#include <cortex-base/logging.h>
+#include <cortex-base/RuntimeError.h>
+#include <algorithm>
+#include <cassert>
+#include <string.h>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+#define ERROR(msg...) logError("http.http2.Connection", msg)
+
+#ifndef NDEBUG
+#define TRACE(msg...) logTrace("http.http2.Connection", msg)
+#else
+#define TRACE(msg...) do {} while (0)
+#endif
+
+/** Divided by a stream's weight, this is its stride per frame served. */
+static const uint64_t StrideBase = 1 << 16;
+
+Connection::Connection(EndPoint* endpoint,
+                       Executor* executor,
+                       const HttpHandler& handler,
+                       HttpDateGenerator* dateGenerator,
+                       HttpOutputCompressor* outputCompressor,
+                       size_t maxRequestUriLength,
+                       size_t maxRequestBodyLength,
+                       size_t maxConcurrentStreams,
+                       size_t initialWindowSize)
+    : ::cortex::Connection(endpoint, executor),
+      handler_(handler),
+      dateGenerator_(dateGenerator),
+      outputCompressor_(outputCompressor),
+      maxRequestUriLength_(maxRequestUriLength),
+      maxRequestBodyLength_(maxRequestBodyLength),
+      maxConcurrentStreams_(maxConcurrentStreams),
+      initialWindowSize_(initialWindowSize),
+      remoteInitialWindowSize_(DefaultWindowSize),
+      inputBuffer_(),
+      inputOffset_(0),
+      prefaceReceived_(false),
+      processingInput_(false),
+      parser_(this),
+      writer_(),
+      generator_(&writer_),
+      completions_(),
+      flushing_(false),
+      headerDecoder_(),
+      headerEncoder_(),
+      streams_(),
+      rootStreams_(),
+      rootVirtualTime_(0),
+      lastStreamID_(0),
+      idlePriority_{0, 0, false, 16},
+      sendWindow_(DefaultWindowSize),
+      recvWindow_(DefaultWindowSize),
+      goAwaySent_(false),
+      goAwayReceived_(false) {
+  TRACE("%p ctor", this);
+}
+
+Connection::~Connection() {
+  TRACE("%p dtor", this);
+
+  // pending completions may refer to streams, never invoke them from here.
+  completions_.clear();
+  rootStreams_.clear();
+  streams_.clear();
+}
+
+Stream* Connection::findStream(StreamID sid) const {
+  auto i = streams_.find(sid);
+  if (i != streams_.end())
+    return i->second.get();
+
+  return nullptr;
+}
+
+// {{{ Connection overrides
+void Connection::onOpen() {
+  TRACE("%p onOpen", this);
+  ::cortex::Connection::onOpen();
+
+  // RFC 7540, Section 3.5: the server connection preface consists of a
+  // (potentially empty) SETTINGS frame, sent right away.
+  generator_.generateSettings({
+      {SettingsParameter::MaxConcurrentStreams,
+       static_cast<uint32_t>(maxConcurrentStreams_)},
+      {SettingsParameter::InitialWindowSize,
+       static_cast<uint32_t>(initialWindowSize_)},
+  });
+
+  flushOutput();
+}
+
+void Connection::onClose() {
+  TRACE("%p onClose", this);
+  ::cortex::Connection::onClose();
+}
+
+void Connection::setInputBufferSize(size_t size) {
+  TRACE("%p setInputBufferSize(%zu)", this, size);
+  inputBuffer_.reserve(size);
+}
+
+void Connection::onFillable() {
+  TRACE("%p onFillable", this);
+
+  if (endpoint()->fill(&inputBuffer_) == 0) {
+    TRACE("%p onFillable: fill() returned 0", this);
+    endpoint()->close();
+    return;
+  }
+
+  parseFragment();
+}
+
+void Connection::parseFragment() {
+  processingInput_ = true;
+
+  if (!prefaceReceived_) {
+    const size_t n = std::min(inputBuffer_.size() - inputOffset_,
+                              ConnectionPrefaceSize);
+
+    if (memcmp(inputBuffer_.data() + inputOffset_, ConnectionPreface, n) != 0) {
+      processingInput_ = false;
+      goAway(ErrorCode::ProtocolError, "Invalid connection preface.");
+      return;
+    }
+
+    if (n == ConnectionPrefaceSize) {
+      inputOffset_ += n;
+      prefaceReceived_ = true;
+    }
+  }
+
+  if (prefaceReceived_) {
+    inputOffset_ += parser_.parseFragment(inputBuffer_.ref(inputOffset_));
+  }
+
+  // keep an incomplete trailing frame at the front for the next round
+  if (inputOffset_ == inputBuffer_.size()) {
+    inputBuffer_.clear();
+    inputOffset_ = 0;
+  } else if (inputOffset_ != 0) {
+    const size_t pending = inputBuffer_.size() - inputOffset_;
+    memmove(inputBuffer_.data(), inputBuffer_.data() + inputOffset_, pending);
+    inputBuffer_.resize(pending);
+    inputOffset_ = 0;
+  }
+
+  processingInput_ = false;
+
+  scheduleOutput();
+}
+
+void Connection::onFlushable() {
+  TRACE("%p onFlushable", this);
+  flushOutput();
+}
+
+void Connection::onInterestFailure(const std::exception& error) {
+  TRACE("%p onInterestFailure(%s): %s",
+        this, typeid(error).name(), error.what());
+
+  logError("Connection", error);
+
+  // notify everyone waiting for output that we failed on I/O.
+  auto completions = std::move(completions_);
+  completions_.clear();
+  for (CompletionHandler& completion: completions)
+    completion(false);
+
+  endpoint()->close();
+}
+// }}}
+
+// {{{ FrameListener overrides
+void Connection::onData(StreamID sid, const BufferRef& data, bool last,
+                        size_t flowControlled) {
+  TRACE("%p onData(sid %u, %zu bytes, %s)",
+        this, sid, data.size(), last ? "last" : "not last");
+
+  recvWindow_ -= flowControlled;
+  if (recvWindow_ < 0) {
+    goAway(ErrorCode::FlowControlError,
+           "Connection flow-control window exceeded.");
+    return;
+  }
+
+  Stream* stream = findStream(sid);
+  if (!stream) {
+    if (sid > lastStreamID_) {
+      goAway(ErrorCode::ProtocolError, "DATA frame on idle stream.");
+      return;
+    }
+    // the stream has been closed on our side, that is, frames still
+    // in flight are to be ignored. Only the connection window matters.
+  } else if (stream->isRemoteClosed()) {
+    if (!stream->isReset()) {
+      resetStream(sid, ErrorCode::StreamClosed);
+    }
+  } else {
+    stream->recvWindow_ -= flowControlled;
+    if (stream->recvWindow_ < 0) {
+      resetStream(sid, ErrorCode::FlowControlError);
+    } else {
+      // the body is buffered by the channel, so its window is handed
+      // back as soon as half of it has been used.
+      if (!last && stream->recvWindow_ <= static_cast<int64_t>(initialWindowSize_ / 2)) {
+        generator_.generateWindowUpdate(
+            sid, initialWindowSize_ - stream->recvWindow_);
+        stream->recvWindow_ = initialWindowSize_;
+      }
+
+      stream->onRequestData(data, last);
+    }
+  }
+
+  if (recvWindow_ <= static_cast<int64_t>(DefaultWindowSize / 2)) {
+    generator_.generateWindowUpdate(0, DefaultWindowSize - recvWindow_);
+    recvWindow_ = DefaultWindowSize;
+  }
+}
+
+void Connection::onHeaders(StreamID sid, const BufferRef& headerBlock,
+                           bool last) {
+  TRACE("%p onHeaders(sid %u, %zu bytes, %s)",
+        this, sid, headerBlock.size(), last ? "last" : "not last");
+
+  // header blocks must always be decoded to keep the HPACK state in sync,
+  // even if the stream is going to be refused.
+  HeaderFieldList fields;
+  bool decoded = headerDecoder_.decode(
+      headerBlock,
+      [&](const BufferRef& name, const BufferRef& value, bool sensitive) {
+        fields.push_back(name, value);
+      });
+
+  if (!decoded) {
+    goAway(ErrorCode::CompressionError, "Could not decode header block.");
+    return;
+  }
+
+  if (sid % 2 == 0) {
+    goAway(ErrorCode::ProtocolError, "Invalid stream identifier.");
+    return;
+  }
+
+  if (Stream* stream = findStream(sid)) {
+    // request trailers
+    if (stream->isRemoteClosed()) {
+      if (!stream->isReset())
+        resetStream(sid, ErrorCode::StreamClosed);
+    } else if (!last || !stream->onRequestTrailers(fields)) {
+      resetStream(sid, ErrorCode::ProtocolError);
+    }
+    return;
+  }
+
+  if (sid <= lastStreamID_) {
+    goAway(ErrorCode::ProtocolError, "Stream identifier not increasing.");
+    return;
+  }
+
+  lastStreamID_ = sid;
+
+  if (goAwaySent_) {
+    // RFC 7540, Section 6.8: streams beyond GOAWAY are ignored.
+    return;
+  }
+
+  if (streams_.size() >= maxConcurrentStreams_) {
+    resetStream(sid, ErrorCode::RefusedStream);
+    return;
+  }
+
+  Stream* stream = createStream(sid);
+
+  if (!stream->onRequestHeaders(fields, last)) {
+    TRACE("%p onHeaders: malformed request on stream %u", this, sid);
+    generator_.generateResetStream(sid, ErrorCode::ProtocolError);
+    removeStream(stream);
+  }
+}
+
+void Connection::onPriority(StreamID sid, StreamID dependency,
+                            bool exclusive, unsigned weight) {
+  TRACE("%p onPriority(sid %u, dependency %u, %s, weight %u)",
+        this, sid, dependency, exclusive ? "exclusive" : "shared", weight);
+
+  if (Stream* stream = findStream(sid)) {
+    setPriority(stream, dependency, exclusive, weight);
+  } else if (sid > lastStreamID_) {
+    // HEADERS with priority, or a PRIORITY frame for a stream that is
+    // yet to be opened.
+    idlePriority_ = {sid, dependency, exclusive, weight};
+  }
+}
+
+void Connection::onResetStream(StreamID sid, ErrorCode errorCode) {
+  TRACE("%p onResetStream(sid %u, %s)",
+        this, sid, to_string(errorCode).c_str());
+
+  if (sid > lastStreamID_) {
+    goAway(ErrorCode::ProtocolError, "RST_STREAM frame on idle stream.");
+    return;
+  }
+
+  if (Stream* stream = findStream(sid)) {
+    if (!stream->isReset()) {
+      stream->onReset();
+    }
+  }
+}
+
+void Connection::onSettings(const SettingsList& settings) {
+  for (const auto& setting: settings) {
+    TRACE("%p onSettings: %s = %u",
+          this, to_string(setting.first).c_str(), setting.second);
+
+    switch (setting.first) {
+      case SettingsParameter::HeaderTableSize:
+        headerEncoder_.setMaxTableSize(
+            std::min<size_t>(setting.second, hpack::DefaultMaxTableSize));
+        break;
+      case SettingsParameter::InitialWindowSize: {
+        // RFC 7540, Section 6.9.2: adjust all stream windows by the delta
+        const int64_t delta = static_cast<int64_t>(setting.second) -
+                              static_cast<int64_t>(remoteInitialWindowSize_);
+        remoteInitialWindowSize_ = setting.second;
+
+        for (auto& entry: streams_) {
+          Stream* stream = entry.second.get();
+          stream->sendWindow_ += delta;
+          if (stream->sendWindow_ > MaxWindowSize) {
+            goAway(ErrorCode::FlowControlError,
+                   "Stream flow-control window overflow.");
+            return;
+          }
+        }
+        break;
+      }
+      case SettingsParameter::MaxFrameSize:
+        generator_.setMaxFrameSize(setting.second);
+        break;
+      case SettingsParameter::EnablePush:
+      case SettingsParameter::MaxConcurrentStreams:
+      case SettingsParameter::MaxHeaderListSize:
+      default:
+        // we never push nor open streams, and do not limit what we send.
+        break;
+    }
+  }
+
+  generator_.generateSettingsAck();
+}
+
+void Connection::onSettingsAck() {
+  TRACE("%p onSettingsAck", this);
+}
+
+void Connection::onPushPromise(StreamID sid, StreamID promisedStreamID,
+                               const BufferRef& headerBlock) {
+  goAway(ErrorCode::ProtocolError, "Clients must not push.");
+}
+
+void Connection::onPing(const BufferRef& data) {
+  TRACE("%p onPing", this);
+  generator_.generatePingAck(data);
+}
+
+void Connection::onPingAck(const BufferRef& data) {
+  TRACE("%p onPingAck", this);
+}
+
+void Connection::onGoAway(StreamID lastStreamID, ErrorCode errorCode,
+                          const BufferRef& debugData) {
+  TRACE("%p onGoAway(last sid %u, %s): %s",
+        this, lastStreamID, to_string(errorCode).c_str(),
+        debugData.str().c_str());
+
+  // the client will not open any new streams, so we are done as soon as
+  // all active streams are.
+  goAwayReceived_ = true;
+}
+
+void Connection::onWindowUpdate(StreamID sid, uint32_t increment) {
+  TRACE("%p onWindowUpdate(sid %u, %u)", this, sid, increment);
+
+  if (sid == 0) {
+    sendWindow_ += increment;
+    if (sendWindow_ > MaxWindowSize) {
+      goAway(ErrorCode::FlowControlError,
+             "Connection flow-control window overflow.");
+    }
+    return;
+  }
+
+  if (Stream* stream = findStream(sid)) {
+    stream->sendWindow_ += increment;
+    if (stream->sendWindow_ > MaxWindowSize) {
+      resetStream(sid, ErrorCode::FlowControlError);
+    }
+  } else if (sid > lastStreamID_) {
+    goAway(ErrorCode::ProtocolError, "WINDOW_UPDATE frame on idle stream.");
+  }
+}
+
+void Connection::onConnectionError(ErrorCode errorCode,
+                                   const std::string& message) {
+  TRACE("%p onConnectionError(%s): %s",
+        this, to_string(errorCode).c_str(), message.c_str());
+
+  goAway(errorCode, message);
+}
+
+void Connection::onStreamError(StreamID sid, ErrorCode errorCode,
+                               const std::string& message) {
+  TRACE("%p onStreamError(sid %u, %s): %s",
+        this, sid, to_string(errorCode).c_str(), message.c_str());
+
+  resetStream(sid, errorCode);
+}
+// }}}
+
+// {{{ stream management
+Stream* Connection::createStream(StreamID sid) {
+  Stream* stream = new Stream(sid, this, handler_,
+                              maxRequestUriLength_, maxRequestBodyLength_,
+                              dateGenerator_, outputCompressor_,
+                              remoteInitialWindowSize_, initialWindowSize_);
+  streams_[sid].reset(stream);
+
+  stream->channel()->request()->setRemoteIP(endpoint()->remoteIP());
+
+  rootStreams_.push_back(stream);
+  if (idlePriority_.sid == sid) {
+    setPriority(stream, idlePriority_.dependency, idlePriority_.exclusive,
+                idlePriority_.weight);
+    idlePriority_.sid = 0;
+  } else {
+    setPriority(stream, 0, false, 16);
+  }
+
+  return stream;
+}
+
+void Connection::removeStream(Stream* stream) {
+  TRACE("%p removeStream(sid %u)", this, stream->id());
+
+  // RFC 7540, Section 5.3.4: dependents of a closed stream inherit its
+  // parent, sharing the closed stream's weight proportionally.
+  unsigned total = 0;
+  for (Stream* child: stream->children_)
+    total += child->weight_;
+
+  std::list<Stream*>* siblings = dependentsOf(stream->parent_);
+  for (Stream* child: stream->children_) {
+    child->weight_ = std::max(1u, child->weight_ * stream->weight_ / total);
+    child->parent_ = stream->parent_;
+    siblings->push_back(child);
+  }
+  stream->children_.clear();
+
+  unlinkStream(stream);
+  streams_.erase(stream->id());
+}
+
+std::list<Stream*>* Connection::dependentsOf(Stream* parent) {
+  return parent ? &parent->children_ : &rootStreams_;
+}
+
+void Connection::unlinkStream(Stream* stream) {
+  std::list<Stream*>* siblings = dependentsOf(stream->parent_);
+  siblings->remove(stream);
+  stream->parent_ = nullptr;
+}
+
+void Connection::setPriority(Stream* stream, StreamID dependency,
+                             bool exclusive, unsigned weight) {
+  // RFC 7540, Section 5.3.1: unknown dependencies yield default priority.
+  Stream* parent = dependency != 0 ? findStream(dependency) : nullptr;
+  if (dependency != 0 && parent == nullptr) {
+    exclusive = false;
+    weight = 16;
+  }
+
+  if (parent == stream)
+    return;
+
+  // RFC 7540, Section 5.3.3: when depending on one of its own dependents,
+  // that dependent is moved up to our former parent first.
+  for (Stream* p = parent ? parent->parent_ : nullptr; p; p = p->parent_) {
+    if (p == stream) {
+      unlinkStream(parent);
+      parent->parent_ = stream->parent_;
+      dependentsOf(parent->parent_)->push_back(parent);
+      break;
+    }
+  }
+
+  unlinkStream(stream);
+
+  std::list<Stream*>* siblings = dependentsOf(parent);
+
+  if (exclusive) {
+    for (Stream* child: *siblings) {
+      child->parent_ = stream;
+      stream->children_.push_back(child);
+    }
+    siblings->clear();
+  }
+
+  stream->parent_ = parent;
+  stream->weight_ = weight;
+  siblings->push_back(stream);
+}
+
+void Connection::resetStream(StreamID sid, ErrorCode errorCode) {
+  TRACE("%p resetStream(sid %u, %s)", this, sid, to_string(errorCode).c_str());
+
+  generator_.generateResetStream(sid, errorCode);
+
+  if (Stream* stream = findStream(sid)) {
+    stream->onReset();
+  }
+
+  scheduleOutput();
+}
+
+void Connection::goAway(ErrorCode errorCode, const std::string& message) {
+  if (goAwaySent_)
+    return;
+
+  TRACE("%p goAway(%s): %s", this, to_string(errorCode).c_str(),
+        message.c_str());
+
+  goAwaySent_ = true;
+  generator_.generateGoAway(lastStreamID_, errorCode, BufferRef(message));
+  scheduleOutput();
+}
+// }}}
+
+// {{{ output
+void Connection::scheduleOutput() {
+  if (!goAwaySent_) {
+    // hand out DATA frames one at a time along the dependency tree, until
+    // either windows are exhausted or nobody has anything left to send.
+    while (Stream* stream = selectStream(&rootStreams_, &rootVirtualTime_)) {
+      const size_t limit = std::min<int64_t>(std::max<int64_t>(0, sendWindow_),
+                                             generator_.maxFrameSize());
+      sendWindow_ -= stream->transmit(limit);
+    }
+  }
+
+  if (!processingInput_) {
+    flushOutput();
+  }
+}
+
+bool Connection::isSubtreeReady(Stream* stream) const {
+  if (stream->isReady(sendWindow_ > 0))
+    return true;
+
+  for (Stream* child: stream->children_)
+    if (isSubtreeReady(child))
+      return true;
+
+  return false;
+}
+
+Stream* Connection::selectStream(std::list<Stream*>* candidates,
+                                 uint64_t* virtualTime) {
+  // RFC 7540, Section 5.3.2: siblings share resources proportionally to
+  // their weights, and dependents are only served when their parent
+  // cannot make progress.
+  Stream* best = nullptr;
+  for (Stream* stream: *candidates)
+    if ((best == nullptr || stream->pass_ < best->pass_) &&
+        isSubtreeReady(stream))
+      best = stream;
+
+  if (best == nullptr)
+    return nullptr;
+
+  // a stream becoming ready after being idle starts at the current time
+  // rather than catching up with the credit it did not use.
+  if (best->pass_ < *virtualTime)
+    best->pass_ = *virtualTime;
+
+  *virtualTime = best->pass_;
+  best->pass_ += StrideBase / best->weight_;
+
+  if (best->isReady(sendWindow_ > 0))
+    return best;
+
+  return selectStream(&best->children_, &best->childrenVirtualTime_);
+}
+
+void Connection::complete(CompletionHandler handler) {
+  completions_.emplace_back(std::move(handler));
+}
+
+void Connection::flushOutput() {
+  if (flushing_)
+    return;
+
+  flushing_ = true;
+
+  bool flushed;
+  for (;;) {
+    flushed = writer_.flush(endpoint());
+    if (!flushed || completions_.empty())
+      break;
+
+    // completions may produce more output, which is flushed within the
+    // very same round.
+    auto completions = std::move(completions_);
+    completions_.clear();
+    for (CompletionHandler& completion: completions)
+      completion(true);
+  }
+
+  flushing_ = false;
+
+  if (!flushed) {
+    // Note, the endpoint is only interested in one direction at a time,
+    // so a fill currently pending is flushing the rest upon next input.
+    wantFlush();
+  } else if (goAwaySent_ || (goAwayReceived_ && streams_.empty())) {
+    endpoint()->close();
+  } else {
+    wantFill();
+  }
+}
+// }}}
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
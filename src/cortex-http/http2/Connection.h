@@ -0,0 +1,169 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cortex-http/Api.h>
+#include <cortex-http/HttpHandler.h>
+#include <cortex-http/http2/Frame.h>
+#include <cortex-http/http2/FrameListener.h>
+#include <cortex-http/http2/FrameParser.h>
+#include <cortex-http/http2/FrameGenerator.h>
+#include <cortex-http/http2/hpack.h>
+#include <cortex-base/Buffer.h>
+#include <cortex-base/CompletionHandler.h>
+#include <cortex-base/net/Connection.h>
+#include <cortex-base/net/EndPointWriter.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace cortex {
+namespace http {
+
+class HttpDateGenerator;
+class HttpOutputCompressor;
+
+namespace http2 {
+
+class Stream;
+
+/**
+ * Implements a HTTP/2 (RFC 7540) server-side transport connection.
+ *
+ * Multiplexes concurrent streams, each one carrying its own HttpChannel,
+ * enforces connection and stream level flow control in both directions
+ * and interleaves outgoing DATA frames along the stream dependency tree
+ * using weighted stride scheduling.
+ *
+ * The connection expects the client connection preface right away, that
+ * is, either after ALPN negotiated @c "h2" or, for plaintext @c "h2c",
+ * with prior knowledge.
+ */
+class CORTEX_HTTP_API Connection : public ::cortex::Connection,
+                                   public FrameListener {
+ public:
+  Connection(EndPoint* endpoint,
+             Executor* executor,
+             const HttpHandler& handler,
+             HttpDateGenerator* dateGenerator,
+             HttpOutputCompressor* outputCompressor,
+             size_t maxRequestUriLength,
+             size_t maxRequestBodyLength,
+             size_t maxConcurrentStreams,
+             size_t initialWindowSize);
+  ~Connection();
+
+  size_t bytesReceived() const noexcept { return parser_.bytesReceived(); }
+  size_t bytesTransmitted() const noexcept { return generator_.bytesTransmitted(); }
+
+  /** Number of streams not yet fully closed. */
+  size_t streamCount() const noexcept { return streams_.size(); }
+
+  Stream* findStream(StreamID sid) const;
+
+ private:
+  friend class Stream;
+
+  // Connection overrides
+  void onOpen() override;
+  void onClose() override;
+  void setInputBufferSize(size_t size) override;
+  void onFillable() override;
+  void onFlushable() override;
+  void onInterestFailure(const std::exception& error) override;
+
+  // FrameListener overrides
+  void onData(StreamID sid, const BufferRef& data, bool last,
+              size_t flowControlled) override;
+  void onHeaders(StreamID sid, const BufferRef& headerBlock,
+                 bool last) override;
+  void onPriority(StreamID sid, StreamID dependency, bool exclusive,
+                  unsigned weight) override;
+  void onResetStream(StreamID sid, ErrorCode errorCode) override;
+  void onSettings(const SettingsList& settings) override;
+  void onSettingsAck() override;
+  void onPushPromise(StreamID sid, StreamID promisedStreamID,
+                     const BufferRef& headerBlock) override;
+  void onPing(const BufferRef& data) override;
+  void onPingAck(const BufferRef& data) override;
+  void onGoAway(StreamID lastStreamID, ErrorCode errorCode,
+                const BufferRef& debugData) override;
+  void onWindowUpdate(StreamID sid, uint32_t increment) override;
+  void onConnectionError(ErrorCode errorCode,
+                         const std::string& message) override;
+  void onStreamError(StreamID sid, ErrorCode errorCode,
+                     const std::string& message) override;
+
+  void parseFragment();
+
+  // stream management
+  Stream* createStream(StreamID sid);
+  void removeStream(Stream* stream);
+  void setPriority(Stream* stream, StreamID dependency, bool exclusive,
+                   unsigned weight);
+  void unlinkStream(Stream* stream);
+  std::list<Stream*>* dependentsOf(Stream* parent);
+  void resetStream(StreamID sid, ErrorCode errorCode);
+  void goAway(ErrorCode errorCode, const std::string& message);
+
+  // output
+  void scheduleOutput();
+  bool isSubtreeReady(Stream* stream) const;
+  Stream* selectStream(std::list<Stream*>* candidates, uint64_t* virtualTime);
+  void complete(CompletionHandler handler);
+  void flushOutput();
+
+ private:
+  HttpHandler handler_;
+  HttpDateGenerator* dateGenerator_;
+  HttpOutputCompressor* outputCompressor_;
+  size_t maxRequestUriLength_;
+  size_t maxRequestBodyLength_;
+  size_t maxConcurrentStreams_;
+  size_t initialWindowSize_;        //!< our SETTINGS_INITIAL_WINDOW_SIZE
+  size_t remoteInitialWindowSize_;  //!< peer's SETTINGS_INITIAL_WINDOW_SIZE
+
+  Buffer inputBuffer_;
+  size_t inputOffset_;
+  bool prefaceReceived_;
+  bool processingInput_;
+  FrameParser parser_;
+
+  EndPointWriter writer_;
+  FrameGenerator generator_;
+  std::vector<CompletionHandler> completions_;
+  bool flushing_;
+
+  hpack::Decoder headerDecoder_;
+  hpack::Encoder headerEncoder_;
+
+  std::unordered_map<StreamID, std::unique_ptr<Stream>> streams_;
+  std::list<Stream*> rootStreams_;
+  uint64_t rootVirtualTime_;
+  StreamID lastStreamID_;
+
+  // PRIORITY received for a stream that is yet idle
+  struct {
+    StreamID sid;
+    StreamID dependency;
+    bool exclusive;
+    unsigned weight;
+  } idlePriority_;
+
+  // connection level flow control
+  int64_t sendWindow_;
+  int64_t recvWindow_;
+
+  bool goAwaySent_;
+  bool goAwayReceived_;
+};
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
@@ -0,0 +1,58 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/ConnectionFactory.h>
+#include <cortex-http/http2/Connection.h>
+#include <cortex-http/http2/Frame.h>
+#include <cortex-base/net/Connector.h>
+#include <cortex-base/WallClock.h>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+ConnectionFactory::ConnectionFactory()
+    : ConnectionFactory(WallClock::system(),
+                        4096,
+                        4 * 1024 * 1024,
+                        100,
+                        DefaultWindowSize) {
+}
+
+ConnectionFactory::ConnectionFactory(
+    WallClock* clock,
+    size_t maxRequestUriLength,
+    size_t maxRequestBodyLength,
+    size_t maxConcurrentStreams,
+    size_t initialWindowSize)
+    : HttpConnectionFactory("h2", clock, maxRequestUriLength,
+                            maxRequestBodyLength),
+      maxConcurrentStreams_(maxConcurrentStreams),
+      initialWindowSize_(initialWindowSize) {
+  setInputBufferSize(16 * 1024);
+}
+
+ConnectionFactory::~ConnectionFactory() {
+}
+
+::cortex::Connection* ConnectionFactory::create(Connector* connector,
+                                                EndPoint* endpoint) {
+  return configure(new http2::Connection(endpoint,
+                                         connector->executor(),
+                                         handler(),
+                                         dateGenerator(),
+                                         outputCompressor(),
+                                         maxRequestUriLength(),
+                                         maxRequestBodyLength(),
+                                         maxConcurrentStreams(),
+                                         initialWindowSize()),
+                   connector);
+}
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
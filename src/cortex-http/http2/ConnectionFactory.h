@@ -0,0 +1,53 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cortex-http/Api.h>
+#include <cortex-base/sysconfig.h>
+#include <cortex-http/HttpConnectionFactory.h>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+/**
+ * Connection factory for HTTP/2 connections.
+ *
+ * Registered under the protocol name @c "h2", it is picked by ALPN on TLS
+ * connectors. For plaintext connections (h2c) make it the connector's
+ * default factory, so that clients with prior knowledge get served.
+ */
+class CORTEX_HTTP_API ConnectionFactory : public HttpConnectionFactory {
+ public:
+  ConnectionFactory();
+
+  ConnectionFactory(
+      WallClock* clock,
+      size_t maxRequestUriLength,
+      size_t maxRequestBodyLength,
+      size_t maxConcurrentStreams,
+      size_t initialWindowSize);
+
+  ~ConnectionFactory();
+
+  size_t maxConcurrentStreams() const CORTEX_NOEXCEPT { return maxConcurrentStreams_; }
+  void setMaxConcurrentStreams(size_t value) { maxConcurrentStreams_ = value; }
+
+  size_t initialWindowSize() const CORTEX_NOEXCEPT { return initialWindowSize_; }
+  void setInitialWindowSize(size_t value) { initialWindowSize_ = value; }
+
+  ::cortex::Connection* create(Connector* connector, EndPoint* endpoint) override;
+
+ private:
+  size_t maxConcurrentStreams_;
+  size_t initialWindowSize_;
+};
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
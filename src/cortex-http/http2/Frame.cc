@@ -0,0 +1,84 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/Frame.h>
+#include <stdio.h>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+std::string to_string(FrameType type) {
+  switch (type) {
+    case FrameType::Data: return "DATA";
+    case FrameType::Headers: return "HEADERS";
+    case FrameType::Priority: return "PRIORITY";
+    case FrameType::ResetStream: return "RST_STREAM";
+    case FrameType::Settings: return "SETTINGS";
+    case FrameType::PushPromise: return "PUSH_PROMISE";
+    case FrameType::Ping: return "PING";
+    case FrameType::GoAway: return "GOAWAY";
+    case FrameType::WindowUpdate: return "WINDOW_UPDATE";
+    case FrameType::Continuation: return "CONTINUATION";
+    default: {
+      char buf[16];
+      int n = snprintf(buf, sizeof(buf), "<%u>", static_cast<unsigned>(type));
+      return std::string(buf, n);
+    }
+  }
+}
+
+std::string to_string(ErrorCode ec) {
+  switch (ec) {
+    case ErrorCode::NoError: return "NO_ERROR";
+    case ErrorCode::ProtocolError: return "PROTOCOL_ERROR";
+    case ErrorCode::InternalError: return "INTERNAL_ERROR";
+    case ErrorCode::FlowControlError: return "FLOW_CONTROL_ERROR";
+    case ErrorCode::SettingsTimeout: return "SETTINGS_TIMEOUT";
+    case ErrorCode::StreamClosed: return "STREAM_CLOSED";
+    case ErrorCode::FrameSizeError: return "FRAME_SIZE_ERROR";
+    case ErrorCode::RefusedStream: return "REFUSED_STREAM";
+    case ErrorCode::Cancel: return "CANCEL";
+    case ErrorCode::CompressionError: return "COMPRESSION_ERROR";
+    case ErrorCode::ConnectError: return "CONNECT_ERROR";
+    case ErrorCode::EnhanceYourCalm: return "ENHANCE_YOUR_CALM";
+    case ErrorCode::InadequateSecurity: return "INADEQUATE_SECURITY";
+    case ErrorCode::Http11Required: return "HTTP_1_1_REQUIRED";
+    default: {
+      char buf[16];
+      int n = snprintf(buf, sizeof(buf), "<%u>", static_cast<unsigned>(ec));
+      return std::string(buf, n);
+    }
+  }
+}
+
+std::string to_string(SettingsParameter parameter) {
+  switch (parameter) {
+    case SettingsParameter::HeaderTableSize:
+      return "SETTINGS_HEADER_TABLE_SIZE";
+    case SettingsParameter::EnablePush:
+      return "SETTINGS_ENABLE_PUSH";
+    case SettingsParameter::MaxConcurrentStreams:
+      return "SETTINGS_MAX_CONCURRENT_STREAMS";
+    case SettingsParameter::InitialWindowSize:
+      return "SETTINGS_INITIAL_WINDOW_SIZE";
+    case SettingsParameter::MaxFrameSize:
+      return "SETTINGS_MAX_FRAME_SIZE";
+    case SettingsParameter::MaxHeaderListSize:
+      return "SETTINGS_MAX_HEADER_LIST_SIZE";
+    default: {
+      char buf[16];
+      int n = snprintf(buf, sizeof(buf), "<%u>",
+                       static_cast<unsigned>(parameter));
+      return std::string(buf, n);
+    }
+  }
+}
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
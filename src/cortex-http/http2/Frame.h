@@ -0,0 +1,92 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cortex-http/Api.h>
+#include <string>
+#include <stdint.h>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+typedef uint32_t StreamID;
+
+/** Size of the fixed frame header (RFC 7540, Section 4.1). */
+constexpr size_t FrameHeaderSize = 9;
+
+/** Initial and minimum value of @c SETTINGS_MAX_FRAME_SIZE. */
+constexpr size_t DefaultMaxFrameSize = 16384;
+
+/** Upper bound of @c SETTINGS_MAX_FRAME_SIZE. */
+constexpr size_t MaxFrameSizeLimit = 16777215;
+
+/** Initial flow-control window size of connections and streams. */
+constexpr size_t DefaultWindowSize = 65535;
+
+/** Maximum flow-control window size. */
+constexpr size_t MaxWindowSize = 0x7fffffff;
+
+/** The client connection preface (RFC 7540, Section 3.5). */
+constexpr char ConnectionPreface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+constexpr size_t ConnectionPrefaceSize = sizeof(ConnectionPreface) - 1;
+
+enum class FrameType : uint8_t {
+  Data = 0,
+  Headers = 1,
+  Priority = 2,
+  ResetStream = 3,
+  Settings = 4,
+  PushPromise = 5,
+  Ping = 6,
+  GoAway = 7,
+  WindowUpdate = 8,
+  Continuation = 9,
+};
+
+namespace FrameFlags {
+  constexpr uint8_t EndStream = 0x01;
+  constexpr uint8_t Ack = 0x01;
+  constexpr uint8_t EndHeaders = 0x04;
+  constexpr uint8_t Padded = 0x08;
+  constexpr uint8_t Priority = 0x20;
+}
+
+enum class ErrorCode : uint32_t {
+  NoError = 0,
+  ProtocolError = 1,
+  InternalError = 2,
+  FlowControlError = 3,
+  SettingsTimeout = 4,
+  StreamClosed = 5,
+  FrameSizeError = 6,
+  RefusedStream = 7,
+  Cancel = 8,
+  CompressionError = 9,
+  ConnectError = 10,
+  EnhanceYourCalm = 11,
+  InadequateSecurity = 12,
+  Http11Required = 13,
+};
+
+enum class SettingsParameter : uint16_t {
+  HeaderTableSize = 1,
+  EnablePush = 2,
+  MaxConcurrentStreams = 3,
+  InitialWindowSize = 4,
+  MaxFrameSize = 5,
+  MaxHeaderListSize = 6,
+};
+
+CORTEX_HTTP_API std::string to_string(FrameType type);
+CORTEX_HTTP_API std::string to_string(ErrorCode ec);
+CORTEX_HTTP_API std::string to_string(SettingsParameter parameter);
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
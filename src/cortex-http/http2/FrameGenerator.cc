@@ -0,0 +1,227 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/FrameGenerator.h>
+#include <cortex-base/net/EndPointWriter.h>
+#include <algorithm>
+#include <assert.h>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+FrameGenerator::FrameGenerator(EndPointWriter* writer, size_t maxFrameSize)
+    : writer_(writer),
+      maxFrameSize_(maxFrameSize),
+      bytesTransmitted_(0),
+      buffer_() {
+}
+
+void FrameGenerator::generateClientPreface() {
+  buffer_.push_back(ConnectionPreface, ConnectionPrefaceSize);
+  flushBuffer();
+}
+
+void FrameGenerator::generateData(StreamID sid, const BufferRef& data,
+                                  bool last) {
+  assert(sid != 0);
+
+  size_t offset = 0;
+  do {
+    const size_t n = std::min(data.size() - offset, maxFrameSize_);
+    const bool end = offset + n == data.size();
+
+    generateFrameHeader(FrameType::Data,
+                        last && end ? FrameFlags::EndStream : 0, sid, n);
+    flushBuffer();
+
+    if (n != 0) {
+      writer_->write(data.ref(offset, n));
+      bytesTransmitted_ += n;
+    }
+
+    offset += n;
+  } while (offset != data.size());
+}
+
+void FrameGenerator::generateData(StreamID sid, Buffer&& data, bool last) {
+  assert(sid != 0);
+
+  if (data.size() > maxFrameSize_) {
+    // the writer must own the data, but splitting is rare enough
+    // for one more copy not to hurt.
+    size_t offset = 0;
+    do {
+      const size_t n = std::min(data.size() - offset, maxFrameSize_);
+      const bool end = offset + n == data.size();
+
+      generateFrameHeader(FrameType::Data,
+                          last && end ? FrameFlags::EndStream : 0, sid, n);
+      buffer_.push_back(data.ref(offset, n));
+      flushBuffer();
+
+      offset += n;
+    } while (offset != data.size());
+    return;
+  }
+
+  generateFrameHeader(FrameType::Data, last ? FrameFlags::EndStream : 0, sid,
+                      data.size());
+  buffer_.push_back(data);
+  flushBuffer();
+}
+
+void FrameGenerator::generateData(StreamID sid, FileRef&& data, bool last) {
+  assert(sid != 0);
+
+  while (data.size() > maxFrameSize_) {
+    generateFrameHeader(FrameType::Data, 0, sid, maxFrameSize_);
+    flushBuffer();
+
+    // only the last slice owns the file descriptor, so that it gets
+    // closed after everything has been written.
+    writer_->write(FileRef(data.handle(), data.offset(), maxFrameSize_, false));
+    bytesTransmitted_ += maxFrameSize_;
+
+    data.setOffset(data.offset() + maxFrameSize_);
+    data.setSize(data.size() - maxFrameSize_);
+  }
+
+  const size_t n = data.size();
+  generateFrameHeader(FrameType::Data, last ? FrameFlags::EndStream : 0, sid, n);
+  flushBuffer();
+
+  writer_->write(std::move(data));
+  bytesTransmitted_ += n;
+}
+
+void FrameGenerator::generateHeaders(StreamID sid,
+                                     const BufferRef& headerBlock,
+                                     bool last) {
+  assert(sid != 0);
+
+  const size_t n = std::min(headerBlock.size(), maxFrameSize_);
+  uint8_t flags = last ? FrameFlags::EndStream : 0;
+  if (n == headerBlock.size())
+    flags |= FrameFlags::EndHeaders;
+
+  generateFrameHeader(FrameType::Headers, flags, sid, n);
+  buffer_.push_back(headerBlock.ref(0, n));
+
+  for (size_t offset = n; offset != headerBlock.size();) {
+    const size_t m = std::min(headerBlock.size() - offset, maxFrameSize_);
+    const bool end = offset + m == headerBlock.size();
+
+    generateFrameHeader(FrameType::Continuation,
+                        end ? FrameFlags::EndHeaders : 0, sid, m);
+    buffer_.push_back(headerBlock.ref(offset, m));
+
+    offset += m;
+  }
+
+  flushBuffer();
+}
+
+void FrameGenerator::generatePriority(StreamID sid, StreamID dependency,
+                                      bool exclusive, unsigned weight) {
+  assert(weight >= 1 && weight <= 256);
+
+  generateFrameHeader(FrameType::Priority, 0, sid, 5);
+  write32((dependency & 0x7fffffff) | (exclusive ? 0x80000000 : 0));
+  buffer_.push_back(static_cast<char>(weight - 1));
+  flushBuffer();
+}
+
+void FrameGenerator::generateResetStream(StreamID sid, ErrorCode errorCode) {
+  generateFrameHeader(FrameType::ResetStream, 0, sid, 4);
+  write32(static_cast<uint32_t>(errorCode));
+  flushBuffer();
+}
+
+void FrameGenerator::generateSettings(const SettingsList& settings) {
+  generateFrameHeader(FrameType::Settings, 0, 0, settings.size() * 6);
+
+  for (const auto& setting: settings) {
+    write16(static_cast<uint16_t>(setting.first));
+    write32(setting.second);
+  }
+
+  flushBuffer();
+}
+
+void FrameGenerator::generateSettingsAck() {
+  generateFrameHeader(FrameType::Settings, FrameFlags::Ack, 0, 0);
+  flushBuffer();
+}
+
+void FrameGenerator::generatePing(const BufferRef& payload) {
+  assert(payload.size() == 8);
+
+  generateFrameHeader(FrameType::Ping, 0, 0, 8);
+  buffer_.push_back(payload);
+  flushBuffer();
+}
+
+void FrameGenerator::generatePingAck(const BufferRef& payload) {
+  assert(payload.size() == 8);
+
+  generateFrameHeader(FrameType::Ping, FrameFlags::Ack, 0, 8);
+  buffer_.push_back(payload);
+  flushBuffer();
+}
+
+void FrameGenerator::generateGoAway(StreamID lastStreamID,
+                                    ErrorCode errorCode,
+                                    const BufferRef& debugData) {
+  generateFrameHeader(FrameType::GoAway, 0, 0, 8 + debugData.size());
+  write32(lastStreamID & 0x7fffffff);
+  write32(static_cast<uint32_t>(errorCode));
+  buffer_.push_back(debugData);
+  flushBuffer();
+}
+
+void FrameGenerator::generateWindowUpdate(StreamID sid, size_t increment) {
+  assert(increment > 0 && increment <= MaxWindowSize);
+
+  generateFrameHeader(FrameType::WindowUpdate, 0, sid, 4);
+  write32(static_cast<uint32_t>(increment));
+  flushBuffer();
+}
+
+void FrameGenerator::generateFrameHeader(FrameType type, uint8_t flags,
+                                         StreamID sid, size_t length) {
+  buffer_.push_back(static_cast<char>((length >> 16) & 0xFF));
+  buffer_.push_back(static_cast<char>((length >> 8) & 0xFF));
+  buffer_.push_back(static_cast<char>(length & 0xFF));
+  buffer_.push_back(static_cast<char>(type));
+  buffer_.push_back(static_cast<char>(flags));
+  write32(sid & 0x7fffffff);
+}
+
+void FrameGenerator::write16(uint16_t value) {
+  buffer_.push_back(static_cast<char>((value >> 8) & 0xFF));
+  buffer_.push_back(static_cast<char>(value & 0xFF));
+}
+
+void FrameGenerator::write32(uint32_t value) {
+  buffer_.push_back(static_cast<char>((value >> 24) & 0xFF));
+  buffer_.push_back(static_cast<char>((value >> 16) & 0xFF));
+  buffer_.push_back(static_cast<char>((value >> 8) & 0xFF));
+  buffer_.push_back(static_cast<char>(value & 0xFF));
+}
+
+void FrameGenerator::flushBuffer() {
+  if (!buffer_.empty()) {
+    bytesTransmitted_ += buffer_.size();
+    writer_->write(std::move(buffer_));
+    buffer_.clear();
+  }
+}
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
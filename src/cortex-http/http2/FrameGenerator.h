@@ -0,0 +1,85 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cortex-http/Api.h>
+#include <cortex-http/http2/Frame.h>
+#include <cortex-http/http2/FrameListener.h>
+#include <cortex-base/io/FileRef.h>
+#include <cortex-base/Buffer.h>
+
+namespace cortex {
+
+class EndPointWriter;
+
+namespace http {
+namespace http2 {
+
+/**
+ * HTTP/2 frame generator.
+ *
+ * Serializes frames into an EndPointWriter. Frames whose payload exceeds
+ * the peer's maximum frame size are split, that is, DATA into multiple DATA
+ * frames and header blocks into HEADERS followed by CONTINUATION frames.
+ *
+ * Flow control is not a concern of the generator.
+ */
+class CORTEX_HTTP_API FrameGenerator {
+ public:
+  explicit FrameGenerator(EndPointWriter* writer,
+                          size_t maxFrameSize = DefaultMaxFrameSize);
+
+  /** The peer's @c SETTINGS_MAX_FRAME_SIZE. */
+  size_t maxFrameSize() const noexcept { return maxFrameSize_; }
+  void setMaxFrameSize(size_t value) { maxFrameSize_ = value; }
+
+  /** Number of bytes passed to the writer so far. */
+  size_t bytesTransmitted() const noexcept { return bytesTransmitted_; }
+
+  /** Generates the client connection preface, not including SETTINGS. */
+  void generateClientPreface();
+
+  void generateData(StreamID sid, const BufferRef& data, bool last);
+  void generateData(StreamID sid, Buffer&& data, bool last);
+  void generateData(StreamID sid, FileRef&& data, bool last);
+
+  void generateHeaders(StreamID sid, const BufferRef& headerBlock, bool last);
+
+  void generatePriority(StreamID sid, StreamID dependency, bool exclusive,
+                        unsigned weight);
+
+  void generateResetStream(StreamID sid, ErrorCode errorCode);
+
+  void generateSettings(const SettingsList& settings);
+  void generateSettingsAck();
+
+  void generatePing(const BufferRef& payload);
+  void generatePingAck(const BufferRef& payload);
+
+  void generateGoAway(StreamID lastStreamID, ErrorCode errorCode,
+                      const BufferRef& debugData = BufferRef());
+
+  void generateWindowUpdate(StreamID sid, size_t increment);
+
+ private:
+  void generateFrameHeader(FrameType type, uint8_t flags, StreamID sid,
+                           size_t length);
+  void write16(uint16_t value);
+  void write32(uint32_t value);
+  void flushBuffer();
+
+ private:
+  EndPointWriter* writer_;
+  size_t maxFrameSize_;
+  size_t bytesTransmitted_;
+  Buffer buffer_;
+};
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
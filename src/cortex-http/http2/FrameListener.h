@@ -0,0 +1,111 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cortex-http/Api.h>
+#include <cortex-http/http2/Frame.h>
+#include <cortex-base/Buffer.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+typedef std::vector<std::pair<SettingsParameter, uint32_t>> SettingsList;
+
+/**
+ * HTTP/2 frame observer.
+ *
+ * The interface methods get invoked by the FrameParser for every
+ * frame that has been fully parsed and validated.
+ *
+ * @see FrameParser
+ */
+class CORTEX_HTTP_API FrameListener {
+ public:
+  virtual ~FrameListener() {}
+
+  /**
+   * DATA frame, with padding already stripped off.
+   *
+   * @param sid stream identifier.
+   * @param data the frame's payload.
+   * @param last whether or not END_STREAM was set.
+   * @param flowControlled number of octets that count against the
+   *                       flow-control windows, including padding.
+   */
+  virtual void onData(StreamID sid, const BufferRef& data, bool last,
+                      size_t flowControlled) = 0;
+
+  /**
+   * A complete header block, reassembled from a HEADERS frame and all its
+   * CONTINUATION frames.
+   *
+   * @param sid stream identifier.
+   * @param headerBlock the HPACK-encoded header block.
+   * @param last whether or not END_STREAM was set.
+   */
+  virtual void onHeaders(StreamID sid, const BufferRef& headerBlock,
+                         bool last) = 0;
+
+  /**
+   * Stream priority, either from a PRIORITY frame or a HEADERS frame
+   * with the PRIORITY flag set (then invoked right before onHeaders()).
+   *
+   * @param sid stream identifier.
+   * @param dependency stream identifier of the stream this one depends on.
+   * @param exclusive whether or not the dependency is exclusive.
+   * @param weight stream weight, between 1 and 256.
+   */
+  virtual void onPriority(StreamID sid, StreamID dependency, bool exclusive,
+                          unsigned weight) = 0;
+
+  virtual void onResetStream(StreamID sid, ErrorCode errorCode) = 0;
+
+  virtual void onSettings(const SettingsList& settings) = 0;
+
+  virtual void onSettingsAck() = 0;
+
+  virtual void onPushPromise(StreamID sid, StreamID promisedStreamID,
+                             const BufferRef& headerBlock) = 0;
+
+  virtual void onPing(const BufferRef& data) = 0;
+
+  virtual void onPingAck(const BufferRef& data) = 0;
+
+  virtual void onGoAway(StreamID lastStreamID, ErrorCode errorCode,
+                        const BufferRef& debugData) = 0;
+
+  /**
+   * WINDOW_UPDATE frame.
+   *
+   * @param sid stream identifier, or 0 for the connection window.
+   * @param increment window size increment, never 0.
+   */
+  virtual void onWindowUpdate(StreamID sid, uint32_t increment) = 0;
+
+  /**
+   * A connection error has been detected. The parser will not process
+   * any further input.
+   */
+  virtual void onConnectionError(ErrorCode errorCode,
+                                 const std::string& message) = 0;
+
+  /**
+   * A stream error has been detected. The frame causing it has been
+   * skipped and parsing continues.
+   */
+  virtual void onStreamError(StreamID sid, ErrorCode errorCode,
+                             const std::string& message) = 0;
+};
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
@@ -0,0 +1,262 @@
+// This file is part of the "x0" project, http://cortex.io/
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/FrameParser.h>
+#include <cortex-http/http2/FrameGenerator.h>
+#include <cortex-http/http2/FrameListener.h>
+#include <cortex-base/net/EndPointWriter.h>
+#include <cortex-base/net/ByteArrayEndPoint.h>
+#include <cortex-base/Buffer.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace cortex;
+using namespace cortex::http;
+using namespace cortex::http::http2;
+
+/**
+ * Records every frame event as a human readable line.
+ */
+class FrameRecorder : public FrameListener { // {{{
+ public:
+  std::vector<std::string> events;
+
+  void onData(StreamID sid, const BufferRef& data, bool last,
+              size_t flowControlled) override {
+    record("DATA %u %s%s (%zu)", sid, data.str().c_str(),
+           last ? " END_STREAM" : "", flowControlled);
+  }
+
+  void onHeaders(StreamID sid, const BufferRef& headerBlock,
+                 bool last) override {
+    record("HEADERS %u %zu%s", sid, headerBlock.size(),
+           last ? " END_STREAM" : "");
+  }
+
+  void onPriority(StreamID sid, StreamID dependency, bool exclusive,
+                  unsigned weight) override {
+    record("PRIORITY %u %u%s %u", sid, dependency,
+           exclusive ? " exclusive" : "", weight);
+  }
+
+  void onResetStream(StreamID sid, ErrorCode errorCode) override {
+    record("RST_STREAM %u %s", sid, to_string(errorCode).c_str());
+  }
+
+  void onSettings(const SettingsList& settings) override {
+    std::string s = "SETTINGS";
+    for (const auto& setting: settings)
+      s += " " + to_string(setting.first) + "=" + std::to_string(setting.second);
+    events.push_back(s);
+  }
+
+  void onSettingsAck() override {
+    record("SETTINGS ACK");
+  }
+
+  void onPushPromise(StreamID sid, StreamID promisedStreamID,
+                     const BufferRef& headerBlock) override {
+    record("PUSH_PROMISE %u %u %zu", sid, promisedStreamID,
+           headerBlock.size());
+  }
+
+  void onPing(const BufferRef& data) override {
+    record("PING %s", data.str().c_str());
+  }
+
+  void onPingAck(const BufferRef& data) override {
+    record("PING ACK %s", data.str().c_str());
+  }
+
+  void onGoAway(StreamID lastStreamID, ErrorCode errorCode,
+                const BufferRef& debugData) override {
+    record("GOAWAY %u %s %s", lastStreamID, to_string(errorCode).c_str(),
+           debugData.str().c_str());
+  }
+
+  void onWindowUpdate(StreamID sid, uint32_t increment) override {
+    record("WINDOW_UPDATE %u %u", sid, increment);
+  }
+
+  void onConnectionError(ErrorCode errorCode,
+                         const std::string& message) override {
+    record("connection error %s", to_string(errorCode).c_str());
+  }
+
+  void onStreamError(StreamID sid, ErrorCode errorCode,
+                     const std::string& message) override {
+    record("stream error %u %s", sid, to_string(errorCode).c_str());
+  }
+
+ private:
+  template<typename... Args>
+  void record(const char* fmt, Args... args) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), fmt, args...);
+    events.push_back(buf);
+  }
+};
+// }}}
+
+static Buffer serialize(const std::function<void(FrameGenerator&)>& gen,
+                        size_t maxFrameSize = DefaultMaxFrameSize) {
+  EndPointWriter writer;
+  FrameGenerator generator(&writer, maxFrameSize);
+  gen(generator);
+
+  ByteArrayEndPoint ep(nullptr);
+  writer.flush(&ep);
+  return ep.output();
+}
+
+TEST(http_http2_FrameParser, settings) {
+  Buffer wire = serialize([](FrameGenerator& g) {
+    g.generateSettings({{SettingsParameter::InitialWindowSize, 1024},
+                        {SettingsParameter::MaxConcurrentStreams, 7}});
+    g.generateSettingsAck();
+  });
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder);
+  ASSERT_EQ(wire.size(), parser.parseFragment(wire.ref()));
+
+  ASSERT_EQ(2, recorder.events.size());
+  EXPECT_EQ("SETTINGS SETTINGS_INITIAL_WINDOW_SIZE=1024 "
+            "SETTINGS_MAX_CONCURRENT_STREAMS=7", recorder.events[0]);
+  EXPECT_EQ("SETTINGS ACK", recorder.events[1]);
+}
+
+TEST(http_http2_FrameParser, dataSplitByMaxFrameSize) {
+  Buffer wire = serialize([](FrameGenerator& g) {
+    g.generateData(1, BufferRef("Hello, World"), true);
+  }, 5);
+
+  ASSERT_EQ(3 * FrameHeaderSize + 12, wire.size());
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder);
+  ASSERT_EQ(wire.size(), parser.parseFragment(wire.ref()));
+
+  ASSERT_EQ(3, recorder.events.size());
+  EXPECT_EQ("DATA 1 Hello (5)", recorder.events[0]);
+  EXPECT_EQ("DATA 1 , Wor (5)", recorder.events[1]);
+  EXPECT_EQ("DATA 1 ld END_STREAM (2)", recorder.events[2]);
+}
+
+TEST(http_http2_FrameParser, headersWithContinuation) {
+  Buffer block("0123456789abcdefghij");
+  Buffer wire = serialize([&](FrameGenerator& g) {
+    g.generateHeaders(3, block, true);
+  }, 8);
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder);
+  ASSERT_EQ(wire.size(), parser.parseFragment(wire.ref()));
+
+  ASSERT_EQ(1, recorder.events.size());
+  EXPECT_EQ("HEADERS 3 20 END_STREAM", recorder.events[0]);
+}
+
+TEST(http_http2_FrameParser, controlFrames) {
+  Buffer wire = serialize([](FrameGenerator& g) {
+    g.generatePing(BufferRef("12345678"));
+    g.generatePingAck(BufferRef("abcdefgh"));
+    g.generatePriority(5, 3, true, 256);
+    g.generateWindowUpdate(0, 4096);
+    g.generateResetStream(5, ErrorCode::Cancel);
+    g.generateGoAway(5, ErrorCode::NoError, BufferRef("bye"));
+  });
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder);
+  ASSERT_EQ(wire.size(), parser.parseFragment(wire.ref()));
+
+  ASSERT_EQ(6, recorder.events.size());
+  EXPECT_EQ("PING 12345678", recorder.events[0]);
+  EXPECT_EQ("PING ACK abcdefgh", recorder.events[1]);
+  EXPECT_EQ("PRIORITY 5 3 exclusive 256", recorder.events[2]);
+  EXPECT_EQ("WINDOW_UPDATE 0 4096", recorder.events[3]);
+  EXPECT_EQ("RST_STREAM 5 CANCEL", recorder.events[4]);
+  EXPECT_EQ("GOAWAY 5 NO_ERROR bye", recorder.events[5]);
+}
+
+TEST(http_http2_FrameParser, partialFrame) {
+  Buffer wire = serialize([](FrameGenerator& g) {
+    g.generatePing(BufferRef("12345678"));
+    g.generateData(1, BufferRef("body"), false);
+  });
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder);
+
+  // only whole frames are consumed
+  const size_t pingSize = FrameHeaderSize + 8;
+  ASSERT_EQ(pingSize, parser.parseFragment(wire.ref(0, wire.size() - 1)));
+  ASSERT_EQ(1, recorder.events.size());
+
+  ASSERT_EQ(wire.size() - pingSize, parser.parseFragment(wire.ref(pingSize)));
+  ASSERT_EQ(2, recorder.events.size());
+  EXPECT_EQ("DATA 1 body (4)", recorder.events[1]);
+}
+
+TEST(http_http2_FrameParser, dataOnStreamZero) {
+  Buffer wire;
+  wire.push_back("\x00\x00\x01\x00\x00\x00\x00\x00\x00" "x", 10);
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder);
+  parser.parseFragment(wire.ref());
+
+  ASSERT_EQ(1, recorder.events.size());
+  EXPECT_EQ("connection error PROTOCOL_ERROR", recorder.events[0]);
+  EXPECT_TRUE(parser.isFailed());
+}
+
+TEST(http_http2_FrameParser, frameTooLarge) {
+  Buffer wire = serialize([](FrameGenerator& g) {
+    g.generateData(1, BufferRef("0123456789"), false);
+  });
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder, 8);
+  parser.parseFragment(wire.ref());
+
+  ASSERT_EQ(1, recorder.events.size());
+  EXPECT_EQ("connection error FRAME_SIZE_ERROR", recorder.events[0]);
+}
+
+TEST(http_http2_FrameParser, interruptedContinuation) {
+  Buffer block("0123456789abcdefghij");
+  Buffer wire = serialize([&](FrameGenerator& g) {
+    g.generateHeaders(1, block.ref(0, 8), false);
+    g.generatePing(BufferRef("12345678"));
+  });
+
+  // drop END_HEADERS from the HEADERS frame so that CONTINUATION is expected
+  wire.data()[4] &= ~FrameFlags::EndHeaders;
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder);
+  parser.parseFragment(wire.ref());
+
+  ASSERT_EQ(1, recorder.events.size());
+  EXPECT_EQ("connection error PROTOCOL_ERROR", recorder.events[0]);
+}
+
+TEST(http_http2_FrameParser, windowUpdateZeroIncrement) {
+  Buffer wire;
+  wire.push_back("\x00\x00\x04\x08\x00\x00\x00\x00\x03" "\x00\x00\x00\x00", 13);
+
+  FrameRecorder recorder;
+  FrameParser parser(&recorder);
+  ASSERT_EQ(wire.size(), parser.parseFragment(wire.ref()));
+
+  ASSERT_EQ(1, recorder.events.size());
+  EXPECT_EQ("stream error 3 PROTOCOL_ERROR", recorder.events[0]);
+  EXPECT_FALSE(parser.isFailed());
+}
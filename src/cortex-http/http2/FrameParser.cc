@@ -0,0 +1,451 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/FrameParser.h>
+#include <cortex-http/http2/FrameListener.h>
+#include <cortex-base/logging.h>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+#ifndef NDEBUG
+#define TRACE(msg...) logTrace("http.http2.FrameParser", msg)
+#else
+#define TRACE(msg...) do {} while (0)
+#endif
+
+static inline uint32_t read16(const char* p) {
+  const uint8_t* u = reinterpret_cast<const uint8_t*>(p);
+  return (u[0] << 8) | u[1];
+}
+
+static inline uint32_t read24(const char* p) {
+  const uint8_t* u = reinterpret_cast<const uint8_t*>(p);
+  return (u[0] << 16) | (u[1] << 8) | u[2];
+}
+
+static inline uint32_t read32(const char* p) {
+  const uint8_t* u = reinterpret_cast<const uint8_t*>(p);
+  return (static_cast<uint32_t>(u[0]) << 24) | (u[1] << 16) | (u[2] << 8) |
+         u[3];
+}
+
+FrameParser::FrameParser(FrameListener* listener, size_t maxFrameSize)
+    : listener_(listener),
+      maxFrameSize_(maxFrameSize),
+      maxHeaderBlockSize_(256 * 1024),
+      bytesReceived_(0),
+      failed_(false),
+      continuationType_(FrameType::Headers),
+      continuationStreamID_(0),
+      promisedStreamID_(0),
+      continuationEndStream_(false),
+      headerBlock_() {
+}
+
+FrameParser::~FrameParser() {
+}
+
+size_t FrameParser::parseFragment(const BufferRef& chunk) {
+  size_t offset = 0;
+
+  while (!failed_ && chunk.size() - offset >= FrameHeaderSize) {
+    const char* header = chunk.data() + offset;
+    const size_t length = read24(header);
+    const FrameType type = static_cast<FrameType>(header[3]);
+    const uint8_t flags = static_cast<uint8_t>(header[4]);
+    const StreamID sid = read32(header + 5) & 0x7fffffff;
+
+    if (length > maxFrameSize_) {
+      connectionError(ErrorCode::FrameSizeError, "Frame too large.");
+      break;
+    }
+
+    if (chunk.size() - offset < FrameHeaderSize + length)
+      break;
+
+    offset += FrameHeaderSize + length;
+    bytesReceived_ += FrameHeaderSize + length;
+
+    parseFrame(type, flags, sid,
+               chunk.ref(offset - length, length));
+  }
+
+  // nothing will ever be parsed again, so swallow everything
+  if (failed_)
+    return chunk.size();
+
+  return offset;
+}
+
+void FrameParser::parseFrame(FrameType type, uint8_t flags, StreamID sid,
+                             const BufferRef& payload) {
+  TRACE("parseFrame: %s (flags 0x%02x, stream %u, length %zu)",
+        to_string(type).c_str(), flags, sid, payload.size());
+
+  if (continuationStreamID_ != 0 && type != FrameType::Continuation) {
+    connectionError(ErrorCode::ProtocolError,
+                    "Expected CONTINUATION frame.");
+    return;
+  }
+
+  switch (type) {
+    case FrameType::Data:
+      parseData(flags, sid, payload);
+      break;
+    case FrameType::Headers:
+      parseHeaders(flags, sid, payload);
+      break;
+    case FrameType::Priority:
+      parsePriority(sid, payload);
+      break;
+    case FrameType::ResetStream:
+      parseResetStream(sid, payload);
+      break;
+    case FrameType::Settings:
+      parseSettings(flags, sid, payload);
+      break;
+    case FrameType::PushPromise:
+      parsePushPromise(flags, sid, payload);
+      break;
+    case FrameType::Ping:
+      parsePing(flags, sid, payload);
+      break;
+    case FrameType::GoAway:
+      parseGoAway(sid, payload);
+      break;
+    case FrameType::WindowUpdate:
+      parseWindowUpdate(sid, payload);
+      break;
+    case FrameType::Continuation:
+      parseContinuation(flags, sid, payload);
+      break;
+    default:
+      // RFC 7540, Section 4.1: unknown frame types must be ignored
+      break;
+  }
+}
+
+bool FrameParser::stripPadding(uint8_t flags, BufferRef* payload) {
+  if (!(flags & FrameFlags::Padded))
+    return true;
+
+  if (payload->empty()) {
+    connectionError(ErrorCode::FrameSizeError, "Missing pad length.");
+    return false;
+  }
+
+  const size_t padLength = static_cast<uint8_t>((*payload)[0]);
+  if (padLength >= payload->size()) {
+    connectionError(ErrorCode::ProtocolError, "Padding exceeds payload.");
+    return false;
+  }
+
+  *payload = payload->ref(1, payload->size() - 1 - padLength);
+  return true;
+}
+
+void FrameParser::parseData(uint8_t flags, StreamID sid,
+                            const BufferRef& payload) {
+  if (sid == 0) {
+    connectionError(ErrorCode::ProtocolError, "DATA frame on stream 0.");
+    return;
+  }
+
+  BufferRef data = payload;
+  if (!stripPadding(flags, &data))
+    return;
+
+  listener_->onData(sid, data, flags & FrameFlags::EndStream, payload.size());
+}
+
+void FrameParser::parseHeaders(uint8_t flags, StreamID sid,
+                               const BufferRef& payload) {
+  if (sid == 0) {
+    connectionError(ErrorCode::ProtocolError, "HEADERS frame on stream 0.");
+    return;
+  }
+
+  BufferRef fragment = payload;
+  if (!stripPadding(flags, &fragment))
+    return;
+
+  if (flags & FrameFlags::Priority) {
+    if (fragment.size() < 5) {
+      connectionError(ErrorCode::FrameSizeError,
+                      "HEADERS frame too small for priority.");
+      return;
+    }
+
+    const uint32_t dependency = read32(fragment.data());
+    const unsigned weight = static_cast<uint8_t>(fragment[4]) + 1;
+
+    // self-dependencies are reported as-is, because the header block
+    // must still be decoded to keep the compression context in sync.
+    listener_->onPriority(sid, dependency & 0x7fffffff,
+                          (dependency & 0x80000000) != 0, weight);
+
+    fragment = fragment.ref(5);
+  }
+
+  beginHeaderBlock(FrameType::Headers, flags, sid, 0, fragment);
+}
+
+void FrameParser::parsePriority(StreamID sid, const BufferRef& payload) {
+  if (sid == 0) {
+    connectionError(ErrorCode::ProtocolError, "PRIORITY frame on stream 0.");
+    return;
+  }
+
+  if (payload.size() != 5) {
+    listener_->onStreamError(sid, ErrorCode::FrameSizeError,
+                             "Invalid PRIORITY frame size.");
+    return;
+  }
+
+  const uint32_t dependency = read32(payload.data());
+  const StreamID dependencyID = dependency & 0x7fffffff;
+
+  if (dependencyID == sid) {
+    listener_->onStreamError(sid, ErrorCode::ProtocolError,
+                             "Stream depends on itself.");
+    return;
+  }
+
+  listener_->onPriority(sid, dependencyID, (dependency & 0x80000000) != 0,
+                        static_cast<uint8_t>(payload[4]) + 1);
+}
+
+void FrameParser::parseResetStream(StreamID sid, const BufferRef& payload) {
+  if (sid == 0) {
+    connectionError(ErrorCode::ProtocolError,
+                    "RST_STREAM frame on stream 0.");
+    return;
+  }
+
+  if (payload.size() != 4) {
+    connectionError(ErrorCode::FrameSizeError,
+                    "Invalid RST_STREAM frame size.");
+    return;
+  }
+
+  listener_->onResetStream(sid, static_cast<ErrorCode>(read32(payload.data())));
+}
+
+void FrameParser::parseSettings(uint8_t flags, StreamID sid,
+                                const BufferRef& payload) {
+  if (sid != 0) {
+    connectionError(ErrorCode::ProtocolError,
+                    "SETTINGS frame on non-zero stream.");
+    return;
+  }
+
+  if (flags & FrameFlags::Ack) {
+    if (!payload.empty()) {
+      connectionError(ErrorCode::FrameSizeError,
+                      "SETTINGS acknowledgement with payload.");
+      return;
+    }
+    listener_->onSettingsAck();
+    return;
+  }
+
+  if (payload.size() % 6 != 0) {
+    connectionError(ErrorCode::FrameSizeError, "Invalid SETTINGS frame size.");
+    return;
+  }
+
+  SettingsList settings;
+  settings.reserve(payload.size() / 6);
+
+  for (size_t i = 0; i < payload.size(); i += 6) {
+    const uint16_t id = read16(payload.data() + i);
+    const uint32_t value = read32(payload.data() + i + 2);
+
+    switch (static_cast<SettingsParameter>(id)) {
+      case SettingsParameter::EnablePush:
+        if (value > 1) {
+          connectionError(ErrorCode::ProtocolError,
+                          "Invalid SETTINGS_ENABLE_PUSH value.");
+          return;
+        }
+        break;
+      case SettingsParameter::InitialWindowSize:
+        if (value > MaxWindowSize) {
+          connectionError(ErrorCode::FlowControlError,
+                          "Invalid SETTINGS_INITIAL_WINDOW_SIZE value.");
+          return;
+        }
+        break;
+      case SettingsParameter::MaxFrameSize:
+        if (value < DefaultMaxFrameSize || value > MaxFrameSizeLimit) {
+          connectionError(ErrorCode::ProtocolError,
+                          "Invalid SETTINGS_MAX_FRAME_SIZE value.");
+          return;
+        }
+        break;
+      case SettingsParameter::HeaderTableSize:
+      case SettingsParameter::MaxConcurrentStreams:
+      case SettingsParameter::MaxHeaderListSize:
+        break;
+      default:
+        // RFC 7540, Section 6.5.2: unknown settings must be ignored
+        continue;
+    }
+
+    settings.emplace_back(static_cast<SettingsParameter>(id), value);
+  }
+
+  listener_->onSettings(settings);
+}
+
+void FrameParser::parsePushPromise(uint8_t flags, StreamID sid,
+                                   const BufferRef& payload) {
+  if (sid == 0) {
+    connectionError(ErrorCode::ProtocolError,
+                    "PUSH_PROMISE frame on stream 0.");
+    return;
+  }
+
+  BufferRef fragment = payload;
+  if (!stripPadding(flags, &fragment))
+    return;
+
+  if (fragment.size() < 4) {
+    connectionError(ErrorCode::FrameSizeError,
+                    "Invalid PUSH_PROMISE frame size.");
+    return;
+  }
+
+  const StreamID promisedStreamID = read32(fragment.data()) & 0x7fffffff;
+
+  beginHeaderBlock(FrameType::PushPromise, flags, sid, promisedStreamID,
+                   fragment.ref(4));
+}
+
+void FrameParser::parsePing(uint8_t flags, StreamID sid,
+                            const BufferRef& payload) {
+  if (sid != 0) {
+    connectionError(ErrorCode::ProtocolError, "PING frame on non-zero stream.");
+    return;
+  }
+
+  if (payload.size() != 8) {
+    connectionError(ErrorCode::FrameSizeError, "Invalid PING frame size.");
+    return;
+  }
+
+  if (flags & FrameFlags::Ack)
+    listener_->onPingAck(payload);
+  else
+    listener_->onPing(payload);
+}
+
+void FrameParser::parseGoAway(StreamID sid, const BufferRef& payload) {
+  if (sid != 0) {
+    connectionError(ErrorCode::ProtocolError,
+                    "GOAWAY frame on non-zero stream.");
+    return;
+  }
+
+  if (payload.size() < 8) {
+    connectionError(ErrorCode::FrameSizeError, "Invalid GOAWAY frame size.");
+    return;
+  }
+
+  listener_->onGoAway(read32(payload.data()) & 0x7fffffff,
+                      static_cast<ErrorCode>(read32(payload.data() + 4)),
+                      payload.ref(8));
+}
+
+void FrameParser::parseWindowUpdate(StreamID sid, const BufferRef& payload) {
+  if (payload.size() != 4) {
+    connectionError(ErrorCode::FrameSizeError,
+                    "Invalid WINDOW_UPDATE frame size.");
+    return;
+  }
+
+  const uint32_t increment = read32(payload.data()) & 0x7fffffff;
+
+  if (increment == 0) {
+    if (sid == 0)
+      connectionError(ErrorCode::ProtocolError, "Zero window increment.");
+    else
+      listener_->onStreamError(sid, ErrorCode::ProtocolError,
+                               "Zero window increment.");
+    return;
+  }
+
+  listener_->onWindowUpdate(sid, increment);
+}
+
+void FrameParser::parseContinuation(uint8_t flags, StreamID sid,
+                                    const BufferRef& payload) {
+  if (continuationStreamID_ == 0 || continuationStreamID_ != sid) {
+    connectionError(ErrorCode::ProtocolError,
+                    "Unexpected CONTINUATION frame.");
+    return;
+  }
+
+  if (headerBlock_.size() + payload.size() > maxHeaderBlockSize_) {
+    connectionError(ErrorCode::EnhanceYourCalm, "Header block too large.");
+    return;
+  }
+
+  headerBlock_.push_back(payload);
+
+  if (flags & FrameFlags::EndHeaders) {
+    endHeaderBlock();
+  }
+}
+
+void FrameParser::beginHeaderBlock(FrameType type, uint8_t flags,
+                                   StreamID sid, StreamID promisedStreamID,
+                                   const BufferRef& fragment) {
+  const bool endStream = (flags & FrameFlags::EndStream) != 0;
+
+  if (flags & FrameFlags::EndHeaders) {
+    // common case: the whole block in one frame, no copy required
+    if (type == FrameType::Headers)
+      listener_->onHeaders(sid, fragment, endStream);
+    else
+      listener_->onPushPromise(sid, promisedStreamID, fragment);
+    return;
+  }
+
+  continuationType_ = type;
+  continuationStreamID_ = sid;
+  promisedStreamID_ = promisedStreamID;
+  continuationEndStream_ = endStream;
+
+  headerBlock_.clear();
+  headerBlock_.push_back(fragment);
+}
+
+void FrameParser::endHeaderBlock() {
+  const StreamID sid = continuationStreamID_;
+  continuationStreamID_ = 0;
+
+  if (continuationType_ == FrameType::Headers)
+    listener_->onHeaders(sid, headerBlock_.ref(), continuationEndStream_);
+  else
+    listener_->onPushPromise(sid, promisedStreamID_, headerBlock_.ref());
+
+  headerBlock_.clear();
+}
+
+void FrameParser::connectionError(ErrorCode ec, const std::string& message) {
+  TRACE("connectionError: %s. %s", to_string(ec).c_str(), message.c_str());
+
+  failed_ = true;
+  listener_->onConnectionError(ec, message);
+}
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
@@ -0,0 +1,106 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cortex-http/Api.h>
+#include <cortex-http/http2/Frame.h>
+#include <cortex-base/Buffer.h>
+#include <string>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+class FrameListener;
+
+/**
+ * HTTP/2 frame parser (RFC 7540, Section 4 and 6).
+ *
+ * Splits the input into frames, validates them against the framing rules
+ * and reports them to its FrameListener. Header blocks split across
+ * CONTINUATION frames are reassembled before being reported.
+ *
+ * The connection preface is not part of the frame layer and must have been
+ * consumed before any input is passed to this parser.
+ */
+class CORTEX_HTTP_API FrameParser {
+ public:
+  explicit FrameParser(FrameListener* listener = nullptr,
+                       size_t maxFrameSize = DefaultMaxFrameSize);
+  ~FrameParser();
+
+  void setListener(FrameListener* listener) { listener_ = listener; }
+  FrameListener* listener() const noexcept { return listener_; }
+
+  /**
+   * Maximum frame payload size accepted, as advertised via our own
+   * @c SETTINGS_MAX_FRAME_SIZE.
+   */
+  size_t maxFrameSize() const noexcept { return maxFrameSize_; }
+  void setMaxFrameSize(size_t value) { maxFrameSize_ = value; }
+
+  /**
+   * Maximum size of a header block accumulated across CONTINUATION frames.
+   */
+  size_t maxHeaderBlockSize() const noexcept { return maxHeaderBlockSize_; }
+  void setMaxHeaderBlockSize(size_t value) { maxHeaderBlockSize_ = value; }
+
+  /** Number of octets processed so far. */
+  size_t bytesReceived() const noexcept { return bytesReceived_; }
+
+  /** Whether or not a connection error stopped this parser. */
+  bool isFailed() const noexcept { return failed_; }
+
+  /**
+   * Parses all complete frames contained in @p chunk.
+   *
+   * @return number of bytes consumed, which is always a multiple of whole
+   *         frames. Incomplete trailing frames must be passed again once
+   *         more input is available.
+   */
+  size_t parseFragment(const BufferRef& chunk);
+
+ private:
+  void parseFrame(FrameType type, uint8_t flags, StreamID sid,
+                  const BufferRef& payload);
+  void parseData(uint8_t flags, StreamID sid, const BufferRef& payload);
+  void parseHeaders(uint8_t flags, StreamID sid, const BufferRef& payload);
+  void parsePriority(StreamID sid, const BufferRef& payload);
+  void parseResetStream(StreamID sid, const BufferRef& payload);
+  void parseSettings(uint8_t flags, StreamID sid, const BufferRef& payload);
+  void parsePushPromise(uint8_t flags, StreamID sid, const BufferRef& payload);
+  void parsePing(uint8_t flags, StreamID sid, const BufferRef& payload);
+  void parseGoAway(StreamID sid, const BufferRef& payload);
+  void parseWindowUpdate(StreamID sid, const BufferRef& payload);
+  void parseContinuation(uint8_t flags, StreamID sid, const BufferRef& payload);
+
+  bool stripPadding(uint8_t flags, BufferRef* payload);
+  void beginHeaderBlock(FrameType type, uint8_t flags, StreamID sid,
+                        StreamID promisedStreamID, const BufferRef& fragment);
+  void endHeaderBlock();
+
+  void connectionError(ErrorCode ec, const std::string& message);
+
+ private:
+  FrameListener* listener_;
+  size_t maxFrameSize_;
+  size_t maxHeaderBlockSize_;
+  size_t bytesReceived_;
+  bool failed_;
+
+  // state of a header block being continued
+  FrameType continuationType_;
+  StreamID continuationStreamID_;  //!< 0 if no CONTINUATION is expected
+  StreamID promisedStreamID_;
+  bool continuationEndStream_;
+  Buffer headerBlock_;
+};
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
@@ -0,0 +1,584 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/Stream.h>
+#include <cortex-http/http2/Connection.h>
+#include <cortex-http/http2/FrameGenerator.h>
+#include <cortex-http/HttpChannel.h>
+#include <cortex-http/HttpBufferedInput.h>
+#include <cortex-http/HttpRequest.h>
+#include <cortex-http/HttpResponse.h>
+#include <cortex-http/HttpResponseInfo.h>
+#include <cortex-http/HeaderFieldList.h>
+#include <cortex-http/BadMessage.h>
+#include <cortex-base/RuntimeError.h>
+#include <cortex-base/logging.h>
+#include <algorithm>
+#include <string>
+
+namespace cortex {
+namespace http {
+namespace http2 {
+
+#ifndef NDEBUG
+#define TRACE(msg...) logTrace("http.http2.Stream", msg)
+#else
+#define TRACE(msg...) do {} while (0)
+#endif
+
+std::string to_string(StreamState state) {
+  switch (state) {
+    case StreamState::Idle: return "idle";
+    case StreamState::Open: return "open";
+    case StreamState::HalfClosedLocal: return "half-closed (local)";
+    case StreamState::HalfClosedRemote: return "half-closed (remote)";
+    case StreamState::Closed: return "closed";
+    default: return "<invalid>";
+  }
+}
+
+// {{{ DataChunk
+/**
+ * A response body chunk, transferred as one or more DATA frames.
+ */
+class Stream::DataChunk {
+ public:
+  explicit DataChunk(CompletionHandler onComplete)
+      : onComplete_(std::move(onComplete)) {}
+  virtual ~DataChunk() {}
+
+  /** Number of octets not yet transferred. */
+  virtual size_t size() const = 0;
+
+  /** Generates DATA frames for the next @p n octets. */
+  virtual void transferTo(FrameGenerator* generator, StreamID sid,
+                          size_t n, bool last) = 0;
+
+  CompletionHandler& onComplete() { return onComplete_; }
+
+ private:
+  CompletionHandler onComplete_;
+};
+
+class Stream::BufferChunk : public DataChunk {
+ public:
+  BufferChunk(Buffer&& data, CompletionHandler onComplete)
+      : DataChunk(std::move(onComplete)), data_(std::move(data)), offset_(0) {}
+
+  size_t size() const override { return data_.size() - offset_; }
+
+  void transferTo(FrameGenerator* generator, StreamID sid,
+                  size_t n, bool last) override {
+    if (offset_ == 0 && n == data_.size()) {
+      generator->generateData(sid, std::move(data_), last);
+      data_.clear();
+    } else {
+      generator->generateData(sid, Buffer(data_.ref(offset_, n)), last);
+      offset_ += n;
+    }
+  }
+
+ private:
+  Buffer data_;
+  size_t offset_;
+};
+
+class Stream::BufferRefChunk : public DataChunk {
+ public:
+  BufferRefChunk(const BufferRef& data, CompletionHandler onComplete)
+      : DataChunk(std::move(onComplete)), data_(data), offset_(0) {}
+
+  size_t size() const override { return data_.size() - offset_; }
+
+  void transferTo(FrameGenerator* generator, StreamID sid,
+                  size_t n, bool last) override {
+    // the caller guarantees the data to live until its completion
+    generator->generateData(sid, data_.ref(offset_, n), last);
+    offset_ += n;
+  }
+
+ private:
+  BufferRef data_;
+  size_t offset_;
+};
+
+class Stream::FileChunk : public DataChunk {
+ public:
+  FileChunk(FileRef&& file, CompletionHandler onComplete)
+      : DataChunk(std::move(onComplete)), file_(std::move(file)) {}
+
+  size_t size() const override { return file_.size(); }
+
+  void transferTo(FrameGenerator* generator, StreamID sid,
+                  size_t n, bool last) override {
+    if (n == file_.size()) {
+      generator->generateData(sid, std::move(file_), last);
+      file_.setSize(0);
+    } else {
+      generator->generateData(
+          sid, FileRef(file_.handle(), file_.offset(), n, false), last);
+      file_.setOffset(file_.offset() + n);
+      file_.setSize(file_.size() - n);
+    }
+  }
+
+ private:
+  FileRef file_;
+};
+// }}}
+
+Stream::Stream(StreamID id,
+               Connection* connection,
+               const HttpHandler& handler,
+               size_t maxRequestUriLength,
+               size_t maxRequestBodyLength,
+               HttpDateGenerator* dateGenerator,
+               HttpOutputCompressor* outputCompressor,
+               size_t sendWindowSize,
+               size_t recvWindowSize)
+    : id_(id),
+      state_(StreamState::Idle),
+      connection_(connection),
+      channel_(new HttpChannel(
+          this, handler, std::unique_ptr<HttpInput>(new HttpBufferedInput()),
+          maxRequestUriLength, maxRequestBodyLength,
+          dateGenerator, outputCompressor)),
+      parent_(nullptr),
+      children_(),
+      weight_(16),
+      pass_(0),
+      childrenVirtualTime_(0),
+      sendWindow_(sendWindowSize),
+      recvWindow_(recvWindowSize),
+      output_(),
+      bytesTransmitted_(0),
+      headResponse_(false),
+      completed_(false),
+      reset_(false),
+      closing_(false) {
+  TRACE("%p ctor (sid %u)", this, id_);
+}
+
+Stream::~Stream() {
+  TRACE("%p dtor (sid %u)", this, id_);
+}
+
+// {{{ request side
+static bool isConnectionSpecificHeader(const BufferRef& name) {
+  // RFC 7540, Section 8.1.2.2
+  return name == "connection" ||
+         name == "keep-alive" ||
+         name == "proxy-connection" ||
+         name == "transfer-encoding" ||
+         name == "upgrade";
+}
+
+bool Stream::onRequestHeaders(const HeaderFieldList& fields, bool last) {
+  std::string method;
+  std::string scheme;
+  std::string path;
+  std::string authority;
+  std::string cookie;
+  bool regularSeen = false;
+
+  // RFC 7540, Section 8.1.2: reject malformed requests before anything
+  // reaches the channel.
+  for (const HeaderField& field: fields) {
+    const BufferRef name = field.name();
+
+    if (name.empty() ||
+        std::any_of(name.begin(), name.end(),
+                    [](char ch) { return ch >= 'A' && ch <= 'Z'; }))
+      return false;
+
+    if (name[0] == ':') {
+      if (regularSeen)
+        return false;
+
+      std::string* target;
+      if (name == ":method")
+        target = &method;
+      else if (name == ":scheme")
+        target = &scheme;
+      else if (name == ":path")
+        target = &path;
+      else if (name == ":authority")
+        target = &authority;
+      else
+        return false;
+
+      if (!target->empty() || field.value().empty())
+        return false;
+
+      *target = field.value().str();
+    } else {
+      regularSeen = true;
+
+      if (isConnectionSpecificHeader(name))
+        return false;
+
+      if (name == "te" && field.value() != "trailers")
+        return false;
+    }
+  }
+
+  if (method.empty())
+    return false;
+
+  if (method == "CONNECT") {
+    if (!scheme.empty() || !path.empty() || authority.empty())
+      return false;
+    path = authority;
+  } else if (scheme.empty() || path.empty()) {
+    return false;
+  }
+
+  state_ = StreamState::Open;
+  if (last)
+    state_ = StreamState::HalfClosedRemote;
+
+  channel_->request()->setBytesReceived(connection_->bytesReceived());
+
+  try {
+    channel_->onMessageBegin(BufferRef(method), BufferRef(path),
+                             HttpVersion::VERSION_2_0);
+
+    if (!authority.empty())
+      channel_->onMessageHeader(BufferRef("Host"), BufferRef(authority));
+
+    for (const HeaderField& field: fields) {
+      const BufferRef name = field.name();
+      if (name[0] == ':')
+        continue;
+
+      if (name == "host" && !authority.empty())
+        continue;
+
+      // RFC 7540, Section 8.1.2.5: cookie crumbs are joined for HTTP/1
+      // semantics.
+      if (name == "cookie") {
+        if (!cookie.empty())
+          cookie += "; ";
+        cookie.append(field.value().data(), field.value().size());
+        continue;
+      }
+
+      channel_->onMessageHeader(name, field.value());
+    }
+
+    if (!cookie.empty())
+      channel_->onMessageHeader(BufferRef("cookie"), BufferRef(cookie));
+
+    channel_->onMessageHeaderEnd();
+
+    if (last) {
+      channel_->onMessageEnd();
+    }
+  } catch (const BadMessage& e) {
+    TRACE("%p onRequestHeaders: BadMessage caught (while in state %s). %s",
+          this, to_string(channel_->state()).c_str(), e.what());
+
+    if (channel_->response()->version() == HttpVersion::UNKNOWN)
+      channel_->response()->setVersion(HttpVersion::VERSION_2_0);
+
+    if (channel_->state() == HttpChannelState::READING)
+      channel_->setState(HttpChannelState::HANDLING);
+
+    channel_->response()->sendError(e.httpCode(), e.what());
+  }
+
+  return true;
+}
+
+bool Stream::onRequestTrailers(const HeaderFieldList& fields) {
+  // trailers are validated but not passed on, as HttpChannel has no
+  // notion of request trailers.
+  for (const HeaderField& field: fields) {
+    const BufferRef name = field.name();
+    if (name.empty() || name[0] == ':' || isConnectionSpecificHeader(name))
+      return false;
+  }
+
+  onRemoteClosed();
+  channel_->onMessageEnd();
+  return true;
+}
+
+void Stream::onRequestData(const BufferRef& data, bool last) {
+  channel_->request()->setBytesReceived(connection_->bytesReceived());
+
+  if (!data.empty())
+    channel_->onMessageContent(data);
+
+  if (last) {
+    onRemoteClosed();
+    channel_->onMessageEnd();
+  }
+}
+
+void Stream::onRemoteClosed() {
+  if (state_ == StreamState::HalfClosedLocal)
+    state_ = StreamState::Closed;
+  else
+    state_ = StreamState::HalfClosedRemote;
+}
+
+void Stream::onReset() {
+  TRACE("%p onReset (sid %u)", this, id_);
+
+  reset_ = true;
+  state_ = StreamState::Closed;
+
+  for (std::unique_ptr<DataChunk>& chunk: output_) {
+    if (CompletionHandler onComplete = std::move(chunk->onComplete())) {
+      connection_->complete([onComplete](bool) { onComplete(false); });
+    }
+  }
+  output_.clear();
+
+  if (completed_) {
+    scheduleRemoval();
+  }
+}
+// }}}
+
+// {{{ HttpTransport overrides
+void Stream::abort() {
+  TRACE("%p abort (sid %u)", this, id_);
+
+  if (closing_)
+    return;
+
+  completed_ = true;
+
+  if (!reset_)
+    connection_->resetStream(id_, ErrorCode::InternalError);
+  else
+    scheduleRemoval();
+
+  connection_->scheduleOutput();
+}
+
+void Stream::completed() {
+  TRACE("%p completed (sid %u)", this, id_);
+
+  if (completed_) {
+    if (reset_)
+      return;  // aborted by us or reset by the peer before
+
+    RAISE(IllegalStateError, "Invalid State. Stream already completed.");
+  }
+
+  completed_ = true;
+
+  if (reset_)
+    scheduleRemoval();
+
+  connection_->scheduleOutput();
+}
+
+void Stream::send(HttpResponseInfo&& responseInfo, Buffer&& chunk,
+                  CompletionHandler onComplete) {
+  sendHeaders(responseInfo);
+  send(std::move(chunk), std::move(onComplete));
+}
+
+void Stream::send(HttpResponseInfo&& responseInfo, const BufferRef& chunk,
+                  CompletionHandler onComplete) {
+  sendHeaders(responseInfo);
+  send(chunk, std::move(onComplete));
+}
+
+void Stream::send(HttpResponseInfo&& responseInfo, FileRef&& chunk,
+                  CompletionHandler onComplete) {
+  sendHeaders(responseInfo);
+  send(std::move(chunk), std::move(onComplete));
+}
+
+void Stream::send(Buffer&& chunk, CompletionHandler onComplete) {
+  TRACE("%p send(Buffer, chunkSize=%zu)", this, chunk.size());
+  enqueue(std::unique_ptr<DataChunk>(
+      new BufferChunk(std::move(chunk), std::move(onComplete))));
+}
+
+void Stream::send(const BufferRef& chunk, CompletionHandler onComplete) {
+  TRACE("%p send(BufferRef, chunkSize=%zu)", this, chunk.size());
+  enqueue(std::unique_ptr<DataChunk>(
+      new BufferRefChunk(chunk, std::move(onComplete))));
+}
+
+void Stream::send(FileRef&& chunk, CompletionHandler onComplete) {
+  TRACE("%p send(FileRef, fd=%d, chunkSize=%zu)",
+        this, chunk.handle(), chunk.size());
+  enqueue(std::unique_ptr<DataChunk>(
+      new FileChunk(std::move(chunk), std::move(onComplete))));
+}
+// }}}
+
+// {{{ response side
+void Stream::sendHeaders(const HttpResponseInfo& info) {
+  TRACE("%p sendHeaders(status=%d)", this, static_cast<int>(info.status()));
+
+  if (reset_ || isLocalClosed())
+    return;
+
+  const int status = static_cast<int>(info.status());
+
+  if (status >= 200)
+    headResponse_ = info.isHeadResponse();
+
+  hpack::Encoder& encoder = connection_->headerEncoder_;
+  Buffer block;
+  encoder.beginHeaderBlock(&block);
+
+  char statusText[4];
+  snprintf(statusText, sizeof(statusText), "%03d", status);
+  encoder.encode(&block, BufferRef(":status"), BufferRef(statusText, 3));
+
+  std::string name;
+  for (const HeaderField& field: info.headers()) {
+    name.assign(field.name().data(), field.name().size());
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+    if (isConnectionSpecificHeader(BufferRef(name)) || name == "content-length")
+      continue;
+
+    encoder.encode(&block, BufferRef(name), field.value());
+  }
+
+  if (status >= 200 && status != 204 && status != 304 &&
+      info.hasContentLength()) {
+    std::string value = std::to_string(info.contentLength());
+    encoder.encode(&block, BufferRef("content-length"), BufferRef(value));
+  }
+
+  connection_->generator_.generateHeaders(id_, block, false);
+}
+
+void Stream::enqueue(std::unique_ptr<DataChunk>&& chunk) {
+  if (reset_ || headResponse_) {
+    // nothing is going to be written, so report completion right away,
+    // that is, successful for HEAD responses and failed for reset streams.
+    if (CompletionHandler onComplete = std::move(chunk->onComplete())) {
+      const bool succeed = !reset_;
+      connection_->complete([onComplete, succeed](bool) {
+        onComplete(succeed);
+      });
+    }
+    connection_->scheduleOutput();
+    return;
+  }
+
+  if (completed_)
+    RAISE(IllegalStateError, "Invalid State. Stream already completed.");
+
+  output_.emplace_back(std::move(chunk));
+  connection_->scheduleOutput();
+}
+
+bool Stream::isReady(bool connectionWindowAvailable) const {
+  if (reset_ || isLocalClosed())
+    return false;
+
+  if (output_.empty())
+    return completed_;
+
+  return output_.front()->size() == 0 ||
+         (sendWindow_ > 0 && connectionWindowAvailable);
+}
+
+size_t Stream::transmit(size_t limit) {
+  if (output_.empty()) {
+    sendEndOfStream();
+    return 0;
+  }
+
+  DataChunk* chunk = output_.front().get();
+  const size_t n = std::min(std::min(chunk->size(), limit),
+                            static_cast<size_t>(std::max<int64_t>(0, sendWindow_)));
+  const bool drained = n == chunk->size();
+  const bool last = drained && output_.size() == 1 && completed_ &&
+                    channel_->response()->trailers().empty();
+
+  if (n != 0 || last)
+    chunk->transferTo(&connection_->generator_, id_, n, last);
+
+  sendWindow_ -= n;
+  bytesTransmitted_ += n;
+
+  if (drained) {
+    if (CompletionHandler onComplete = std::move(chunk->onComplete()))
+      connection_->complete(std::move(onComplete));
+
+    output_.pop_front();
+  }
+
+  if (last)
+    onEndOfStreamSent();
+
+  return n;
+}
+
+void Stream::sendEndOfStream() {
+  const HeaderFieldList& trailers = channel_->response()->trailers();
+
+  if (trailers.empty()) {
+    connection_->generator_.generateData(id_, BufferRef(), true);
+  } else {
+    hpack::Encoder& encoder = connection_->headerEncoder_;
+    Buffer block;
+    encoder.beginHeaderBlock(&block);
+
+    std::string name;
+    for (const HeaderField& field: trailers) {
+      name.assign(field.name().data(), field.name().size());
+      std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+      encoder.encode(&block, BufferRef(name), field.value());
+    }
+
+    connection_->generator_.generateHeaders(id_, block, true);
+  }
+
+  onEndOfStreamSent();
+}
+
+void Stream::onEndOfStreamSent() {
+  TRACE("%p onEndOfStreamSent (sid %u, %s)",
+        this, id_, to_string(state_).c_str());
+
+  if (!isRemoteClosed()) {
+    // RFC 7540, Section 8.1: the response is complete, so tell the client
+    // to stop sending the remainder of its request.
+    connection_->generator_.generateResetStream(id_, ErrorCode::NoError);
+  }
+
+  state_ = StreamState::Closed;
+  scheduleRemoval();
+}
+
+void Stream::scheduleRemoval() {
+  if (closing_)
+    return;
+
+  closing_ = true;
+  connection_->complete(std::bind(&Stream::onResponseComplete, this,
+                                  std::placeholders::_1));
+}
+
+void Stream::onResponseComplete(bool succeed) {
+  TRACE("%p onResponseComplete(%s)", this, succeed ? "succeed" : "failure");
+
+  channel_->response()->setBytesTransmitted(bytesTransmitted_);
+  channel_->responseEnd();
+
+  connection_->removeStream(this);
+}
+// }}}
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
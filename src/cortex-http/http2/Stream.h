@@ -0,0 +1,168 @@
+// This file is part of the "x0" project
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cortex-http/Api.h>
+#include <cortex-http/HttpTransport.h>
+#include <cortex-http/HttpHandler.h>
+#include <cortex-http/http2/Frame.h>
+#include <cortex-base/Buffer.h>
+#include <cortex-base/io/FileRef.h>
+#include <cortex-base/CompletionHandler.h>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+
+namespace cortex {
+namespace http {
+
+class HttpChannel;
+class HttpDateGenerator;
+class HttpOutputCompressor;
+class HeaderFieldList;
+
+namespace http2 {
+
+class Connection;
+class FrameGenerator;
+
+/**
+ * Stream states as of RFC 7540, Section 5.1.
+ *
+ * Push-related states are not needed as we never push.
+ */
+enum class StreamState {
+  Idle,
+  Open,
+  HalfClosedLocal,
+  HalfClosedRemote,
+  Closed,
+};
+
+CORTEX_HTTP_API std::string to_string(StreamState state);
+
+/**
+ * A single HTTP/2 stream, carrying one request/response exchange.
+ *
+ * The stream is the HttpTransport of its own HttpChannel. Response header
+ * blocks are generated right away, whereas body chunks are queued and
+ * written by the Connection as flow-control windows and stream priorities
+ * permit.
+ */
+class CORTEX_HTTP_API Stream : public HttpTransport {
+ public:
+  Stream(StreamID id,
+         Connection* connection,
+         const HttpHandler& handler,
+         size_t maxRequestUriLength,
+         size_t maxRequestBodyLength,
+         HttpDateGenerator* dateGenerator,
+         HttpOutputCompressor* outputCompressor,
+         size_t sendWindowSize,
+         size_t recvWindowSize);
+  ~Stream();
+
+  StreamID id() const noexcept { return id_; }
+  StreamState state() const noexcept { return state_; }
+  HttpChannel* channel() const noexcept { return channel_.get(); }
+
+  bool isLocalClosed() const noexcept {
+    return state_ == StreamState::HalfClosedLocal ||
+           state_ == StreamState::Closed;
+  }
+
+  bool isRemoteClosed() const noexcept {
+    return state_ == StreamState::HalfClosedRemote ||
+           state_ == StreamState::Closed;
+  }
+
+  /** Whether or not RST_STREAM has been sent or received on this stream. */
+  bool isReset() const noexcept { return reset_; }
+
+  /** The stream this one depends on, or @c nullptr for the root. */
+  Stream* parentStream() const noexcept { return parent_; }
+  const std::list<Stream*>& dependentStreams() const { return children_; }
+  unsigned weight() const noexcept { return weight_; }
+
+  /** Remaining octets we may send before the peer's next WINDOW_UPDATE. */
+  int64_t sendWindow() const noexcept { return sendWindow_; }
+
+  /** Remaining octets the peer may send before our next WINDOW_UPDATE. */
+  int64_t recvWindow() const noexcept { return recvWindow_; }
+
+  /** Number of DATA payload octets generated on this stream. */
+  size_t bytesTransmitted() const noexcept { return bytesTransmitted_; }
+
+  // HttpTransport overrides
+  void abort() override;
+  void completed() override;
+  void send(HttpResponseInfo&& responseInfo, Buffer&& chunk,
+            CompletionHandler onComplete) override;
+  void send(HttpResponseInfo&& responseInfo, const BufferRef& chunk,
+            CompletionHandler onComplete) override;
+  void send(HttpResponseInfo&& responseInfo, FileRef&& chunk,
+            CompletionHandler onComplete) override;
+  void send(Buffer&& chunk, CompletionHandler onComplete) override;
+  void send(const BufferRef& chunk, CompletionHandler onComplete) override;
+  void send(FileRef&& chunk, CompletionHandler onComplete) override;
+
+ private:
+  friend class Connection;
+
+  class DataChunk;
+  class BufferChunk;
+  class BufferRefChunk;
+  class FileChunk;
+
+  // request side, driven by the Connection
+  bool onRequestHeaders(const HeaderFieldList& fields, bool last);
+  bool onRequestTrailers(const HeaderFieldList& fields);
+  void onRequestData(const BufferRef& data, bool last);
+  void onRemoteClosed();
+  void onReset();
+
+  // response side
+  void sendHeaders(const HttpResponseInfo& info);
+  void enqueue(std::unique_ptr<DataChunk>&& chunk);
+  bool isReady(bool connectionWindowAvailable) const;
+  size_t transmit(size_t limit);
+  void sendEndOfStream();
+  void onEndOfStreamSent();
+  void scheduleRemoval();
+  void onResponseComplete(bool succeed);
+
+ private:
+  StreamID id_;
+  StreamState state_;
+  Connection* connection_;
+  std::unique_ptr<HttpChannel> channel_;
+
+  // priority
+  Stream* parent_;
+  std::list<Stream*> children_;
+  unsigned weight_;
+  uint64_t pass_;                  //!< stride scheduling pass value
+  uint64_t childrenVirtualTime_;   //!< pass of the last child served
+
+  // flow control
+  int64_t sendWindow_;
+  int64_t recvWindow_;
+
+  // output
+  std::deque<std::unique_ptr<DataChunk>> output_;
+  size_t bytesTransmitted_;
+  bool headResponse_;
+  bool completed_;  //!< the channel has finished generating the response
+  bool reset_;
+  bool closing_;    //!< onResponseComplete() has been scheduled
+};
+
+}  // namespace http2
+}  // namespace http
+}  // namespace cortex
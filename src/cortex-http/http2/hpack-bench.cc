@@ -0,0 +1,171 @@
+// This file is part of the "x0" project, http://cortex.io/
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/hpack.h>
+#include <cortex-base/Buffer.h>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdio.h>
+
+using namespace cortex;
+using namespace cortex::hpack;
+
+typedef std::vector<std::pair<std::string, std::string>> HeaderBlock;
+
+// a page load: the document, followed by its subresources
+static const std::vector<HeaderBlock> browserRequests = {
+  {{":method", "GET"},
+   {":scheme", "https"},
+   {":authority", "www.example.com"},
+   {":path", "/index.html"},
+   {"cache-control", "max-age=0"},
+   {"upgrade-insecure-requests", "1"},
+   {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+                  "(KHTML, like Gecko) Chrome/46.0.2490.80 Safari/537.36"},
+   {"accept", "text/html,application/xhtml+xml,application/xml;q=0.9,"
+              "image/webp,*/*;q=0.8"},
+   {"accept-encoding", "gzip, deflate, sdch"},
+   {"accept-language", "en-US,en;q=0.8,de;q=0.6"},
+   {"cookie", "_ga=GA1.2.1234567890.1445678901"},
+   {"cookie", "session=4f1c2a9b8e7d6c5b4a392817f6e5d4c3b2a19081"},
+   {"cookie", "theme=dark"}},
+
+  {{":method", "GET"},
+   {":scheme", "https"},
+   {":authority", "www.example.com"},
+   {":path", "/static/css/main.3f9a2c1b.css"},
+   {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+                  "(KHTML, like Gecko) Chrome/46.0.2490.80 Safari/537.36"},
+   {"accept", "text/css,*/*;q=0.1"},
+   {"referer", "https://www.example.com/index.html"},
+   {"accept-encoding", "gzip, deflate, sdch"},
+   {"accept-language", "en-US,en;q=0.8,de;q=0.6"},
+   {"cookie", "_ga=GA1.2.1234567890.1445678901"},
+   {"cookie", "session=4f1c2a9b8e7d6c5b4a392817f6e5d4c3b2a19081"},
+   {"cookie", "theme=dark"}},
+
+  {{":method", "GET"},
+   {":scheme", "https"},
+   {":authority", "www.example.com"},
+   {":path", "/static/js/app.8d7e6f5a.js"},
+   {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+                  "(KHTML, like Gecko) Chrome/46.0.2490.80 Safari/537.36"},
+   {"accept", "*/*"},
+   {"referer", "https://www.example.com/index.html"},
+   {"accept-encoding", "gzip, deflate, sdch"},
+   {"accept-language", "en-US,en;q=0.8,de;q=0.6"},
+   {"cookie", "_ga=GA1.2.1234567890.1445678901"},
+   {"cookie", "session=4f1c2a9b8e7d6c5b4a392817f6e5d4c3b2a19081"},
+   {"cookie", "theme=dark"},
+   {"if-none-match", "\"5627a7e1-1f4a\""}},
+};
+
+static const std::vector<HeaderBlock> apiResponses = {
+  {{":status", "200"},
+   {"date", "Wed, 21 Oct 2015 15:02:25 GMT"},
+   {"server", "cortex"},
+   {"content-type", "application/json"},
+   {"content-length", "1842"},
+   {"cache-control", "private, max-age=0"},
+   {"x-request-id", "8c1f6b2e-3f7a-4d9c-9e2b-5a6c7d8e9f01"},
+   {"vary", "accept-encoding"}},
+
+  {{":status", "304"},
+   {"date", "Wed, 21 Oct 2015 15:02:26 GMT"},
+   {"server", "cortex"},
+   {"etag", "\"5627a7e1-1f4a\""},
+   {"x-request-id", "2b3c4d5e-6f70-4182-93a4-b5c6d7e8f901"}},
+
+  {{":status", "404"},
+   {"date", "Wed, 21 Oct 2015 15:02:26 GMT"},
+   {"server", "cortex"},
+   {"content-type", "application/json"},
+   {"content-length", "27"},
+   {"x-request-id", "9a8b7c6d-5e4f-4031-8211-0f1e2d3c4b5a"}},
+};
+
+static void benchmarkCorpus(const char* name,
+                            const std::vector<HeaderBlock>& corpus,
+                            size_t rounds) {
+  Encoder encoder;
+  Decoder decoder;
+  Buffer block;
+  size_t fields = 0;
+  size_t plainBytes = 0;
+  size_t encodedBytes = 0;
+  size_t decoded = 0;
+  double encodeNanos = 0;
+  double decodeNanos = 0;
+
+  for (size_t round = 0; round < rounds; ++round) {
+    for (const HeaderBlock& headers: corpus) {
+      block.clear();
+
+      auto start = std::chrono::steady_clock::now();
+      encoder.beginHeaderBlock(&block);
+      for (const auto& field: headers)
+        encoder.encode(&block, BufferRef(field.first), BufferRef(field.second));
+      auto encoded = std::chrono::steady_clock::now();
+
+      decoder.decode(block.ref(), [&](const BufferRef& name,
+                                      const BufferRef& value, bool) {
+        decoded++;
+      });
+      auto end = std::chrono::steady_clock::now();
+
+      encodeNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+          encoded - start).count();
+      decodeNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+          end - encoded).count();
+
+      for (const auto& field: headers)
+        plainBytes += field.first.size() + field.second.size() + 4;
+
+      fields += headers.size();
+      encodedBytes += block.size();
+    }
+  }
+
+  printf("%-10s %10zu fields %6.1f ns/field encode %6.1f ns/field decode "
+         "%5.1f%% saved (%s)\n",
+         name, fields, encodeNanos / fields, decodeNanos / fields,
+         100.0 * (plainBytes - encodedBytes) / plainBytes,
+         decoded == fields ? "ok" : "MISMATCH");
+}
+
+static void benchmarkHuffman(size_t rounds) {
+  const BufferRef input =
+      "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+      "(KHTML, like Gecko) Chrome/46.0.2490.80 Safari/537.36";
+  Buffer encoded;
+  Huffman::encode(&encoded, input);
+
+  Buffer decoded;
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t round = 0; round < rounds; ++round) {
+    decoded.clear();
+    Huffman::decode(&decoded, encoded.ref());
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  const double nanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+  printf("%-10s %10zu octets %6.2f ns/octet decode\n",
+         "huffman", rounds * input.size(), nanos / (rounds * input.size()));
+}
+
+int main() {
+  benchmarkCorpus("browser", browserRequests, 200000);
+  benchmarkCorpus("api", apiResponses, 200000);
+  benchmarkHuffman(1000000);
+
+  return 0;
+}
@@ -0,0 +1,322 @@
+// This file is part of the "x0" project, http://cortex.io/
+//   (c) 2009-2014 Christian Parpart <trapni@gmail.com>
+//
+// Licensed under the MIT License (the "License"); you may not use this
+// file except in compliance with the License. You may obtain a copy of
+// the License at: http://opensource.org/licenses/MIT
+
+#include <cortex-http/http2/hpack.h>
+#include <cortex-base/Buffer.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace cortex;
+using namespace cortex::hpack;
+
+typedef std::vector<std::pair<std::string, std::string>> Fields;
+
+static Buffer fromHex(const std::string& hex) {
+  Buffer result;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2)
+    result.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), 0, 16)));
+  return result;
+}
+
+static bool decode(Decoder* decoder, const std::string& hex, Fields* fields) {
+  fields->clear();
+  Buffer block = fromHex(hex);
+  return decoder->decode(block.ref(), [&](const BufferRef& name,
+                                          const BufferRef& value,
+                                          bool sensitive) {
+    fields->emplace_back(name.str(), value.str());
+  });
+}
+
+TEST(hpack_EncoderHelper, encodeInt) {
+  // RFC 7541, C.1.1: encoding 10 using a 5-bit prefix
+  Buffer a;
+  EncoderHelper::encodeInt(&a, 0, 10, 5);
+  ASSERT_EQ(fromHex("0a"), a);
+
+  // RFC 7541, C.1.2: encoding 1337 using a 5-bit prefix
+  Buffer b;
+  EncoderHelper::encodeInt(&b, 0, 1337, 5);
+  ASSERT_EQ(fromHex("1f9a0a"), b);
+
+  // RFC 7541, C.1.3: encoding 42 starting at an octet boundary
+  Buffer c;
+  EncoderHelper::encodeInt(&c, 0, 42, 8);
+  ASSERT_EQ(fromHex("2a"), c);
+}
+
+TEST(hpack_DecoderHelper, decodeInt) {
+  uint64_t value = 0;
+
+  ASSERT_EQ(1, DecoderHelper::decodeInt(fromHex("0a").ref(), 5, &value));
+  ASSERT_EQ(10, value);
+
+  ASSERT_EQ(3, DecoderHelper::decodeInt(fromHex("1f9a0a").ref(), 5, &value));
+  ASSERT_EQ(1337, value);
+
+  // truncated continuation
+  ASSERT_EQ(0, DecoderHelper::decodeInt(fromHex("1f9a").ref(), 5, &value));
+}
+
+TEST(hpack_Huffman, roundtrip) {
+  const BufferRef input = "https://www.example.com";
+  Buffer encoded;
+  Huffman::encode(&encoded, input);
+  ASSERT_EQ(fromHex("9d29ad171863c78f0b97c8e9ae82ae43d3"), encoded);
+  ASSERT_EQ(encoded.size(), Huffman::encodeLength(input));
+
+  Buffer decoded;
+  ASSERT_TRUE(Huffman::decode(&decoded, encoded.ref()));
+  ASSERT_EQ("https://www.example.com", decoded.str());
+}
+
+TEST(hpack_Huffman, invalidPadding) {
+  Buffer decoded;
+
+  // 'a' (00011) padded with zeros instead of EOS bits
+  ASSERT_FALSE(Huffman::decode(&decoded, fromHex("18").ref()));
+
+  // padding of 8 bits or more
+  ASSERT_FALSE(Huffman::decode(&decoded, fromHex("1fff").ref()));
+}
+
+TEST(hpack_Huffman, allOctets) {
+  std::string input;
+  for (int i = 0; i < 256; ++i)
+    input.push_back(static_cast<char>(i));
+
+  Buffer encoded;
+  Huffman::encode(&encoded, BufferRef(input));
+
+  Buffer decoded;
+  ASSERT_TRUE(Huffman::decode(&decoded, encoded.ref()));
+  ASSERT_EQ(input, decoded.str());
+}
+
+TEST(hpack_Huffman, eos) {
+  Buffer decoded;
+
+  // 30 bits of EOS must never be decoded
+  ASSERT_FALSE(Huffman::decode(&decoded, fromHex("ffffffff").ref()));
+}
+
+TEST(hpack_DynamicTable, eviction) {
+  DynamicTable table(100);
+
+  table.add("name1", "value1");  // 43 octets
+  table.add("name2", "value2");  // 86 octets
+  ASSERT_EQ(2, table.length());
+  ASSERT_EQ(86, table.size());
+
+  table.add("name3", "value3");  // evicts name1
+  ASSERT_EQ(2, table.length());
+  ASSERT_EQ("name3", table.at(0).name);
+  ASSERT_EQ("name2", table.at(1).name);
+
+  table.setMaxSize(50);
+  ASSERT_EQ(1, table.length());
+  ASSERT_EQ("name3", table.at(0).name);
+}
+
+TEST(hpack_DynamicTable, wraparound) {
+  DynamicTable table(3 * 43);
+  size_t index = 0;
+  bool full = false;
+
+  // cycle the ring buffer several times over
+  for (int i = 0; i < 20; ++i) {
+    const std::string value = "value" + std::to_string(i % 10);
+    table.add(i % 2 ? "name1" : "name2", BufferRef(value));
+    ASSERT_LE(table.size(), table.maxSize());
+  }
+
+  ASSERT_EQ(3, table.length());
+  ASSERT_EQ("value9", table.at(0).value);
+  ASSERT_EQ("value8", table.at(1).value);
+  ASSERT_EQ("value7", table.at(2).value);
+
+  // the newest entry of a name wins
+  ASSERT_TRUE(table.find("name1", "value5", &index, &full));
+  ASSERT_FALSE(full);
+  ASSERT_EQ(0, index);
+
+  ASSERT_TRUE(table.find("name2", "value8", &index, &full));
+  ASSERT_TRUE(full);
+  ASSERT_EQ(1, index);
+
+  // evicted entries are gone from the index
+  ASSERT_FALSE(table.find("name1", "value5", &index, &full) && full);
+}
+
+TEST(hpack_DynamicTable, grow) {
+  DynamicTable table(43);
+  table.add("name1", "value1");
+  table.setMaxSize(4 * 43);
+  table.add("name2", "value2");
+  table.add("name3", "value3");
+
+  size_t index = 0;
+  bool full = false;
+  ASSERT_TRUE(table.find("name1", "value1", &index, &full));
+  ASSERT_TRUE(full);
+  ASSERT_EQ(2, index);
+  ASSERT_EQ("name3", table.at(0).name);
+}
+
+TEST(hpack_StaticTable, find) {
+  size_t index = 0;
+  bool full = false;
+
+  ASSERT_TRUE(StaticTable::find(":status", "404", &index, &full));
+  ASSERT_TRUE(full);
+  ASSERT_EQ(13, index);
+
+  // the lowest index of a name is preferred
+  ASSERT_TRUE(StaticTable::find(":status", "307", &index, &full));
+  ASSERT_FALSE(full);
+  ASSERT_EQ(8, index);
+
+  ASSERT_FALSE(StaticTable::find("x-custom", "", &index, &full));
+}
+
+TEST(hpack_Decoder, requestsWithHuffman) {
+  // RFC 7541, C.4
+  Decoder decoder;
+  Fields fields;
+
+  ASSERT_TRUE(decode(&decoder, "828684418cf1e3c2e5f23a6ba0ab90f4ff", &fields));
+  ASSERT_EQ(Fields({{":method", "GET"},
+                    {":scheme", "http"},
+                    {":path", "/"},
+                    {":authority", "www.example.com"}}), fields);
+  ASSERT_EQ(57, decoder.dynamicTable().size());
+
+  ASSERT_TRUE(decode(&decoder, "828684be5886a8eb10649cbf", &fields));
+  ASSERT_EQ(Fields({{":method", "GET"},
+                    {":scheme", "http"},
+                    {":path", "/"},
+                    {":authority", "www.example.com"},
+                    {"cache-control", "no-cache"}}), fields);
+  ASSERT_EQ(110, decoder.dynamicTable().size());
+
+  ASSERT_TRUE(decode(&decoder, "828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf",
+                     &fields));
+  ASSERT_EQ(Fields({{":method", "GET"},
+                    {":scheme", "https"},
+                    {":path", "/index.html"},
+                    {":authority", "www.example.com"},
+                    {"custom-key", "custom-value"}}), fields);
+  ASSERT_EQ(164, decoder.dynamicTable().size());
+}
+
+TEST(hpack_Decoder, responsesWithEviction) {
+  // RFC 7541, C.6
+  Decoder decoder(256);
+  Fields fields;
+
+  ASSERT_TRUE(decode(&decoder,
+      "488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a62d1bff"
+      "6e919d29ad171863c78f0b97c8e9ae82ae43d3", &fields));
+  ASSERT_EQ(4, fields.size());
+  ASSERT_EQ(std::make_pair(std::string("location"),
+                           std::string("https://www.example.com")), fields[3]);
+  ASSERT_EQ(222, decoder.dynamicTable().size());
+
+  ASSERT_TRUE(decode(&decoder, "4883640effc1c0bf", &fields));
+  ASSERT_EQ(std::make_pair(std::string(":status"), std::string("307")),
+            fields[0]);
+  ASSERT_EQ(222, decoder.dynamicTable().size());
+
+  ASSERT_TRUE(decode(&decoder,
+      "88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a839bd9ab77ad94"
+      "e7821dd7f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f9587316065c0"
+      "03ed4ee5b1063d5007", &fields));
+  ASSERT_EQ(6, fields.size());
+  ASSERT_EQ(std::make_pair(std::string("set-cookie"),
+                           std::string("foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; "
+                                       "max-age=3600; version=1")),
+            fields[5]);
+  ASSERT_EQ(215, decoder.dynamicTable().size());
+  ASSERT_EQ(3, decoder.dynamicTable().length());
+}
+
+TEST(hpack_Decoder, invalidIndex) {
+  Decoder decoder;
+  Fields fields;
+
+  ASSERT_FALSE(decode(&decoder, "80", &fields));  // index 0
+  ASSERT_FALSE(decode(&decoder, "be", &fields));  // empty dynamic table
+}
+
+TEST(hpack_Decoder, tableSizeUpdate) {
+  Decoder decoder;
+  Fields fields;
+
+  // update to 0 at the start of a block is fine
+  ASSERT_TRUE(decode(&decoder, "2082", &fields));
+
+  // update after a header field representation is not
+  ASSERT_FALSE(decode(&decoder, "8220", &fields));
+
+  // update beyond the advertised maximum is not
+  Decoder small(256);
+  ASSERT_FALSE(decode(&small, "3fe11f", &fields));
+}
+
+TEST(hpack_Encoder, roundtrip) {
+  Encoder encoder;
+  Decoder decoder;
+
+  const Fields response = {{":status", "200"},
+                           {"content-type", "text/html"},
+                           {"server", "cortex"},
+                           {"x-custom", "some value"},
+                           {"authorization", "secret"}};
+
+  for (int round = 0; round < 2; ++round) {
+    Buffer block;
+    encoder.beginHeaderBlock(&block);
+    for (const auto& field: response) {
+      encoder.encode(&block, BufferRef(field.first), BufferRef(field.second),
+                     field.first == "authorization");
+    }
+
+    Fields fields;
+    ASSERT_TRUE(decoder.decode(block.ref(), [&](const BufferRef& name,
+                                                const BufferRef& value,
+                                                bool sensitive) {
+      ASSERT_EQ(name == "authorization", sensitive);
+      fields.emplace_back(name.str(), value.str());
+    }));
+    ASSERT_EQ(response, fields);
+
+    if (round == 1) {
+      // everything but the sensitive field was indexed by the first block
+      ASSERT_GT(20, block.size());
+    }
+  }
+
+  ASSERT_EQ(encoder.dynamicTable().size(), decoder.dynamicTable().size());
+}
+
+TEST(hpack_Encoder, tableSizeChange) {
+  Encoder encoder;
+  Decoder decoder;
+
+  encoder.setMaxTableSize(0);
+
+  Buffer block;
+  encoder.beginHeaderBlock(&block);
+  encoder.encode(&block, "x-custom", "value");
+
+  ASSERT_TRUE(decoder.decode(block.ref(), [](const BufferRef&,
+                                             const BufferRef&, bool) {}));
+  ASSERT_EQ(0, decoder.dynamicTable().maxSize());
+  ASSERT_EQ(0, decoder.dynamicTable().length());
+}
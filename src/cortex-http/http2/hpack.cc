@@ -5,258 +5,843 @@
 // file except in compliance with the License. You may obtain a copy of
 // the License at: http://opensource.org/licenses/MIT
 
-#include <cortex-base/hpack.h>
+#include <cortex-http/http2/hpack.h>
 #include <algorithm>
-#include <inttypes.h>
+#include <vector>
+#include <string.h>
 
 namespace cortex {
 namespace hpack {
 
-// {{{ StaticTable
-StaticTable::StaticTable()
-    : entries_({/*  0 */ {"", ""},
-                /*  1 */ {":authority", ""},
-                /*  2 */ {":method", "GET"},
-                /*  3 */ {":method", "POST"},
-                /*  4 */ {":path", "/"},
-                /*  5 */ {":path", "/index.html"},
-                /*  6 */ {":scheme", "http"},
-                /*  7 */ {":scheme", "https"},
-                /*  8 */ {":status", "200"},
-                /*  9 */ {":status", "204"},
-
-                /* 10 */ {":status", "206"},
-                /* 11 */ {":status", "304"},
-                /* 12 */ {":status", "400"},
-                /* 13 */ {":status", "404"},
-                /* 14 */ {":status", "500"},
-                /* 15 */ {"accept-charset", ""},
-                /* 16 */ {"accept-encoding", "gzip, deflate"},
-                /* 17 */ {"accept-language", ""},
-                /* 18 */ {"accept-ranges", ""},
-                /* 19 */ {"accept", ""},
-
-                /* 20 */ {"access-control-allow-origin", ""},
-                /* 21 */ {"age", ""},
-                /* 22 */ {"allow", ""},
-                /* 23 */ {"authorization", ""},
-                /* 24 */ {"cache-control", ""},
-                /* 25 */ {"content-disposition", ""},
-                /* 26 */ {"content-encoding", ""},
-                /* 27 */ {"content-language", ""},
-                /* 28 */ {"content-length", ""},
-                /* 29 */ {"content-location", ""},
-
-                /* 30 */ {"content-range", ""},
-                /* 31 */ {"content-type", ""},
-                /* 32 */ {"cookie", ""},
-                /* 33 */ {"date", ""},
-                /* 34 */ {"etag", ""},
-                /* 35 */ {"expect", ""},
-                /* 36 */ {"expires", ""},
-                /* 37 */ {"from", ""},
-                /* 38 */ {"host", ""},
-                /* 39 */ {"if-match", ""},
-
-                /* 40 */ {"if-modified-since", ""},
-                /* 41 */ {"if-none-match", ""},
-                /* 42 */ {"if-range", ""},
-                /* 43 */ {"if-unmodified-since", ""},
-                /* 44 */ {"last-modified", ""},
-                /* 45 */ {"link", ""},
-                /* 46 */ {"location", ""},
-                /* 47 */ {"max-forwards", ""},
-
-                /* 48 */ {"proxy-authenticate", ""},
-                /* 49 */ {"proxy-authorization", ""},
-                /* 50 */ {"range", ""},
-                /* 51 */ {"referer", ""},
-                /* 52 */ {"refresh", ""},
-                /* 53 */ {"retry-after", ""},
-                /* 54 */ {"server", ""},
-                /* 55 */ {"set-cookie", ""},
-                /* 56 */ {"strict-transport-security", ""},
-                /* 57 */ {"transfer-encoding", ""},
-                /* 58 */ {"user-agent", ""},
-                /* 59 */ {"vary", ""},
-                /* 60 */ {"via", ""},
-                /* 61 */ {"www-authenticate", ""}}) {}
-
-StaticTable::~StaticTable() {}
-
-StaticTable* StaticTable::get() {
-  static StaticTable table;
-  return &table;
-}
-// }}}
-// {{{ HeaderTable
-HeaderTable::HeaderTable(size_t maxEntries)
-    : maxEntries_(maxEntries), entries_(), referenceSets_() {}
+// {{{ HeaderFieldIndex
+// Multiplicative hashing of eight octets per step, with the value hash
+// chained onto the name's.
+static inline uint32_t hashValue(uint32_t seed, const char* data, size_t n) {
+  constexpr uint64_t K = 0x9e3779b97f4a7c15ull;
+  uint64_t h = seed ^ (n * K);
 
-HeaderTable::~HeaderTable() {
-  assert(referenceSets_.empty() &&
-         "There shall be no reference set at header table destruction.");
-}
-
-void HeaderTable::setMaxEntries(size_t limit) {
-  maxEntries_ = limit;
+  for (; n >= 8; data += 8, n -= 8) {
+    uint64_t word;
+    memcpy(&word, data, 8);
+    h = ((h << 5 | h >> 59) ^ word) * K;
+  }
 
-  while (size() > limit) {
-    entries_.pop_back();
+  if (n != 0) {
+    uint64_t word = 0;
+    for (size_t i = 0; i != n; ++i)
+      word |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    h = ((h << 5 | h >> 59) ^ word) * K;
   }
+
+  return static_cast<uint32_t>(h ^ (h >> 32));
 }
 
-void HeaderTable::add(const HeaderField& field) {
-  while (size() >= maxEntries()) {
-    entries_.pop_back();
-  }
+static inline uint32_t hashName(const char* data, size_t n) {
+  return hashValue(0, data, n);
+}
 
-  entries_.push_front(field);
+static inline bool equals(const std::string& a, const BufferRef& b) {
+  return a.size() == b.size() && memcmp(a.data(), b.data(), b.size()) == 0;
 }
 
-HeaderTable::iterator HeaderTable::find(const HeaderFieldName& name) {
-  return std::find_if(entries_.begin(), entries_.end(),
-                      [&](const HeaderField& f) {
-    // just test on header name
-    return f.name == name;
-  });
+HeaderFieldHash::HeaderFieldHash(const BufferRef& n, const BufferRef& v)
+    : name(hashName(n.data(), n.size())),
+      field(hashValue(name, v.data(), v.size())) {
 }
 
-HeaderTable::const_iterator HeaderTable::find(
-    const HeaderFieldName& name) const {
-  return std::find_if(entries_.cbegin(), entries_.cend(),
-                      [&](const HeaderField& f) {
-    // just test on header name
-    return f.name == name;
-  });
+HeaderFieldIndex::HeaderFieldIndex() : buckets_(), mask_(0) {
 }
 
-bool HeaderTable::contains(const HeaderField* field) const {
-  auto i = std::find_if(entries_.cbegin(), entries_.cend(),
-                        [&](const HeaderField& f) { return &f == field; });
+void HeaderFieldIndex::reset(size_t maxKeys) {
+  // keep the load factor at or below 50%
+  size_t capacity = 8;
+  while (capacity < 2 * maxKeys)
+    capacity *= 2;
 
-  return i != cend();
+  buckets_.assign(capacity, Bucket{0, 0, false});
+  mask_ = capacity - 1;
 }
 
-void HeaderTable::remove(const HeaderFieldName& name) {
-  auto i = find(name);
+template<typename Equals>
+bool HeaderFieldIndex::find(uint32_t hash, const Equals& equals,
+                            uint64_t* id) const {
+  for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+    const Bucket& bucket = buckets_[i];
+    if (!bucket.used)
+      return false;
 
-  if (i != entries_.end()) {
-    for (ReferenceSet* rs : referenceSets_) {
-      rs->remove(&*i);
+    if (bucket.hash == hash && equals(bucket.id)) {
+      *id = bucket.id;
+      return true;
     }
-    entries_.erase(i);
   }
 }
 
-void HeaderTable::remove(const HeaderField* field) {
-  auto i = std::find_if(begin(), end(),
-                        [&](const HeaderField& f) { return &f == field; });
+template<typename Equals>
+void HeaderFieldIndex::insert(uint32_t hash, const Equals& equals,
+                              uint64_t id) {
+  for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+    Bucket& bucket = buckets_[i];
+    if (!bucket.used) {
+      bucket = Bucket{id, hash, true};
+      return;
+    }
 
-  if (i != entries_.end()) {
-    for (ReferenceSet* rs : referenceSets_) {
-      rs->remove(&*i);
+    if (bucket.hash == hash && equals(bucket.id)) {
+      bucket.id = id;
+      return;
     }
-    entries_.erase(i);
   }
 }
 
-void HeaderTable::clear() {
-  for (const HeaderField& entry : entries_) {
-    for (ReferenceSet* rs : referenceSets_) {
-      rs->remove(&entry);
+void HeaderFieldIndex::erase(uint32_t hash, uint64_t id) {
+  size_t i = hash & mask_;
+
+  for (;; i = (i + 1) & mask_) {
+    if (!buckets_[i].used)
+      return;
+
+    if (buckets_[i].id == id)
+      break;
+  }
+
+  // backward shift deletion, keeping all probe sequences gap-free
+  for (size_t j = (i + 1) & mask_; buckets_[j].used; j = (j + 1) & mask_) {
+    const size_t home = buckets_[j].hash & mask_;
+    const bool movable = i <= j ? (home <= i || home > j)
+                                : (home <= i && home > j);
+    if (movable) {
+      buckets_[i] = buckets_[j];
+      i = j;
     }
   }
 
-  entries_.clear();
+  buckets_[i].used = false;
+}
+// }}}
+// {{{ StaticTable
+static const HeaderField staticEntries[StaticTable::Length] = {
+  /*  1 */ {":authority", ""},
+  /*  2 */ {":method", "GET"},
+  /*  3 */ {":method", "POST"},
+  /*  4 */ {":path", "/"},
+  /*  5 */ {":path", "/index.html"},
+  /*  6 */ {":scheme", "http"},
+  /*  7 */ {":scheme", "https"},
+  /*  8 */ {":status", "200"},
+  /*  9 */ {":status", "204"},
+  /* 10 */ {":status", "206"},
+  /* 11 */ {":status", "304"},
+  /* 12 */ {":status", "400"},
+  /* 13 */ {":status", "404"},
+  /* 14 */ {":status", "500"},
+  /* 15 */ {"accept-charset", ""},
+  /* 16 */ {"accept-encoding", "gzip, deflate"},
+  /* 17 */ {"accept-language", ""},
+  /* 18 */ {"accept-ranges", ""},
+  /* 19 */ {"accept", ""},
+  /* 20 */ {"access-control-allow-origin", ""},
+  /* 21 */ {"age", ""},
+  /* 22 */ {"allow", ""},
+  /* 23 */ {"authorization", ""},
+  /* 24 */ {"cache-control", ""},
+  /* 25 */ {"content-disposition", ""},
+  /* 26 */ {"content-encoding", ""},
+  /* 27 */ {"content-language", ""},
+  /* 28 */ {"content-length", ""},
+  /* 29 */ {"content-location", ""},
+  /* 30 */ {"content-range", ""},
+  /* 31 */ {"content-type", ""},
+  /* 32 */ {"cookie", ""},
+  /* 33 */ {"date", ""},
+  /* 34 */ {"etag", ""},
+  /* 35 */ {"expect", ""},
+  /* 36 */ {"expires", ""},
+  /* 37 */ {"from", ""},
+  /* 38 */ {"host", ""},
+  /* 39 */ {"if-match", ""},
+  /* 40 */ {"if-modified-since", ""},
+  /* 41 */ {"if-none-match", ""},
+  /* 42 */ {"if-range", ""},
+  /* 43 */ {"if-unmodified-since", ""},
+  /* 44 */ {"last-modified", ""},
+  /* 45 */ {"link", ""},
+  /* 46 */ {"location", ""},
+  /* 47 */ {"max-forwards", ""},
+  /* 48 */ {"proxy-authenticate", ""},
+  /* 49 */ {"proxy-authorization", ""},
+  /* 50 */ {"range", ""},
+  /* 51 */ {"referer", ""},
+  /* 52 */ {"refresh", ""},
+  /* 53 */ {"retry-after", ""},
+  /* 54 */ {"server", ""},
+  /* 55 */ {"set-cookie", ""},
+  /* 56 */ {"strict-transport-security", ""},
+  /* 57 */ {"transfer-encoding", ""},
+  /* 58 */ {"user-agent", ""},
+  /* 59 */ {"vary", ""},
+  /* 60 */ {"via", ""},
+  /* 61 */ {"www-authenticate", ""},
+};
+
+const HeaderField& StaticTable::at(size_t index) {
+  assert(index >= 1 && index <= Length);
+  return staticEntries[index - 1];
 }
 
-void HeaderTable::link(ReferenceSet* ref) { referenceSets_.push_back(ref); }
+/**
+ * Name and name-value indices over the static table, mapping to the
+ * lowest 1-based index of each key.
+ */
+struct StaticTableIndex {
+  HeaderFieldIndex names;
+  HeaderFieldIndex fields;
+
+  StaticTableIndex();
+  static const StaticTableIndex& get();
+};
+
+StaticTableIndex::StaticTableIndex() {
+  names.reset(StaticTable::Length);
+  fields.reset(StaticTable::Length);
 
-void HeaderTable::unlink(ReferenceSet* ref) {
-  auto i = std::find(referenceSets_.begin(), referenceSets_.end(), ref);
-  if (i != referenceSets_.end()) {
-    referenceSets_.erase(i);
+  for (size_t i = StaticTable::Length; i >= 1; --i) {
+    const HeaderField& field = StaticTable::at(i);
+    const uint32_t nameHash = hashName(field.name.data(), field.name.size());
+    const uint32_t fieldHash = hashValue(nameHash, field.value.data(),
+                                         field.value.size());
+
+    // walking backwards lets lower indices replace higher ones
+    names.insert(nameHash, [&](uint64_t id) {
+      return StaticTable::at(id).name == field.name;
+    }, i);
+    fields.insert(fieldHash, [&](uint64_t id) {
+      return StaticTable::at(id) == field;
+    }, i);
   }
 }
-// }}}
-// {{{ ReferenceSet
-ReferenceSet::ReferenceSet(HeaderTable* headerTable)
-    : headerTable_(headerTable), references_() {
 
-  headerTable_->link(this);
+const StaticTableIndex& StaticTableIndex::get() {
+  static StaticTableIndex index;
+  return index;
 }
 
-ReferenceSet::~ReferenceSet() {
-  //.
-  headerTable_->unlink(this);
+bool StaticTable::find(const BufferRef& name, const BufferRef& value,
+                       size_t* index, bool* nameValueMatch) {
+  return find(name, value, HeaderFieldHash(name, value), index,
+              nameValueMatch);
 }
 
-bool ReferenceSet::empty() const {
-  //.
-  return references_.empty();
+bool StaticTable::find(const BufferRef& name, const BufferRef& value,
+                       const HeaderFieldHash& hash,
+                       size_t* index, bool* nameValueMatch) {
+  const StaticTableIndex& tables = StaticTableIndex::get();
+  uint64_t found = 0;
+
+  if (!tables.names.find(hash.name, [&](uint64_t id) {
+        return equals(StaticTable::at(id).name, name);
+      }, &found))
+    return false;
+
+  *index = found;
+  *nameValueMatch = false;
+
+  if (tables.fields.find(hash.field, [&](uint64_t id) {
+        const HeaderField& field = StaticTable::at(id);
+        return equals(field.name, name) && equals(field.value, value);
+      }, &found)) {
+    *index = found;
+    *nameValueMatch = true;
+  }
+
+  return true;
+}
+// }}}
+// {{{ DynamicTable
+DynamicTable::DynamicTable(size_t maxSize)
+    : maxSize_(maxSize),
+      size_(0),
+      length_(0),
+      inserted_(0),
+      entries_(),
+      nameIndex_(),
+      fieldIndex_() {
+  reserve(maxSize);
 }
 
-size_t ReferenceSet::size() const {
-  //.
-  return references_.size();
+DynamicTable::~DynamicTable() {
 }
 
-void ReferenceSet::add(const HeaderField* field) {
-  if (headerTable_->contains(field)) {
-    if (!contains(field)) {
-      references_.push_back(field);
-    }
+/**
+ * Resizes the ring buffer and indices to hold the maximum number of
+ * entries a table of @p maxSize octets can contain.
+ *
+ * One spare slot ensures that add() never overwrites an entry that was
+ * live before the call, as its arguments may still refer to it.
+ */
+void DynamicTable::reserve(size_t maxSize) {
+  const size_t capacity = maxSize / HeaderFieldOverhead + 1;
+
+  if (capacity <= entries_.size())
+    return;
+
+  std::vector<HeaderField> entries(capacity);
+  for (uint64_t seq = inserted_ - length_; seq != inserted_; ++seq)
+    entries[seq % capacity] = std::move(entry(seq));
+  entries_.swap(entries);
+
+  nameIndex_.reset(capacity);
+  fieldIndex_.reset(capacity);
+
+  for (uint64_t seq = inserted_ - length_; seq != inserted_; ++seq) {
+    const HeaderField& field = entry(seq);
+    const uint32_t nameHash = hashName(field.name.data(), field.name.size());
+    const uint32_t fieldHash = hashValue(nameHash, field.value.data(),
+                                         field.value.size());
+
+    // oldest first, so that the newest entry of each key wins
+    nameIndex_.insert(nameHash, [&](uint64_t id) {
+      return entry(id).name == field.name;
+    }, seq);
+    fieldIndex_.insert(fieldHash, [&](uint64_t id) {
+      return entry(id) == field;
+    }, seq);
   }
 }
 
-bool ReferenceSet::contains(const HeaderField* field) const {
-  auto i = std::find(references_.begin(), references_.end(), field);
-  return i != references_.end();
+void DynamicTable::setMaxSize(size_t value) {
+  maxSize_ = value;
+  evict(0);
+  reserve(value);
+}
+
+void DynamicTable::add(const BufferRef& name, const BufferRef& value) {
+  const size_t required = name.size() + value.size() + HeaderFieldOverhead;
+
+  if (required > maxSize_) {
+    // RFC 7541, Section 4.4: not an error, but empties the table.
+    clear();
+    return;
+  }
+
+  // Evicted entries keep their storage until their slot gets reused,
+  // which reserve() guarantees not to happen within this call.
+  evict(required);
+
+  const uint64_t seq = inserted_;
+  HeaderField& field = entry(seq);
+  field.name.assign(name.data(), name.size());
+  field.value.assign(value.data(), value.size());
+  inserted_++;
+  length_++;
+  size_ += required;
+
+  const uint32_t nameHash = hashName(name.data(), name.size());
+  const uint32_t fieldHash = hashValue(nameHash, value.data(), value.size());
+
+  nameIndex_.insert(nameHash, [&](uint64_t id) {
+    return entry(id).name == field.name;
+  }, seq);
+  fieldIndex_.insert(fieldHash, [&](uint64_t id) {
+    return entry(id) == field;
+  }, seq);
 }
 
-void ReferenceSet::remove(const HeaderField* field) {
-  auto i = std::find(references_.begin(), references_.end(), field);
-  if (i != references_.end()) {
-    references_.erase(i);
+void DynamicTable::evict(size_t required) {
+  while (length_ != 0 && size_ + required > maxSize_) {
+    const uint64_t seq = inserted_ - length_;
+    const HeaderField& field = entry(seq);
+    const uint32_t nameHash = hashName(field.name.data(), field.name.size());
+    const uint32_t fieldHash = hashValue(nameHash, field.value.data(),
+                                         field.value.size());
+
+    // As the oldest entry, it is only indexed if no newer entry shares its key.
+    nameIndex_.erase(nameHash, seq);
+    fieldIndex_.erase(fieldHash, seq);
+
+    size_ -= field.size();
+    length_--;
   }
 }
 
-ReferenceSet::iterator ReferenceSet::begin() {
-  return iterator(this, references_.begin());
+bool DynamicTable::find(const BufferRef& name, const BufferRef& value,
+                        size_t* index, bool* nameValueMatch) const {
+  return find(name, value, HeaderFieldHash(name, value), index,
+              nameValueMatch);
 }
 
-ReferenceSet::iterator ReferenceSet::end() {
-  return iterator(this, references_.end());
+bool DynamicTable::find(const BufferRef& name, const BufferRef& value,
+                        const HeaderFieldHash& hash,
+                        size_t* index, bool* nameValueMatch) const {
+  uint64_t seq = 0;
+
+  if (!nameIndex_.find(hash.name, [&](uint64_t id) {
+        return equals(entry(id).name, name);
+      }, &seq))
+    return false;
+
+  *index = inserted_ - 1 - seq;
+  *nameValueMatch = false;
+
+  if (fieldIndex_.find(hash.field, [&](uint64_t id) {
+        const HeaderField& field = entry(id);
+        return equals(field.name, name) && equals(field.value, value);
+      }, &seq)) {
+    *index = inserted_ - 1 - seq;
+    *nameValueMatch = true;
+  }
+
+  return true;
+}
+
+void DynamicTable::clear() {
+  evict(maxSize_ + 1);
 }
 // }}}
-// {{{ ReferenceSet::iterator
-ReferenceSet::iterator::iterator()
-    : referenceSet_(nullptr), current_(), end_() {}
+// {{{ Huffman
+struct HuffmanCode {
+  uint32_t code;
+  uint8_t bits;
+};
+
+static const HuffmanCode huffmanCodes[257] = {
+  /*   0       */ {0x00001ff8, 13},
+  /*   1       */ {0x007fffd8, 23},
+  /*   2       */ {0x0fffffe2, 28},
+  /*   3       */ {0x0fffffe3, 28},
+  /*   4       */ {0x0fffffe4, 28},
+  /*   5       */ {0x0fffffe5, 28},
+  /*   6       */ {0x0fffffe6, 28},
+  /*   7       */ {0x0fffffe7, 28},
+  /*   8       */ {0x0fffffe8, 28},
+  /*   9       */ {0x00ffffea, 24},
+  /*  10       */ {0x3ffffffc, 30},
+  /*  11       */ {0x0fffffe9, 28},
+  /*  12       */ {0x0fffffea, 28},
+  /*  13       */ {0x3ffffffd, 30},
+  /*  14       */ {0x0fffffeb, 28},
+  /*  15       */ {0x0fffffec, 28},
+  /*  16       */ {0x0fffffed, 28},
+  /*  17       */ {0x0fffffee, 28},
+  /*  18       */ {0x0fffffef, 28},
+  /*  19       */ {0x0ffffff0, 28},
+  /*  20       */ {0x0ffffff1, 28},
+  /*  21       */ {0x0ffffff2, 28},
+  /*  22       */ {0x3ffffffe, 30},
+  /*  23       */ {0x0ffffff3, 28},
+  /*  24       */ {0x0ffffff4, 28},
+  /*  25       */ {0x0ffffff5, 28},
+  /*  26       */ {0x0ffffff6, 28},
+  /*  27       */ {0x0ffffff7, 28},
+  /*  28       */ {0x0ffffff8, 28},
+  /*  29       */ {0x0ffffff9, 28},
+  /*  30       */ {0x0ffffffa, 28},
+  /*  31       */ {0x0ffffffb, 28},
+  /*  32 ' '   */ {0x00000014,  6},
+  /*  33 '!'   */ {0x000003f8, 10},
+  /*  34 '"'   */ {0x000003f9, 10},
+  /*  35 '#'   */ {0x00000ffa, 12},
+  /*  36 '$'   */ {0x00001ff9, 13},
+  /*  37 '%'   */ {0x00000015,  6},
+  /*  38 '&'   */ {0x000000f8,  8},
+  /*  39 "'"   */ {0x000007fa, 11},
+  /*  40 '('   */ {0x000003fa, 10},
+  /*  41 ')'   */ {0x000003fb, 10},
+  /*  42 '*'   */ {0x000000f9,  8},
+  /*  43 '+'   */ {0x000007fb, 11},
+  /*  44 ','   */ {0x000000fa,  8},
+  /*  45 '-'   */ {0x00000016,  6},
+  /*  46 '.'   */ {0x00000017,  6},
+  /*  47 '/'   */ {0x00000018,  6},
+  /*  48 '0'   */ {0x00000000,  5},
+  /*  49 '1'   */ {0x00000001,  5},
+  /*  50 '2'   */ {0x00000002,  5},
+  /*  51 '3'   */ {0x00000019,  6},
+  /*  52 '4'   */ {0x0000001a,  6},
+  /*  53 '5'   */ {0x0000001b,  6},
+  /*  54 '6'   */ {0x0000001c,  6},
+  /*  55 '7'   */ {0x0000001d,  6},
+  /*  56 '8'   */ {0x0000001e,  6},
+  /*  57 '9'   */ {0x0000001f,  6},
+  /*  58 ':'   */ {0x0000005c,  7},
+  /*  59 ';'   */ {0x000000fb,  8},
+  /*  60 '<'   */ {0x00007ffc, 15},
+  /*  61 '='   */ {0x00000020,  6},
+  /*  62 '>'   */ {0x00000ffb, 12},
+  /*  63 '?'   */ {0x000003fc, 10},
+  /*  64 '@'   */ {0x00001ffa, 13},
+  /*  65 'A'   */ {0x00000021,  6},
+  /*  66 'B'   */ {0x0000005d,  7},
+  /*  67 'C'   */ {0x0000005e,  7},
+  /*  68 'D'   */ {0x0000005f,  7},
+  /*  69 'E'   */ {0x00000060,  7},
+  /*  70 'F'   */ {0x00000061,  7},
+  /*  71 'G'   */ {0x00000062,  7},
+  /*  72 'H'   */ {0x00000063,  7},
+  /*  73 'I'   */ {0x00000064,  7},
+  /*  74 'J'   */ {0x00000065,  7},
+  /*  75 'K'   */ {0x00000066,  7},
+  /*  76 'L'   */ {0x00000067,  7},
+  /*  77 'M'   */ {0x00000068,  7},
+  /*  78 'N'   */ {0x00000069,  7},
+  /*  79 'O'   */ {0x0000006a,  7},
+  /*  80 'P'   */ {0x0000006b,  7},
+  /*  81 'Q'   */ {0x0000006c,  7},
+  /*  82 'R'   */ {0x0000006d,  7},
+  /*  83 'S'   */ {0x0000006e,  7},
+  /*  84 'T'   */ {0x0000006f,  7},
+  /*  85 'U'   */ {0x00000070,  7},
+  /*  86 'V'   */ {0x00000071,  7},
+  /*  87 'W'   */ {0x00000072,  7},
+  /*  88 'X'   */ {0x000000fc,  8},
+  /*  89 'Y'   */ {0x00000073,  7},
+  /*  90 'Z'   */ {0x000000fd,  8},
+  /*  91 '['   */ {0x00001ffb, 13},
+  /*  92 '\\'  */ {0x0007fff0, 19},
+  /*  93 ']'   */ {0x00001ffc, 13},
+  /*  94 '^'   */ {0x00003ffc, 14},
+  /*  95 '_'   */ {0x00000022,  6},
+  /*  96 '`'   */ {0x00007ffd, 15},
+  /*  97 'a'   */ {0x00000003,  5},
+  /*  98 'b'   */ {0x00000023,  6},
+  /*  99 'c'   */ {0x00000004,  5},
+  /* 100 'd'   */ {0x00000024,  6},
+  /* 101 'e'   */ {0x00000005,  5},
+  /* 102 'f'   */ {0x00000025,  6},
+  /* 103 'g'   */ {0x00000026,  6},
+  /* 104 'h'   */ {0x00000027,  6},
+  /* 105 'i'   */ {0x00000006,  5},
+  /* 106 'j'   */ {0x00000074,  7},
+  /* 107 'k'   */ {0x00000075,  7},
+  /* 108 'l'   */ {0x00000028,  6},
+  /* 109 'm'   */ {0x00000029,  6},
+  /* 110 'n'   */ {0x0000002a,  6},
+  /* 111 'o'   */ {0x00000007,  5},
+  /* 112 'p'   */ {0x0000002b,  6},
+  /* 113 'q'   */ {0x00000076,  7},
+  /* 114 'r'   */ {0x0000002c,  6},
+  /* 115 's'   */ {0x00000008,  5},
+  /* 116 't'   */ {0x00000009,  5},
+  /* 117 'u'   */ {0x0000002d,  6},
+  /* 118 'v'   */ {0x00000077,  7},
+  /* 119 'w'   */ {0x00000078,  7},
+  /* 120 'x'   */ {0x00000079,  7},
+  /* 121 'y'   */ {0x0000007a,  7},
+  /* 122 'z'   */ {0x0000007b,  7},
+  /* 123 '{'   */ {0x00007ffe, 15},
+  /* 124 '|'   */ {0x000007fc, 11},
+  /* 125 '}'   */ {0x00003ffd, 14},
+  /* 126 '~'   */ {0x00001ffd, 13},
+  /* 127       */ {0x0ffffffc, 28},
+  /* 128       */ {0x000fffe6, 20},
+  /* 129       */ {0x003fffd2, 22},
+  /* 130       */ {0x000fffe7, 20},
+  /* 131       */ {0x000fffe8, 20},
+  /* 132       */ {0x003fffd3, 22},
+  /* 133       */ {0x003fffd4, 22},
+  /* 134       */ {0x003fffd5, 22},
+  /* 135       */ {0x007fffd9, 23},
+  /* 136       */ {0x003fffd6, 22},
+  /* 137       */ {0x007fffda, 23},
+  /* 138       */ {0x007fffdb, 23},
+  /* 139       */ {0x007fffdc, 23},
+  /* 140       */ {0x007fffdd, 23},
+  /* 141       */ {0x007fffde, 23},
+  /* 142       */ {0x00ffffeb, 24},
+  /* 143       */ {0x007fffdf, 23},
+  /* 144       */ {0x00ffffec, 24},
+  /* 145       */ {0x00ffffed, 24},
+  /* 146       */ {0x003fffd7, 22},
+  /* 147       */ {0x007fffe0, 23},
+  /* 148       */ {0x00ffffee, 24},
+  /* 149       */ {0x007fffe1, 23},
+  /* 150       */ {0x007fffe2, 23},
+  /* 151       */ {0x007fffe3, 23},
+  /* 152       */ {0x007fffe4, 23},
+  /* 153       */ {0x001fffdc, 21},
+  /* 154       */ {0x003fffd8, 22},
+  /* 155       */ {0x007fffe5, 23},
+  /* 156       */ {0x003fffd9, 22},
+  /* 157       */ {0x007fffe6, 23},
+  /* 158       */ {0x007fffe7, 23},
+  /* 159       */ {0x00ffffef, 24},
+  /* 160       */ {0x003fffda, 22},
+  /* 161       */ {0x001fffdd, 21},
+  /* 162       */ {0x000fffe9, 20},
+  /* 163       */ {0x003fffdb, 22},
+  /* 164       */ {0x003fffdc, 22},
+  /* 165       */ {0x007fffe8, 23},
+  /* 166       */ {0x007fffe9, 23},
+  /* 167       */ {0x001fffde, 21},
+  /* 168       */ {0x007fffea, 23},
+  /* 169       */ {0x003fffdd, 22},
+  /* 170       */ {0x003fffde, 22},
+  /* 171       */ {0x00fffff0, 24},
+  /* 172       */ {0x001fffdf, 21},
+  /* 173       */ {0x003fffdf, 22},
+  /* 174       */ {0x007fffeb, 23},
+  /* 175       */ {0x007fffec, 23},
+  /* 176       */ {0x001fffe0, 21},
+  /* 177       */ {0x001fffe1, 21},
+  /* 178       */ {0x003fffe0, 22},
+  /* 179       */ {0x001fffe2, 21},
+  /* 180       */ {0x007fffed, 23},
+  /* 181       */ {0x003fffe1, 22},
+  /* 182       */ {0x007fffee, 23},
+  /* 183       */ {0x007fffef, 23},
+  /* 184       */ {0x000fffea, 20},
+  /* 185       */ {0x003fffe2, 22},
+  /* 186       */ {0x003fffe3, 22},
+  /* 187       */ {0x003fffe4, 22},
+  /* 188       */ {0x007ffff0, 23},
+  /* 189       */ {0x003fffe5, 22},
+  /* 190       */ {0x003fffe6, 22},
+  /* 191       */ {0x007ffff1, 23},
+  /* 192       */ {0x03ffffe0, 26},
+  /* 193       */ {0x03ffffe1, 26},
+  /* 194       */ {0x000fffeb, 20},
+  /* 195       */ {0x0007fff1, 19},
+  /* 196       */ {0x003fffe7, 22},
+  /* 197       */ {0x007ffff2, 23},
+  /* 198       */ {0x003fffe8, 22},
+  /* 199       */ {0x01ffffec, 25},
+  /* 200       */ {0x03ffffe2, 26},
+  /* 201       */ {0x03ffffe3, 26},
+  /* 202       */ {0x03ffffe4, 26},
+  /* 203       */ {0x07ffffde, 27},
+  /* 204       */ {0x07ffffdf, 27},
+  /* 205       */ {0x03ffffe5, 26},
+  /* 206       */ {0x00fffff1, 24},
+  /* 207       */ {0x01ffffed, 25},
+  /* 208       */ {0x0007fff2, 19},
+  /* 209       */ {0x001fffe3, 21},
+  /* 210       */ {0x03ffffe6, 26},
+  /* 211       */ {0x07ffffe0, 27},
+  /* 212       */ {0x07ffffe1, 27},
+  /* 213       */ {0x03ffffe7, 26},
+  /* 214       */ {0x07ffffe2, 27},
+  /* 215       */ {0x00fffff2, 24},
+  /* 216       */ {0x001fffe4, 21},
+  /* 217       */ {0x001fffe5, 21},
+  /* 218       */ {0x03ffffe8, 26},
+  /* 219       */ {0x03ffffe9, 26},
+  /* 220       */ {0x0ffffffd, 28},
+  /* 221       */ {0x07ffffe3, 27},
+  /* 222       */ {0x07ffffe4, 27},
+  /* 223       */ {0x07ffffe5, 27},
+  /* 224       */ {0x000fffec, 20},
+  /* 225       */ {0x00fffff3, 24},
+  /* 226       */ {0x000fffed, 20},
+  /* 227       */ {0x001fffe6, 21},
+  /* 228       */ {0x003fffe9, 22},
+  /* 229       */ {0x001fffe7, 21},
+  /* 230       */ {0x001fffe8, 21},
+  /* 231       */ {0x007ffff3, 23},
+  /* 232       */ {0x003fffea, 22},
+  /* 233       */ {0x003fffeb, 22},
+  /* 234       */ {0x01ffffee, 25},
+  /* 235       */ {0x01ffffef, 25},
+  /* 236       */ {0x00fffff4, 24},
+  /* 237       */ {0x00fffff5, 24},
+  /* 238       */ {0x03ffffea, 26},
+  /* 239       */ {0x007ffff4, 23},
+  /* 240       */ {0x03ffffeb, 26},
+  /* 241       */ {0x07ffffe6, 27},
+  /* 242       */ {0x03ffffec, 26},
+  /* 243       */ {0x03ffffed, 26},
+  /* 244       */ {0x07ffffe7, 27},
+  /* 245       */ {0x07ffffe8, 27},
+  /* 246       */ {0x07ffffe9, 27},
+  /* 247       */ {0x07ffffea, 27},
+  /* 248       */ {0x07ffffeb, 27},
+  /* 249       */ {0x0ffffffe, 28},
+  /* 250       */ {0x07ffffec, 27},
+  /* 251       */ {0x07ffffed, 27},
+  /* 252       */ {0x07ffffee, 27},
+  /* 253       */ {0x07ffffef, 27},
+  /* 254       */ {0x07fffff0, 27},
+  /* 255       */ {0x03ffffee, 26},
+  /* 256 EOS   */ {0x3fffffff, 30},
+};
+
+static constexpr unsigned HuffmanEOS = 256;
 
-ReferenceSet::iterator::iterator(ReferenceSet* rs,
-                                 std::list<const HeaderField*>::iterator init)
-    : referenceSet_(rs), current_(init), end_(rs->references_.end()) {}
+/**
+ * Huffman decoding state machine, consuming four bits per transition.
+ *
+ * Each state is an inner node of the code tree, i.e. the bits consumed
+ * since the last complete symbol. As no code is shorter than five bits,
+ * a transition completes at most one symbol.
+ */
+class HuffmanDecodeTable {
+ public:
+  enum Flags : uint8_t {
+    Emit = 1,     //!< the transition completed @c symbol
+    Fail = 2,     //!< the transition ran into EOS
+    Accept = 4,   //!< target state is valid padding (Section 5.2)
+  };
+
+  struct Transition {
+    uint8_t state;
+    uint8_t flags;
+    uint8_t symbol;
+  };
+
+  HuffmanDecodeTable();
+
+  const Transition& next(unsigned state, unsigned nibble) const {
+    return transitions_[state][nibble];
+  }
+
+  static const HuffmanDecodeTable& get();
+
+ private:
+  Transition transitions_[256][16];
+};
+
+HuffmanDecodeTable::HuffmanDecodeTable() {
+  // build the code tree first
+  struct Node {
+    int16_t next[2];  //!< child node index, or 0 if none
+    int16_t symbol;   //!< decoded symbol of a leaf, or -1 for inner nodes
+  };
+
+  std::vector<Node> nodes;
+  nodes.reserve(2 * 257);
+  nodes.push_back(Node{{0, 0}, -1});
+
+  for (unsigned sym = 0; sym <= HuffmanEOS; ++sym) {
+    const HuffmanCode& hc = huffmanCodes[sym];
+    size_t current = 0;
+
+    for (int bit = hc.bits - 1; bit >= 0; --bit) {
+      const unsigned b = (hc.code >> bit) & 1;
+      if (nodes[current].next[b] == 0) {
+        nodes[current].next[b] = static_cast<int16_t>(nodes.size());
+        nodes.push_back(Node{{0, 0}, -1});
+      }
+      current = nodes[current].next[b];
+    }
 
-ReferenceSet::iterator& ReferenceSet::iterator::operator++() {
-  if (current_ != end_) {
-    ++current_;
+    nodes[current].symbol = static_cast<int16_t>(sym);
   }
 
-  return *this;
+  // number the inner nodes, which are exactly 256 for 257 leafs,
+  // and find those reachable from the root by up to 7 one-bits
+  std::vector<int> stateOf(nodes.size(), -1);
+  std::vector<size_t> nodeOf;
+  std::vector<bool> accepting;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].symbol < 0) {
+      stateOf[i] = static_cast<int>(nodeOf.size());
+      nodeOf.push_back(i);
+      accepting.push_back(false);
+    }
+  }
+  assert(nodeOf.size() == 256);
+
+  for (size_t i = 0, depth = 0; depth < 8 && nodes[i].symbol < 0; ++depth) {
+    accepting[stateOf[i]] = true;
+    i = nodes[i].next[1];
+  }
+
+  for (size_t state = 0; state < 256; ++state) {
+    for (unsigned nibble = 0; nibble < 16; ++nibble) {
+      Transition& t = transitions_[state][nibble];
+      size_t current = nodeOf[state];
+      t = Transition{0, 0, 0};
+
+      for (int bit = 3; bit >= 0; --bit) {
+        current = nodes[current].next[(nibble >> bit) & 1];
+
+        if (nodes[current].symbol == static_cast<int16_t>(HuffmanEOS)) {
+          t.flags = Fail;
+          break;
+        }
+
+        if (nodes[current].symbol >= 0) {
+          t.flags |= Emit;
+          t.symbol = static_cast<uint8_t>(nodes[current].symbol);
+          current = 0;
+        }
+      }
+
+      if (!(t.flags & Fail)) {
+        t.state = static_cast<uint8_t>(stateOf[current]);
+        if (accepting[t.state])
+          t.flags |= Accept;
+      }
+    }
+  }
+}
+
+const HuffmanDecodeTable& HuffmanDecodeTable::get() {
+  static HuffmanDecodeTable table;
+  return table;
 }
 
-bool ReferenceSet::iterator::operator==(const iterator& other) const {
-  return referenceSet_ == other.referenceSet_ && current_ == other.current_;
+size_t Huffman::encodeLength(const BufferRef& value) {
+  size_t bits = 0;
+
+  for (char ch: value)
+    bits += huffmanCodes[static_cast<uint8_t>(ch)].bits;
+
+  return (bits + 7) / 8;
 }
 
-bool ReferenceSet::iterator::operator!=(const iterator& other) const {
-  return !(*this == other);
+void Huffman::encode(Buffer* output, const BufferRef& value) {
+  uint64_t current = 0;
+  unsigned pending = 0;
+
+  for (char ch: value) {
+    const HuffmanCode& hc = huffmanCodes[static_cast<uint8_t>(ch)];
+    current = (current << hc.bits) | hc.code;
+    pending += hc.bits;
+
+    while (pending >= 8) {
+      pending -= 8;
+      output->push_back(static_cast<char>(current >> pending));
+    }
+  }
+
+  if (pending > 0) {
+    // pad with the most significant bits of EOS, that is, all ones
+    current = (current << (8 - pending)) | (0xFF >> pending);
+    output->push_back(static_cast<char>(current));
+  }
 }
 
-const HeaderField& ReferenceSet::iterator::operator*() const {
-  return **current_;
-  // return *referenceSet_->headerTable()->find(*current_);
+bool Huffman::decode(Buffer* output, const BufferRef& value) {
+  typedef HuffmanDecodeTable::Transition Transition;
+
+  const HuffmanDecodeTable& table = HuffmanDecodeTable::get();
+  unsigned state = 0;
+  bool accept = true;
+
+  output->reserve(output->size() + value.size() * 8 / 5);
+
+  for (char ch: value) {
+    const uint8_t byte = static_cast<uint8_t>(ch);
+
+    const Transition& hi = table.next(state, byte >> 4);
+    if (hi.flags & HuffmanDecodeTable::Fail)
+      return false;
+    if (hi.flags & HuffmanDecodeTable::Emit)
+      output->push_back(static_cast<char>(hi.symbol));
+
+    const Transition& lo = table.next(hi.state, byte & 0x0F);
+    if (lo.flags & HuffmanDecodeTable::Fail)
+      return false;
+    if (lo.flags & HuffmanDecodeTable::Emit)
+      output->push_back(static_cast<char>(lo.symbol));
+
+    state = lo.state;
+    accept = (lo.flags & HuffmanDecodeTable::Accept) != 0;
+  }
+
+  // RFC 7541, Section 5.2: padding must be shorter than 8 bits and
+  // correspond to the most significant bits of EOS.
+  return accept;
 }
 // }}}
 // {{{ EncoderHelper
@@ -264,20 +849,21 @@ const HeaderField& ReferenceSet::iterator::operator*() const {
  * Encodes an integer.
  *
  * @param output     The output buffer to encode to.
+ * @param flags      Bits to set in the first octet, above the prefix.
  * @param value      The integer value to encode.
  * @param prefixBits Number of bits for the first bytes that the encoder
  *                   is allowed to use (between 1 and 8).
  */
-void EncoderHelper::encodeInt(Buffer* output, uint64_t value,
+void EncoderHelper::encodeInt(Buffer* output, uint8_t flags, uint64_t value,
                               unsigned prefixBits) {
   assert(prefixBits >= 1 && prefixBits <= 8);
 
   const unsigned maxValue = (1 << prefixBits) - 1;
 
   if (value < maxValue) {
-    output->push_back(static_cast<char>(value));
+    output->push_back(static_cast<char>(flags | value));
   } else {
-    output->push_back(static_cast<char>(maxValue));
+    output->push_back(static_cast<char>(flags | maxValue));
     value -= maxValue;
 
     while (value >= 128) {
@@ -289,107 +875,323 @@ void EncoderHelper::encodeInt(Buffer* output, uint64_t value,
   }
 }
 
+/**
+ * @brief Encodes a string literal.
+ *
+ * @param output  target buffer to write to
+ * @param value   the string to encode
+ * @param huffman whether or not to Huffman-encode, if that's shorter
+ */
+void EncoderHelper::encodeString(Buffer* output, const BufferRef& value,
+                                 bool huffman) {
+  if (huffman) {
+    const size_t encodedLength = Huffman::encodeLength(value);
+    if (encodedLength < value.size()) {
+      encodeInt(output, 0x80, encodedLength, 7);
+      Huffman::encode(output, value);
+      return;
+    }
+  }
+
+  encodeInt(output, 0x00, value.size(), 7);
+  output->push_back(value);
+}
+
 /**
  * @brief Encodes an indexed header.
  *
  * @param output   target buffer to write to
  * @param index    header index
  */
-void EncoderHelper::encodeIndexed(Buffer* output, unsigned index) {
-  size_t n = output->size();
-  encodeInt(output, index, 7);
-  output->data()[n] |= 0x80;
+void EncoderHelper::encodeIndexed(Buffer* output, size_t index) {
+  encodeInt(output, 0x80, index, 7);
+}
+
+static inline void encodeLiteralPrefix(Buffer* output, size_t index,
+                                       bool indexing, bool sensitive) {
+  if (indexing)
+    EncoderHelper::encodeInt(output, 0x40, index, 6);
+  else if (sensitive)
+    EncoderHelper::encodeInt(output, 0x10, index, 4);
+  else
+    EncoderHelper::encodeInt(output, 0x00, index, 4);
 }
 
 /**
  * @brief Encodes a header field with literal name and literal value.
  *
- * @param output   target buffer to write to
- * @param name     header field's name
- * @param value    header field's value
- * @param indexing whether or not given header-field should be persisted in
- *                 the header table.
- * @param huffman  whether or not to Huffman-encode
+ * @param output    target buffer to write to
+ * @param name      header field's name
+ * @param value     header field's value
+ * @param indexing  whether or not given header-field should be persisted in
+ *                  the header table.
+ * @param sensitive whether or not intermediaries must never index this field
+ * @param huffman   whether or not to Huffman-encode
  */
 void EncoderHelper::encodeLiteral(Buffer* output, const BufferRef& name,
                                   const BufferRef& value, bool indexing,
-                                  bool huffman) {
-
-  // if (huffman) {
-  //   name = huffman_encode(name)
-  //   value = huffman_encode(value)
-  // }
-
-  if (indexing) {
-    output->push_back('\0x40');
-  } else {
-    output->push_back('\0x00');
-  }
-
-  encodeInt(output, name.size(), 7);
-  output->push_back(name);
-
-  encodeInt(output, value.size(), 7);
-  output->push_back(value);
+                                  bool sensitive, bool huffman) {
+  encodeLiteralPrefix(output, 0, indexing, sensitive);
+  encodeString(output, name, huffman);
+  encodeString(output, value, huffman);
 }
 
 /**
  * @brief Encodes header field with indexed name and literal value.
  *
- * @param output output buffer to encode to
- * @param name name index
- * @param value value literal
- * @param huffman whether or not to huffman-encode the value literal
+ * @param output    output buffer to encode to
+ * @param index     name index
+ * @param value     value literal
+ * @param indexing  whether or not given header-field should be persisted in
+ *                  the header table.
+ * @param sensitive whether or not intermediaries must never index this field
+ * @param huffman   whether or not to huffman-encode the value literal
  */
-void EncoderHelper::encodeIndexedLiteral(Buffer* output, unsigned name,
-                                         const BufferRef& value, bool huffman) {
-  // if (huffman) {
-  //   value = huffman_encode(value);
-  // }
-
-  encodeInt(output, name, 4);
-  encodeInt(output, value.size(), 7);
-  output->push_back(value);
+void EncoderHelper::encodeIndexedLiteral(Buffer* output, size_t index,
+                                         const BufferRef& value, bool indexing,
+                                         bool sensitive, bool huffman) {
+  encodeLiteralPrefix(output, index, indexing, sensitive);
+  encodeString(output, value, huffman);
 }
 
-void EncoderHelper::encodeTableSizeChange(Buffer* output, unsigned newSize) {
-  size_t n = output->size();
-  encodeInt(output, newSize, 4);
-  output->data()[n] |= 0x20;
+void EncoderHelper::encodeTableSizeChange(Buffer* output, size_t newSize) {
+  encodeInt(output, 0x20, newSize, 5);
 }
 // }}}
-// {{{ DecoderHelper
-uint64_t DecoderHelper::decodeInt(const BufferRef& data, unsigned prefixBits,
-                                  unsigned* bytesConsumed) {
+// {{{ Encoder
+Encoder::Encoder(size_t maxTableSize)
+    : dynamicTable_(maxTableSize),
+      pendingTableSize_(maxTableSize),
+      tableSizeChanged_(false) {
+}
+
+Encoder::~Encoder() {
+}
+
+void Encoder::setMaxTableSize(size_t value) {
+  // Only shrink right away, as the peer's table must not be larger
+  // than what the peer's decoder is told about at the next block.
+  if (value < dynamicTable_.maxSize())
+    dynamicTable_.setMaxSize(value);
+
+  pendingTableSize_ = value;
+  tableSizeChanged_ = true;
+}
+
+void Encoder::beginHeaderBlock(Buffer* output) {
+  if (tableSizeChanged_) {
+    dynamicTable_.setMaxSize(pendingTableSize_);
+    encodeTableSizeChange(output, pendingTableSize_);
+    tableSizeChanged_ = false;
+  }
+}
+
+void Encoder::encode(Buffer* output, const BufferRef& name,
+                     const BufferRef& value, bool sensitive) {
+  const HeaderFieldHash hash(name, value);
+
+  size_t staticIndex = 0;
+  bool staticFull = false;
+  const bool staticFound = StaticTable::find(name, value, hash, &staticIndex,
+                                             &staticFull);
+
+  if (staticFull && !sensitive) {
+    encodeIndexed(output, staticIndex);
+    return;
+  }
+
+  size_t dynamicIndex = 0;
+  bool dynamicFull = false;
+  const bool dynamicFound = dynamicTable_.find(name, value, hash,
+                                               &dynamicIndex, &dynamicFull);
+
+  if (dynamicFull && !sensitive) {
+    encodeIndexed(output, StaticTable::Length + 1 + dynamicIndex);
+    return;
+  }
+
+  const bool indexing = !sensitive &&
+      name.size() + value.size() + HeaderFieldOverhead <= dynamicTable_.maxSize();
+
+  if (staticFound) {
+    encodeIndexedLiteral(output, staticIndex, value, indexing, sensitive, true);
+  } else if (dynamicFound) {
+    encodeIndexedLiteral(output, StaticTable::Length + 1 + dynamicIndex, value,
+                         indexing, sensitive, true);
+  } else {
+    encodeLiteral(output, name, value, indexing, sensitive, true);
+  }
 
+  if (indexing) {
+    dynamicTable_.add(name, value);
+  }
+}
+// }}}
+// {{{ DecoderHelper
+size_t DecoderHelper::decodeInt(const BufferRef& data, unsigned prefixBits,
+                                uint64_t* result) {
   assert(prefixBits >= 1 && prefixBits <= 8);
 
+  if (data.empty())
+    return 0;
+
   const uint8_t mask = 0xFF >> (8 - prefixBits);
-  unsigned index = 0;
-  uint64_t result = data[index] & mask;
+  uint64_t value = static_cast<uint8_t>(data[0]) & mask;
+  size_t index = 1;
 
-  if (result >= (1 << prefixBits) - 1) {
+  if (value == mask) {
     unsigned M = 0;
-    while (true) {
-      index++;
-      const uint8_t byte = data[index];
-      result += (byte & 127) * (1 << M);
-      if ((byte & 128) != 128) {
+    for (;;) {
+      if (index == data.size() || M > 56)
+        return 0;
+
+      const uint8_t byte = static_cast<uint8_t>(data[index++]);
+      value += static_cast<uint64_t>(byte & 127) << M;
+      if ((byte & 128) != 128)
         break;
-      }
-      M = M + 7;
+
+      M += 7;
     }
   }
 
-  if (bytesConsumed) {
-    *bytesConsumed = index + 1;
+  *result = value;
+  return index;
+}
+
+size_t DecoderHelper::decodeString(const BufferRef& data, Buffer* scratch,
+                                   BufferRef* result) {
+  if (data.empty())
+    return 0;
+
+  const bool huffman = (static_cast<uint8_t>(data[0]) & 0x80) != 0;
+  uint64_t length = 0;
+  const size_t n = decodeInt(data, 7, &length);
+
+  if (n == 0 || length > data.size() - n)
+    return 0;
+
+  const BufferRef literal = data.ref(n, length);
+
+  if (huffman) {
+    scratch->clear();
+    if (!Huffman::decode(scratch, literal))
+      return 0;
+
+    *result = scratch->ref();
+  } else {
+    *result = literal;
   }
 
-  return result;
+  return n + length;
+}
+// }}}
+// {{{ Decoder
+Decoder::Decoder(size_t maxTableSize)
+    : dynamicTable_(maxTableSize),
+      maxTableSize_(maxTableSize),
+      nameScratch_(),
+      valueScratch_() {
+}
+
+Decoder::~Decoder() {
+}
+
+void Decoder::setMaxTableSize(size_t value) {
+  maxTableSize_ = value;
+
+  if (dynamicTable_.maxSize() > value)
+    dynamicTable_.setMaxSize(value);
+}
+
+bool Decoder::lookup(size_t index, const HeaderField** result) const {
+  if (index == 0)
+    return false;
+
+  if (index <= StaticTable::Length) {
+    *result = &StaticTable::at(index);
+    return true;
+  }
+
+  index -= StaticTable::Length + 1;
+  if (index >= dynamicTable_.length())
+    return false;
+
+  *result = &dynamicTable_.at(index);
+  return true;
+}
+
+bool Decoder::decode(const BufferRef& headerBlock, const Emitter& emit) {
+  BufferRef input = headerBlock;
+  bool headerSeen = false;
+
+  while (!input.empty()) {
+    const uint8_t octet = static_cast<uint8_t>(input[0]);
+
+    if (octet & 0x80) {
+      // indexed header field
+      uint64_t index = 0;
+      const size_t n = decodeInt(input, 7, &index);
+      const HeaderField* field = nullptr;
+      if (n == 0 || !lookup(index, &field))
+        return false;
+
+      emit(BufferRef(field->name), BufferRef(field->value), false);
+      input = input.ref(n);
+      headerSeen = true;
+    } else if ((octet & 0xE0) == 0x20) {
+      // dynamic table size update, only allowed at the start of a block
+      uint64_t size = 0;
+      const size_t n = decodeInt(input, 5, &size);
+      if (n == 0 || headerSeen || size > maxTableSize_)
+        return false;
+
+      dynamicTable_.setMaxSize(size);
+      input = input.ref(n);
+    } else {
+      // literal header field, with incremental indexing (01xxxxxx),
+      // without indexing (0000xxxx) or never indexed (0001xxxx)
+      const bool indexing = (octet & 0xC0) == 0x40;
+      const bool sensitive = !indexing && (octet & 0x10) != 0;
+      const unsigned prefixBits = indexing ? 6 : 4;
+
+      uint64_t index = 0;
+      size_t n = decodeInt(input, prefixBits, &index);
+      if (n == 0)
+        return false;
+      input = input.ref(n);
+
+      BufferRef name;
+      if (index != 0) {
+        const HeaderField* field = nullptr;
+        if (!lookup(index, &field))
+          return false;
+        name = BufferRef(field->name);
+      } else {
+        n = decodeString(input, &nameScratch_, &name);
+        if (n == 0)
+          return false;
+        input = input.ref(n);
+      }
+
+      BufferRef value;
+      n = decodeString(input, &valueScratch_, &value);
+      if (n == 0)
+        return false;
+      input = input.ref(n);
+
+      emit(name, value, sensitive);
+
+      if (indexing) {
+        dynamicTable_.add(name, value);
+      }
+
+      headerSeen = true;
+    }
+  }
+
+  return true;
 }
 // }}}
 
 }  // namespace hpack
 }  // namespace cortex
-
-// vim:ts=2:sw=2
@@ -8,25 +8,30 @@
 #pragma once
 
 #include <cortex-http/Api.h>
-#include <base/Buffer.h>
-#include <map>
-#include <list>
-#include <deque>
-#include <vector>
-#include <utility>
+#include <cortex-base/Buffer.h>
+#include <functional>
 #include <string>
+#include <vector>
 #include <assert.h>
 #include <stdint.h>
 
 namespace cortex {
-
-using namespace base;
-
 namespace hpack {
 
 typedef std::string HeaderFieldName;
 typedef std::string HeaderFieldValue;
 
+/**
+ * Overhead in octets that is accounted for each dynamic table entry
+ * in addition to its name and value (RFC 7541, Section 4.1).
+ */
+constexpr size_t HeaderFieldOverhead = 32;
+
+/**
+ * Default size of the dynamic table, in octets.
+ */
+constexpr size_t DefaultMaxTableSize = 4096;
+
 /**
  * A name-value pair.
  *
@@ -37,16 +42,22 @@ struct HeaderField {
   HeaderField() = default;
   HeaderField(HeaderField&&) = default;
   HeaderField(const HeaderField&) = default;
+  HeaderField& operator=(HeaderField&&) = default;
   HeaderField& operator=(const HeaderField&) = default;
   HeaderField(const HeaderFieldName& nam, const HeaderFieldValue& val)
       : name(nam), value(val) {}
 
+  /**
+   * Retrieves the number of octets this field accounts for in a
+   * dynamic table.
+   */
+  size_t size() const { return name.size() + value.size() + HeaderFieldOverhead; }
+
   bool operator==(const HeaderField& other) const {
     return name == other.name && value == other.value;
   }
 
   bool operator!=(const HeaderField& other) const {
-    //.
     return !(*this == other);
   }
 
@@ -56,187 +67,351 @@ struct HeaderField {
 };
 
 /**
- * Unordered group of header fields.
+ * Hashes of a header field as used by the table indices, one over the
+ * name only and one over name and value.
  *
- * A header set is an unordered group of header fields that
- * are encoded jointly. It can contain duplicate header fields.  A
- * complete set of key-value pairs contained in a HTTP request or
- * response is a header set.
+ * Computed once per field for searching both, static and dynamic table.
  */
-typedef std::list<HeaderField> HeaderSet;
+struct CORTEX_HTTP_API HeaderFieldHash {
+  HeaderFieldHash(const BufferRef& name, const BufferRef& value);
+
+  uint32_t name;
+  uint32_t field;
+};
 
 /**
- * The static table (see Appendix B) is a component used
- * to associate static header fields to index values. 
+ * Open-addressing hash index over header table entries.
  *
- * This data is ordered, read-only, always accessible,
- * and may be shared amongst
- * all encoding contexts.
+ * Maps the hash of a key, either a field name or a name-value pair, to
+ * the id of the entry holding that key. Keys are compared by the
+ * caller-provided predicate, as the index does not store them itself.
  */
-class CORTEX_HTTP_API StaticTable {
+class CORTEX_HTTP_API HeaderFieldIndex {
  public:
-  StaticTable();
-  ~StaticTable();
-
-  static StaticTable* get();
+  HeaderFieldIndex();
+
+  /**
+   * Clears the index and sizes it for up to @p maxKeys keys.
+   */
+  void reset(size_t maxKeys);
+
+  /**
+   * Retrieves the id of the entry whose key @p equals the searched one.
+   */
+  template<typename Equals>
+  bool find(uint32_t hash, const Equals& equals, uint64_t* id) const;
+
+  /**
+   * Maps the key to @p id, replacing the id of an equal key, if any.
+   */
+  template<typename Equals>
+  void insert(uint32_t hash, const Equals& equals, uint64_t id);
+
+  /**
+   * Removes the key of given @p hash unless it got remapped to another id.
+   */
+  void erase(uint32_t hash, uint64_t id);
 
  private:
-  std::vector<HeaderField> entries_;
+  struct Bucket {
+    uint64_t id;
+    uint32_t hash;
+    bool used;
+  };
+
+  std::vector<Bucket> buckets_;
+  size_t mask_;
 };
 
-class ReferenceSet;
+/**
+ * The static table (see Appendix A) is a component used
+ * to associate static header fields to index values.
+ *
+ * This data is ordered, read-only, always accessible,
+ * and may be shared amongst all encoding contexts.
+ */
+class CORTEX_HTTP_API StaticTable {
+ public:
+  /** Number of entries in the static table. */
+  static constexpr size_t Length = 61;
+
+  /**
+   * Retrieves the static table entry at given 1-based @p index.
+   */
+  static const HeaderField& at(size_t index);
+
+  /**
+   * Searches the static table for given header field.
+   *
+   * @param name header field name to search for.
+   * @param value header field value to search for.
+   * @param index output 1-based index of the best match.
+   * @param nameValueMatch output whether or not the value matches, too.
+   *
+   * @retval true at least the name matched.
+   * @retval false neither name nor value matched.
+   */
+  static bool find(const BufferRef& name, const BufferRef& value,
+                   size_t* index, bool* nameValueMatch);
+
+  static bool find(const BufferRef& name, const BufferRef& value,
+                   const HeaderFieldHash& hash,
+                   size_t* index, bool* nameValueMatch);
+};
 
 /**
- * List of headers.
+ * The dynamic table (see Section 2.3.2) is a FIFO of header fields,
+ * bounded by its maximum size in octets.
  *
- * The header table (see Section 3.2) is a component used
- * to associate stored header fields to index values.
+ * Newer entries have lower indices, starting at index 0. Upon insertion,
+ * the oldest entries are evicted until the new entry fits.
+ *
+ * Entries live in a ring buffer large enough for the maximum number of
+ * entries the table size permits, so that insertion and eviction never
+ * move entries and recycle the storage of evicted ones. Each entry is
+ * identified by its insertion sequence number, which the name and the
+ * name-value indices map to for O(1) lookups.
  */
-class CORTEX_HTTP_API HeaderTable {
+class CORTEX_HTTP_API DynamicTable {
  public:
-  explicit HeaderTable(size_t maxEntries);
-  ~HeaderTable();
+  explicit DynamicTable(size_t maxSize);
+  ~DynamicTable();
+
+  /** Maximum number of octets this table may occupy. */
+  size_t maxSize() const { return maxSize_; }
+
+  /**
+   * Changes the maximum table size, evicting entries as needed.
+   */
+  void setMaxSize(size_t value);
+
+  /** Number of octets currently occupied (including entry overhead). */
+  size_t size() const { return size_; }
+
+  /** Number of entries. */
+  size_t length() const { return length_; }
+
+  bool empty() const { return length_ == 0; }
+
+  /**
+   * Inserts given field as newest entry, evicting older ones as needed.
+   *
+   * An entry larger than maxSize() empties the table without being added.
+   */
+  void add(const BufferRef& name, const BufferRef& value);
+
+  /**
+   * Retrieves the entry at given 0-based @p index, 0 being the newest entry.
+   */
+  const HeaderField& at(size_t index) const {
+    assert(index < length());
+    return entry(inserted_ - 1 - index);
+  }
 
-  size_t maxEntries() const { return maxEntries_; }
-  void setMaxEntries(size_t value);
+  /**
+   * Searches the table for given header field.
+   *
+   * @see StaticTable::find(const BufferRef&, const BufferRef&, size_t*, bool*)
+   */
+  bool find(const BufferRef& name, const BufferRef& value,
+            size_t* index, bool* nameValueMatch) const;
 
-  bool empty() const { return entries_.empty(); }
-  size_t size() const { return entries_.size(); }
+  bool find(const BufferRef& name, const BufferRef& value,
+            const HeaderFieldHash& hash,
+            size_t* index, bool* nameValueMatch) const;
 
-  void add(const HeaderField& field);
-  bool contains(const HeaderFieldName& name) const;
-  bool contains(const HeaderField* name) const;
-  void remove(const HeaderFieldName& name);
-  void remove(const HeaderField* field);
   void clear();
 
-  const HeaderField* entry(unsigned index) const {
-    assert(index >= 1 && index <= size());
-    return &entries_[index - 1];
-  }
-
-  const HeaderField& first() const {
-    assert(!empty());
-    return *entry(1);
+ private:
+  const HeaderField& entry(uint64_t seq) const {
+    return entries_[seq % entries_.size()];
   }
 
-  const HeaderField& last() const {
-    assert(!empty());
-    return *entry(size());
+  HeaderField& entry(uint64_t seq) {
+    return entries_[seq % entries_.size()];
   }
 
-  typedef std::deque<HeaderField>::iterator iterator;
-  typedef std::deque<HeaderField>::const_iterator const_iterator;
-
-  iterator begin() { return entries_.begin(); }
-  iterator end() { return entries_.end(); }
-
-  const_iterator cbegin() const { return entries_.cbegin(); }
-  const_iterator cend() const { return entries_.cend(); }
-
-  iterator find(const HeaderFieldName& name);
-  const_iterator find(const HeaderFieldName& name) const;
-
- private:
-  friend class ReferenceSet;
-
-  void link(ReferenceSet* ref);
-  void unlink(ReferenceSet* ref);
+  void reserve(size_t maxSize);
+  void evict(size_t required);
 
  private:
-  size_t maxEntries_;
-  std::deque<HeaderField> entries_;
-  std::list<ReferenceSet*> referenceSets_;
+  size_t maxSize_;
+  size_t size_;
+  size_t length_;
+  uint64_t inserted_;                 //!< sequence number of the next entry
+  std::vector<HeaderField> entries_;  //!< ring buffer, indexed by seq
+  HeaderFieldIndex nameIndex_;        //!< name -> newest seq
+  HeaderFieldIndex fieldIndex_;       //!< name and value -> newest seq
 };
 
 /**
- * used for differential encoding of a new header set.
+ * Canonical Huffman code of RFC 7541, Appendix B.
  */
-class CORTEX_HTTP_API ReferenceSet {
+class CORTEX_HTTP_API Huffman {
  public:
-  explicit ReferenceSet(HeaderTable* headerTable);
-  ~ReferenceSet();
-
-  bool empty() const;
-  size_t size() const;
-
-  void add(const HeaderField* field);
-  bool contains(const HeaderField* field) const;
-  void remove(const HeaderField* field);
-
-  struct iterator;
-
-  iterator begin();
-  iterator end();
-
-  HeaderTable* headerTable() const { return headerTable_; }
-
- private:
-  HeaderTable* headerTable_;
-  std::list<const HeaderField*> references_;
-};
-
-class CORTEX_HTTP_API ReferenceSet::iterator {
- public:
-  iterator();
-  iterator(ReferenceSet* rs, std::list<const HeaderField*>::iterator init);
-  iterator(iterator&& other) = default;
-  iterator(const iterator& other) = default;
-  iterator& operator=(const iterator& other) = default;
-
-  iterator& operator++();
-  bool operator==(const iterator& other) const;
-  bool operator!=(const iterator& other) const;
-
-  const HeaderField& operator*() const;
-
- private:
-  ReferenceSet* referenceSet_;
-  std::list<const HeaderField*>::iterator current_;
-  std::list<const HeaderField*>::iterator end_;
+  /**
+   * Computes the number of octets @p value is Huffman-encoded into.
+   */
+  static size_t encodeLength(const BufferRef& value);
+
+  /**
+   * Huffman-encodes @p value and appends the result to @p output.
+   */
+  static void encode(Buffer* output, const BufferRef& value);
+
+  /**
+   * Decodes a Huffman-encoded string.
+   *
+   * Consumes four bits per step by means of a precomputed state machine
+   * over the code tree, rather than walking the tree bit by bit.
+   *
+   * @param output target buffer the decoded octets are appended to.
+   * @param value Huffman-encoded input.
+   *
+   * @retval true decoding succeed.
+   * @retval false @p value is not a valid Huffman-encoded string.
+   */
+  static bool decode(Buffer* output, const BufferRef& value);
 };
 
 /**
- * Helper methods for encoding header fragments. 
+ * Helper methods for encoding header fragments.
  */
 class CORTEX_HTTP_API EncoderHelper {
  public:
-  static void encodeInt(Buffer* output, uint64_t i, unsigned prefixBits);
-  static void encodeIndexed(Buffer* output, unsigned index);
+  static void encodeInt(Buffer* output, uint8_t flags, uint64_t value,
+                        unsigned prefixBits);
+  static void encodeString(Buffer* output, const BufferRef& value,
+                           bool huffman);
+  static void encodeIndexed(Buffer* output, size_t index);
   static void encodeLiteral(Buffer* output, const BufferRef& name,
                             const BufferRef& value, bool indexing,
-                            bool huffman);
-  static void encodeIndexedLiteral(Buffer* output, unsigned index,
-                                   const BufferRef& value, bool huffman);
-  static void encodeTableSizeChange(Buffer* output, unsigned newSize);
+                            bool sensitive, bool huffman);
+  static void encodeIndexedLiteral(Buffer* output, size_t index,
+                                   const BufferRef& value, bool indexing,
+                                   bool sensitive, bool huffman);
+  static void encodeTableSizeChange(Buffer* output, size_t newSize);
 };
 
+/**
+ * HPACK header block encoder.
+ *
+ * Each encoder maintains the dynamic table that mirrors the one of the
+ * remote decoder, hence one encoder must be used for all header blocks
+ * sent over a connection, in the order they are transmitted.
+ */
 class CORTEX_HTTP_API Encoder : private EncoderHelper {
  public:
-  Encoder();
+  explicit Encoder(size_t maxTableSize = DefaultMaxTableSize);
   ~Encoder();
 
-  void encode(const HeaderSet& headerBlock);
+  /**
+   * Applies the peer's @c SETTINGS_HEADER_TABLE_SIZE.
+   *
+   * The change is signaled to the peer at the start of the next header block.
+   */
+  void setMaxTableSize(size_t value);
+
+  const DynamicTable& dynamicTable() const { return dynamicTable_; }
+
+  /**
+   * Starts encoding a new header block into @p output.
+   */
+  void beginHeaderBlock(Buffer* output);
+
+  /**
+   * Encodes a single header field into @p output.
+   *
+   * @param output target buffer to append the representation to.
+   * @param name lower-case header field name.
+   * @param value header field value.
+   * @param sensitive whether or not the field must never be indexed,
+   *                  such as for authorization credentials.
+   */
+  void encode(Buffer* output, const BufferRef& name, const BufferRef& value,
+              bool sensitive = false);
+
+ private:
+  DynamicTable dynamicTable_;
+  size_t pendingTableSize_;
+  bool tableSizeChanged_;
 };
 
 /**
- * Helper methods for decoding header fragments. 
+ * Helper methods for decoding header fragments.
  */
 class CORTEX_HTTP_API DecoderHelper {
  public:
-  static uint64_t decodeInt(const BufferRef& input, unsigned prefixBits,
-                            unsigned* bytesConsumed);
+  /**
+   * Decodes a prefix-encoded integer.
+   *
+   * @param input the input to decode, starting at the integer's first octet.
+   * @param prefixBits number of bits of the first octet used by the integer.
+   * @param result output value.
+   *
+   * @return number of octets consumed or 0 on truncated or overlong input.
+   */
+  static size_t decodeInt(const BufferRef& input, unsigned prefixBits,
+                          uint64_t* result);
+
+  /**
+   * Decodes a string literal.
+   *
+   * Plain strings are returned as a reference into @p input, Huffman-encoded
+   * strings are decoded into @p scratch and referenced from there.
+   *
+   * @return number of octets consumed or 0 on invalid input.
+   */
+  static size_t decodeString(const BufferRef& input, Buffer* scratch,
+                             BufferRef* result);
 };
 
+/**
+ * HPACK header block decoder.
+ */
 class CORTEX_HTTP_API Decoder : private DecoderHelper {
  public:
-  Decoder();
+  /**
+   * Callback invoked for each decoded header field.
+   *
+   * Passed references are only valid for the duration of the call.
+   */
+  typedef std::function<void(const BufferRef& name, const BufferRef& value,
+                             bool sensitive)> Emitter;
+
+  explicit Decoder(size_t maxTableSize = DefaultMaxTableSize);
   ~Decoder();
 
-  void decode(const BufferRef& headerBlock);
+  /**
+   * Sets the upper bound the peer may set the dynamic table size to,
+   * as advertised by our @c SETTINGS_HEADER_TABLE_SIZE.
+   */
+  void setMaxTableSize(size_t value);
+
+  const DynamicTable& dynamicTable() const { return dynamicTable_; }
+
+  /**
+   * Decodes a complete header block.
+   *
+   * @param headerBlock the header block, reassembled from all frames.
+   * @param emit callback invoked for each decoded header field, in order.
+   *
+   * @retval true the header block was decoded successfully.
+   * @retval false a decoding error occurred. The decoding context is
+   *               corrupted and the connection must be torn down with
+   *               @c COMPRESSION_ERROR.
+   */
+  bool decode(const BufferRef& headerBlock, const Emitter& emit);
+
+ private:
+  bool lookup(size_t index, const HeaderField** result) const;
+
+ private:
+  DynamicTable dynamicTable_;
+  size_t maxTableSize_;
+  Buffer nameScratch_;
+  Buffer valueScratch_;
 };
 
 }  // namespace hpack
 }  // namespace cortex
-
-// vim:ts=2:sw=2
@@ -67,8 +67,7 @@ void Transport::run(HttpVersion version, const std::string& method,
     channel_->onMessageBegin(BufferRef(method), BufferRef(entity), version);
 
     for (const HeaderField& header: headers) {
-      channel_->onMessageHeader(BufferRef(header.name()),
-                                BufferRef(header.value()));
+      channel_->onMessageHeader(header.name(), header.value());
     }
 
     channel_->onMessageHeaderEnd();
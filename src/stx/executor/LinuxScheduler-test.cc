@@ -0,0 +1,113 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <stx/executor/LinuxScheduler.h>
+#include <stx/MonotonicTime.h>
+#include <stx/MonotonicClock.h>
+#include <stx/application.h>
+#include <stx/exception.h>
+#include <stx/logging.h>
+#include <stx/test/unittest.h>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// The behaviour both schedulers share is covered by Scheduler-test.cc; this
+// only tests what is specific to the epoll/timerfd/eventfd implementation.
+
+using namespace stx;
+
+static stx::test::UnitTest LinuxSchedulerTest("LinuxSchedulerTest");
+int main() {
+  auto& t = LinuxSchedulerTest;
+  return t.run();
+}
+
+TEST_INITIALIZER(LinuxSchedulerTest, logging, []() {
+  Application::logToStderr(LogLevel::kTrace);
+});
+
+/* I/O interests are edge-triggered and one-shot, so re-registering on an fd
+ * whose data has not been consumed yet must re-arm the existing epoll
+ * registration and report the fd as readable again.
+ */
+TEST_CASE(LinuxSchedulerTest, executeOnReadable_rearm_unconsumed, [] () {
+  LinuxScheduler sched;
+  int fds[2];
+  EXPECT_EQ(0, pipe(fds));
+  EXPECT_EQ(1, write(fds[1], "x", 1));
+
+  int fireCount = 0;
+  sched.executeOnReadable(fds[0], [&] { fireCount++; });
+  sched.runLoopOnce();
+  EXPECT_EQ(1, fireCount);
+
+  sched.executeOnReadable(fds[0], [&] { fireCount++; });
+  sched.runLoopOnce();
+  EXPECT_EQ(2, fireCount);
+
+  close(fds[0]);
+  close(fds[1]);
+});
+
+/* Closing an fd silently drops it from the epoll set, so a new fd that
+ * reuses its number must be added again rather than modified.
+ */
+TEST_CASE(LinuxSchedulerTest, executeOnReadable_reused_fd, [] () {
+  LinuxScheduler sched;
+  int a[2];
+  EXPECT_EQ(0, pipe(a));
+  EXPECT_EQ(1, write(a[1], "x", 1));
+
+  int fireCount = 0;
+  sched.executeOnReadable(a[0], [&] { fireCount++; });
+  sched.runLoopOnce();
+  close(a[0]);
+  close(a[1]);
+
+  int b[2];
+  EXPECT_EQ(0, pipe(b));
+  EXPECT_EQ(1, write(b[1], "x", 1));
+
+  sched.executeOnReadable(b[0], [&] { fireCount++; });
+  sched.runLoopOnce();
+  EXPECT_EQ(2, fireCount);
+
+  close(b[0]);
+  close(b[1]);
+});
+
+/* The timerfd is armed to the earliest deadline only, so a timer that is
+ * added from another thread while the loop waits for a later one must wake
+ * the loop up and re-arm the timerfd.
+ */
+TEST_CASE(LinuxSchedulerTest, executeAfter_earlier_from_other_thread, [] () {
+  LinuxScheduler sched;
+  MonotonicTime start = MonotonicClock::now();
+  int fireCount = 0;
+
+  auto later = sched.executeAfter(Duration::fromSeconds(2), [&]() {
+    fireCount += 10;
+  });
+
+  std::thread adder([&]() {
+    usleep(50 * 1000);
+    sched.executeAfter(Duration::fromMilliseconds(10), [&]() {
+      fireCount++;
+      later->cancel();
+    });
+  });
+
+  sched.runLoop();
+  adder.join();
+
+  EXPECT_EQ(1, fireCount);
+  EXPECT_NEAR(60, (MonotonicClock::now() - start).milliseconds(), 50);
+});
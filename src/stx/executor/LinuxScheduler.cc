@@ -0,0 +1,514 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <stx/executor/LinuxScheduler.h>
+#include <stx/MonotonicClock.h>
+#include <stx/thread/Wakeup.h>
+#include <stx/exception.h>
+#include <stx/WallClock.h>
+#include <stx/StringUtil.h>
+#include <stx/exceptionhandler.h>
+#include <stx/logging.h>
+#include <stx/sysconfig.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace stx {
+
+#define ERROR(msg...) logError("LinuxScheduler", msg)
+
+#ifndef NDEBUG
+#define TRACE(msg...) logTrace("LinuxScheduler", msg)
+#else
+#define TRACE(msg...) do {} while (0)
+#endif
+
+/** Maximum number of events to be retrieved by a single epoll_wait(). */
+static const size_t kMaxEventsPerLoop = 1024;
+
+template<>
+std::string StringUtil::toString<LinuxScheduler::Mode>(LinuxScheduler::Mode mode) {
+  return inspect(mode);
+}
+
+template<>
+std::string StringUtil::toString<LinuxScheduler::Watcher*>(LinuxScheduler::Watcher* w) {
+  if (!w)
+    return "nil";
+
+  return inspect(*w);
+}
+
+LinuxScheduler::LinuxScheduler(
+    std::unique_ptr<stx::ExceptionHandler> eh,
+    std::function<void()> preInvoke,
+    std::function<void()> postInvoke)
+    : Scheduler(std::move(eh)),
+      lock_(),
+      epollfd_(-1),
+      eventfd_(-1),
+      timerfd_(-1),
+      timerDeadline_(0),
+      onPreInvokePending_(preInvoke),
+      onPostInvokePending_(postInvoke),
+      tasks_(),
+      timers_(),
+      watchers_(),
+      timeouts_(),
+      events_(kMaxEventsPerLoop),
+      readerCount_(0),
+      writerCount_(0) {
+  epollfd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epollfd_ < 0) {
+    RAISE_ERRNO(kIOError, "Could not create epoll set");
+  }
+
+  eventfd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (eventfd_ < 0) {
+    RAISE_ERRNO(kIOError, "Could not create eventfd");
+  }
+
+  timerfd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timerfd_ < 0) {
+    RAISE_ERRNO(kIOError, "Could not create timerfd");
+  }
+
+  for (int fd: {eventfd_, timerfd_}) {
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollfd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      RAISE_ERRNO(kIOError, "epoll_ctl failed");
+    }
+  }
+
+  TRACE("ctor: epoll=$0, eventfd=$1, timerfd=$2", epollfd_, eventfd_, timerfd_);
+}
+
+LinuxScheduler::LinuxScheduler(std::unique_ptr<stx::ExceptionHandler> eh)
+    : LinuxScheduler(std::move(eh), nullptr, nullptr) {
+}
+
+LinuxScheduler::LinuxScheduler()
+    : LinuxScheduler(std::unique_ptr<ExceptionHandler>(new CatchAndLogExceptionHandler("LinuxScheduler"))) {
+}
+
+LinuxScheduler::~LinuxScheduler() {
+  TRACE("~dtor");
+
+  while (!timers_.empty()) {
+    timers_.pop()->decRef();
+  }
+
+  ::close(timerfd_);
+  ::close(eventfd_);
+  ::close(epollfd_);
+}
+
+MonotonicTime LinuxScheduler::now() const {
+  return MonotonicClock::now();
+}
+
+void LinuxScheduler::execute(Task task) {
+  {
+    std::lock_guard<std::mutex> lk(lock_);
+    tasks_.emplace_back(std::move(task));
+  }
+  breakLoop();
+}
+
+std::string LinuxScheduler::toString() const {
+  return StringUtil::format("LinuxScheduler: epoll=$0, eventfd=$1, timerfd=$2",
+      epollfd_, eventfd_, timerfd_);
+}
+
+Scheduler::HandleRef LinuxScheduler::executeAfter(Duration delay, Task task) {
+  return insertIntoTimersList(now() + delay, task);
+}
+
+Scheduler::HandleRef LinuxScheduler::executeAt(UnixTime when, Task task) {
+  return executeAfter(when - WallClock::now(), task);
+}
+
+Scheduler::HandleRef LinuxScheduler::insertIntoTimersList(MonotonicTime dt,
+                                                          Task task) {
+  RefPtr<Timer> t(new Timer(task));
+  Timer* timer = t.get();
+
+  t->setCancelHandler([this, timer]() {
+    std::lock_guard<std::mutex> lk(lock_);
+    if (timers_.remove(timer)) {
+      timer->decRef();
+    }
+  });
+
+  std::lock_guard<std::mutex> lk(lock_);
+
+  // the queue's reference, released upon fire or cancellation
+  timer->incRef();
+  timers_.push(timer, dt);
+  breakLoopIfEarlier(dt);
+
+  return t.as<Handle>();
+}
+
+void LinuxScheduler::breakLoopIfEarlier(MonotonicTime deadline) {
+  // the loop might be waiting for a later deadline in another thread
+  if (deadline < timerDeadline_) {
+    breakLoop();
+  }
+}
+
+Scheduler::HandleRef LinuxScheduler::executeOnReadable(int fd, Task task, Duration tmo, Task tcb) {
+  std::lock_guard<std::mutex> lk(lock_);
+  HandleRef handle = setupWatcher(fd, Mode::READABLE, task, tmo, tcb);
+  readerCount_++;
+  return handle;
+}
+
+Scheduler::HandleRef LinuxScheduler::executeOnWritable(int fd, Task task, Duration tmo, Task tcb) {
+  std::lock_guard<std::mutex> lk(lock_);
+  HandleRef handle = setupWatcher(fd, Mode::WRITABLE, task, tmo, tcb);
+  writerCount_++;
+  return handle;
+}
+
+void LinuxScheduler::cancelFD(int fd) {
+  Watcher* w = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(lock_);
+    if (fd >= 0 && static_cast<size_t>(fd) < watchers_.size()) {
+      w = &watchers_[fd];
+    }
+  }
+
+  if (w) {
+    w->cancel();
+  }
+}
+
+LinuxScheduler::HandleRef LinuxScheduler::setupWatcher(
+    int fd, Mode mode, Task task,
+    Duration tmo, Task tcb) {
+
+  TRACE("setupWatcher($0, $1, $2)", fd, mode, tmo);
+
+  if (fd < 0)
+    RAISE(kIOError, "invalid file descriptor");
+
+  if (static_cast<size_t>(fd) >= watchers_.size()) {
+    // growing a deque at its end never relocates existing elements, so
+    // the intrusive timeout list stays valid.
+    watchers_.resize(fd + 1);
+  }
+
+  Watcher* interest = &watchers_[fd];
+
+  if (interest->fd >= 0)
+    RAISE(kIOError, "Already watching on resource");
+
+  interest->reset(fd, mode, task, tcb);
+  interest->setCancelHandler([this, interest]() {
+    std::lock_guard<std::mutex> lk(lock_);
+    if (interest->fd < 0)
+      return;
+
+    switch (interest->mode) {
+      case Mode::READABLE: readerCount_--; break;
+      case Mode::WRITABLE: writerCount_--; break;
+    }
+
+    // The one-shot epoll registration is left armed; a late event
+    // is discarded in collectActiveHandles() as the slot is cleared.
+    unlinkWatcher(interest);
+  });
+
+  armWatcher(interest);
+  timeouts_.push(interest, now() + tmo);
+  breakLoopIfEarlier(interest->deadline());
+
+  return interest;
+}
+
+void LinuxScheduler::armWatcher(Watcher* w) {
+  epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = w->fd;
+  ev.events = EPOLLET | EPOLLONESHOT;
+
+  switch (w->mode) {
+    case Mode::READABLE: ev.events |= EPOLLIN | EPOLLRDHUP; break;
+    case Mode::WRITABLE: ev.events |= EPOLLOUT; break;
+  }
+
+  // The fd may have been closed (which implicitly removes it from the
+  // epoll set) and reused since we've seen it last, so fall back to the
+  // respective other operation.
+  int rv;
+  if (w->registered) {
+    rv = epoll_ctl(epollfd_, EPOLL_CTL_MOD, w->fd, &ev);
+    if (rv < 0 && errno == ENOENT) {
+      rv = epoll_ctl(epollfd_, EPOLL_CTL_ADD, w->fd, &ev);
+    }
+  } else {
+    rv = epoll_ctl(epollfd_, EPOLL_CTL_ADD, w->fd, &ev);
+    if (rv < 0 && errno == EEXIST) {
+      rv = epoll_ctl(epollfd_, EPOLL_CTL_MOD, w->fd, &ev);
+    }
+  }
+
+  if (rv < 0) {
+    int e = errno;
+    w->clear();
+    errno = e;
+    RAISE_ERRNO(kIOError, "epoll_ctl failed");
+  }
+
+  w->registered = true;
+}
+
+void LinuxScheduler::unlinkWatcher(Watcher* w) {
+  timeouts_.remove(w);
+  w->clear();
+}
+
+void LinuxScheduler::collectActiveHandles(const epoll_event* events, int count,
+                                          std::list<Task>* result) {
+  for (int i = 0; i < count; ++i) {
+    const int fd = events[i].data.fd;
+
+    if (fd == eventfd_ || fd == timerfd_)
+      continue;
+
+    if (fd < 0 || static_cast<size_t>(fd) >= watchers_.size())
+      continue;
+
+    Watcher* w = &watchers_[fd];
+    if (w->fd < 0) {
+      TRACE("collectActiveHandles: - skip stale fd $0", fd);
+      continue;
+    }
+
+    TRACE("collectActiveHandles: + active fd $0 $1", fd, w->mode);
+
+    switch (w->mode) {
+      case Mode::READABLE: readerCount_--; break;
+      case Mode::WRITABLE: writerCount_--; break;
+    }
+
+    // Do not use Handle::fire() here, as it would keep the handle locked
+    // while the task is possibly re-registering an interest on this fd.
+    Task onIO = std::move(w->onIO);
+    result->push_back([w, onIO] {
+      if (!w->isCancelled()) {
+        onIO();
+      }
+    });
+    unlinkWatcher(w);
+  }
+}
+
+void LinuxScheduler::collectTimeouts(std::list<Task>* result) {
+  const MonotonicTime now = this->now();
+
+  while (!timeouts_.empty() && timeouts_.top()->deadline() <= now) {
+    Watcher* w = timeouts_.top();
+    TRACE("collectTimeouts: timeouting $0", w);
+    Task onTimeout = std::move(w->onTimeout);
+    result->push_back([w, onTimeout] {
+      if (!w->isCancelled() && onTimeout) {
+        onTimeout();
+      }
+    });
+    switch (w->mode) {
+      case Mode::READABLE: readerCount_--; break;
+      case Mode::WRITABLE: writerCount_--; break;
+    }
+    unlinkWatcher(w);
+  }
+
+  while (!timers_.empty() && timers_.top()->deadline() <= now) {
+    RefPtr<Timer> job(timers_.pop());
+    job->decRef(); // adopt the queue's reference
+    result->push_back([job] { job->fire(job->action); });
+  }
+}
+
+// FIXME: this is actually so generic, it could be put into Executor API directly
+void LinuxScheduler::executeOnWakeup(Task task, Wakeup* wakeup, long generation) {
+  wakeup->onWakeup(generation, std::bind(&LinuxScheduler::execute, this, task));
+}
+
+size_t LinuxScheduler::timerCount() {
+  std::lock_guard<std::mutex> lk(lock_);
+  return timers_.size();
+}
+
+size_t LinuxScheduler::readerCount() {
+  return readerCount_.load();
+}
+
+size_t LinuxScheduler::writerCount() {
+  return writerCount_.load();
+}
+
+size_t LinuxScheduler::taskCount() {
+  std::lock_guard<std::mutex> lk(lock_);
+  return tasks_.size();
+}
+
+void LinuxScheduler::runLoop() {
+  for (;;) {
+    lock_.lock();
+    bool cont = !tasks_.empty()
+             || !timers_.empty()
+             || !timeouts_.empty();
+    lock_.unlock();
+
+    if (!cont)
+      break;
+
+    runLoopOnce();
+  }
+}
+
+void LinuxScheduler::runLoopOnce() {
+  int waitMillis = -1;
+
+  {
+    std::lock_guard<std::mutex> lk(lock_);
+
+    if (!tasks_.empty()) {
+      waitMillis = 0;
+    } else {
+      armTimer(nextDeadline());
+    }
+  }
+
+  TRACE("runLoopOnce: epoll_wait(tmo=$0)", waitMillis);
+
+  int rv;
+  do rv = ::epoll_wait(epollfd_, events_.data(), events_.size(), waitMillis);
+  while (rv < 0 && errno == EINTR);
+
+  if (rv < 0)
+    RAISE_ERRNO(kIOError, "epoll_wait failed");
+
+  TRACE("runLoopOnce: epoll_wait returned $0", rv);
+
+  for (int i = 0; i < rv; ++i) {
+    uint64_t counter;
+    if (events_[i].data.fd == eventfd_) {
+      while (::read(eventfd_, &counter, sizeof(counter)) > 0) {}
+    } else if (events_[i].data.fd == timerfd_) {
+      while (::read(timerfd_, &counter, sizeof(counter)) > 0) {}
+    }
+  }
+
+  std::list<Task> activeTasks;
+  {
+    std::lock_guard<std::mutex> lk(lock_);
+
+    activeTasks = std::move(tasks_);
+    collectActiveHandles(events_.data(), rv, &activeTasks);
+    collectTimeouts(&activeTasks);
+  }
+
+  safeCall(onPreInvokePending_);
+  safeCallEach(activeTasks);
+  safeCall(onPostInvokePending_);
+}
+
+MonotonicTime LinuxScheduler::nextDeadline() const {
+  // do not sleep longer than this, so runLoopOnce() eventually returns
+  MonotonicTime deadline = now() + Duration::fromSeconds(5);
+
+  if (!timers_.empty() && timers_.top()->deadline() < deadline)
+    deadline = timers_.top()->deadline();
+
+  if (!timeouts_.empty() && timeouts_.top()->deadline() < deadline)
+    deadline = timeouts_.top()->deadline();
+
+  return deadline;
+}
+
+void LinuxScheduler::armTimer(MonotonicTime deadline) {
+  // Keep an already armed, still pending timer if it expires earlier
+  // anyways. This may cause a spurious wakeup but saves us a syscall
+  // per loop iteration.
+  if (timerDeadline_ <= deadline && timerDeadline_ > now())
+    return;
+
+  // a zero it_value would disarm the timer
+  const uint64_t nanos = std::max<uint64_t>(deadline.nanoseconds(), 1);
+
+  itimerspec its;
+  memset(&its, 0, sizeof(its));
+  its.it_value.tv_sec = nanos / 1000000000llu;
+  its.it_value.tv_nsec = nanos % 1000000000llu;
+
+  if (timerfd_settime(timerfd_, TFD_TIMER_ABSTIME, &its, nullptr) < 0)
+    RAISE_ERRNO(kIOError, "timerfd_settime failed");
+
+  timerDeadline_ = deadline;
+}
+
+void LinuxScheduler::breakLoop() {
+  uint64_t counter = 1;
+  ::write(eventfd_, &counter, sizeof(counter));
+}
+
+std::string LinuxScheduler::inspectImpl() const {
+  std::stringstream sstr;
+
+  sstr << "{";
+  sstr << "epoll:" << epollfd_
+       << ", eventfd:" << eventfd_
+       << ", timerfd:" << timerfd_;
+
+  sstr << ", watchers(";
+  for (size_t i = 0, e = timeouts_.size(); i != e; ++i) {
+    if (i != 0)
+      sstr << ", ";
+    sstr << inspect(*timeouts_.at(i));
+  }
+  sstr << ")"; // watcher-list
+  sstr << ", front:" << (!timeouts_.empty() ? timeouts_.top()->fd : -1);
+  sstr << "}"; // scheduler
+
+  return sstr.str();
+}
+
+std::string inspect(LinuxScheduler::Mode mode) {
+  static const std::string modes[] = {
+    "READABLE",
+    "WRITABLE"
+  };
+  return modes[static_cast<size_t>(mode)];
+}
+
+std::string inspect(const LinuxScheduler::Watcher& w) {
+  return StringUtil::format("{$0, $1, $2}",
+                            w.fd, w.mode, w.deadline());
+}
+
+std::string inspect(const LinuxScheduler& s) {
+  return s.inspectImpl();
+}
+
+} // namespace stx
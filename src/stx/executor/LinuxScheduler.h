@@ -0,0 +1,194 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <stx/sysconfig.h>
+#include <stx/RefPtr.h>
+#include <stx/MonotonicTime.h>
+#include <stx/executor/Scheduler.h>
+#include <stx/executor/TimerQueue.h>
+#include <sys/epoll.h>
+#include <vector>
+#include <deque>
+#include <list>
+#include <mutex>
+
+namespace stx {
+
+/**
+ * Linux specific Scheduler, using epoll, timerfd and eventfd.
+ *
+ * I/O interests are registered edge-triggered and one-shot, so that
+ * the kernel does not need to re-scan idle file descriptors and
+ * the cost of a loop iteration only depends on the number of
+ * file descriptors that actually became ready.
+ */
+class LinuxScheduler : public Scheduler {
+ public:
+  LinuxScheduler(
+      std::unique_ptr<stx::ExceptionHandler> eh,
+      std::function<void()> preInvoke,
+      std::function<void()> postInvoke);
+
+  explicit LinuxScheduler(
+      std::unique_ptr<stx::ExceptionHandler> eh);
+
+  LinuxScheduler();
+
+  ~LinuxScheduler();
+
+  MonotonicTime now() const;
+
+  using Scheduler::executeOnReadable;
+  using Scheduler::executeOnWritable;
+
+  void execute(Task task) override;
+  std::string toString() const override;
+  HandleRef executeAfter(Duration delay, Task task) override;
+  HandleRef executeAt(UnixTime dt, Task task) override;
+  HandleRef executeOnReadable(int fd, Task task, Duration tmo, Task tcb) override;
+  HandleRef executeOnWritable(int fd, Task task, Duration tmo, Task tcb) override;
+  void cancelFD(int fd) override;
+  void executeOnWakeup(Task task, Wakeup* wakeup, long generation) override;
+  size_t timerCount() override;
+  size_t readerCount() override;
+  size_t writerCount() override;
+  size_t taskCount() override;
+  void runLoop() override;
+  void runLoopOnce() override;
+  void breakLoop() override;
+
+ public:
+  enum class Mode { READABLE, WRITABLE };
+  struct Watcher : public Handle, public TimerQueueEntry { // {{{
+    int fd;
+    Mode mode;
+    Task onIO;
+    Task onTimeout;
+    bool registered; //!< whether or not @c fd is known to the epoll set
+
+    Watcher()
+        : fd(-1), mode(Mode::READABLE), onIO(), onTimeout(),
+          registered(false) {
+      // Manually ref because we're not holding it in a
+      // RefPtr<Watcher> container in LinuxScheduler.
+      incRef();
+    }
+
+    void reset(int _fd, Mode _mode, Task _onIO, Task _onTimeout) {
+      fd = _fd;
+      mode = _mode;
+      onIO = _onIO;
+      onTimeout = _onTimeout;
+
+      Handle::reset(nullptr);
+    }
+
+    void clear() {
+      fd = -1;
+    }
+  }; // }}}
+  struct Timer : public Handle, public TimerQueueEntry { // {{{
+    Task action;
+
+    Timer() : Handle(), action() {}
+    explicit Timer(Task t) : Handle(), action(t) {}
+  }; // }}}
+
+ protected:
+  /**
+   * Adds given timer-handle to the timer-list.
+   *
+   * @param dt timestamp at which given timer is to be fired.
+   * @param task task to invoke upon fire.
+   */
+  HandleRef insertIntoTimersList(MonotonicTime dt, Task task);
+
+  /**
+   * Registers an I/O interest.
+   *
+   * @note requires the caller to lock the object mutex.
+   */
+  HandleRef setupWatcher(int fd, Mode mode, Task onFire,
+                         Duration timeout, Task onTimeout);
+
+  /**
+   * (Re-)arms the one-shot epoll registration for given watcher.
+   */
+  void armWatcher(Watcher* w);
+
+  /**
+   * Removes given watcher from the timeout queue and clears it.
+   *
+   * @note requires the caller to lock the object mutex.
+   */
+  void unlinkWatcher(Watcher* w);
+
+  void collectTimeouts(std::list<Task>* result);
+
+  void collectActiveHandles(const epoll_event* events, int count,
+                            std::list<Task>* result);
+
+  /**
+   * Computes the point in time the event loop should wait the most.
+   *
+   * @note requires the caller to lock the object mutex.
+   */
+  MonotonicTime nextDeadline() const;
+
+  /**
+   * Arms the timerfd to expire at given @p deadline.
+   *
+   * @note requires the caller to lock the object mutex.
+   */
+  void armTimer(MonotonicTime deadline);
+
+  /**
+   * Wakes up the event loop if it is waiting for a later deadline.
+   *
+   * @note requires the caller to lock the object mutex.
+   */
+  void breakLoopIfEarlier(MonotonicTime deadline);
+
+  std::string inspectImpl() const;
+
+  friend std::string inspect(const LinuxScheduler&);
+
+ private:
+  /**
+   * mutex, to protect access to tasks, timers and watchers
+   */
+  std::mutex lock_;
+
+  int epollfd_;              //!< epoll set of all registered file descriptors
+  int eventfd_;              //!< eventfd, used to wakeup the waiting syscall
+  int timerfd_;              //!< timerfd, armed to the next timeout to fire
+  MonotonicTime timerDeadline_; //!< deadline the timerfd is currently armed to
+
+  Task onPreInvokePending_;  //!< callback to be invoked before any other hot CB
+  Task onPostInvokePending_; //!< callback to be invoked after any other hot CB
+
+  std::list<Task> tasks_;            //!< list of pending tasks
+  TimerQueue<Timer> timers_;         //!< timers, ordered by deadline
+
+  std::deque<Watcher> watchers_;    //!< I/O watchers, indexed by fd
+  TimerQueue<Watcher> timeouts_;    //!< active I/O watchers, ordered by timeout
+
+  std::vector<epoll_event> events_; //!< result buffer for epoll_wait()
+
+  std::atomic<size_t> readerCount_; //!< number of active read interests
+  std::atomic<size_t> writerCount_; //!< number of active write interests
+};
+
+std::string inspect(LinuxScheduler::Mode mode);
+std::string inspect(const LinuxScheduler::Watcher& w);
+std::string inspect(const LinuxScheduler& s);
+
+} // namespace stx
@@ -12,11 +12,14 @@
 #include <stx/sysconfig.h>
 #include <stx/executor/PosixScheduler.h>
 
+#if defined(STX_ENABLE_LINUX_SCHEDULER)
+#include <stx/executor/LinuxScheduler.h>
+#endif
+
 namespace stx {
 
-#if defined(__linux__)
-// TODO using NativeScheduler = LinuxScheduler;
-using NativeScheduler = PosixScheduler;
+#if defined(STX_ENABLE_LINUX_SCHEDULER)
+using NativeScheduler = LinuxScheduler;
 #else
 using NativeScheduler = PosixScheduler;
 #endif
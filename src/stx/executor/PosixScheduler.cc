@@ -75,8 +75,9 @@ PosixScheduler::PosixScheduler(
       tasks_(),
       timers_(),
       watchers_(),
-      firstWatcher_(nullptr),
-      lastWatcher_(nullptr) {
+      timeouts_(),
+      readerCount_(0),
+      writerCount_(0) {
   if (pipe(wakeupPipe_) < 0) {
     RAISE_ERRNO("Could not create pipe");
   }
@@ -100,6 +101,11 @@ PosixScheduler::PosixScheduler()
 
 PosixScheduler::~PosixScheduler() {
   TRACE("~dtor");
+
+  while (!timers_.empty()) {
+    timers_.pop()->decRef();
+  }
+
   ::close(wakeupPipe_[PIPE_READ_END]);
   ::close(wakeupPipe_[PIPE_WRITE_END]);
 }
@@ -133,130 +139,80 @@ Scheduler::HandleRef PosixScheduler::executeAt(UnixTime when, Task task) {
 
 Scheduler::HandleRef PosixScheduler::insertIntoTimersList(MonotonicTime dt,
                                                           Task task) {
-  RefPtr<Timer> t(new Timer(dt, task));
-
-  auto onCancel = [this, t]() {
-    auto i = timers_.end();
-    auto e = timers_.begin();
+  RefPtr<Timer> t(new Timer(task));
+  Timer* timer = t.get();
 
-    while (i != e) {
-      i--;
-      if (i->get() == t.get()) {
-        timers_.erase(i);
-        break;
-      }
+  t->setCancelHandler([this, timer]() {
+    std::lock_guard<std::mutex> lk(lock_);
+    if (timers_.remove(timer)) {
+      timer->decRef();
     }
-  };
-  t->setCancelHandler(onCancel);
+  });
 
   std::lock_guard<std::mutex> lk(lock_);
 
-  auto i = timers_.end();
-  auto e = timers_.begin();
+  // the queue's reference, released upon fire or cancellation
+  timer->incRef();
+  timers_.push(timer, dt);
 
-  while (i != e) {
-    i--;
-    const RefPtr<Timer>& current = *i;
-    if (current->when >= t->when) {
-      i = timers_.insert(i, t);
-      return t.as<Handle>();
-
-      // return std::make_shared<Handle>([this, i]() {
-      //   std::lock_guard<std::mutex> lk(lock_);
-      //   timers_.erase(i);
-      // });
-    }
-  }
-
-  timers_.push_front(t);
-  i = timers_.begin();
   return t.as<Handle>();
-
-  // return std::make_shared<Handle>([this, i]() {
-  //   std::lock_guard<std::mutex> lk(lock_);
-  //   timers_.erase(i);
-  // });
 }
 
 void PosixScheduler::collectTimeouts(std::list<Task>* result) {
-  for (Watcher* w = firstWatcher_; w && w->timeout <= now(); ) {
-    TRACE("collectTimeouts: timeouting $0", *w);
-    result->push_back([w] { w->fire(w->onTimeout); });
+  const MonotonicTime now = this->now();
+
+  while (!timeouts_.empty() && timeouts_.top()->deadline() <= now) {
+    Watcher* w = timeouts_.top();
+    TRACE("collectTimeouts: timeouting $0", w);
+    Task onTimeout = w->onTimeout;
+    result->push_back([w, onTimeout] {
+      if (!w->isCancelled() && onTimeout) {
+        onTimeout();
+      }
+    });
     switch (w->mode) {
       case Mode::READABLE: readerCount_--; break;
       case Mode::WRITABLE: writerCount_--; break;
     }
-    w = unlinkWatcher(w);
+    unlinkWatcher(w);
   }
 
-  for (;;) {
-    if (timers_.empty())
-      break;
-
-    const RefPtr<Timer>& job = timers_.front();
-
-    if (job->when > now())
-      break;
-
+  while (!timers_.empty() && timers_.top()->deadline() <= now) {
+    RefPtr<Timer> job(timers_.pop());
+    job->decRef(); // adopt the queue's reference
     result->push_back([job] { job->fire(job->action); });
-    timers_.pop_front();
   }
 }
 
-void PosixScheduler::linkWatcher(Watcher* w, Watcher* pred) {
-  Watcher* succ = pred->next;
-
-  w->prev = pred;
-  w->next = succ;
-
-  TRACE("linkWatcher $0 between $1 and $2", w, pred, succ);
-
-  if (pred)
-    pred->next = w;
-  else
-    firstWatcher_ = w;
-
-  if (succ)
-    succ->prev = w;
-  else
-    lastWatcher_ = w;
-}
-
-PosixScheduler::Watcher* PosixScheduler::unlinkWatcher(Watcher* w) {
-  Watcher* pred = w->prev;
-  Watcher* succ = w->next;
-
-  if (pred)
-    pred->next = succ;
-  else
-    firstWatcher_ = succ;
-
-  if (succ)
-    succ->prev = pred;
-  else
-    lastWatcher_ = pred;
-
+void PosixScheduler::unlinkWatcher(Watcher* w) {
+  timeouts_.remove(w);
   w->clear();
-
-  return succ;
 }
 
 Scheduler::HandleRef PosixScheduler::executeOnReadable(int fd, Task task, Duration tmo, Task tcb) {
-  readerCount_++;
   std::lock_guard<std::mutex> lk(lock_);
-  return setupWatcher(fd, Mode::READABLE, task, tmo, tcb);
+  HandleRef handle = setupWatcher(fd, Mode::READABLE, task, tmo, tcb);
+  readerCount_++;
+  return handle;
 }
 
 Scheduler::HandleRef PosixScheduler::executeOnWritable(int fd, Task task, Duration tmo, Task tcb) {
-  writerCount_++;
   std::lock_guard<std::mutex> lk(lock_);
-  return setupWatcher(fd, Mode::WRITABLE, task, tmo, tcb);
+  HandleRef handle = setupWatcher(fd, Mode::WRITABLE, task, tmo, tcb);
+  writerCount_++;
+  return handle;
 }
 
 void PosixScheduler::cancelFD(int fd) {
-  std::lock_guard<std::mutex> lk(lock_);
-  if (fd < watchers_.size()) {
-    Watcher* w = &watchers_[fd];
+  Watcher* w = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(lock_);
+    if (fd >= 0 && fd < watchers_.size()) {
+      w = &watchers_[fd];
+    }
+  }
+
+  if (w) {
     w->cancel();
   }
 }
@@ -270,8 +226,8 @@ PosixScheduler::HandleRef PosixScheduler::setupWatcher(
   MonotonicTime timeout = now() + tmo;
 
   if (fd >= watchers_.size()) {
-    // we cannot dynamically resize here without also updating the doubly linked
-    // list as a realloc() can potentially change memory locations.
+    // we cannot dynamically resize here without also updating the timeout
+    // queue as a realloc() can potentially change memory locations.
     RAISE(kIOError, "fd number too high");
   }
 
@@ -281,50 +237,45 @@ PosixScheduler::HandleRef PosixScheduler::setupWatcher(
     RAISE("AlreadyWatchingOnResource", "Already watching on resource");
     // TODO RAISE_STATUS(AlreadyWatchingOnResource);
 
-  interest->reset(fd, mode, task, timeout, tcb);
-
-  // inject watcher ordered by timeout ascending
-  if (lastWatcher_ != nullptr) {
-    Watcher* succ = lastWatcher_;
+  interest->reset(fd, mode, task, tcb);
+  interest->setCancelHandler([this, interest]() {
+    std::lock_guard<std::mutex> lk(lock_);
+    if (interest->fd < 0)
+      return;
 
-    while (succ->prev != nullptr) {
-      if (interest->timeout <= succ->prev->timeout) {
-        linkWatcher(interest, succ->prev);
-        return interest; // handle;
-      }
+    switch (interest->mode) {
+      case Mode::READABLE: readerCount_--; break;
+      case Mode::WRITABLE: writerCount_--; break;
     }
-    // put in front
-    interest->next = firstWatcher_;
-    firstWatcher_->prev = interest;
-    firstWatcher_ = interest;
-  } else {
-    firstWatcher_ = lastWatcher_ = interest;
-  }
+    unlinkWatcher(interest);
+  });
+
+  timeouts_.push(interest, timeout);
 
   return interest; // handle;
 }
 
 void PosixScheduler::collectActiveHandles(const fd_set* input,
                                           const fd_set* output,
+                                          int wmark,
                                           std::list<Task>* result) {
-  Watcher* w = firstWatcher_;
+  for (int fd = 0; fd <= wmark; ++fd) {
+    Watcher* w = &watchers_[fd];
+    if (w->fd < 0)
+      continue;
 
-  while (w != nullptr) {
-    if (FD_ISSET(w->fd, input)) {
-      TRACE("collectActiveHandles: + active fd $0 READABLE", w->fd);
+    if (w->mode == Mode::READABLE && FD_ISSET(fd, input)) {
+      TRACE("collectActiveHandles: + active fd $0 READABLE", fd);
       readerCount_--;
-      result->push_back(w->onIO);
-      w = unlinkWatcher(w);
-    }
-    else if (FD_ISSET(w->fd, output)) {
-      TRACE("collectActiveHandles: + active fd $0 WRITABLE", w->fd);
+    } else if (w->mode == Mode::WRITABLE && FD_ISSET(fd, output)) {
+      TRACE("collectActiveHandles: + active fd $0 WRITABLE", fd);
       writerCount_--;
-      result->push_back(w->onIO);
-      w = unlinkWatcher(w);
     } else {
-      TRACE("collectActiveHandles: - skip fd $0", w->fd);
-      w = w->next;
+      continue;
     }
+
+    result->push_back(w->onIO);
+    unlinkWatcher(w);
   }
 }
 
@@ -356,7 +307,7 @@ void PosixScheduler::runLoop() {
     lock_.lock();
     bool cont = !tasks_.empty()
              || !timers_.empty()
-             || firstWatcher_ != nullptr;
+             || !timeouts_.empty();
     lock_.unlock();
 
     if (!cont)
@@ -381,9 +332,8 @@ void PosixScheduler::runLoopOnce() {
   {
     std::lock_guard<std::mutex> lk(lock_);
 
-    for (const Watcher* w = firstWatcher_; w; w = w->next) {
-      if (w->fd < 0)
-        continue;
+    for (size_t i = 0, e = timeouts_.size(); i != e; ++i) {
+      const Watcher* w = timeouts_.at(i);
 
       switch (w->mode) {
         case Mode::READABLE:
@@ -404,6 +354,7 @@ void PosixScheduler::runLoopOnce() {
   }
 
   FD_SET(wakeupPipe_[PIPE_READ_END], &input);
+  wmark = std::max(wmark, wakeupPipe_[PIPE_READ_END]);
 
   TRACE("runLoopOnce(): select(wmark=$0, in=$1, out=$2, err=$3, tmo=$4)",
         wmark + 1, incount, outcount, errcount, Duration(tv));
@@ -431,7 +382,7 @@ void PosixScheduler::runLoopOnce() {
     std::lock_guard<std::mutex> lk(lock_);
 
     activeTasks = std::move(tasks_);
-    collectActiveHandles(&input, &output, &activeTasks);
+    collectActiveHandles(&input, &output, wmark, &activeTasks);
     collectTimeouts(&activeTasks);
   }
 
@@ -444,12 +395,17 @@ Duration PosixScheduler::nextTimeout() const {
   if (!tasks_.empty())
     return Duration::Zero;
 
+  const MonotonicTime now = this->now();
+  auto until = [now](MonotonicTime dt) -> Duration {
+    return dt > now ? dt - now : Duration::Zero;
+  };
+
   const Duration a = !timers_.empty()
-                 ? timers_.front()->when - now()
+                 ? until(timers_.top()->deadline())
                  : Duration::fromSeconds(5);
 
-  const Duration b = firstWatcher_ != nullptr
-                 ? firstWatcher_->timeout - now()
+  const Duration b = !timeouts_.empty()
+                 ? until(timeouts_.top()->deadline())
                  : Duration::fromSeconds(6);
 
   return std::min(a, b);
@@ -546,14 +502,13 @@ std::string PosixScheduler::inspectImpl() const {
        << "/" << wakeupPipe_[PIPE_WRITE_END];
 
   sstr << ", watchers(";
-  for (Watcher* w = firstWatcher_; w != nullptr; w = w->next) {
-    if (w != firstWatcher_)
+  for (size_t i = 0, e = timeouts_.size(); i != e; ++i) {
+    if (i != 0)
       sstr << ", ";
-    sstr << inspect(*w);
+    sstr << inspect(*timeouts_.at(i));
   }
   sstr << ")"; // watcher-list
-  sstr << ", front:" << (firstWatcher_ ? firstWatcher_->fd : -1);
-  sstr << ", back:" << (lastWatcher_ ? lastWatcher_->fd : -1);
+  sstr << ", front:" << (!timeouts_.empty() ? timeouts_.top()->fd : -1);
   sstr << "}"; // scheduler
 
   return sstr.str();
@@ -569,7 +524,7 @@ std::string inspect(PosixScheduler::Mode mode) {
 
 std::string inspect(const PosixScheduler::Watcher& w) {
   return StringUtil::format("{$0, $1, $2}",
-                            w.fd, w.mode, w.timeout);
+                            w.fd, w.mode, w.deadline());
 }
 
 std::string inspect(const PosixScheduler& s) {
@@ -12,6 +12,7 @@
 #include <stx/RefPtr.h>
 #include <stx/MonotonicTime.h>
 #include <stx/executor/Scheduler.h>
+#include <stx/executor/TimerQueue.h>
 #include <sys/select.h>
 #include <set>
 #include <vector>
@@ -77,67 +78,44 @@ class PosixScheduler : public Scheduler {
 
  public:
   enum class Mode { READABLE, WRITABLE };
-  struct Watcher : public Handle { // {{{
+  struct Watcher : public Handle, public TimerQueueEntry { // {{{
     int fd;
     Mode mode;
     Task onIO;
-    MonotonicTime timeout;
     Task onTimeout;
 
-    Watcher* prev; //!< predecessor by timeout ASC
-    Watcher* next; //!< successor by timeout ASC
-
     Watcher()
-        : Watcher(-1, Mode::READABLE, nullptr, MonotonicTime(0), nullptr) {}
+        : Watcher(-1, Mode::READABLE, nullptr, nullptr) {}
 
     Watcher(const Watcher& w)
-        : Watcher(w.fd, w.mode, w.onIO, w.timeout, w.onTimeout) {}
+        : Watcher(w.fd, w.mode, w.onIO, w.onTimeout) {}
 
-    Watcher(int _fd, Mode _mode, Task _onIO,
-            MonotonicTime _timeout, Task _onTimeout)
-        : fd(_fd), mode(_mode), onIO(_onIO),
-          timeout(_timeout), onTimeout(_onTimeout),
-          prev(nullptr), next(nullptr) {
+    Watcher(int _fd, Mode _mode, Task _onIO, Task _onTimeout)
+        : fd(_fd), mode(_mode), onIO(_onIO), onTimeout(_onTimeout) {
       // Manually ref because we're not holding it in a
       // RefPtr<Watcher> vector in PosixScheduler.
       // - Though, no need to manually unref() either.
       incRef();
     }
 
-    void reset(int _fd, Mode _mode, Task _onIO,
-            MonotonicTime _timeout, Task _onTimeout) {
+    void reset(int _fd, Mode _mode, Task _onIO, Task _onTimeout) {
       fd = _fd;
       mode = _mode;
       onIO = _onIO;
-      timeout = _timeout;
       onTimeout = _onTimeout;
 
-      prev = nullptr;
-      next = nullptr;
-
       Handle::reset(nullptr);
     }
 
     void clear() {
       fd = -1;
-      timeout = MonotonicTime(0);
-      prev = nullptr;
-      next = nullptr;
-    }
-
-    bool operator<(const Watcher& other) const {
-      return timeout < other.timeout;
     }
   }; // }}}
-  struct Timer : public Handle { // {{{
-    MonotonicTime when;
+  struct Timer : public Handle, public TimerQueueEntry { // {{{
     Task action;
 
-    Timer() : Handle(), when(), action() {}
-    Timer(MonotonicTime dt, Task t) : Handle(), when(dt), action(t) {}
-    Timer(MonotonicTime dt, Task t, Task c) : Handle(c), when(dt), action(t) {}
-    Timer(const Timer&) = default;
-    Timer& operator=(const Timer&) = default;
+    Timer() : Handle(), action() {}
+    explicit Timer(Task t) : Handle(), action(t) {}
   }; // }}}
 
  protected:
@@ -155,6 +133,7 @@ class PosixScheduler : public Scheduler {
 
   void collectActiveHandles(const fd_set* input,
                             const fd_set* output,
+                            int wmark,
                             std::list<Task>* result);
 
   /**
@@ -166,19 +145,11 @@ class PosixScheduler : public Scheduler {
                          Duration timeout, Task onTimeout);
 
   /**
-   * Inserts watcher between @p pred and @p pred's successor.
-   *
-   * @note requires the caller to lock the object mutex.
-   */
-  void linkWatcher(Watcher* w, Watcher* pred);
-
-  /**
-   * Removes given watcher from ordered list of watchers.
+   * Removes given watcher from the timeout queue and clears it.
    *
-   * @return watcher next to the given watcher, ascending ordered by time.
    * @note requires the caller to lock the object mutex.
    */
-  Watcher* unlinkWatcher(Watcher* w);
+  void unlinkWatcher(Watcher* w);
 
   /**
    * Computes the timespan the event loop should wait the most.
@@ -203,11 +174,10 @@ class PosixScheduler : public Scheduler {
   Task onPostInvokePending_; //!< callback to be invoked after any other hot CB
 
   std::list<Task> tasks_;            //!< list of pending tasks
-  std::list<RefPtr<Timer>> timers_;  //!< ASC-sorted list of timers
+  TimerQueue<Timer> timers_;         //!< timers, ordered by deadline
 
   std::vector<Watcher> watchers_;   //!< I/O watchers
-  Watcher* firstWatcher_;           //!< I/O watcher with the smallest timeout
-  Watcher* lastWatcher_;            //!< I/O watcher with the largest timeout
+  TimerQueue<Watcher> timeouts_;    //!< active I/O watchers, ordered by timeout
 
   std::atomic<size_t> readerCount_; //!< number of active read interests
   std::atomic<size_t> writerCount_; //!< number of active write interests
@@ -0,0 +1,106 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <stx/executor/PosixScheduler.h>
+#include <stx/executor/LinuxScheduler.h>
+#include <stx/test/benchmark.h>
+#include <stx/stringutil.h>
+#include <type_traits>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+
+using namespace stx;
+
+/**
+ * Measures the cost of a single event loop iteration that dispatches exactly
+ * one ready file descriptor while @p numIdle other read-interests are
+ * registered but idle, e.g. keep-alive connections.
+ */
+template<typename SchedulerType>
+static void benchmarkIdleSockets(const std::string& name, size_t numIdle) {
+  std::vector<int> fds;
+  bool ok = true;
+
+  for (size_t i = 0; i < numIdle; i += 2) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+      ok = false;
+      break;
+    }
+    fds.push_back(sv[0]);
+    fds.push_back(sv[1]);
+  }
+
+  int active[2];
+  ok = ok && pipe(active) == 0;
+
+  const std::string label = StringUtil::format("$0 ($1 idle)", name, numIdle);
+
+  if (!ok || (std::is_same<SchedulerType, PosixScheduler>::value &&
+              active[0] >= FD_SETSIZE)) {
+    printf("%-40s %14s\n", label.c_str(), "n/a");
+  } else {
+    SchedulerType scheduler;
+    char buf[16];
+
+    for (int fd: fds) {
+      scheduler.executeOnReadable(fd, []() {});
+    }
+
+    std::function<void()> onReadable = [&]() {
+      ::read(active[0], buf, sizeof(buf));
+      scheduler.executeOnReadable(active[0], onReadable);
+    };
+    scheduler.executeOnReadable(active[0], onReadable);
+
+    auto result = Benchmark::benchmark([&]() {
+      ::write(active[1], "x", 1);
+      scheduler.runLoopOnce();
+    }, 10000);
+
+    Benchmark::printResultTable(label, result, true);
+
+    for (int fd: fds) {
+      scheduler.cancelFD(fd);
+    }
+    scheduler.cancelFD(active[0]);
+  }
+
+  for (int fd: fds) {
+    ::close(fd);
+  }
+
+  if (ok) {
+    ::close(active[0]);
+    ::close(active[1]);
+  }
+}
+
+int main() {
+  rlimit rlim;
+  if (getrlimit(RLIMIT_NOFILE, &rlim) == 0) {
+    rlim.rlim_cur = rlim.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rlim);
+  }
+
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  for (size_t numIdle: {1000, 10000, 100000}) {
+    benchmarkIdleSockets<PosixScheduler>("PosixScheduler", numIdle);
+    benchmarkIdleSockets<LinuxScheduler>("LinuxScheduler", numIdle);
+  }
+
+  return 0;
+}
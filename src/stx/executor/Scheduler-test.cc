@@ -7,7 +7,7 @@
 // You should have received a copy of the GNU Affero General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#include <stx/executor/PosixScheduler.h>
+#include <stx/executor/NativeScheduler.h>
 #include <stx/MonotonicTime.h>
 #include <stx/MonotonicClock.h>
 #include <stx/application.h>
@@ -58,24 +58,39 @@ class SystemPipe { // {{{
   int fds_[2];
 }; // }}}
 
-static stx::test::UnitTest PosixSchedulerTest("PosixSchedulerTest");
+static stx::test::UnitTest SchedulerTest("SchedulerTest");
 int main() {
-  auto& t = PosixSchedulerTest;
+  auto& t = SchedulerTest;
   return t.run();
 }
 
-TEST_INITIALIZER(PosixSchedulerTest, logging, []() {
+TEST_INITIALIZER(SchedulerTest, logging, []() {
   Application::logToStderr(LogLevel::kTrace);
 });
 
+// Defines a test body templated on the scheduler type and runs it against
+// every scheduler implementation that is available on this platform.
+#if defined(STX_ENABLE_LINUX_SCHEDULER)
+#define LINUX_SCHEDULER_TEST_CASE(N) \
+    TEST_CASE(SchedulerTest, LinuxScheduler_##N, &N<LinuxScheduler>)
+#else
+#define LINUX_SCHEDULER_TEST_CASE(N)
+#endif
+
+#define SCHEDULER_TEST_CASE(N) \
+    template<typename SchedulerType> static void N(); \
+    TEST_CASE(SchedulerTest, PosixScheduler_##N, &N<PosixScheduler>) \
+    LINUX_SCHEDULER_TEST_CASE(N) \
+    template<typename SchedulerType> static void N()
+
 /* test case:
  * 1.) insert interest A with timeout 10s
  * 2.) after 5 seconds, insert interest B with timeout 2
  * 3.) the interest B should now be fired after 2 seconds
  * 4.) the interest A should now be fired after 3 seconds
  */
-TEST_CASE(PosixSchedulerTest, timeoutBreak, []() {
-  PosixScheduler scheduler;
+SCHEDULER_TEST_CASE(timeoutBreak) {
+  SchedulerType scheduler;
   SystemPipe a;
   SystemPipe b;
   MonotonicTime start = MonotonicClock::now();
@@ -103,10 +118,10 @@ TEST_CASE(PosixSchedulerTest, timeoutBreak, []() {
   EXPECT_TRUE(!b_fired_at);
   EXPECT_NEAR(500, (a_timeout_at - start).milliseconds(), 50);
   EXPECT_NEAR(100,  (b_timeout_at - start).milliseconds(), 50);
-});
+}
 
-TEST_CASE(PosixSchedulerTest, executeAfter_without_handle, [] () {
-  PosixScheduler scheduler;
+SCHEDULER_TEST_CASE(executeAfter_without_handle) {
+  SchedulerType scheduler;
   MonotonicTime start;
   MonotonicTime firedAt;
   int fireCount = 0;
@@ -125,10 +140,10 @@ TEST_CASE(PosixSchedulerTest, executeAfter_without_handle, [] () {
 
   EXPECT_EQ(1, fireCount);
   EXPECT_NEAR(50, diff.milliseconds(), 10);
-});
+}
 
-TEST_CASE(PosixSchedulerTest, executeAfter_cancel_beforeRun, [] () {
-  PosixScheduler scheduler;
+SCHEDULER_TEST_CASE(executeAfter_cancel_beforeRun) {
+  SchedulerType scheduler;
   int fireCount = 0;
 
   auto handle = scheduler.executeAfter(Duration::fromSeconds(1), [&](){
@@ -140,10 +155,10 @@ TEST_CASE(PosixSchedulerTest, executeAfter_cancel_beforeRun, [] () {
   handle->cancel();
   EXPECT_EQ(0, scheduler.timerCount());
   EXPECT_EQ(0, fireCount);
-});
+}
 
-TEST_CASE(PosixSchedulerTest, executeAfter_cancel_beforeRun2, [] () {
-  PosixScheduler scheduler;
+SCHEDULER_TEST_CASE(executeAfter_cancel_beforeRun2) {
+  SchedulerType scheduler;
   int fire1Count = 0;
   int fire2Count = 0;
 
@@ -163,15 +178,15 @@ TEST_CASE(PosixSchedulerTest, executeAfter_cancel_beforeRun2, [] () {
 
   EXPECT_EQ(0, fire1Count);
   EXPECT_EQ(1, fire2Count);
-});
+}
 
-TEST_CASE(PosixSchedulerTest, executeOnReadable, [] () {
+SCHEDULER_TEST_CASE(executeOnReadable) {
   // executeOnReadable: test cancellation after fire
   // executeOnReadable: test fire
   // executeOnReadable: test timeout
   // executeOnReadable: test fire at the time of the timeout
 
-  PosixScheduler sched;
+  SchedulerType sched;
 
   SystemPipe pipe;
   int fireCount = 0;
@@ -192,10 +207,10 @@ TEST_CASE(PosixSchedulerTest, executeOnReadable, [] () {
 
   EXPECT_EQ(1, fireCount);
   EXPECT_EQ(0, timeoutCount);
-});
+}
 
-TEST_CASE(PosixSchedulerTest, executeOnReadable_timeout, [] () {
-  PosixScheduler sched;
+SCHEDULER_TEST_CASE(executeOnReadable_timeout) {
+  SchedulerType sched;
   SystemPipe pipe;
 
   int fireCount = 0;
@@ -208,10 +223,10 @@ TEST_CASE(PosixSchedulerTest, executeOnReadable_timeout, [] () {
 
   EXPECT_EQ(0, fireCount);
   EXPECT_EQ(1, timeoutCount);
-});
+}
 
-TEST_CASE(PosixSchedulerTest, executeOnReadable_timeout_on_cancelled, [] () {
-  PosixScheduler sched;
+SCHEDULER_TEST_CASE(executeOnReadable_timeout_on_cancelled) {
+  SchedulerType sched;
   SystemPipe pipe;
 
   int fireCount = 0;
@@ -229,10 +244,10 @@ TEST_CASE(PosixSchedulerTest, executeOnReadable_timeout_on_cancelled, [] () {
 
   EXPECT_EQ(0, fireCount);
   EXPECT_EQ(0, timeoutCount);
-});
+}
 
-TEST_CASE(PosixSchedulerTest, executeOnReadable_twice_on_same_fd, [] () {
-  PosixScheduler sched;
+SCHEDULER_TEST_CASE(executeOnReadable_twice_on_same_fd) {
+  SchedulerType sched;
   SystemPipe pipe;
 
   sched.executeOnReadable(pipe.readerFd(), [] () {});
@@ -245,10 +260,10 @@ TEST_CASE(PosixSchedulerTest, executeOnReadable_twice_on_same_fd, [] () {
   // EXPECT_THROW(
   //     sched.executeOnReadable(pipe.readerFd(), [] () {}),
   //     AlreadyWatchingOnResource);
-});
+}
 
-TEST_CASE(PosixSchedulerTest, executeOnWritable, [] () {
-  PosixScheduler sched;
+SCHEDULER_TEST_CASE(executeOnWritable) {
+  SchedulerType sched;
 
   SystemPipe pipe;
   int fireCount = 0;
@@ -266,16 +281,16 @@ TEST_CASE(PosixSchedulerTest, executeOnWritable, [] () {
 
   EXPECT_EQ(1, fireCount);
   EXPECT_EQ(0, timeoutCount);
-});
+}
 
-// TEST_CASE(PosixSchedulerTest, waitForReadable, [] () { // TODO
-// });
+// SCHEDULER_TEST_CASE(waitForReadable) { // TODO
+// }
 // 
-// TEST_CASE(PosixSchedulerTest, waitForWritable, [] () { // TODO
-// });
+// SCHEDULER_TEST_CASE(waitForWritable) { // TODO
+// }
 // 
-// TEST_CASE(PosixSchedulerTest, waitForReadable_timed, [] () { // TODO
-// });
+// SCHEDULER_TEST_CASE(waitForReadable_timed) { // TODO
+// }
 // 
-// TEST_CASE(PosixSchedulerTest, waitForWritable_timed, [] () { // TODO
-// });
+// SCHEDULER_TEST_CASE(waitForWritable_timed) { // TODO
+// }
@@ -0,0 +1,77 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <stx/executor/ThreadPool.h>
+#include <stx/test/benchmark.h>
+#include <stx/stringutil.h>
+#include <functional>
+#include <stdio.h>
+
+using namespace stx;
+
+/**
+ * Measures the throughput of tiny tasks that are all submitted from a
+ * single non-worker thread, e.g. an I/O thread handing off requests.
+ */
+static void benchmarkExternalSubmit(size_t numThreads) {
+  ThreadPool pool(numThreads);
+  const size_t numTasks = 1000000;
+
+  auto result = Benchmark::benchmark([&]() {
+    for (size_t i = 0; i < numTasks; ++i) {
+      pool.execute([]() {});
+    }
+    pool.wait();
+  }, 1);
+
+  Benchmark::printResultTable(
+      StringUtil::format("external submit ($0 threads)", numThreads),
+      Benchmark::BenchmarkResult(result.meanRuntimeNanos(), numTasks), true);
+}
+
+/**
+ * Measures the throughput of a recursive fork/join style fan-out, where
+ * every task is submitted from within a worker thread.
+ */
+static void benchmarkForkJoin(size_t numThreads) {
+  ThreadPool pool(numThreads);
+  const int depth = 9;
+  const int fanout = 4;
+  size_t numTasks = 0;
+  for (int i = 0, n = 1; i <= depth; ++i, n *= fanout)
+    numTasks += n;
+
+  std::function<void(int)> spawn = [&](int level) {
+    if (level > 0) {
+      for (int i = 0; i < fanout; ++i) {
+        pool.execute(std::bind(spawn, level - 1));
+      }
+    }
+  };
+
+  auto result = Benchmark::benchmark([&]() {
+    pool.execute(std::bind(spawn, depth));
+    pool.wait();
+  }, 1);
+
+  Benchmark::printResultTable(
+      StringUtil::format("fork/join ($0 threads)", numThreads),
+      Benchmark::BenchmarkResult(result.meanRuntimeNanos(), numTasks), true);
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  for (size_t numThreads: {1, 2, 4, 8}) {
+    benchmarkExternalSubmit(numThreads);
+    benchmarkForkJoin(numThreads);
+  }
+
+  return 0;
+}
@@ -58,3 +58,26 @@ TEST_CASE(ThreadPoolTest, simple, []() -> void {
   EXPECT_NEAR(100, (end2 - startTime).milliseconds(), 10); // executed instantly
   EXPECT_NEAR(200, (end3 - startTime).milliseconds(), 10); // executed queued
 });
+
+TEST_CASE(ThreadPoolTest, nested_execute, []() -> void {
+  stx::ThreadPool tp(4);
+  std::atomic<size_t> count(0);
+
+  // every task spawns its children from within a worker thread,
+  // which exercises the per-worker deques and stealing.
+  std::function<void(int)> spawn = [&](int depth) {
+    count++;
+    if (depth > 0) {
+      for (int i = 0; i < 4; ++i) {
+        tp.execute(std::bind(spawn, depth - 1));
+      }
+    }
+  };
+
+  tp.execute(std::bind(spawn, 5));
+  tp.wait();
+
+  // 1 + 4 + 16 + 64 + 256 + 1024
+  EXPECT_EQ(1365, count.load());
+  EXPECT_EQ(0, tp.pendingCount());
+});
@@ -9,6 +9,7 @@
 
 #include <stx/executor/ThreadPool.h>
 #include <stx/executor/PosixScheduler.h>
+#include <stx/executor/WorkStealingDeque.h>
 #include <stx/thread/Wakeup.h>
 #include <stx/exception.h>
 #include <stx/WallClock.h>
@@ -19,6 +20,7 @@
 #include <thread>
 #include <exception>
 #include <typeinfo>
+#include <algorithm>
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -46,14 +48,48 @@ ThreadPool::ThreadPool(std::unique_ptr<stx::ExceptionHandler> eh)
     : ThreadPool(processorCount(), std::move(eh)) {
 }
 
+/**
+ * Per-thread state of a single worker.
+ */
+struct ThreadPool::Worker {
+  Worker(ThreadPool* p, size_t i)
+      : pool(p), id(i), seed(static_cast<uint32_t>(i * 2654435761u + 1)),
+        deque() {}
+
+  /** Picks a pseudo random index in [0, n) via xorshift. */
+  size_t random(size_t n) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % n;
+  }
+
+  ThreadPool* pool;
+  size_t id;
+  uint32_t seed;
+  WorkStealingDeque<Task*> deque;
+};
+
+/**
+ * Maximum number of tasks a worker moves from the injection queue
+ * into its own deque at once.
+ */
+static constexpr size_t kInjectBatchSize = 32;
+
+thread_local ThreadPool::Worker* ThreadPool::currentWorker_ = nullptr;
+
 ThreadPool::ThreadPool(size_t num_threads,
                        std::unique_ptr<stx::ExceptionHandler> eh)
     : Scheduler(std::move(eh)),
       active_(true),
       threads_(),
+      workers_(),
       mutex_(),
       condition_(),
+      drained_(),
       pendingTasks_(),
+      pendingCount_(0),
+      sleepingCount_(0),
       activeTasks_(0),
       activeTimers_(0),
       activeReaders_(0),
@@ -62,6 +98,11 @@ ThreadPool::ThreadPool(size_t num_threads,
   if (num_threads < 1)
     throw std::runtime_error("Invalid argument.");
 
+  // all workers must exist before any of them may start stealing
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(new Worker(this, i));
+  }
+
   for (size_t i = 0; i < num_threads; i++) {
     threads_.emplace_back(std::bind(&ThreadPool::work, this, i));
   }
@@ -73,11 +114,22 @@ ThreadPool::~ThreadPool() {
   for (std::thread& thread: threads_) {
     thread.join();
   }
+
+  // release tasks that never got a chance to run
+  Task* task = nullptr;
+  for (std::unique_ptr<Worker>& worker: workers_) {
+    while (worker->deque.pop(&task)) {
+      delete task;
+    }
+  }
+
+  for (Task* task: pendingTasks_) {
+    delete task;
+  }
 }
 
 size_t ThreadPool::pendingCount() const {
-  std::unique_lock<std::mutex> lock(mutex_);
-  return pendingTasks_.size();
+  return pendingCount_.load();
 }
 
 size_t ThreadPool::activeCount() const {
@@ -88,20 +140,15 @@ void ThreadPool::wait() {
   TRACE("$0 wait()", (void*) this);
   std::unique_lock<std::mutex> lock(mutex_);
 
-  if (pendingTasks_.empty() && activeTasks_ == 0) {
-    TRACE("$0 wait: pending=$1, active=$2 (immediate return)",
-          (void*) this, pendingTasks_.size(), activeTasks_.load());
-    return;
-  }
-
-  condition_.wait(lock, [&]() -> bool {
+  drained_.wait(lock, [&]() -> bool {
     TRACE("$0 wait: pending=$1, active=$2",
-          (void*) this, pendingTasks_.size(), activeTasks_.load());
-    return pendingTasks_.empty() && activeTasks_.load() == 0;
+          (void*) this, pendingCount_.load(), activeTasks_.load());
+    return pendingCount_.load() == 0 && activeTasks_.load() == 0;
   });
 }
 
 void ThreadPool::stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
   active_ = false;
   condition_.notify_all();
 }
@@ -118,41 +165,129 @@ size_t ThreadPool::processorCount() {
 #endif
 }
 
-void ThreadPool::work(int workerId) {
+void ThreadPool::work(size_t workerId) {
   TRACE("$0 worker[$1] enter", (void*) this, workerId);
 
-  while (active_) {
-    Task task;
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-      condition_.wait(lock, [&]() { return !pendingTasks_.empty() || !active_; });
-
-      if (!active_)
-        break;
+  Worker* self = workers_[workerId].get();
+  currentWorker_ = self;
 
-      TRACE("$0 work[$1]: task received", (void*) this, workerId);
-      task = std::move(pendingTasks_.front());
-      pendingTasks_.pop_front();
+  while (active_) {
+    Task* task = nullptr;
+    if (!findTask(self, &task)) {
+      park();
+      continue;
     }
 
+    // account the task as active before it stops being pending, so that
+    // wait() never observes both counters at zero in between.
     activeTasks_++;
-    safeCall(task);
-    activeTasks_--;
+    pendingCount_--;
+
+    safeCall(*task);
+    delete task;
 
-    // notify the potential wait() call
-    condition_.notify_all();
+    if (--activeTasks_ == 0 && pendingCount_.load() == 0) {
+      // notify the potential wait() call
+      std::lock_guard<std::mutex> lock(mutex_);
+      drained_.notify_all();
+    }
   }
 
+  currentWorker_ = nullptr;
+
   TRACE("$0 worker[$1] leave", (void*) this, workerId);
 }
 
+bool ThreadPool::findTask(Worker* self, Task** result) {
+  if (self->deque.pop(result))
+    return true;
+
+  if (takeInjected(self, result))
+    return true;
+
+  while (pendingCount_.load() > 0 && active_) {
+    if (steal(self, result))
+      return true;
+
+    if (takeInjected(self, result))
+      return true;
+
+    // the remaining tasks are about to be taken by their owners
+    std::this_thread::yield();
+  }
+
+  return false;
+}
+
+bool ThreadPool::takeInjected(Worker* self, Task** result) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (pendingTasks_.empty())
+    return false;
+
+  TRACE("$0 work[$1]: task received", (void*) this, self->id);
+
+  *result = pendingTasks_.front();
+  pendingTasks_.pop_front();
+
+  // move half of our fair share of the remaining backlog over, so other
+  // workers can steal it from us instead of contending on mutex_.
+  // Short backlogs are left alone to keep their FIFO order.
+  const size_t share = pendingTasks_.size() / (2 * workers_.size());
+  for (size_t n = std::min(share, kInjectBatchSize); n > 0; --n) {
+    self->deque.push(pendingTasks_.front());
+    pendingTasks_.pop_front();
+  }
+
+  return true;
+}
+
+bool ThreadPool::steal(Worker* self, Task** result) {
+  const size_t count = workers_.size();
+  const size_t start = self->random(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    Worker* victim = workers_[(start + i) % count].get();
+    if (victim != self && victim->deque.steal(result)) {
+      TRACE("$0 work[$1]: task stolen from worker[$2]",
+            (void*) this, self->id, victim->id);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::park() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  sleepingCount_++;
+  condition_.wait(lock, [&]() {
+    return pendingCount_.load() > 0 || !active_;
+  });
+  sleepingCount_--;
+}
+
 void ThreadPool::execute(Task task) {
-  {
-    std::unique_lock<std::mutex> lock(mutex_);
-    TRACE("$0 execute: enqueue task & notify_all", (void*) this);
-    pendingTasks_.emplace_back(std::move(task));
+  Task* t = new Task(std::move(task));
+
+  // make the task visible as pending before it can be dequeued
+  pendingCount_++;
+
+  Worker* self = currentWorker_;
+  if (self && self->pool == this) {
+    TRACE("$0 execute: push to worker[$1]", (void*) this, self->id);
+    self->deque.push(t);
+  } else {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TRACE("$0 execute: enqueue task", (void*) this);
+    pendingTasks_.push_back(t);
+  }
+
+  if (sleepingCount_.load() > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    condition_.notify_one();
   }
-  condition_.notify_all();
 }
 
 ThreadPool::HandleRef ThreadPool::executeOnReadable(int fd, Task task, Duration tmo, Task tcb) {
@@ -254,7 +389,8 @@ void ThreadPool::runLoopOnce() {
 }
 
 void ThreadPool::breakLoop() {
-  condition_.notify_all();
+  std::lock_guard<std::mutex> lock(mutex_);
+  drained_.notify_all();
 }
 
 std::string ThreadPool::toString() const {
@@ -17,11 +17,19 @@
 #include <thread>
 #include <atomic>
 #include <deque>
+#include <memory>
+#include <vector>
 
 namespace stx {
 
 /**
- * Standard thread-safe thread pool.
+ * Standard thread-safe, work-stealing thread pool.
+ *
+ * Each worker owns a lock-free deque. Tasks submitted from within a worker
+ * are pushed onto its own deque, tasks submitted from any other thread
+ * go through a shared injection queue. Idle workers first drain their own
+ * deque, then grab a batch from the injection queue and finally try to
+ * steal from randomly chosen other workers before they go to sleep.
  */
 class ThreadPool : public Scheduler {
  public:
@@ -102,14 +110,45 @@ class ThreadPool : public Scheduler {
                                   long generation);
 
  private:
-  void work(int workerId);
+  struct Worker;
+
+  void work(size_t workerId);
+
+  /**
+   * Retrieves the next task to run for given worker.
+   *
+   * @retval true a task has been dequeued into @p result.
+   * @retval false no task could be found.
+   */
+  bool findTask(Worker* self, Task** result);
+
+  /**
+   * Moves a batch of tasks from the injection queue into @p self's deque.
+   */
+  bool takeInjected(Worker* self, Task** result);
+
+  /**
+   * Tries to steal a task from any other worker, starting at a random one.
+   */
+  bool steal(Worker* self, Task** result);
+
+  /**
+   * Blocks the calling worker until new tasks have been submitted.
+   */
+  void park();
 
  private:
-  bool active_;
+  static thread_local Worker* currentWorker_;
+
+  std::atomic<bool> active_;
   std::deque<std::thread> threads_;
+  std::vector<std::unique_ptr<Worker>> workers_;
   mutable std::mutex mutex_;
-  std::condition_variable condition_;
-  std::deque<Task> pendingTasks_;
+  std::condition_variable condition_;  //!< parks idle workers
+  std::condition_variable drained_;    //!< signals wait() callers
+  std::deque<Task*> pendingTasks_;     //!< tasks submitted by non-workers
+  std::atomic<size_t> pendingCount_;   //!< number of tasks queued anywhere
+  std::atomic<size_t> sleepingCount_;  //!< number of parked workers
   std::atomic<size_t> activeTasks_;
   std::atomic<size_t> activeTimers_;
   std::atomic<size_t> activeReaders_;
@@ -0,0 +1,101 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <stx/executor/TimerQueue.h>
+#include <stx/executor/NativeScheduler.h>
+#include <stx/test/benchmark.h>
+#include <stx/MonotonicClock.h>
+#include <vector>
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace stx;
+
+static const size_t kNumTimers = 1000000;
+
+struct BenchTimer : public TimerQueueEntry {
+};
+
+static void printPhase(const std::string& label, MonotonicTime start,
+                       size_t count) {
+  Benchmark::printResultTable(
+      label,
+      Benchmark::BenchmarkResult(
+          MonotonicClock::now().nanoseconds() - start.nanoseconds(),
+          count),
+      true);
+}
+
+/**
+ * Inserts 1M timers with random deadlines, cancels every other one
+ * and fires the remaining ones in deadline order.
+ */
+static void benchmarkTimerQueue() {
+  std::vector<BenchTimer> timers(kNumTimers);
+  TimerQueue<BenchTimer> queue;
+
+  srand(42);
+
+  MonotonicTime start = MonotonicClock::now();
+  for (BenchTimer& t: timers) {
+    queue.push(&t, MonotonicTime(rand()));
+  }
+  printPhase("TimerQueue: insert", start, kNumTimers);
+
+  start = MonotonicClock::now();
+  for (size_t i = 0; i < kNumTimers; i += 2) {
+    queue.remove(&timers[i]);
+  }
+  printPhase("TimerQueue: cancel", start, kNumTimers / 2);
+
+  start = MonotonicClock::now();
+  while (!queue.empty()) {
+    queue.pop();
+  }
+  printPhase("TimerQueue: fire", start, kNumTimers / 2);
+}
+
+/**
+ * Same as above, but through the Scheduler API, including the cost
+ * of handles and tasks.
+ */
+static void benchmarkScheduler() {
+  NativeScheduler scheduler;
+  std::vector<Scheduler::HandleRef> handles;
+  size_t fired = 0;
+
+  handles.reserve(kNumTimers);
+
+  MonotonicTime start = MonotonicClock::now();
+  for (size_t i = 0; i < kNumTimers; ++i) {
+    handles.emplace_back(scheduler.executeAfter(
+        Duration::fromMicroseconds(rand() % 100000),
+        [&fired]() { fired++; }));
+  }
+  printPhase("Scheduler: executeAfter", start, kNumTimers);
+
+  start = MonotonicClock::now();
+  for (size_t i = 0; i < kNumTimers; i += 2) {
+    handles[i]->cancel();
+  }
+  printPhase("Scheduler: cancel", start, kNumTimers / 2);
+
+  start = MonotonicClock::now();
+  scheduler.runLoop();
+  printPhase("Scheduler: fire (incl. 100ms spread)", start, fired);
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  benchmarkTimerQueue();
+  benchmarkScheduler();
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+namespace stx {
+
+template<typename T>
+TimerQueue<T>::TimerQueue()
+    : heap_() {
+}
+
+template<typename T>
+void TimerQueue<T>::push(T* t, MonotonicTime deadline) {
+  TimerQueueEntry* e = entryOf(t);
+
+  if (e->isQueued()) {
+    reschedule(t, deadline);
+    return;
+  }
+
+  e->deadline_ = deadline;
+  heap_.push_back(t);
+  e->queueIndex_ = heap_.size() - 1;
+  siftUp(e->queueIndex_);
+}
+
+template<typename T>
+void TimerQueue<T>::reschedule(T* t, MonotonicTime deadline) {
+  TimerQueueEntry* e = entryOf(t);
+  const MonotonicTime old = e->deadline_;
+  e->deadline_ = deadline;
+
+  if (deadline < old) {
+    siftUp(e->queueIndex_);
+  } else {
+    siftDown(e->queueIndex_);
+  }
+}
+
+template<typename T>
+bool TimerQueue<T>::remove(T* t) {
+  TimerQueueEntry* e = entryOf(t);
+
+  if (!e->isQueued())
+    return false;
+
+  const size_t i = e->queueIndex_;
+  e->queueIndex_ = TimerQueueEntry::npos;
+
+  T* last = heap_.back();
+  heap_.pop_back();
+
+  if (last != t) {
+    place(i, last);
+    if (i > 0 && entryOf(last)->deadline_ < entryOf(heap_[(i - 1) / kArity])->deadline_) {
+      siftUp(i);
+    } else {
+      siftDown(i);
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+T* TimerQueue<T>::top() const {
+  return heap_.empty() ? nullptr : heap_.front();
+}
+
+template<typename T>
+T* TimerQueue<T>::pop() {
+  T* t = top();
+  if (t)
+    remove(t);
+
+  return t;
+}
+
+template<typename T>
+inline void TimerQueue<T>::place(size_t i, T* t) {
+  heap_[i] = t;
+  entryOf(t)->queueIndex_ = i;
+}
+
+template<typename T>
+void TimerQueue<T>::siftUp(size_t i) {
+  T* t = heap_[i];
+  const MonotonicTime deadline = entryOf(t)->deadline_;
+
+  while (i > 0) {
+    const size_t parent = (i - 1) / kArity;
+    if (!(deadline < entryOf(heap_[parent])->deadline_))
+      break;
+
+    place(i, heap_[parent]);
+    i = parent;
+  }
+
+  place(i, t);
+}
+
+template<typename T>
+void TimerQueue<T>::siftDown(size_t i) {
+  const size_t count = heap_.size();
+  T* t = heap_[i];
+  const MonotonicTime deadline = entryOf(t)->deadline_;
+
+  for (;;) {
+    const size_t first = i * kArity + 1;
+    if (first >= count)
+      break;
+
+    const size_t last = std::min(first + kArity, count);
+    size_t best = first;
+    for (size_t c = first + 1; c < last; ++c) {
+      if (entryOf(heap_[c])->deadline_ < entryOf(heap_[best])->deadline_) {
+        best = c;
+      }
+    }
+
+    if (!(entryOf(heap_[best])->deadline_ < deadline))
+      break;
+
+    place(i, heap_[best]);
+    i = best;
+  }
+
+  place(i, t);
+}
+
+} // namespace stx
@@ -0,0 +1,88 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <stx/executor/TimerQueue.h>
+#include <stx/test/unittest.h>
+#include <vector>
+#include <stdlib.h>
+
+using namespace stx;
+
+UNIT_TEST(TimerQueueTest);
+
+struct TestTimer : public TimerQueueEntry {
+  int id;
+};
+
+TEST_CASE(TimerQueueTest, pop_ordered, []() {
+  std::vector<TestTimer> timers(1000);
+  TimerQueue<TestTimer> queue;
+
+  srand(42);
+  for (size_t i = 0; i < timers.size(); ++i) {
+    timers[i].id = i;
+    queue.push(&timers[i], MonotonicTime(rand() % 100));
+  }
+
+  EXPECT_EQ(1000, queue.size());
+
+  MonotonicTime last(0);
+  while (!queue.empty()) {
+    TestTimer* t = queue.pop();
+    EXPECT_TRUE(last <= t->deadline());
+    EXPECT_TRUE(!t->isQueued());
+    last = t->deadline();
+  }
+});
+
+TEST_CASE(TimerQueueTest, remove, []() {
+  std::vector<TestTimer> timers(100);
+  TimerQueue<TestTimer> queue;
+
+  for (size_t i = 0; i < timers.size(); ++i) {
+    timers[i].id = i;
+    queue.push(&timers[i], MonotonicTime(i * 7 % 100));
+  }
+
+  for (size_t i = 0; i < timers.size(); i += 2) {
+    EXPECT_TRUE(queue.remove(&timers[i]));
+  }
+  EXPECT_TRUE(!queue.remove(&timers[0]));
+  EXPECT_EQ(50, queue.size());
+
+  MonotonicTime last(0);
+  while (!queue.empty()) {
+    TestTimer* t = queue.pop();
+    EXPECT_EQ(1, t->id % 2);
+    EXPECT_TRUE(last <= t->deadline());
+    last = t->deadline();
+  }
+});
+
+TEST_CASE(TimerQueueTest, reschedule, []() {
+  TestTimer a;
+  TestTimer b;
+  TestTimer c;
+  TimerQueue<TestTimer> queue;
+
+  queue.push(&a, MonotonicTime(10));
+  queue.push(&b, MonotonicTime(20));
+  queue.push(&c, MonotonicTime(30));
+  EXPECT_TRUE(queue.top() == &a);
+
+  queue.reschedule(&a, MonotonicTime(40));
+  EXPECT_TRUE(queue.top() == &b);
+
+  queue.push(&c, MonotonicTime(5)); // already queued, thus rescheduled
+  EXPECT_EQ(3, queue.size());
+  EXPECT_TRUE(queue.pop() == &c);
+  EXPECT_TRUE(queue.pop() == &b);
+  EXPECT_TRUE(queue.pop() == &a);
+  EXPECT_TRUE(queue.pop() == nullptr);
+});
@@ -0,0 +1,113 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <stx/MonotonicTime.h>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+namespace stx {
+
+template<typename T> class TimerQueue;
+
+/**
+ * Base class for objects that can be scheduled in a TimerQueue.
+ *
+ * The entry remembers its own position inside the queue, which allows
+ * removing or rescheduling it without searching.
+ */
+class TimerQueueEntry {
+ public:
+  TimerQueueEntry() : deadline_(), queueIndex_(npos) {}
+
+  /** Retrieves the point in time this entry is scheduled for. */
+  MonotonicTime deadline() const noexcept { return deadline_; }
+
+  /** Tests whether or not this entry is currently scheduled. */
+  bool isQueued() const noexcept { return queueIndex_ != npos; }
+
+ private:
+  template<typename T> friend class TimerQueue;
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  MonotonicTime deadline_;
+  size_t queueIndex_;
+};
+
+/**
+ * Priority queue of timers ordered by their deadline, implemented as
+ * an intrusive 4-ary min-heap.
+ *
+ * Insertion, removal and rescheduling are O(log n), the earliest
+ * deadline is available in O(1). A 4-ary heap is shallower than a
+ * binary one and keeps the children of a node within one cache line.
+ *
+ * The queue does not take ownership of its entries.
+ *
+ * @param T entry type, must derive from TimerQueueEntry.
+ */
+template<typename T>
+class TimerQueue {
+ public:
+  TimerQueue();
+
+  /** Tests whether the queue is empty. */
+  bool empty() const noexcept { return heap_.empty(); }
+
+  /** Retrieves the number of scheduled entries. */
+  size_t size() const noexcept { return heap_.size(); }
+
+  /**
+   * Schedules given @p entry at @p deadline.
+   *
+   * If the entry is already scheduled it is rescheduled instead.
+   */
+  void push(T* entry, MonotonicTime deadline);
+
+  /**
+   * Changes the deadline of an already scheduled @p entry.
+   */
+  void reschedule(T* entry, MonotonicTime deadline);
+
+  /**
+   * Removes given @p entry from the queue.
+   *
+   * @retval true the entry was scheduled and has been removed.
+   * @retval false the entry was not scheduled.
+   */
+  bool remove(T* entry);
+
+  /** Retrieves the entry with the earliest deadline or @c nullptr. */
+  T* top() const;
+
+  /** Removes and returns the entry with the earliest deadline. */
+  T* pop();
+
+  /** Retrieves the n-th entry in heap order (not sorted by deadline). */
+  T* at(size_t i) const { return heap_[i]; }
+
+ private:
+  static TimerQueueEntry* entryOf(T* t) { return t; }
+
+  void place(size_t i, T* t);
+  void siftUp(size_t i);
+  void siftDown(size_t i);
+
+ private:
+  static constexpr size_t kArity = 4;
+
+  std::vector<T*> heap_;
+};
+
+} // namespace stx
+
+#include <stx/executor/TimerQueue-inl.h>
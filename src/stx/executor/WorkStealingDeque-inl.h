@@ -0,0 +1,111 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+namespace stx {
+
+template<typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_t initialCapacity)
+    : top_(0),
+      bottom_(0),
+      buffer_(nullptr),
+      buffers_() {
+  size_t capacity = 1;
+  while (capacity < initialCapacity)
+    capacity <<= 1;
+
+  buffers_.emplace_back(new Buffer(capacity));
+  buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+}
+
+template<typename T>
+void WorkStealingDeque<T>::push(T value) {
+  const int64_t b = bottom_.load(std::memory_order_relaxed);
+  const int64_t t = top_.load(std::memory_order_acquire);
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+
+  if (b - t > static_cast<int64_t>(buffer->capacity()) - 1) {
+    buffer = grow(buffer, b, t);
+  }
+
+  buffer->put(b, value);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(b + 1, std::memory_order_relaxed);
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::pop(T* result) {
+  const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  bottom_.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = top_.load(std::memory_order_relaxed);
+
+  if (t > b) {
+    // empty
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  *result = buffer->get(b);
+
+  if (t == b) {
+    // last element, race against thieves
+    bool won = top_.compare_exchange_strong(t, t + 1,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  return true;
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::steal(T* result) {
+  int64_t t = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t b = bottom_.load(std::memory_order_acquire);
+
+  if (t >= b)
+    return false;
+
+  Buffer* buffer = buffer_.load(std::memory_order_acquire);
+  T value = buffer->get(t);
+
+  if (!top_.compare_exchange_strong(t, t + 1,
+                                    std::memory_order_seq_cst,
+                                    std::memory_order_relaxed))
+    return false;
+
+  *result = value;
+  return true;
+}
+
+template<typename T>
+size_t WorkStealingDeque<T>::size() const {
+  const int64_t b = bottom_.load(std::memory_order_relaxed);
+  const int64_t t = top_.load(std::memory_order_relaxed);
+  return b > t ? static_cast<size_t>(b - t) : 0;
+}
+
+template<typename T>
+typename WorkStealingDeque<T>::Buffer* WorkStealingDeque<T>::grow(
+    Buffer* buffer, int64_t bottom, int64_t top) {
+  Buffer* bigger = new Buffer(buffer->capacity() * 2);
+
+  for (int64_t i = top; i != bottom; ++i)
+    bigger->put(i, buffer->get(i));
+
+  buffers_.emplace_back(bigger);
+  buffer_.store(bigger, std::memory_order_release);
+
+  return bigger;
+}
+
+} // namespace stx
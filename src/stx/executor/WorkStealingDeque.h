@@ -0,0 +1,103 @@
+// This file is part of the "libcortex" project
+//   (c) 2009-2015 Christian Parpart <https://github.com/christianparpart>
+//   (c) 2014-2015 Paul Asmuth <https://github.com/paulasmuth>
+//
+// libcortex is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Affero General Public License v3.0.
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+namespace stx {
+
+/**
+ * Lock-free Chase-Lev work-stealing deque.
+ *
+ * The owning thread pushes and pops at the bottom end (LIFO), while any
+ * other thread may steal from the top end (FIFO). The buffer grows on
+ * demand; retired buffers are kept until the deque is destroyed, as
+ * concurrent thieves may still be reading from them.
+ *
+ * See "Correct and Efficient Work-Stealing for Weak Memory Models"
+ * (Lê, Pop, Cohen, Zappa Nardelli; PPoPP 2013).
+ *
+ * @param T element type, must be trivially copyable (typically a pointer).
+ */
+template<typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t initialCapacity = 1024);
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  /**
+   * Pushes @p value to the bottom end.
+   *
+   * @note may only be invoked by the owning thread.
+   */
+  void push(T value);
+
+  /**
+   * Pops the most recently pushed value from the bottom end.
+   *
+   * @retval true a value was popped into @p result.
+   * @retval false the deque was empty.
+   *
+   * @note may only be invoked by the owning thread.
+   */
+  bool pop(T* result);
+
+  /**
+   * Steals the least recently pushed value from the top end.
+   *
+   * @retval true a value was stolen into @p result.
+   * @retval false the deque was empty or the race was lost to
+   *               another thief or the owner.
+   */
+  bool steal(T* result);
+
+  /** Retrieves an estimate of the number of elements. */
+  size_t size() const;
+
+  /** Tests whether the deque appears empty. */
+  bool empty() const { return size() == 0; }
+
+ private:
+  struct Buffer { // {{{
+    explicit Buffer(size_t capacity)
+        : mask(capacity - 1),
+          slots(new std::atomic<T>[capacity]) {}
+
+    size_t capacity() const { return mask + 1; }
+
+    T get(int64_t i) const {
+      return slots[i & mask].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t i, T value) {
+      slots[i & mask].store(value, std::memory_order_relaxed);
+    }
+
+    size_t mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  }; // }}}
+
+  Buffer* grow(Buffer* buffer, int64_t bottom, int64_t top);
+
+ private:
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  std::atomic<Buffer*> buffer_;
+  std::vector<std::unique_ptr<Buffer>> buffers_; //!< current and retired
+};
+
+} // namespace stx
+
+#include <stx/executor/WorkStealingDeque-inl.h>
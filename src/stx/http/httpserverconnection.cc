@@ -10,6 +10,7 @@
 #include "stx/exception.h"
 #include "stx/inspect.h"
 #include "stx/logging.h"
+#include "stx/MonotonicClock.h"
 #include "stx/http/httpserverconnection.h"
 #include "stx/http/httpgenerator.h"
 
@@ -114,6 +115,12 @@ void HTTPServerConnection::read() {
       close();
       return;
     } else {
+      if (!first_byte_time_) {
+        first_byte_time_ = MonotonicClock::now();
+        stats_->first_byte_time.addValue(
+            (first_byte_time_ - request_start_).microseconds());
+      }
+
       parser_.parse((char *) read_buf_.data(), len);
     }
   } catch (Exception& e) {
@@ -189,6 +196,9 @@ void HTTPServerConnection::nextRequest() {
   cur_handler_.reset(nullptr);
   on_write_completed_cb_ = nullptr;
   body_buf_.clear();
+  request_start_ = MonotonicClock::now();
+  first_byte_time_ = MonotonicTime();
+  response_time_ = MonotonicTime();
 
   parser_.onBodyChunk([this] (const char* data, size_t size) {
     std::unique_lock<std::recursive_mutex> lk(mutex_);
@@ -202,6 +212,10 @@ void HTTPServerConnection::dispatchRequest() {
   stats_->total_requests.incr(1);
   stats_->current_requests.incr(1);
 
+  headers_time_ = MonotonicClock::now();
+  stats_->header_time.addValue(
+      (headers_time_ - first_byte_time_).microseconds());
+
   incRef();
   cur_handler_= handler_factory_->getHandler(this, cur_request_.get());
   cur_handler_->handleHTTPRequest();
@@ -266,6 +280,12 @@ void HTTPServerConnection::writeResponse(
     RAISE(kIllegalStateError, "can't write response before request is read");
   }
 
+  if (!response_time_) {
+    response_time_ = MonotonicClock::now();
+    stats_->handler_time.addValue(
+        (response_time_ - headers_time_).microseconds());
+  }
+
   BufferOutputStream os(&write_buf_);
   HTTPGenerator::generate(resp, &os);
   on_write_completed_cb_ = ready_callback;
@@ -290,6 +310,13 @@ void HTTPServerConnection::writeResponseBody(
 void HTTPServerConnection::finishResponse() {
   stats_->current_requests.decr(1);
 
+  auto now = MonotonicClock::now();
+  if (response_time_ != MonotonicTime()) {
+    stats_->flush_time.addValue((now - response_time_).microseconds());
+  }
+
+  stats_->request_time.addValue((now - first_byte_time_).microseconds());
+
   if (decRef()) {
     return;
   }
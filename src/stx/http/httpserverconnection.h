@@ -12,6 +12,7 @@
 #include <memory>
 #include <vector>
 #include <stx/autoref.h>
+#include <stx/MonotonicTime.h>
 #include <stx/stdtypes.h>
 #include <stx/http/httphandler.h>
 #include <stx/http/httpparser.h>
@@ -126,6 +127,10 @@ protected:
   mutable std::recursive_mutex mutex_;
   bool closed_;
   HTTPServerStats* stats_;
+  MonotonicTime request_start_;
+  MonotonicTime first_byte_time_;
+  MonotonicTime headers_time_;
+  MonotonicTime response_time_;
 };
 
 }
@@ -13,6 +13,7 @@
 #include "stx/io/fileutil.h"
 #include "stx/stdtypes.h"
 #include "stx/stats/counter.h"
+#include "stx/stats/histogram.h"
 #include "stx/stats/multicounter.h"
 #include "stx/stats/statsrepository.h"
 
@@ -86,6 +87,19 @@ struct HTTPServerStats {
   stats::Counter<uint64_t> received_bytes;
   stats::Counter<uint64_t> sent_bytes;
 
+  /**
+   * Per request phase times in microseconds: from accepting the connection
+   * (or finishing the previous request on it) until the first byte of the
+   * request was read, from there until all headers were parsed, from there
+   * until the handler wrote the response, from there until the last byte of
+   * the response was written, and the whole request from the first byte on
+   */
+  stats::Histogram first_byte_time;
+  stats::Histogram header_time;
+  stats::Histogram handler_time;
+  stats::Histogram flush_time;
+  stats::Histogram request_time;
+
   HTTPServerStats() :
       status_codes(("http_status")) {}
 
@@ -132,6 +146,53 @@ struct HTTPServerStats {
         &sent_bytes,
         stats::ExportMode::EXPORT_DELTA);
 
+    exportHistogram(
+        path_prefix,
+        "first_byte_time",
+        &first_byte_time,
+        stats_repo);
+
+    exportHistogram(
+        path_prefix,
+        "header_time",
+        &header_time,
+        stats_repo);
+
+    exportHistogram(
+        path_prefix,
+        "handler_time",
+        &handler_time,
+        stats_repo);
+
+    exportHistogram(
+        path_prefix,
+        "flush_time",
+        &flush_time,
+        stats_repo);
+
+    exportHistogram(
+        path_prefix,
+        "request_time",
+        &request_time,
+        stats_repo);
+  }
+
+protected:
+
+  void exportHistogram(
+      const String& path_prefix,
+      const String& name,
+      stats::Histogram* histogram,
+      stats::StatsRepository* stats_repo) {
+    stats_repo->exportStat(
+        FileUtil::joinPaths(path_prefix, name),
+        histogram,
+        stats::ExportMode::EXPORT_DELTA);
+
+    stats_repo->exportStat(
+        FileUtil::joinPaths(path_prefix, name),
+        histogram->percentiles(),
+        stats::ExportMode::EXPORT_VALUE);
   }
 };
 
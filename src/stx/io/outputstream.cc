@@ -207,5 +207,9 @@ size_t BufferOutputStream::write(const char* data, size_t size) {
   return size;
 }
 
+Buffer* BufferOutputStream::buffer() const {
+  return buf_;
+}
+
 } // fnord
 
@@ -224,6 +224,11 @@ public:
    */
   size_t write(const char* data, size_t size) override;
 
+  /**
+   * Returns the buffer this stream appends to
+   */
+  Buffer* buffer() const;
+
 protected:
   Buffer* buf_;
 };
@@ -14,6 +14,7 @@
 #include "stx/UnixTime.h"
 #include "stx/json/json.h"
 #include "stx/json/jsoninputstream.h"
+#include "stx/json/jsonscanner.h"
 
 namespace stx {
 namespace json {
@@ -31,13 +32,15 @@ JSONToken::JSONToken(
     size(1) {}
 
 JSONObject parseJSON(const std::string& json_str) {
-  JSONInputStream json(StringInputStream::fromString(json_str));
-  return parseJSON(&json);
+  JSONObject obj;
+  JSONScanner::parse(json_str.data(), json_str.size(), &obj);
+  return obj;
 }
 
 JSONObject parseJSON(const stx::Buffer& json_buf) {
-  JSONInputStream json(BufferInputStream::fromBuffer(&json_buf));
-  return parseJSON(&json);
+  JSONObject obj;
+  JSONScanner::parse((const char*) json_buf.data(), json_buf.size(), &obj);
+  return obj;
 }
 
 JSONObject parseJSON(JSONInputStream* json) {
@@ -23,6 +23,9 @@ namespace json {
 class JSONOutputStream;
 class JSONInputStream;
 
+template <typename T, typename Enable = void>
+struct JSONCodec;
+
 template <typename T, typename O>
 void toJSONImpl(const Vector<T>& value, O* target);
 
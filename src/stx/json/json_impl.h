@@ -14,7 +14,9 @@
 #include "stx/UnixTime.h"
 #include "stx/traits.h"
 #include "stx/json/jsonutil.h"
+#include "stx/json/jsoncodec.h"
 #include "stx/json/jsonoutputstream.h"
+#include "stx/json/jsonreader.h"
 #include "stx/reflect/indexsequence.h"
 #include "stx/reflect/reflect.h"
 
@@ -76,12 +78,14 @@ T fromJSON(
 
 template <typename T>
 T fromJSON(const std::string& json_str) {
-  return fromJSON<T>(parseJSON(json_str));
+  JSONReader json(json_str.data(), json_str.size());
+  return JSONCodec<T>::decode(&json);
 }
 
 template <typename T>
 T fromJSON(const stx::Buffer& json_buf) {
-  return fromJSON<T>(parseJSON(json_buf));
+  JSONReader json((const char*) json_buf.data(), json_buf.size());
+  return JSONCodec<T>::decode(&json);
 }
 
 template <typename T>
@@ -110,13 +114,11 @@ void toJSON(const T& value, O* target) {
 
 template <typename T>
 std::string toJSONString(const T& value) {
-  std::string json_str;
-  JSONOutputStream json(
-      static_cast<std::unique_ptr<OutputStream>>(
-          StringOutputStream::fromString(&json_str)));
+  Buffer buf;
+  JSONOutputStream json(&buf);
 
-  toJSON(value, &json);
-  return json_str;
+  JSONCodec<T>::encode(value, &json);
+  return buf.toString();
 }
 
 template <typename T>
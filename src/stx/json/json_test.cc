@@ -12,10 +12,13 @@
 #include <string.h>
 #include "stx/io/inputstream.h"
 #include "stx/json/flatjsonreader.h"
+#include "stx/json/jsoncodec.h"
 #include "stx/json/jsondocument.h"
 #include "stx/json/jsonutil.h"
 #include "stx/json/jsoninputstream.h"
+#include "stx/json/jsonoutputstream.h"
 #include "stx/json/jsonpointer.h"
+#include "stx/json/jsonscanner.h"
 #include "stx/test/unittest.h"
 
 UNIT_TEST(JSONTest);
@@ -286,3 +289,280 @@ TEST_CASE(JSONTest, TestJSONReencoding1, [] () {
   auto obj2 = stx::json::fromJSON<TestJSONObject>(obj_json);
   EXPECT_EQ(obj2.data, orig_str);
 });
+
+static stx::json::JSONObject parseJSONStream(const std::string& json_str) {
+  JSONInputStream json(StringInputStream::fromString(json_str));
+  return stx::json::parseJSON(&json);
+}
+
+static void expectSameTokens(const std::string& json_str) {
+  auto expected = parseJSONStream(json_str);
+  stx::json::JSONObject tokens;
+  stx::json::JSONScanner::parse(json_str.data(), json_str.size(), &tokens);
+
+  EXPECT_EQ(tokens.size(), expected.size());
+  for (size_t i = 0; i < tokens.size() && i < expected.size(); ++i) {
+    EXPECT_EQ(tokens[i].type, expected[i].type);
+    EXPECT_EQ(tokens[i].data, expected[i].data);
+    EXPECT_EQ(tokens[i].size, expected[i].size);
+  }
+}
+
+TEST_CASE(JSONTest, TestJSONScanner, [] () {
+  expectSameTokens(
+      "{ 123: \"fnord\", \"blah\": [ true, false, null, 3.7e-5 ] }");
+  expectSameTokens(R"({"str":"fub \\\"blah\\\" bar","x":{}})");
+  expectSameTokens(R"([[],{},"",-1,"{[:,]}",{"a":[1,2,{"b":null}]}])");
+  expectSameTokens("{\"a\":\r\n [1,\n2]}");
+  expectSameTokens("");
+  expectSameTokens("   ");
+  expectSameTokens("12");
+
+  auto tokens = stx::json::parseJSON(R"({"a": "b\"c", "d": [1e5]})");
+  EXPECT_EQ(tokens.size(), 8);
+  EXPECT_EQ(tokens[0].size, 8);
+  EXPECT_EQ(tokens[2].data, "b\"c");
+  EXPECT_EQ(tokens[4].size, 3);
+  EXPECT_EQ(tokens[5].data, "1e5");
+
+  /* unlike the JSONInputStream, the scanner also accepts tabs */
+  tokens = stx::json::parseJSON("{\"a\":\t[1,\t2]}");
+  EXPECT_EQ(tokens.size(), 7);
+});
+
+TEST_CASE(JSONTest, TestJSONScannerBlockBoundaries, [] () {
+  /* runs of backslashes and quotes across the 64 byte blocks */
+  for (size_t pad = 0; pad < 70; ++pad) {
+    for (size_t nbackslashes = 0; nbackslashes < 6; ++nbackslashes) {
+      std::string json_str = "[\"";
+      json_str += std::string(pad, 'x');
+      json_str += std::string(nbackslashes * 2, '\\');
+      json_str += "\\\"";
+      json_str += std::string(pad % 7, ' ');
+      json_str += "\", {\"k\": [true, 1.5, \"]\"]}, \"";
+      json_str += std::string(nbackslashes * 2, '\\');
+      json_str += "\"]";
+      expectSameTokens(json_str);
+    }
+  }
+
+  std::string long_str = "[";
+  for (size_t i = 0; i < 500; ++i) {
+    long_str += "{\"id\": 12345, \"text\": \"a \\\"quoted\\\" {text}\"},";
+  }
+  long_str += "null]";
+  expectSameTokens(long_str);
+});
+
+TEST_CASE(JSONTest, TestJSONScannerErrors, [] () {
+  EXPECT_EXCEPTION("invalid json. unterminated string", [] {
+    stx::json::parseJSON(R"({"a": "b)");
+  });
+
+  EXPECT_EXCEPTION("invalid json. unterminated string", [] {
+    stx::json::parseJSON(R"(["\"])");
+  });
+
+  EXPECT_EXCEPTION("unbalanced braces", [] {
+    stx::json::parseJSON("[]]");
+  });
+
+  EXPECT_EXCEPTION("invalid JSON. unexpected end of stream", [] {
+    stx::json::parseJSON("[[]");
+  });
+
+  EXPECT_EXCEPTION("invalid json. expected 'true', got 'trux'", [] {
+    stx::json::parseJSON("[trux]");
+  });
+
+  EXPECT_EXCEPTION("invalid json, unexpected char: x", [] {
+    stx::json::parseJSON("[truex]");
+  });
+
+  EXPECT_EXCEPTION("invalid json, unexpected char: @", [] {
+    stx::json::parseJSON("[@]");
+  });
+});
+
+static stx::String formatFloat(double value) {
+  stx::Buffer buf;
+  stx::json::JSONOutputStream json(&buf);
+  json.addFloat(value);
+  return buf.toString();
+}
+
+static stx::String formatInteger(int64_t value) {
+  stx::Buffer buf;
+  stx::json::JSONOutputStream json(&buf);
+  json.addInteger(value);
+  return buf.toString();
+}
+
+static const double kRoundtripValues[] = {
+  1.0 / 3, 2.0 / 3, 1e-20, 123456789.123, 1e17, 0.3
+};
+
+TEST_CASE(JSONTest, TestJSONOutputStreamNumbers, [] () {
+  EXPECT_EQ(formatFloat(1.0), "1.0");
+  EXPECT_EQ(formatFloat(23.5), "23.5");
+  EXPECT_EQ(formatFloat(-123.5), "-123.5");
+  EXPECT_EQ(formatFloat(0.1), "0.1");
+  EXPECT_EQ(formatFloat(0.05), "0.05");
+  EXPECT_EQ(formatFloat(1.0 / 3), "0.3333333333333333");
+  EXPECT_EQ(formatFloat(3.7e-5), "0.000037");
+  EXPECT_EQ(formatFloat(1e300), "1e+300");
+  EXPECT_EQ(formatFloat(0.0), "null");
+  EXPECT_EQ(formatFloat(std::nan("")), "null");
+
+  for (auto v : kRoundtripValues) {
+    EXPECT_EQ(strtod(formatFloat(v).c_str(), nullptr), v);
+  }
+
+  EXPECT_EQ(formatInteger(0), "0");
+  EXPECT_EQ(formatInteger(7), "7");
+  EXPECT_EQ(formatInteger(-42), "-42");
+  EXPECT_EQ(formatInteger(1234567890123), "1234567890123");
+  EXPECT_EQ(formatInteger(INT64_MAX), "9223372036854775807");
+  EXPECT_EQ(formatInteger(INT64_MIN), "-9223372036854775808");
+});
+
+TEST_CASE(JSONTest, TestJSONOutputStreamEscaping, [] () {
+  stx::String str = "a \"quoted\" string with a \\ and a\nnewline\tand tab";
+  str += " followed by enough plain text to span several blocks";
+
+  stx::Buffer buf;
+  stx::json::JSONOutputStream json(&buf);
+  json.beginObject();
+  json.addObjectEntry("k\"ey");
+  json.addString(str);
+  json.endObject();
+
+  EXPECT_EQ(
+      buf.toString(),
+      "{\"k\\\"ey\": \"a \\\"quoted\\\" string with a \\\\ and a\\nnewline"
+      "\\tand tab followed by enough plain text to span several blocks\"}");
+});
+
+TEST_CASE(JSONTest, TestJSONOutputStreamToBufferOutputStream, [] () {
+  stx::Buffer buf;
+  stx::json::JSONOutputStream json(stx::BufferOutputStream::fromBuffer(&buf));
+  json.beginArray();
+  json.addInteger(1);
+  json.addComma();
+  EXPECT_EQ(buf.toString(), "[1,");
+  json.addTrue();
+  json.endArray();
+  EXPECT_EQ(buf.toString(), "[1,true]");
+});
+
+struct TestItem {
+  stx::String name;
+  stx::Vector<stx::String> tags;
+  unsigned long long count;
+  bool active;
+
+  template <typename T>
+  static void reflect(T* meta) {
+    meta->prop(&TestItem::name, 1, "name", false);
+    meta->prop(&TestItem::tags, 2, "tags", true);
+    meta->prop(&TestItem::count, 3, "count", false);
+    meta->prop(&TestItem::active, 4, "active", true);
+  }
+};
+
+struct TestOrder {
+  int id;
+  stx::String customer;
+  stx::Vector<TestItem> items;
+  stx::json::JSONObject meta;
+
+  template <typename T>
+  static void reflect(T* meta) {
+    meta->prop(&TestOrder::id, 1, "id", false);
+    meta->prop(&TestOrder::customer, 2, "customer", false);
+    meta->prop(&TestOrder::items, 3, "items", false);
+    meta->prop(&TestOrder::meta, 4, "meta", true);
+  }
+};
+
+TEST_CASE(JSONTest, TestJSONCodecMatchesProxy, [] () {
+  TestOrder order;
+  order.id = 42;
+  order.customer = "a \"quoted\" name";
+  order.items.resize(2);
+  order.items[0].name = "first";
+  order.items[0].tags.emplace_back("x");
+  order.items[0].tags.emplace_back("y");
+  order.items[0].count = 12345678901234ULL;
+  order.items[0].active = true;
+  order.items[1].name = "second";
+  order.items[1].count = 0;
+  order.items[1].active = false;
+  order.meta = stx::json::parseJSON(R"({"a": [1, 2], "b": null})");
+
+  stx::Buffer buf;
+  stx::json::JSONOutputStream json(&buf);
+  stx::json::toJSON(order, &json);
+
+  auto json_str = stx::json::toJSONString(order);
+  EXPECT_EQ(json_str, buf.toString());
+
+  auto order2 = stx::json::fromJSON<TestOrder>(json_str);
+  EXPECT_EQ(order2.id, 42);
+  EXPECT_EQ(order2.customer, order.customer);
+  EXPECT_EQ(order2.items.size(), 2);
+  EXPECT_EQ(order2.items[0].name, "first");
+  EXPECT_EQ(order2.items[0].tags.size(), 2);
+  EXPECT_EQ(order2.items[0].tags[1], "y");
+  EXPECT_EQ(order2.items[0].count, 12345678901234ULL);
+  EXPECT_EQ(order2.items[0].active, true);
+  EXPECT_EQ(order2.items[1].name, "second");
+  EXPECT_EQ(order2.items[1].tags.size(), 0);
+  EXPECT_EQ(order2.items[1].active, false);
+  EXPECT_EQ(order2.meta.size(), order.meta.size());
+  EXPECT_EQ(
+      stx::json::toJSONString(order2.meta),
+      stx::json::toJSONString(order.meta));
+});
+
+TEST_CASE(JSONTest, TestJSONCodecDecode, [] () {
+  auto order = stx::json::fromJSON<TestOrder>(
+      R"({"unknown": {"id": 1, "x": ["}"]}, "customer": "c\"d", )"
+      R"("items": [{"count": 7, "name": "n", "extra": [1, [2]]}], )"
+      R"("id": "23"})");
+
+  EXPECT_EQ(order.id, 23);
+  EXPECT_EQ(order.customer, "c\"d");
+  EXPECT_EQ(order.items.size(), 1);
+  EXPECT_EQ(order.items[0].name, "n");
+  EXPECT_EQ(order.items[0].count, 7);
+  EXPECT_EQ(order.meta.size(), 0);
+
+  auto escaped_key = stx::json::fromJSON<TestMessage>(
+      R"({"\a": "value", "b": 1})");
+  EXPECT_EQ(escaped_key.a, "value");
+
+  EXPECT_EXCEPTION("no such element: items", [] {
+    stx::json::fromJSON<TestOrder>(R"({"id": 1, "customer": "c"})");
+  });
+
+  EXPECT_EXCEPTION("unbalanced braces", [] {
+    stx::json::fromJSON<TestOrder>(R"({"id": 1, "meta": {"a": [}]})");
+  });
+});
+
+TEST_CASE(JSONTest, TestPerfectHashTable, [] () {
+  stx::Vector<stx::String> keys;
+  for (int i = 0; i < 100; ++i) {
+    keys.emplace_back(stx::StringUtil::format("key$0", i));
+  }
+
+  stx::json::PerfectHashTable table(keys);
+  for (int i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(table.find(keys[i].data(), keys[i].size()), i);
+  }
+
+  EXPECT_EQ(table.find("key", 3), -1);
+  EXPECT_EQ(table.find("key100", 6), -1);
+  EXPECT_EQ(table.find("", 0), -1);
+});
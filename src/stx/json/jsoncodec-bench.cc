@@ -0,0 +1,168 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "stx/json/json.h"
+#include "stx/json/jsoncodec.h"
+#include "stx/json/jsonoutputstream.h"
+#include "stx/test/benchmark.h"
+#include "stx/stringutil.h"
+
+using namespace stx;
+using namespace stx::json;
+
+static const size_t kNumEvents = 1000;
+
+struct Item {
+  String item_id;
+  unsigned int position;
+  bool clicked;
+  Vector<String> tags;
+
+  template <typename T>
+  static void reflect(T* meta) {
+    meta->prop(&Item::item_id, 1, "item_id", false);
+    meta->prop(&Item::position, 2, "position", false);
+    meta->prop(&Item::clicked, 3, "clicked", false);
+    meta->prop(&Item::tags, 4, "tags", true);
+  }
+};
+
+struct Session {
+  String session_id;
+  String user_agent;
+  unsigned long long first_seen;
+  unsigned long long last_seen;
+
+  template <typename T>
+  static void reflect(T* meta) {
+    meta->prop(&Session::session_id, 1, "session_id", false);
+    meta->prop(&Session::user_agent, 2, "user_agent", false);
+    meta->prop(&Session::first_seen, 3, "first_seen", false);
+    meta->prop(&Session::last_seen, 4, "last_seen", false);
+  }
+};
+
+struct Event {
+  String event_id;
+  String event_type;
+  unsigned long long time;
+  int page;
+  String query;
+  Session session;
+  Vector<Item> items;
+
+  template <typename T>
+  static void reflect(T* meta) {
+    meta->prop(&Event::event_id, 1, "event_id", false);
+    meta->prop(&Event::event_type, 2, "event_type", false);
+    meta->prop(&Event::time, 3, "time", false);
+    meta->prop(&Event::page, 4, "page", false);
+    meta->prop(&Event::query, 5, "query", true);
+    meta->prop(&Event::session, 6, "session", false);
+    meta->prop(&Event::items, 7, "items", false);
+  }
+};
+
+static Event buildEvent(size_t n) {
+  Event ev;
+  ev.event_id = StringUtil::format("ev-$0", n);
+  ev.event_type = n % 3 ? "search" : "click";
+  ev.time = 1430000000000000 + n;
+  ev.page = n % 10;
+  ev.query = StringUtil::format("a \"quoted\" query $0", n % 97);
+  ev.session.session_id = StringUtil::format("session-$0", n / 7);
+  ev.session.user_agent = "Mozilla/5.0 (X11; Linux x86_64)";
+  ev.session.first_seen = 1430000000000000;
+  ev.session.last_seen = 1430000000000000 + n * 3;
+
+  for (size_t j = 0; j < 8; ++j) {
+    Item item;
+    item.item_id = StringUtil::format("item-$0-$1", n, j);
+    item.position = j;
+    item.clicked = (n + j) % 5 == 0;
+    item.tags.emplace_back("tag");
+    ev.items.emplace_back(item);
+  }
+
+  return ev;
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  Vector<Event> events;
+  Vector<String> encoded;
+  for (size_t n = 0; n < kNumEvents; ++n) {
+    events.emplace_back(buildEvent(n));
+    encoded.emplace_back(toJSONString(events.back()));
+  }
+
+  size_t checksum = 0;
+
+  auto proxy_encode = Benchmark::benchmark([&]() {
+    for (const auto& ev : events) {
+      Buffer buf;
+      JSONOutputStream json(&buf);
+      toJSON(ev, &json);
+      checksum += buf.size();
+    }
+  }, 10);
+
+  Benchmark::printResultTable(
+      "encode via JSONOutputProxy",
+      Benchmark::BenchmarkResult(proxy_encode.meanRuntimeNanos(), kNumEvents),
+      true);
+
+  auto codec_encode = Benchmark::benchmark([&]() {
+    for (const auto& ev : events) {
+      Buffer buf;
+      JSONOutputStream json(&buf);
+      JSONCodec<Event>::encode(ev, &json);
+      checksum += buf.size();
+    }
+  }, 10);
+
+  Benchmark::printResultTable(
+      "encode via JSONCodec",
+      Benchmark::BenchmarkResult(codec_encode.meanRuntimeNanos(), kNumEvents),
+      true);
+
+  auto proxy_decode = Benchmark::benchmark([&]() {
+    for (const auto& str : encoded) {
+      auto ev = fromJSON<Event>(parseJSON(str));
+      checksum += ev.items.size();
+    }
+  }, 10);
+
+  Benchmark::printResultTable(
+      "decode via JSONInputProxy",
+      Benchmark::BenchmarkResult(proxy_decode.meanRuntimeNanos(), kNumEvents),
+      true);
+
+  auto codec_decode = Benchmark::benchmark([&]() {
+    for (const auto& str : encoded) {
+      JSONReader json(str.data(), str.size());
+      auto ev = JSONCodec<Event>::decode(&json);
+      checksum += ev.items.size();
+    }
+  }, 10);
+
+  Benchmark::printResultTable(
+      "decode via JSONCodec",
+      Benchmark::BenchmarkResult(codec_decode.meanRuntimeNanos(), kNumEvents),
+      true);
+
+  if (checksum == 0) {
+    printf("unexpected checksum\n");
+  }
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include "stx/exception.h"
+#include "stx/json/jsoncodec.h"
+
+namespace stx {
+namespace json {
+
+PerfectHashTable::PerfectHashTable(
+    const Vector<String>& keys) :
+    keys_(keys) {
+  size_t nslots = 4;
+  while (nslots < keys.size() * 2) {
+    nslots *= 2;
+  }
+
+  // try a few seeds per table size and double the size if none of them
+  // works
+  for (;; nslots *= 2) {
+    mask_ = nslots - 1;
+
+    for (seed_ = 0; seed_ < 64; ++seed_) {
+      slots_.assign(nslots, -1);
+
+      bool collision = false;
+      for (size_t i = 0; i < keys.size() && !collision; ++i) {
+        auto h = hash(keys[i].data(), keys[i].size(), seed_);
+        auto& slot = slots_[h & mask_];
+        if (slot < 0) {
+          slot = i;
+        } else if (keys_[slot] == keys[i]) {
+          RAISEF(kIllegalArgumentError, "duplicate key: $0", keys[i]);
+        } else {
+          collision = true;
+        }
+      }
+
+      if (!collision) {
+        return;
+      }
+    }
+  }
+}
+
+int PerfectHashTable::find(const char* key, size_t key_size) const {
+  auto idx = slots_[hash(key, key_size, seed_) & mask_];
+  if (idx < 0) {
+    return -1;
+  }
+
+  const auto& candidate = keys_[idx];
+  if (candidate.size() != key_size ||
+      memcmp(candidate.data(), key, key_size) != 0) {
+    return -1;
+  }
+
+  return idx;
+}
+
+uint32_t PerfectHashTable::hash(
+    const char* key,
+    size_t key_size,
+    uint32_t seed) {
+  // FNV-1a
+  uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (size_t i = 0; i < key_size; ++i) {
+    h ^= (unsigned char) key[i];
+    h *= 16777619u;
+  }
+
+  h ^= h >> 15;
+  return h;
+}
+
+}
+}
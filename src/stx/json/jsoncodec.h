@@ -0,0 +1,134 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_JSON_JSONCODEC_H
+#define _STX_JSON_JSONCODEC_H
+#include "stx/stdtypes.h"
+#include "stx/reflect/reflect.h"
+#include "stx/traits.h"
+#include "stx/json/json.h"
+#include "stx/json/jsonoutputstream.h"
+#include "stx/json/jsonreader.h"
+
+namespace stx {
+namespace json {
+
+/**
+ * Encodes values straight into a JSONOutputStream and decodes them straight
+ * from a JSONReader. Reflected types, vectors, strings and integers are
+ * handled here, all other types fall back to toJSON() and fromJSON() for
+ * their own tokens.
+ *
+ * The output is the same as toJSON() writes to the JSONOutputStream
+ */
+template <typename T, typename Enable>
+struct JSONCodec {
+  static void encode(const T& value, JSONOutputStream* json);
+  static T decode(JSONReader* json);
+};
+
+template <typename T>
+struct JSONCodec<
+    T,
+    typename std::enable_if<reflect::is_reflected<T>::value>::type> {
+  static void encode(const T& value, JSONOutputStream* json);
+  static T decode(JSONReader* json);
+};
+
+template <typename T>
+struct JSONCodec<
+    T,
+    typename std::enable_if<
+        !reflect::is_reflected<T>::value &&
+        TypeIsVector<T>::value>::type> {
+  static void encode(const T& value, JSONOutputStream* json);
+  static T decode(JSONReader* json);
+};
+
+template <typename T>
+struct JSONCodec<
+    T,
+    typename std::enable_if<
+        std::is_integral<T>::value &&
+        !std::is_same<T, bool>::value>::type> {
+  static void encode(const T& value, JSONOutputStream* json);
+  static T decode(JSONReader* json);
+};
+
+template <>
+struct JSONCodec<bool> {
+  static void encode(const bool& value, JSONOutputStream* json);
+  static bool decode(JSONReader* json);
+};
+
+template <>
+struct JSONCodec<String> {
+  static void encode(const String& value, JSONOutputStream* json);
+  static String decode(JSONReader* json);
+};
+
+/**
+ * A hash table over a fixed set of keys that is free of collisions: the
+ * seed is chosen so that every key hashes to a different slot, and a lookup
+ * compares the key to at most one candidate
+ */
+class PerfectHashTable {
+public:
+
+  PerfectHashTable(const Vector<String>& keys);
+
+  /**
+   * Returns the index of the key in keys or -1 if it isn't one of them
+   */
+  int find(const char* key, size_t key_size) const;
+
+protected:
+  static uint32_t hash(const char* key, size_t key_size, uint32_t seed);
+
+  Vector<String> keys_;
+  Vector<int> slots_;
+  uint32_t seed_;
+  uint32_t mask_;
+};
+
+/**
+ * The properties of a reflected type, collected once from its reflect()
+ * method
+ */
+template <typename T>
+class JSONPropertyTable {
+public:
+
+  struct Property {
+    String name;
+    bool optional;
+    Function<void (const T& instance, JSONOutputStream* json)> encode;
+    Function<void (JSONReader* json, T* instance)> decode;
+  };
+
+  static const JSONPropertyTable<T>& get();
+
+  JSONPropertyTable();
+
+  template <typename PropertyType>
+  void prop(
+      PropertyType T::* prop,
+      uint32_t id,
+      const std::string& prop_name,
+      bool optional);
+
+  Vector<Property> properties;
+  ScopedPtr<PerfectHashTable> index;
+};
+
+}
+}
+
+#include "jsoncodec_impl.h"
+#endif
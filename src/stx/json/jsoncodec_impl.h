@@ -0,0 +1,238 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_JSON_JSONCODEC_IMPL_H
+#define _STX_JSON_JSONCODEC_IMPL_H
+#include "stx/exception.h"
+
+namespace stx {
+namespace json {
+
+template <typename T, typename Enable>
+void JSONCodec<T, Enable>::encode(const T& value, JSONOutputStream* json) {
+  toJSON(value, json);
+}
+
+template <typename T, typename Enable>
+T JSONCodec<T, Enable>::decode(JSONReader* json) {
+  return fromJSON<T>(json->readValue());
+}
+
+template <typename T>
+void JSONCodec<
+    T,
+    typename std::enable_if<reflect::is_reflected<T>::value>::type>::encode(
+        const T& value,
+        JSONOutputStream* json) {
+  const auto& table = JSONPropertyTable<T>::get();
+
+  json->beginObject();
+
+  for (size_t i = 0; i < table.properties.size(); ++i) {
+    const auto& prop = table.properties[i];
+    if (i > 0) {
+      json->addComma();
+    }
+
+    json->addString(prop.name);
+    json->addColon();
+    prop.encode(value, json);
+  }
+
+  json->endObject();
+}
+
+template <typename T>
+T JSONCodec<
+    T,
+    typename std::enable_if<reflect::is_reflected<T>::value>::type>::decode(
+        JSONReader* json) {
+  const auto& table = JSONPropertyTable<T>::get();
+  auto nprops = table.properties.size();
+
+  // one bit per property in seen, unless there are more than 64
+  uint64_t seen = 0;
+  Vector<bool> seen_large(nprops > 64 ? nprops : 0);
+
+  T value;
+  json->expect(JSON_OBJECT_BEGIN);
+
+  const char* key;
+  size_t key_size;
+  while (json->readKey(&key, &key_size)) {
+    auto idx = table.index->find(key, key_size);
+    if (idx < 0) {
+      json->skipValue();
+      continue;
+    }
+
+    table.properties[idx].decode(json, &value);
+    if (nprops > 64) {
+      seen_large[idx] = true;
+    } else {
+      seen |= 1ULL << idx;
+    }
+  }
+
+  for (size_t i = 0; i < nprops; ++i) {
+    auto was_seen = nprops > 64 ? seen_large[i] : (seen >> i) & 1;
+    if (!was_seen && !table.properties[i].optional) {
+      RAISEF(kIndexError, "no such element: $0", table.properties[i].name);
+    }
+  }
+
+  return value;
+}
+
+template <typename T>
+void JSONCodec<
+    T,
+    typename std::enable_if<
+        !reflect::is_reflected<T>::value &&
+        TypeIsVector<T>::value>::type>::encode(
+            const T& value,
+            JSONOutputStream* json) {
+  json->beginArray();
+
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (i > 0) {
+      json->addComma();
+    }
+
+    JSONCodec<typename T::value_type>::encode(value[i], json);
+  }
+
+  json->endArray();
+}
+
+template <typename T>
+T JSONCodec<
+    T,
+    typename std::enable_if<
+        !reflect::is_reflected<T>::value &&
+        TypeIsVector<T>::value>::type>::decode(JSONReader* json) {
+  if (json->peek() != JSON_ARRAY_BEGIN) {
+    RAISE(kIllegalArgumentError, "expected JSON_ARRAY_BEGIN");
+  }
+
+  json->expect(JSON_ARRAY_BEGIN);
+
+  T value;
+  while (json->peek() != JSON_ARRAY_END) {
+    value.emplace_back(JSONCodec<typename T::value_type>::decode(json));
+  }
+
+  json->expect(JSON_ARRAY_END);
+  return value;
+}
+
+template <typename T>
+void JSONCodec<
+    T,
+    typename std::enable_if<
+        std::is_integral<T>::value &&
+        !std::is_same<T, bool>::value>::type>::encode(
+            const T& value,
+            JSONOutputStream* json) {
+  // numbers are written as strings, like toJSON() does
+  char buf[24];
+  auto end = buf + sizeof(buf);
+  auto cur = end;
+
+  auto neg = value < 0;
+  auto abs = neg ? -(uint64_t) value : (uint64_t) value;
+  do {
+    *--cur = '0' + abs % 10;
+    abs /= 10;
+  } while (abs > 0);
+
+  if (neg) {
+    *--cur = '-';
+  }
+
+  json->addString(cur, end - cur);
+}
+
+template <typename T>
+T JSONCodec<
+    T,
+    typename std::enable_if<
+        std::is_integral<T>::value &&
+        !std::is_same<T, bool>::value>::type>::decode(
+            JSONReader* json) {
+  return fromJSON<T>(json->readValue());
+}
+
+inline void JSONCodec<bool>::encode(
+    const bool& value,
+    JSONOutputStream* json) {
+  json->addBool(value);
+}
+
+inline bool JSONCodec<bool>::decode(JSONReader* json) {
+  return fromJSON<bool>(json->readValue());
+}
+
+inline void JSONCodec<String>::encode(
+    const String& value,
+    JSONOutputStream* json) {
+  json->addString(value);
+}
+
+inline String JSONCodec<String>::decode(JSONReader* json) {
+  String value;
+  json->readString(&value);
+  return value;
+}
+
+template <typename T>
+const JSONPropertyTable<T>& JSONPropertyTable<T>::get() {
+  static JSONPropertyTable<T> table;
+  return table;
+}
+
+template <typename T>
+JSONPropertyTable<T>::JSONPropertyTable() {
+  reflect::MetaClass<T>::reflect(this);
+
+  Vector<String> names;
+  for (const auto& prop : properties) {
+    names.emplace_back(prop.name);
+  }
+
+  index.reset(new PerfectHashTable(names));
+}
+
+template <typename T>
+template <typename PropertyType>
+void JSONPropertyTable<T>::prop(
+    PropertyType T::* prop,
+    uint32_t id,
+    const std::string& prop_name,
+    bool optional) {
+  typedef typename std::decay<PropertyType>::type ValueType;
+
+  Property property;
+  property.name = prop_name;
+  property.optional = optional;
+
+  property.encode = [prop] (const T& instance, JSONOutputStream* json) {
+    JSONCodec<ValueType>::encode(instance.*prop, json);
+  };
+
+  property.decode = [prop] (JSONReader* json, T* instance) {
+    instance->*prop = JSONCodec<ValueType>::decode(json);
+  };
+
+  properties.emplace_back(std::move(property));
+}
+
+}
+}
+#endif
@@ -0,0 +1,95 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "stx/io/outputstream.h"
+#include "stx/json/jsonoutputstream.h"
+#include "stx/test/benchmark.h"
+#include "stx/stringutil.h"
+
+using namespace stx;
+using namespace stx::json;
+
+static const size_t kNumRecords = 5000;
+
+/**
+ * Writes records with a mix of strings (some of which need escaping),
+ * integers, floats and bools
+ */
+static void writeRecords(JSONOutputStream* json) {
+  json->beginArray();
+
+  for (size_t i = 0; i < kNumRecords; ++i) {
+    if (i > 0) {
+      json->addComma();
+    }
+
+    json->beginObject();
+    json->addObjectEntry("id");
+    json->addInteger(505874924095815681 + i);
+    json->addComma();
+    json->addObjectEntry("text");
+    json->addString("a reply with a \"quoted\" part and a link to http://t.co/x");
+    json->addComma();
+    json->addObjectEntry("screen_name");
+    json->addString("some_user_name");
+    json->addComma();
+    json->addObjectEntry("followers_count");
+    json->addInteger(i * 17 % 5000);
+    json->addComma();
+    json->addObjectEntry("score");
+    json->addFloat(i * 0.25 + 0.5);
+    json->addComma();
+    json->addObjectEntry("ratio");
+    json->addFloat(i / 7.0 + 1);
+    json->addComma();
+    json->addObjectEntry("verified");
+    json->addBool(i % 5 == 0);
+    json->endObject();
+  }
+
+  json->endArray();
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  size_t bytes = 0;
+
+  auto string_result = Benchmark::benchmark([&]() {
+    String str;
+    JSONOutputStream json(StringOutputStream::fromString(&str));
+    writeRecords(&json);
+    bytes += str.size();
+  }, 20);
+
+  Benchmark::printResultTable(
+      "StringOutputStream",
+      Benchmark::BenchmarkResult(string_result.meanRuntimeNanos(), kNumRecords),
+      true);
+
+  auto buffer_result = Benchmark::benchmark([&]() {
+    Buffer buf;
+    JSONOutputStream json(&buf);
+    writeRecords(&json);
+    bytes += buf.size();
+  }, 20);
+
+  Benchmark::printResultTable(
+      "Buffer",
+      Benchmark::BenchmarkResult(buffer_result.meanRuntimeNanos(), kNumRecords),
+      true);
+
+  if (bytes == 0) {
+    printf("no output\n");
+  }
+
+  return 0;
+}
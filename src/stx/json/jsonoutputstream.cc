@@ -13,16 +13,190 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace stx {
 namespace json {
 
+namespace {
+
+const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+const double kPowersOf10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+  1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17
+};
+
+/**
+ * Writes the decimal digits of value so that they end at end, two digits at
+ * a time. Returns a pointer to the first digit
+ */
+inline char* formatDigits(uint64_t value, char* end) {
+  auto cur = end;
+  while (value >= 100) {
+    auto pair = (value % 100) * 2;
+    value /= 100;
+    *--cur = kDigitPairs[pair + 1];
+    *--cur = kDigitPairs[pair];
+  }
+
+  if (value >= 10) {
+    *--cur = kDigitPairs[value * 2 + 1];
+    *--cur = kDigitPairs[value * 2];
+  } else {
+    *--cur = '0' + value;
+  }
+
+  return cur;
+}
+
+/**
+ * Returns the offset of the first character in data that needs escaping or
+ * size if there is none
+ */
+inline size_t findEscape(const char* data, size_t size) {
+  size_t pos = 0;
+
+#ifdef __SSE2__
+  auto quote = _mm_set1_epi8('"');
+  auto backslash = _mm_set1_epi8('\\');
+  auto newline = _mm_set1_epi8('\n');
+  auto tab = _mm_set1_epi8('\t');
+
+  for (; pos + 16 <= size; pos += 16) {
+    auto chunk = _mm_loadu_si128((const __m128i*) (data + pos));
+    auto match = _mm_or_si128(
+        _mm_or_si128(
+            _mm_cmpeq_epi8(chunk, quote),
+            _mm_cmpeq_epi8(chunk, backslash)),
+        _mm_or_si128(
+            _mm_cmpeq_epi8(chunk, newline),
+            _mm_cmpeq_epi8(chunk, tab)));
+
+    auto mask = _mm_movemask_epi8(match);
+    if (mask) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for (; pos < size; ++pos) {
+    switch (data[pos]) {
+      case '"':
+      case '\\':
+      case '\n':
+      case '\t':
+        return pos;
+
+      default:
+        break;
+    }
+  }
+
+  return size;
+}
+
+/**
+ * Formats value with the fewest fractional digits (up to 17) that parse back
+ * to the same double, e.g. 23.5 or 0.1, and with a trailing ".0" if value is
+ * integral. Returns false for values that don't fit into this notation
+ */
+inline bool formatFixed(double value, char* buf, size_t* len) {
+  auto neg = value < 0;
+  auto abs = neg ? -value : value;
+
+  for (size_t k = 0; k < sizeof(kPowersOf10) / sizeof(double); ++k) {
+    auto scaled = std::nearbyint(abs * kPowersOf10[k]);
+    if (scaled >= 9007199254740992.0) { // 2^53
+      return false;
+    }
+
+    if (scaled / kPowersOf10[k] != abs) {
+      continue;
+    }
+
+    char digits[24];
+    auto end = digits + sizeof(digits);
+    auto begin = formatDigits((uint64_t) scaled, end);
+
+    // pad with leading zeros so that there is at least one integral digit
+    while (end - begin < (ptrdiff_t) k + 1) {
+      *--begin = '0';
+    }
+
+    auto cur = buf;
+    if (neg) {
+      *cur++ = '-';
+    }
+
+    auto integral = (end - begin) - k;
+    memcpy(cur, begin, integral);
+    cur += integral;
+    *cur++ = '.';
+
+    if (k == 0) {
+      *cur++ = '0';
+    } else {
+      memcpy(cur, begin + integral, k);
+      cur += k;
+    }
+
+    *len = cur - buf;
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * Formats value in the shortest %g notation that parses back to the same
+ * double
+ */
+inline size_t formatExponent(double value, char* buf, size_t size) {
+  int len = 0;
+  for (int precision = 15; precision <= 17; ++precision) {
+    len = snprintf(buf, size, "%.*g", precision, value);
+    if (len < 0) {
+      RAISE(kRuntimeError, "snprintf() failed");
+    }
+
+    if (strtod(buf, nullptr) == value) {
+      break;
+    }
+  }
+
+  return len;
+}
+
+} // namespace
+
 JSONOutputStream::JSONOutputStream(
-    std::unique_ptr<OutputStream> output_stream) {
+    std::unique_ptr<OutputStream> output_stream) :
+    buf_(nullptr) {
+  auto buffer_stream = dynamic_cast<BufferOutputStream*>(output_stream.get());
+  if (buffer_stream) {
+    buf_ = buffer_stream->buffer();
+  }
+
   output_.reset(output_stream.release());
 }
 
+JSONOutputStream::JSONOutputStream(Buffer* buf) : buf_(buf) {}
+
 void JSONOutputStream::write(const JSONObject& obj) {
   for (const auto& t : obj) {
     emplace_back(t.type, t.data);
@@ -46,11 +220,11 @@ void JSONOutputStream::emplace_back(
       endArray();
 
       if (!stack_.empty()) {
-        stack_.pop();
+        stack_.pop_back();
       }
 
       if (!stack_.empty()) {
-        stack_.top().second++;
+        stack_.back().second++;
       }
       return;
 
@@ -58,11 +232,11 @@ void JSONOutputStream::emplace_back(
       endObject();
 
       if (!stack_.empty()) {
-        stack_.pop();
+        stack_.pop_back();
       }
 
       if (!stack_.empty()) {
-        stack_.top().second++;
+        stack_.back().second++;
       }
       return;
 
@@ -71,14 +245,14 @@ void JSONOutputStream::emplace_back(
 
   }
 
-  if (!stack_.empty() && stack_.top().second > 0) {
-    switch (stack_.top().first) {
+  if (!stack_.empty() && stack_.back().second > 0) {
+    switch (stack_.back().first) {
       case JSON_ARRAY_BEGIN:
         addComma();
         break;
 
       case JSON_OBJECT_BEGIN:
-        (stack_.top().second % 2 == 0) ? addComma() : addColon();
+        (stack_.back().second % 2 == 0) ? addComma() : addColon();
         break;
 
       default:
@@ -90,19 +264,19 @@ void JSONOutputStream::emplace_back(
 
     case JSON_ARRAY_BEGIN:
       beginArray();
-      stack_.emplace(JSON_ARRAY_BEGIN, 0);
+      stack_.emplace_back(JSON_ARRAY_BEGIN, 0);
       break;
 
     case JSON_OBJECT_BEGIN:
       beginObject();
-      stack_.emplace(JSON_OBJECT_BEGIN, 0);
+      stack_.emplace_back(JSON_OBJECT_BEGIN, 0);
       break;
 
     case JSON_STRING:
       addString(data);
 
       if (!stack_.empty()) {
-        stack_.top().second++;
+        stack_.back().second++;
       }
       break;
 
@@ -110,7 +284,7 @@ void JSONOutputStream::emplace_back(
       addString(data);
 
       if (!stack_.empty()) {
-        stack_.top().second++;
+        stack_.back().second++;
       }
       break;
 
@@ -118,7 +292,7 @@ void JSONOutputStream::emplace_back(
       addTrue();
 
       if (!stack_.empty()) {
-        stack_.top().second++;
+        stack_.back().second++;
       }
       break;
 
@@ -126,7 +300,7 @@ void JSONOutputStream::emplace_back(
       addFalse();
 
       if (!stack_.empty()) {
-        stack_.top().second++;
+        stack_.back().second++;
       }
       break;
 
@@ -134,7 +308,7 @@ void JSONOutputStream::emplace_back(
       addNull();
 
       if (!stack_.empty()) {
-        stack_.top().second++;
+        stack_.back().second++;
       }
       break;
 
@@ -144,37 +318,53 @@ void JSONOutputStream::emplace_back(
 }
 
 void JSONOutputStream::beginObject() {
-  output_->printf("{");
+  write("{", 1);
 }
 
 void JSONOutputStream::endObject() {
-  output_->printf("}");
+  write("}", 1);
 }
 
 void JSONOutputStream::addObjectEntry(const std::string& key) {
-  output_->printf("\"%s\": ", escapeString(key).c_str());
+  write("\"", 1);
+  writeEscaped(key.data(), key.size());
+  write("\": ", 3);
 }
 
 void JSONOutputStream::addComma() {
-  output_->printf(",");
+  write(",", 1);
 }
 
 void JSONOutputStream::addColon() {
-  output_->printf(":");
+  write(":", 1);
 }
 
 void JSONOutputStream::addString(const std::string& string) {
-  output_->write("\"");
-  output_->write(escapeString(string));
-  output_->write("\"");
+  addString(string.data(), string.size());
+}
+
+void JSONOutputStream::addString(const char* data, size_t size) {
+  write("\"", 1);
+  writeEscaped(data, size);
+  write("\"", 1);
 }
 
 void JSONOutputStream::addInteger(int64_t value) {
-  output_->write(StringUtil::toString(value));
+  char buf[24];
+  auto end = buf + sizeof(buf);
+  auto begin = formatDigits(
+      value < 0 ? -(uint64_t) value : (uint64_t) value,
+      end);
+
+  if (value < 0) {
+    *--begin = '-';
+  }
+
+  write(begin, end - begin);
 }
 
 void JSONOutputStream::addNull() {
-  output_->write("null");
+  write("null", 4);
 }
 
 void JSONOutputStream::addBool(bool val) {
@@ -186,27 +376,34 @@ void JSONOutputStream::addBool(bool val) {
 }
 
 void JSONOutputStream::addTrue() {
-  output_->write("true");
+  write("true", 4);
 }
 
 void JSONOutputStream::addFalse() {
-  output_->write("false");
+  write("false", 5);
 }
 
 void JSONOutputStream::addFloat(double value) {
-  if (std::isnormal(value)) {
-    output_->write(StringUtil::toString(value));
-  } else {
+  if (!std::isnormal(value)) {
     addNull();
+    return;
+  }
+
+  char buf[64];
+  size_t len;
+  if (!formatFixed(value, buf, &len)) {
+    len = formatExponent(value, buf, sizeof(buf));
   }
+
+  write(buf, len);
 }
 
 void JSONOutputStream::beginArray() {
-  output_->printf("[");
+  write("[", 1);
 }
 
 void JSONOutputStream::endArray() {
-  output_->printf("]");
+  write("]", 1);
 }
 
 /*
@@ -246,32 +443,37 @@ void JSONOutputStream::addValue(const std::nullptr_t& value) {
 }
 */
 
-std::string JSONOutputStream::escapeString(const std::string& string) const {
-  std::string new_str;
+void JSONOutputStream::writeEscaped(const char* data, size_t size) {
+  auto end = data + size;
+
+  while (data < end) {
+    auto clean = findEscape(data, end - data);
+    if (clean > 0) {
+      write(data, clean);
+      data += clean;
+    }
 
-  for (int i = 0; i < string.size(); ++i) {
-    switch (string.at(i)) {
+    if (data == end) {
+      break;
+    }
+
+    switch (*data++) {
       case '"':
-        new_str += "\\\"";
+        write("\\\"", 2);
         break;
       case '\\':
-        new_str += "\\\\";
+        write("\\\\", 2);
         break;
       case '\n':
-        new_str += "\\n";
+        write("\\n", 2);
         break;
       case '\t':
-        new_str += "\\t";
+        write("\\t", 2);
         break;
-      default:
-        new_str += string.at(i);
     }
   }
-
-  return new_str;
 }
 
-
 } // namespace json
 } // namespace stx
 
@@ -9,10 +9,12 @@
  */
 #ifndef _STX_JSON_JSONOUTPUTSTREAM_H
 #define _STX_JSON_JSONOUTPUTSTREAM_H
+#include <algorithm>
 #include <set>
 #include <stack>
 #include <vector>
 #include <stx/json/jsontypes.h>
+#include <stx/buffer.h>
 #include <stx/exception.h>
 #include <stx/io/outputstream.h>
 
@@ -22,8 +24,17 @@ namespace json {
 class JSONOutputStream {
 public:
 
+  /**
+   * Writes the JSON to the output stream. A BufferOutputStream is bypassed
+   * and the JSON appended to its buffer directly.
+   */
   JSONOutputStream(std::unique_ptr<OutputStream> output_stream);
 
+  /**
+   * Appends the JSON to the buffer, which must outlive the JSONOutputStream
+   */
+  explicit JSONOutputStream(Buffer* buf);
+
   void write(const JSONObject& obj);
 
   void emplace_back(kTokenType token);
@@ -38,6 +49,7 @@ public:
   void addComma();
   void addColon();
   void addString(const std::string& string);
+  void addString(const char* data, size_t size);
   void addFloat(double value);
   void addInteger(int64_t value);
   void addNull();
@@ -46,11 +58,28 @@ public:
   void addFalse();
 
 protected:
-  std::stack<std::pair<kTokenType, int>> stack_;
-  std::string escapeString(const std::string& string) const;
+
+  void write(const char* data, size_t size);
+  void writeEscaped(const char* data, size_t size);
+
+  Vector<std::pair<kTokenType, int>> stack_;
   std::shared_ptr<OutputStream> output_;
+  Buffer* buf_;
 };
 
+inline void JSONOutputStream::write(const char* data, size_t size) {
+  if (buf_) {
+    // Buffer::append only grows the buffer by as much as it needs
+    if (buf_->remaining() < size) {
+      buf_->reserve(std::max(size, buf_->capacity()));
+    }
+
+    buf_->append(data, size);
+  } else {
+    output_->write(data, size);
+  }
+}
+
 } // namespace json
 } // namespace stx
 
@@ -0,0 +1,370 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include "stx/exception.h"
+#include "stx/inspect.h"
+#include "stx/json/jsonreader.h"
+#include "stx/json/jsonscanner.h"
+#include "stx/json/jsonutil.h"
+
+namespace stx {
+namespace json {
+
+namespace {
+
+inline bool isEndOfValue(char c) {
+  switch (c) {
+    case ' ':
+    case '\n':
+    case '\r':
+    case '\t':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+    case '"':
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+inline const char* readLiteral(
+    const char* cur,
+    const char* end,
+    const char* literal,
+    size_t len) {
+  if (end - cur < len || memcmp(cur, literal, len) != 0) {
+    RAISEF(
+        kRuntimeError,
+        "invalid json. expected '$0', got '$1'",
+        literal,
+        String(cur, std::min((size_t) (end - cur), len)));
+  }
+
+  cur += len;
+  if (cur < end && !isEndOfValue(*cur)) {
+    RAISEF(kRuntimeError, "invalid json, unexpected char: $0", String(cur, 1));
+  }
+
+  return cur;
+}
+
+/**
+ * Returns a pointer to the closing quote of the string whose opening quote is
+ * at begin
+ */
+inline const char* findClosingQuote(const char* begin, const char* end) {
+  for (auto cur = begin + 1; cur < end; ++cur) {
+    switch (*cur) {
+      case '"':
+        return cur;
+
+      case '\\':
+        ++cur;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  RAISE(kRuntimeError, "invalid json. unterminated string");
+  __builtin_unreachable();
+}
+
+} // namespace
+
+JSONReader::JSONReader(
+    const char* data,
+    size_t size) :
+    cur_(data),
+    end_(data + size) {}
+
+kTokenType JSONReader::peek() {
+  for (; cur_ < end_; ++cur_) {
+    switch (*cur_) {
+      case ' ':
+      case '\n':
+      case '\r':
+      case '\t':
+      case ':':
+      case ',':
+        continue;
+
+      case '{':
+        return JSON_OBJECT_BEGIN;
+
+      case '}':
+        return JSON_OBJECT_END;
+
+      case '[':
+        return JSON_ARRAY_BEGIN;
+
+      case ']':
+        return JSON_ARRAY_END;
+
+      case '"':
+        return JSON_STRING;
+
+      case 't':
+        return JSON_TRUE;
+
+      case 'f':
+        return JSON_FALSE;
+
+      case 'n':
+        return JSON_NULL;
+
+      case '-':
+      case '0':
+      case '1':
+      case '2':
+      case '3':
+      case '4':
+      case '5':
+      case '6':
+      case '7':
+      case '8':
+      case '9':
+        return JSON_NUMBER;
+
+      default:
+        RAISEF(
+            kRuntimeError,
+            "invalid json, unexpected char: $0",
+            String(cur_, 1));
+
+    }
+  }
+
+  RAISE(kRuntimeError, "invalid JSON. unexpected end of stream");
+  __builtin_unreachable();
+}
+
+void JSONReader::expect(kTokenType type) {
+  auto next = peek();
+  if (next != type) {
+    RAISEF(kParseError, "expected $0, got: $1", type, next);
+  }
+
+  switch (type) {
+    case JSON_OBJECT_BEGIN:
+    case JSON_OBJECT_END:
+    case JSON_ARRAY_BEGIN:
+    case JSON_ARRAY_END:
+      ++cur_;
+      break;
+
+    default:
+      skipValue();
+      break;
+  }
+}
+
+bool JSONReader::readKey(const char** key, size_t* key_size) {
+  switch (peek()) {
+    case JSON_OBJECT_END:
+      ++cur_;
+      return false;
+
+    case JSON_STRING:
+      break;
+
+    default:
+      RAISEF(kParseError, "expected JSON_STRING, got: $0", peek());
+  }
+
+  auto begin = cur_ + 1;
+  auto end = findClosingQuote(cur_, end_);
+
+  if (memchr(begin, '\\', end - begin)) {
+    readString(cur_, &key_);
+    *key = key_.data();
+    *key_size = key_.size();
+  } else {
+    *key = begin;
+    *key_size = end - begin;
+  }
+
+  cur_ = end + 1;
+  return true;
+}
+
+void JSONReader::readString(String* str) {
+  switch (peek()) {
+    case JSON_STRING:
+      cur_ = readString(cur_, str) + 1;
+      break;
+
+    case JSON_NUMBER: {
+      auto begin = cur_;
+      while (cur_ < end_ && !isEndOfValue(*cur_)) {
+        ++cur_;
+      }
+
+      str->assign(begin, cur_);
+      break;
+    }
+
+    case JSON_TRUE:
+      cur_ = readLiteral(cur_, end_, "true", 4);
+      *str = "true";
+      break;
+
+    case JSON_FALSE:
+      cur_ = readLiteral(cur_, end_, "false", 5);
+      *str = "false";
+      break;
+
+    case JSON_NULL:
+      cur_ = readLiteral(cur_, end_, "null", 4);
+      *str = "null";
+      break;
+
+    default:
+      RAISEF(kParseError, "can't convert $0 to string", peek());
+
+  }
+}
+
+const JSONObject& JSONReader::readValue() {
+  auto type = peek();
+
+  switch (type) {
+    case JSON_OBJECT_BEGIN:
+    case JSON_ARRAY_BEGIN: {
+      auto end = findEnd();
+      tokens_.clear();
+      JSONScanner::parse(cur_, end - cur_, &tokens_);
+      cur_ = end;
+      return tokens_;
+    }
+
+    case JSON_STRING:
+    case JSON_NUMBER:
+    case JSON_TRUE:
+    case JSON_FALSE:
+    case JSON_NULL:
+      break;
+
+    default:
+      RAISEF(kParseError, "unexpected token: $0", type);
+
+  }
+
+  // scalars reuse the first token and its string
+  if (tokens_.empty()) {
+    tokens_.emplace_back(type);
+  } else {
+    tokens_.erase(tokens_.begin() + 1, tokens_.end());
+    tokens_[0].type = type;
+    tokens_[0].size = 1;
+  }
+
+  auto& token = tokens_[0];
+  switch (type) {
+    case JSON_STRING:
+    case JSON_NUMBER:
+      readString(&token.data);
+      break;
+
+    default:
+      skipValue();
+      token.data.clear();
+      break;
+  }
+
+  return tokens_;
+}
+
+void JSONReader::skipValue() {
+  switch (peek()) {
+    case JSON_OBJECT_BEGIN:
+    case JSON_ARRAY_BEGIN:
+      cur_ = findEnd();
+      break;
+
+    case JSON_STRING:
+      cur_ = findClosingQuote(cur_, end_) + 1;
+      break;
+
+    case JSON_NUMBER:
+      while (cur_ < end_ && !isEndOfValue(*cur_)) {
+        ++cur_;
+      }
+      break;
+
+    case JSON_TRUE:
+      cur_ = readLiteral(cur_, end_, "true", 4);
+      break;
+
+    case JSON_FALSE:
+      cur_ = readLiteral(cur_, end_, "false", 5);
+      break;
+
+    case JSON_NULL:
+      cur_ = readLiteral(cur_, end_, "null", 4);
+      break;
+
+    default:
+      RAISEF(kParseError, "unexpected token: $0", peek());
+
+  }
+}
+
+const char* JSONReader::findEnd() const {
+  String stack;
+
+  for (auto cur = cur_; cur < end_; ++cur) {
+    switch (*cur) {
+      case '{':
+      case '[':
+        stack += *cur;
+        break;
+
+      case '}':
+      case ']':
+        // '{' and '}' as well as '[' and ']' are two apart
+        if (stack.empty() || stack.back() != *cur - 2) {
+          RAISE(kParseError, "unbalanced braces");
+        }
+
+        stack.pop_back();
+        if (stack.empty()) {
+          return cur + 1;
+        }
+        break;
+
+      case '"':
+        cur = findClosingQuote(cur, end_);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  RAISE(kRuntimeError, "invalid JSON. unexpected end of stream");
+  __builtin_unreachable();
+}
+
+const char* JSONReader::readString(const char* begin, String* str) {
+  auto end = findClosingQuote(begin, end_);
+  str->clear();
+  unescapeString(begin + 1, end, str);
+  return end;
+}
+
+}
+}
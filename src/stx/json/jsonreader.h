@@ -0,0 +1,77 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_JSON_JSONREADER_H
+#define _STX_JSON_JSONREADER_H
+#include <stdlib.h>
+#include "stx/stdtypes.h"
+#include "stx/json/jsontypes.h"
+
+namespace stx {
+namespace json {
+
+/**
+ * Reads the values of a JSON document that is held in memory one by one,
+ * without tokenizing the whole document into a JSONObject first. Like the
+ * JSONInputStream, it ignores ':' and ',' separators.
+ */
+class JSONReader {
+public:
+
+  JSONReader(const char* data, size_t size);
+
+  /**
+   * Returns the type of the next token without consuming it
+   */
+  kTokenType peek();
+
+  /**
+   * Consumes the next token, which must be of the given type
+   */
+  void expect(kTokenType type);
+
+  /**
+   * Reads the next key of the current object or consumes the closing brace
+   * and returns false. The key remains valid until the next call.
+   */
+  bool readKey(const char** key, size_t* key_size);
+
+  /**
+   * Reads a string, number, true, false or null into str like
+   * fromJSON<String>() does
+   */
+  void readString(String* str);
+
+  /**
+   * Reads the next value of any type. The tokens remain valid until the next
+   * call.
+   */
+  const JSONObject& readValue();
+
+  void skipValue();
+
+protected:
+
+  /**
+   * Returns a pointer past the end of the object or array that starts at
+   * cur_
+   */
+  const char* findEnd() const;
+
+  const char* readString(const char* begin, String* str);
+
+  const char* cur_;
+  const char* end_;
+  String key_;
+  JSONObject tokens_;
+};
+
+}
+}
+#endif
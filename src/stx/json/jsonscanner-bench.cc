@@ -0,0 +1,120 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "stx/io/inputstream.h"
+#include "stx/json/json.h"
+#include "stx/json/jsoninputstream.h"
+#include "stx/json/jsonscanner.h"
+#include "stx/test/benchmark.h"
+#include "stx/stringutil.h"
+
+using namespace stx;
+using namespace stx::json;
+
+static const size_t kNumStatuses = 5000;
+
+/**
+ * A timeline in the shape of the twitter API's: statuses with nested user
+ * and entity objects, escaped text and long numeric ids
+ */
+static String timeline() {
+  String json = "{\"statuses\": [";
+
+  for (size_t i = 0; i < kNumStatuses; ++i) {
+    if (i > 0) {
+      json += ",";
+    }
+
+    json += StringUtil::format(
+        R"({"created_at": "Sun Aug 31 00:29:15 +0000 2014", "id": $0, )"
+        R"("id_str": "$0", "text": "@user$1 \"quoted\" reply with a )"
+        R"(link http:\/\/t.co\/$1 and some more text to make it long", )"
+        R"("truncated": false, "in_reply_to_status_id": null, )",
+        505874924095815681 + i,
+        i % 97);
+
+    json += StringUtil::format(
+        R"("user": {"id": $0, "name": "User $0", "screen_name": "user$0", )"
+        R"("location": "", "description": "a description\nwith lines", )"
+        R"("followers_count": $1, "friends_count": $2, "verified": $3, )"
+        R"("profile_background_color": "C0DEED", "lang": "en"}, )",
+        i % 1000,
+        i * 17 % 5000,
+        i * 13 % 300,
+        i % 5 == 0 ? "true" : "false");
+
+    json += StringUtil::format(
+        R"("geo": null, "retweet_count": $0, "favorite_count": $1, )"
+        R"("entities": {"hashtags": [{"text": "tag$0", "indices": [3, 9]}], )"
+        R"("urls": [], "user_mentions": [{"screen_name": "user$1", )"
+        R"("id": $1, "indices": [0, 8]}]}, "favorited": false, )"
+        R"("retweeted": false, "lang": "en", "score": $2})",
+        i % 50,
+        i % 97,
+        i * 0.25);
+  }
+
+  json += "]}";
+  return json;
+}
+
+static void printThroughput(
+    const String& label,
+    const Benchmark::BenchmarkResult& result,
+    size_t bytes) {
+  Benchmark::printResultTable(
+      label,
+      Benchmark::BenchmarkResult(result.meanRuntimeNanos(), 1),
+      true);
+
+  printf(
+      "%-40s %14.3f GB/s\n",
+      "",
+      bytes / (double) result.meanRuntimeNanos());
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  auto json = timeline();
+  printf("corpus: %lu bytes\n", json.size());
+
+  size_t ntokens = 0;
+
+  auto stream_result = Benchmark::benchmark([&]() {
+    JSONInputStream stream(StringInputStream::fromString(json));
+    ntokens += parseJSON(&stream).size();
+  }, 5);
+
+  printThroughput("JSONInputStream", stream_result, json.size());
+
+  auto index_result = Benchmark::benchmark([&]() {
+    Vector<size_t> indexes;
+    JSONScanner::index(json.data(), json.size(), &indexes);
+    ntokens += indexes.size();
+  }, 20);
+
+  printThroughput("JSONScanner::index", index_result, json.size());
+
+  auto scanner_result = Benchmark::benchmark([&]() {
+    JSONObject obj;
+    JSONScanner::parse(json.data(), json.size(), &obj);
+    ntokens += obj.size();
+  }, 20);
+
+  printThroughput("JSONScanner::parse", scanner_result, json.size());
+
+  if (ntokens == 0) {
+    printf("no tokens\n");
+  }
+
+  return 0;
+}
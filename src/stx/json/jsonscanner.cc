@@ -0,0 +1,358 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "stx/exception.h"
+#include "stx/json/jsonscanner.h"
+#include "stx/json/jsonutil.h"
+
+namespace stx {
+namespace json {
+
+namespace {
+
+const uint64_t kEvenBits = 0x5555555555555555ULL;
+
+/**
+ * One bit per byte of a 64 byte block
+ */
+struct BlockMasks {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t op; // {}[]:,
+  uint64_t whitespace;
+};
+
+#ifdef __SSE2__
+
+inline uint64_t eq(__m128i chunk, char c) {
+  return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)));
+}
+
+inline void classify(const char* block, BlockMasks* masks) {
+  masks->quote = 0;
+  masks->backslash = 0;
+  masks->op = 0;
+  masks->whitespace = 0;
+
+  for (size_t i = 0; i < 4; ++i) {
+    auto chunk = _mm_loadu_si128((const __m128i*) (block + i * 16));
+
+    // '{' and '[' as well as '}' and ']' only differ in bit 5
+    auto lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+    auto op = eq(lower, '{') | eq(lower, '}') | eq(chunk, ':') | eq(chunk, ',');
+    auto ws = eq(chunk, ' ') | eq(chunk, '\n') | eq(chunk, '\r') |
+        eq(chunk, '\t');
+
+    masks->quote |= eq(chunk, '"') << (i * 16);
+    masks->backslash |= eq(chunk, '\\') << (i * 16);
+    masks->op |= op << (i * 16);
+    masks->whitespace |= ws << (i * 16);
+  }
+}
+
+#else
+
+inline void classify(const char* block, BlockMasks* masks) {
+  masks->quote = 0;
+  masks->backslash = 0;
+  masks->op = 0;
+  masks->whitespace = 0;
+
+  for (size_t i = 0; i < JSONScanner::kBlockSize; ++i) {
+    switch (block[i]) {
+      case '"':
+        masks->quote |= 1ULL << i;
+        break;
+
+      case '\\':
+        masks->backslash |= 1ULL << i;
+        break;
+
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        masks->op |= 1ULL << i;
+        break;
+
+      case ' ':
+      case '\n':
+      case '\r':
+      case '\t':
+        masks->whitespace |= 1ULL << i;
+        break;
+    }
+  }
+}
+
+#endif
+
+/**
+ * Sets every bit that has an odd number of set bits at or below it, i.e.
+ * everything from an opening quote up to (excluding) its closing quote
+ */
+inline uint64_t prefixXor(uint64_t bits) {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+inline bool isEndOfValue(char c) {
+  switch (c) {
+    case ' ':
+    case '\n':
+    case '\r':
+    case '\t':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+    case '"':
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+inline void expectEndOfValue(const char* cur, const char* end) {
+  if (cur < end && !isEndOfValue(*cur)) {
+    RAISEF(kRuntimeError, "invalid json, unexpected char: $0", String(cur, 1));
+  }
+}
+
+inline void expectLiteral(
+    const char* cur,
+    const char* end,
+    const char* literal,
+    size_t len) {
+  if (end - cur < len || memcmp(cur, literal, len) != 0) {
+    RAISEF(
+        kRuntimeError,
+        "invalid json. expected '$0', got '$1'",
+        literal,
+        String(cur, std::min((size_t) (end - cur), len)));
+  }
+
+  expectEndOfValue(cur + len, end);
+}
+
+inline bool isNumberChar(char c) {
+  switch (c) {
+    case '-':
+    case '+':
+    case '.':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+    case 'e':
+    case 'E':
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+void JSONScanner::index(
+    const char* data,
+    size_t size,
+    Vector<size_t>* indexes) {
+  uint64_t prev_escaped = 0;
+  uint64_t prev_in_string = 0;
+  uint64_t prev_scalar = 0;
+  auto nindexes = indexes->size();
+
+  for (size_t pos = 0; pos < size; pos += kBlockSize) {
+    auto block = data + pos;
+
+    // the last block is padded with whitespace
+    char tail[kBlockSize];
+    if (size - pos < kBlockSize) {
+      memset(tail, ' ', kBlockSize);
+      memcpy(tail, block, size - pos);
+      block = tail;
+    }
+
+    BlockMasks masks;
+    classify(block, &masks);
+
+    // characters preceded by an odd number of backslashes are escaped. a
+    // run of backslashes that starts on an odd bit overflows into the next
+    // even bit when added to the backslash mask, which flips the parity
+    auto backslash = masks.backslash & ~prev_escaped;
+    auto follows_escape = backslash << 1 | prev_escaped;
+    auto odd_starts = backslash & ~kEvenBits & ~follows_escape;
+    unsigned long long even_starts;
+    prev_escaped = __builtin_uaddll_overflow(
+        odd_starts,
+        backslash,
+        &even_starts);
+    auto escaped = (kEvenBits ^ (even_starts << 1)) & follows_escape;
+
+    auto quote = masks.quote & ~escaped;
+    auto in_string = prefixXor(quote) ^ prev_in_string;
+    prev_in_string = (uint64_t) ((int64_t) in_string >> 63);
+
+    // every value that is not a string or an op starts with the first
+    // non-whitespace character after an op or whitespace
+    auto scalar = ~(masks.op | masks.whitespace);
+    auto nonquote_scalar = scalar & ~quote;
+    auto follows_scalar = nonquote_scalar << 1 | prev_scalar;
+    prev_scalar = nonquote_scalar >> 63;
+    auto scalar_start = scalar & ~follows_scalar;
+
+    auto structurals = ((masks.op | scalar_start) & ~in_string) | quote;
+
+    // make room for a full block once instead of growing for every index
+    if (indexes->size() < nindexes + kBlockSize) {
+      indexes->resize(std::max(indexes->size() * 2, nindexes + kBlockSize));
+    }
+
+    auto out = indexes->data() + nindexes;
+    nindexes += __builtin_popcountll(structurals);
+    while (structurals) {
+      *out++ = pos + __builtin_ctzll(structurals);
+      structurals &= structurals - 1;
+    }
+  }
+
+  indexes->resize(nindexes);
+}
+
+void JSONScanner::parse(const char* data, size_t size, JSONObject* obj) {
+  Vector<size_t> indexes;
+  index(data, size, &indexes);
+
+  obj->reserve(obj->size() + indexes.size());
+  Vector<size_t> stack;
+  auto end = data + size;
+
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    auto cur = data + indexes[i];
+
+    switch (*cur) {
+      case '{':
+        obj->emplace_back(JSON_OBJECT_BEGIN);
+        stack.emplace_back(obj->size() - 1);
+        break;
+
+      case '[':
+        obj->emplace_back(JSON_ARRAY_BEGIN);
+        stack.emplace_back(obj->size() - 1);
+        break;
+
+      case '}':
+      case ']':
+        obj->emplace_back(*cur == '}' ? JSON_OBJECT_END : JSON_ARRAY_END);
+
+        if (stack.empty()) {
+          RAISE(kParseError, "unbalanced braces");
+        }
+
+        (*obj)[stack.back()].size = obj->size() - stack.back();
+        stack.pop_back();
+        break;
+
+      case ':':
+      case ',':
+        break;
+
+      case '"': {
+        // the next index is always the closing quote
+        if (++i == indexes.size()) {
+          RAISE(kRuntimeError, "invalid json. unterminated string");
+        }
+
+        auto begin = cur + 1;
+        obj->emplace_back(JSON_STRING);
+        unescapeString(begin, data + indexes[i], &obj->back().data);
+        break;
+      }
+
+      case '-':
+      case '0':
+      case '1':
+      case '2':
+      case '3':
+      case '4':
+      case '5':
+      case '6':
+      case '7':
+      case '8':
+      case '9': {
+        auto num_end = cur;
+        while (num_end < end && isNumberChar(*num_end)) {
+          ++num_end;
+        }
+
+        expectEndOfValue(num_end, end);
+        obj->emplace_back(JSON_NUMBER);
+        obj->back().data.assign(cur, num_end);
+        break;
+      }
+
+      case 't':
+        expectLiteral(cur, end, "true", 4);
+        obj->emplace_back(JSON_TRUE);
+        break;
+
+      case 'f':
+        expectLiteral(cur, end, "false", 5);
+        obj->emplace_back(JSON_FALSE);
+        break;
+
+      case 'n':
+        expectLiteral(cur, end, "null", 4);
+        obj->emplace_back(JSON_NULL);
+        break;
+
+      // like the JSONInputStream, a null byte ends the document
+      case 0:
+        i = indexes.size();
+        break;
+
+      default:
+        RAISEF(
+            kRuntimeError,
+            "invalid json, unexpected char: $0",
+            String(cur, 1));
+
+    }
+  }
+
+  if (!stack.empty()) {
+    RAISE(kRuntimeError, "invalid JSON. unexpected end of stream");
+  }
+}
+
+}
+}
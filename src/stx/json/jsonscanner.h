@@ -0,0 +1,47 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_JSON_JSONSCANNER_H
+#define _STX_JSON_JSONSCANNER_H
+#include <stdlib.h>
+#include "stx/stdtypes.h"
+#include "stx/json/jsontypes.h"
+
+namespace stx {
+namespace json {
+
+/**
+ * Tokenizes a JSON document that is held in memory in two passes. The first
+ * pass looks at 64 bytes at a time and finds the offsets of all structural
+ * characters, i.e. the brackets, separators, string quotes and the first
+ * character of every other value outside of strings. The second pass walks
+ * these offsets and builds the tokens.
+ *
+ * The tokens are the same as the ones parseJSON() builds from a
+ * JSONInputStream, which remains the way to parse streams.
+ */
+class JSONScanner {
+public:
+
+  static void parse(const char* data, size_t size, JSONObject* obj);
+
+  /**
+   * The first pass: appends the offsets of all structural characters to
+   * indexes. Closing quotes are included, so every string is a pair of
+   * offsets.
+   */
+  static void index(const char* data, size_t size, Vector<size_t>* indexes);
+
+  static const size_t kBlockSize = 64;
+
+};
+
+}
+}
+#endif
@@ -7,6 +7,7 @@
  * copy of the GNU General Public License along with this program. If not, see
  * <http://www.gnu.org/licenses/>.
  */
+#include <string.h>
 #include "stx/json/jsonutil.h"
 
 namespace stx {
@@ -257,6 +258,22 @@ Option<String> arrayGetString(
   }
 }
 
-}
+void unescapeString(const char* begin, const char* end, String* dst) {
+  for (auto cur = begin; cur < end; ) {
+    auto escape = (const char*) memchr(cur, '\\', end - cur);
+    if (!escape) {
+      dst->append(cur, end);
+      break;
+    }
+
+    dst->append(cur, escape);
+    if (escape + 1 < end) {
+      *dst += escape[1];
+    }
+
+    cur = escape + 2;
+  }
 }
 
+}
+}
@@ -75,6 +75,13 @@ Option<String> arrayGetString(
     JSONObject::const_iterator end,
     size_t index);
 
+/**
+ * Appends the unescaped contents of a JSON string, without its quotes, to
+ * dst. Same unescaping as the JSONInputStream: a backslash is dropped and the
+ * character following it is kept as is
+ */
+void unescapeString(const char* begin, const char* end, String* dst);
+
 class JSONUtil {
 public:
 
@@ -7,6 +7,7 @@
  * copy of the GNU General Public License along with this program. If not, see
  * <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <string.h>
@@ -14,6 +15,7 @@
 #include <sys/uio.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <stx/sysconfig.h>
 #include "stx/exception.h"
 #include "stx/net/udpsocket.h"
 
@@ -32,12 +34,16 @@ UDPSocket::~UDPSocket() {
   close(fd_);
 }
 
+static void toSockAddr(const InetAddr& addr, struct sockaddr_in* saddr) {
+  saddr->sin_family = AF_INET;
+  saddr->sin_port = htons(addr.port());
+  inet_aton(addr.ip().c_str(), &(saddr->sin_addr));
+  memset(&(saddr->sin_zero), 0, 8);
+}
+
 void UDPSocket::sendTo(const Buffer& pkt, const InetAddr& addr) {
   struct sockaddr_in saddr;
-  saddr.sin_family = AF_INET;
-  saddr.sin_port = htons(addr.port());
-  inet_aton(addr.ip().c_str(), &(saddr.sin_addr));
-  memset(&(saddr.sin_zero), 0, 8);
+  toSockAddr(addr, &saddr);
 
   auto res = sendto(
       fd_,
@@ -52,5 +58,46 @@ void UDPSocket::sendTo(const Buffer& pkt, const InetAddr& addr) {
   }
 }
 
+void UDPSocket::sendTo(
+    const Buffer* packets,
+    size_t count,
+    const InetAddr& addr) {
+#ifdef HAVE_SENDMMSG
+  static const size_t kMaxBatchSize = 64;
+
+  struct sockaddr_in saddr;
+  toSockAddr(addr, &saddr);
+
+  struct iovec iov[kMaxBatchSize];
+  struct mmsghdr msgs[kMaxBatchSize];
+
+  while (count > 0) {
+    auto batch_size = std::min(count, kMaxBatchSize);
+    memset(msgs, 0, sizeof(struct mmsghdr) * batch_size);
+
+    for (size_t i = 0; i < batch_size; ++i) {
+      iov[i].iov_base = packets[i].data();
+      iov[i].iov_len = packets[i].size();
+      msgs[i].msg_hdr.msg_name = &saddr;
+      msgs[i].msg_hdr.msg_namelen = sizeof(saddr);
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    auto res = sendmmsg(fd_, msgs, batch_size, 0);
+    if (res < 0) {
+      RAISE_ERRNO(kIOError, "sendmmsg() failed");
+    }
+
+    packets += res;
+    count -= res;
+  }
+#else
+  for (size_t i = 0; i < count; ++i) {
+    sendTo(packets[i], addr);
+  }
+#endif
+}
+
 }
 }
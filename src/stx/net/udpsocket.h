@@ -25,6 +25,11 @@ public:
 
   void sendTo(const Buffer& packet, const InetAddr& addr);
 
+  /**
+   * Sends count packets to addr, with as few syscalls as possible
+   */
+  void sendTo(const Buffer* packets, size_t count, const InetAddr& addr);
+
 protected:
   int fd_;
 };
@@ -0,0 +1,356 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stx/protobuf/ColumnarMessageDecoder.h>
+#include <stx/util/binarymessagereader.h>
+#include <stx/util/BitPackDecoder.h>
+
+namespace stx {
+namespace msg {
+
+namespace {
+
+/**
+ * A message under reconstruction. Object fields are kept by id and instance
+ * number, so that all columns below the same object field fill the same
+ * instances.
+ */
+struct AssemblyNode {
+  struct Instances {
+    uint32_t field_id;
+    size_t generation;
+    size_t next;
+    Vector<ScopedPtr<AssemblyNode>> nodes;
+  };
+
+  /**
+   * Returns the next instance of the object field for the column with the
+   * given generation, creating it if no previous column did
+   */
+  AssemblyNode* nextInstance(uint32_t field_id, size_t generation) {
+    Instances* instances = nullptr;
+    for (auto& i : objects) {
+      if (i.field_id == field_id) {
+        instances = &i;
+        break;
+      }
+    }
+
+    if (!instances) {
+      objects.emplace_back();
+      instances = &objects.back();
+      instances->field_id = field_id;
+      instances->generation = 0;
+    }
+
+    if (instances->generation != generation) {
+      instances->generation = generation;
+      instances->next = 0;
+    }
+
+    auto idx = instances->next++;
+    if (idx == instances->nodes.size()) {
+      instances->nodes.emplace_back(new AssemblyNode());
+    }
+
+    return instances->nodes[idx].get();
+  }
+
+  void toMessageObject(MessageObject* msg) const {
+    for (const auto& leaf : leaves) {
+      msg->asObject().emplace_back(leaf);
+    }
+
+    for (const auto& i : objects) {
+      for (const auto& node : i.nodes) {
+        node->toMessageObject(&msg->addChild(i.field_id));
+      }
+    }
+  }
+
+  Vector<MessageObject> leaves;
+  Vector<Instances> objects;
+};
+
+class ValueReader {
+public:
+
+  ValueReader(
+      const MessageSchemaField& field,
+      util::BinaryMessageReader* reader) :
+      field_(field),
+      reader_(reader),
+      encoding_((ColumnEncoding) *reader->readUInt8()) {
+    switch (encoding_) {
+
+      case ColumnEncoding::PLAIN:
+        break;
+
+      case ColumnEncoding::BITPACK: {
+        auto size = reader_->readVarUInt();
+        auto data = (void*) reader_->read(size);
+        if (field_.type == FieldType::BOOLEAN) {
+          bitpack_.reset(new util::BitPackDecoder(data, size, 1));
+        } else {
+          bitpack_.reset(
+              new util::BitPackDecoder(data, size, util::BitPackMode::FOR));
+        }
+        break;
+      }
+
+      case ColumnEncoding::DICTIONARY: {
+        auto dict_size = reader_->readVarUInt();
+        for (size_t i = 0; i < dict_size; ++i) {
+          dict_.emplace_back(reader_->readLenencString());
+        }
+
+        auto size = reader_->readVarUInt();
+        auto data = (void*) reader_->read(size);
+        bitpack_.reset(
+            new util::BitPackDecoder(
+                data,
+                size,
+                dict_size > 0 ? dict_size - 1 : 0));
+        break;
+      }
+
+      default:
+        RAISEF(kRuntimeError, "invalid column encoding: $0", (int) encoding_);
+
+    }
+  }
+
+  void read(Vector<MessageObject>* msgs) {
+    auto id = field_.id;
+
+    switch (field_.type) {
+
+      case FieldType::UINT32:
+        if (encoding_ == ColumnEncoding::BITPACK) {
+          msgs->emplace_back(id, bitpack_->next());
+        } else {
+          msgs->emplace_back(id, (uint32_t) reader_->readVarUInt());
+        }
+        break;
+
+      case FieldType::UINT64:
+        msgs->emplace_back(id, (uint64_t) reader_->readVarUInt());
+        break;
+
+      case FieldType::DATETIME:
+        msgs->emplace_back(id, UnixTime(reader_->readVarUInt()));
+        break;
+
+      case FieldType::DOUBLE:
+        msgs->emplace_back(id, reader_->readDouble());
+        break;
+
+      case FieldType::BOOLEAN:
+        if (bitpack_->next()) {
+          msgs->emplace_back(id, msg::TRUE);
+        } else {
+          msgs->emplace_back(id, msg::FALSE);
+        }
+        break;
+
+      case FieldType::STRING:
+        if (encoding_ == ColumnEncoding::DICTIONARY) {
+          auto idx = bitpack_->next();
+          if (idx >= dict_.size()) {
+            RAISE(kIndexError, "dictionary index out of bounds");
+          }
+
+          msgs->emplace_back(id, dict_[idx]);
+        } else {
+          msgs->emplace_back(id, reader_->readLenencString());
+        }
+        break;
+
+      case FieldType::OBJECT:
+        RAISE(kIllegalStateError, "object fields can't be columns");
+
+    }
+  }
+
+protected:
+  const MessageSchemaField& field_;
+  util::BinaryMessageReader* reader_;
+  ColumnEncoding encoding_;
+  ScopedPtr<util::BitPackDecoder> bitpack_;
+  Vector<String> dict_;
+};
+
+void readColumn(
+    const MessageColumn& column,
+    size_t generation,
+    util::BinaryMessageReader* reader,
+    Vector<AssemblyNode>* records) {
+  const auto& path = column.path;
+  auto nentries = reader->readVarUInt();
+  reader->readVarUInt(); // num values
+
+  auto rlevels_size = reader->readVarUInt();
+  util::BitPackDecoder rlevels(
+      (void*) reader->read(rlevels_size),
+      rlevels_size,
+      column.max_rlevel);
+
+  auto dlevels_size = reader->readVarUInt();
+  util::BitPackDecoder dlevels(
+      (void*) reader->read(dlevels_size),
+      dlevels_size,
+      column.max_dlevel);
+
+  ValueReader values(column.field(), reader);
+
+  // the field in the path at which each repetition level repeats
+  Vector<size_t> repeated_depth(column.max_rlevel + 1, 0);
+  for (size_t i = 0; i < path.size(); ++i) {
+    if (path[i]->repeated) {
+      repeated_depth[column.rlevels[i]] = i;
+    }
+  }
+
+  Vector<AssemblyNode*> stack(path.size(), nullptr);
+  size_t record = 0;
+  for (size_t n = 0; n < nentries; ++n) {
+    auto r = rlevels.next();
+    auto d = dlevels.next();
+    if (r > column.max_rlevel || d > column.max_dlevel) {
+      RAISE(kRuntimeError, "invalid repetition or definition level");
+    }
+
+    size_t depth = 0;
+    if (r == 0) {
+      if (n > 0) {
+        ++record;
+      }
+
+      if (record >= records->size()) {
+        RAISE(kIndexError, "column has more records than the batch");
+      }
+
+      stack[0] = &(*records)[record];
+    } else {
+      if (n == 0) {
+        RAISE(kRuntimeError, "column starts with a repeated value");
+      }
+
+      depth = repeated_depth[r];
+    }
+
+    // everything below the field that repeats is a new instance
+    for (auto i = depth; i < d && i + 1 < path.size(); ++i) {
+      stack[i + 1] = stack[i]->nextInstance(path[i]->id, generation);
+    }
+
+    if (d == path.size()) {
+      values.read(&stack.back()->leaves);
+    }
+  }
+}
+
+} // namespace
+
+void ColumnarMessageDecoder::decode(
+    const void* data,
+    size_t size,
+    const MessageSchema& schema,
+    Vector<MessageObject>* msgs) {
+  decode(data, size, schema, nullptr, msgs);
+}
+
+void ColumnarMessageDecoder::decode(
+    const void* data,
+    size_t size,
+    const MessageSchema& schema,
+    const Set<String>& columns,
+    Vector<MessageObject>* msgs) {
+  decode(data, size, schema, &columns, msgs);
+}
+
+void ColumnarMessageDecoder::decode(
+    const void* data,
+    size_t size,
+    const MessageSchema& schema,
+    const Set<String>* columns,
+    Vector<MessageObject>* msgs) {
+  HashMap<String, MessageColumn> schema_columns;
+  for (auto& col : ColumnarMessageEncoder::columns(schema)) {
+    schema_columns.emplace(col.name, col);
+  }
+
+  if (columns) {
+    for (const auto& col : *columns) {
+      if (schema_columns.count(col) == 0) {
+        RAISEF(kNotFoundError, "unknown column: '$0'", col);
+      }
+    }
+  }
+
+  util::BinaryMessageReader reader(data, size);
+  auto nrecords = reader.readVarUInt();
+  auto ncols = reader.readVarUInt();
+
+  struct ColumnPtr {
+    String name;
+    size_t offset;
+    size_t size;
+  };
+
+  Vector<ColumnPtr> col_ptrs;
+  for (size_t i = 0; i < ncols; ++i) {
+    ColumnPtr ptr;
+    ptr.name = reader.readLenencString();
+    ptr.offset = reader.readVarUInt();
+    ptr.size = reader.readVarUInt();
+    col_ptrs.emplace_back(ptr);
+  }
+
+  auto data_begin = (const char*) data + reader.position();
+  auto data_size = size - reader.position();
+
+  Vector<AssemblyNode> records(nrecords);
+  size_t generation = 0;
+  for (const auto& ptr : col_ptrs) {
+    if (columns && columns->count(ptr.name) == 0) {
+      continue;
+    }
+
+    // columns that were removed from the schema are skipped
+    auto col = schema_columns.find(ptr.name);
+    if (col == schema_columns.end()) {
+      continue;
+    }
+
+    if (ptr.offset + ptr.size > data_size) {
+      RAISE(kBufferOverflowError, "column exceeds buffer boundary");
+    }
+
+    try {
+      util::BinaryMessageReader col_reader(data_begin + ptr.offset, ptr.size);
+      readColumn(col->second, ++generation, &col_reader, &records);
+    } catch (const std::exception& e) {
+      RAISEF(
+          kRuntimeError,
+          "error while decoding column '$0': $1",
+          ptr.name,
+          e.what());
+    }
+  }
+
+  msgs->reserve(msgs->size() + nrecords);
+  for (const auto& record : records) {
+    msgs->emplace_back();
+    record.toMessageObject(&msgs->back());
+  }
+}
+
+} // namespace msg
+} // namespace stx
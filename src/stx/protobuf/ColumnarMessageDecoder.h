@@ -0,0 +1,58 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_MSG_COLUMNARMESSAGEDECODER_H
+#define _STX_MSG_COLUMNARMESSAGEDECODER_H
+#include <stx/stdtypes.h>
+#include <stx/buffer.h>
+#include <stx/protobuf/ColumnarMessageEncoder.h>
+#include <stx/protobuf/MessageSchema.h>
+#include <stx/protobuf/MessageObject.h>
+
+namespace stx {
+namespace msg {
+
+/**
+ * Reassembles messages from a batch written by the ColumnarMessageEncoder
+ */
+class ColumnarMessageDecoder {
+public:
+
+  static void decode(
+      const void* data,
+      size_t size,
+      const MessageSchema& schema,
+      Vector<MessageObject>* msgs);
+
+  /**
+   * Decodes only the given columns (by dotted path). The data of all other
+   * columns is never read.
+   */
+  static void decode(
+      const void* data,
+      size_t size,
+      const MessageSchema& schema,
+      const Set<String>& columns,
+      Vector<MessageObject>* msgs);
+
+protected:
+
+  static void decode(
+      const void* data,
+      size_t size,
+      const MessageSchema& schema,
+      const Set<String>* columns,
+      Vector<MessageObject>* msgs);
+
+};
+
+} // namespace msg
+} // namespace stx
+
+#endif
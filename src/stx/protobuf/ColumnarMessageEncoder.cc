@@ -0,0 +1,265 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stx/protobuf/ColumnarMessageEncoder.h>
+#include <stx/util/BitPackEncoder.h>
+
+namespace stx {
+namespace msg {
+
+namespace {
+
+struct ColumnWriter {
+  ColumnWriter(const MessageColumn& _column) : column(_column) {}
+
+  const MessageColumn& column;
+  Vector<uint32_t> rlevels;
+  Vector<uint32_t> dlevels;
+  Vector<const MessageObject*> values;
+};
+
+void stripe(
+    const MessageObject& msg,
+    ColumnWriter* writer,
+    size_t depth,
+    uint32_t rlevel,
+    uint32_t dlevel) {
+  const auto& column = writer->column;
+  const auto& field = *column.path[depth];
+  bool leaf = depth + 1 == column.path.size();
+  bool found = false;
+
+  for (const auto& cld : msg.asObject()) {
+    if (cld.id != field.id) {
+      continue;
+    }
+
+    auto r = found ? column.rlevels[depth] : rlevel;
+    found = true;
+
+    if (leaf) {
+      writer->rlevels.emplace_back(r);
+      writer->dlevels.emplace_back(dlevel + 1);
+      writer->values.emplace_back(&cld);
+    } else {
+      stripe(cld, writer, depth + 1, r, dlevel + 1);
+    }
+
+    if (!field.repeated) {
+      break;
+    }
+  }
+
+  if (!found) {
+    writer->rlevels.emplace_back(rlevel);
+    writer->dlevels.emplace_back(dlevel);
+  }
+}
+
+void writeLevels(
+    const Vector<uint32_t>& levels,
+    uint32_t max_level,
+    util::BinaryMessageWriter* data) {
+  util::BitPackEncoder enc(max_level);
+  for (auto l : levels) {
+    enc.encode(l);
+  }
+  enc.flush();
+
+  data->appendVarUInt(enc.size());
+  data->append(enc.data(), enc.size());
+}
+
+void writeBitPacked(
+    util::BitPackEncoder* enc,
+    util::BinaryMessageWriter* data) {
+  enc->flush();
+  data->appendVarUInt(enc->size());
+  data->append(enc->data(), enc->size());
+}
+
+void writeValues(
+    const ColumnWriter& writer,
+    util::BinaryMessageWriter* data) {
+  const auto& field = writer.column.field();
+  const auto& values = writer.values;
+
+  switch (field.type) {
+
+    case FieldType::UINT32: {
+      if (field.encoding != EncodingHint::BITPACK) {
+        data->appendUInt8((uint8_t) ColumnEncoding::PLAIN);
+        for (auto v : values) {
+          data->appendVarUInt(v->asUInt32());
+        }
+        break;
+      }
+
+      data->appendUInt8((uint8_t) ColumnEncoding::BITPACK);
+      util::BitPackEncoder enc(util::BitPackMode::FOR);
+      for (auto v : values) {
+        enc.encode(v->asUInt32());
+      }
+
+      writeBitPacked(&enc, data);
+      break;
+    }
+
+    case FieldType::UINT64:
+    case FieldType::DATETIME:
+      data->appendUInt8((uint8_t) ColumnEncoding::PLAIN);
+      for (auto v : values) {
+        data->appendVarUInt(v->asUInt64());
+      }
+      break;
+
+    case FieldType::DOUBLE:
+      data->appendUInt8((uint8_t) ColumnEncoding::PLAIN);
+      for (auto v : values) {
+        data->appendDouble(v->asDouble());
+      }
+      break;
+
+    case FieldType::BOOLEAN: {
+      data->appendUInt8((uint8_t) ColumnEncoding::BITPACK);
+      util::BitPackEncoder enc(1);
+      for (auto v : values) {
+        enc.encode(v->asBool() ? 1 : 0);
+      }
+
+      writeBitPacked(&enc, data);
+      break;
+    }
+
+    case FieldType::STRING: {
+      HashMap<String, uint32_t> dict_ids;
+      Vector<const String*> dict;
+      for (auto v : values) {
+        const auto& str = v->asString();
+        if (dict_ids.emplace(str, dict.size()).second) {
+          dict.emplace_back(&str);
+        }
+
+        if (dict.size() * 2 > values.size()) {
+          break;
+        }
+      }
+
+      if (values.empty() || dict.size() * 2 > values.size()) {
+        data->appendUInt8((uint8_t) ColumnEncoding::PLAIN);
+        for (auto v : values) {
+          data->appendLenencString(v->asString());
+        }
+        break;
+      }
+
+      data->appendUInt8((uint8_t) ColumnEncoding::DICTIONARY);
+      data->appendVarUInt(dict.size());
+      for (auto str : dict) {
+        data->appendLenencString(*str);
+      }
+
+      util::BitPackEncoder enc(dict.size() - 1);
+      for (auto v : values) {
+        enc.encode(dict_ids[v->asString()]);
+      }
+
+      writeBitPacked(&enc, data);
+      break;
+    }
+
+    case FieldType::OBJECT:
+      RAISE(kIllegalStateError, "object fields can't be columns");
+
+  }
+}
+
+} // namespace
+
+void ColumnarMessageEncoder::encode(
+    const Vector<MessageObject>& msgs,
+    const MessageSchema& schema,
+    Buffer* buf) {
+  auto cols = columns(schema);
+
+  Vector<ScopedPtr<util::BinaryMessageWriter>> col_data;
+  for (const auto& col : cols) {
+    ColumnWriter writer(col);
+
+    try {
+      for (const auto& msg : msgs) {
+        stripe(msg, &writer, 0, 0, 0);
+      }
+
+      auto data = mkScoped(new util::BinaryMessageWriter());
+      data->appendVarUInt(writer.rlevels.size());
+      data->appendVarUInt(writer.values.size());
+      writeLevels(writer.rlevels, col.max_rlevel, data.get());
+      writeLevels(writer.dlevels, col.max_dlevel, data.get());
+      writeValues(writer, data.get());
+      col_data.emplace_back(std::move(data));
+    } catch (const std::exception& e) {
+      RAISEF(
+          kRuntimeError,
+          "error while encoding column '$0': $1",
+          col.name,
+          e.what());
+    }
+  }
+
+  util::BinaryMessageWriter header;
+  header.appendVarUInt(msgs.size());
+  header.appendVarUInt(cols.size());
+
+  size_t offset = 0;
+  for (size_t i = 0; i < cols.size(); ++i) {
+    header.appendLenencString(cols[i].name);
+    header.appendVarUInt(offset);
+    header.appendVarUInt(col_data[i]->size());
+    offset += col_data[i]->size();
+  }
+
+  buf->append(header.data(), header.size());
+  for (const auto& data : col_data) {
+    buf->append(data->data(), data->size());
+  }
+}
+
+Vector<MessageColumn> ColumnarMessageEncoder::columns(
+    const MessageSchema& schema) {
+  Vector<MessageColumn> columns;
+  MessageColumn root;
+  root.max_rlevel = 0;
+  root.max_dlevel = 0;
+  findColumns(schema, root, &columns);
+  return columns;
+}
+
+void ColumnarMessageEncoder::findColumns(
+    const MessageSchema& schema,
+    MessageColumn prefix,
+    Vector<MessageColumn>* columns) {
+  for (const auto& field : schema.fields()) {
+    auto col = prefix;
+    col.name = prefix.name.empty() ? field.name : prefix.name + "." + field.name;
+    col.path.emplace_back(&field);
+    col.max_rlevel = prefix.max_rlevel + (field.repeated ? 1 : 0);
+    col.max_dlevel = col.path.size();
+    col.rlevels.emplace_back(col.max_rlevel);
+
+    if (field.type == FieldType::OBJECT) {
+      findColumns(*field.schema, col, columns);
+    } else {
+      columns->emplace_back(col);
+    }
+  }
+}
+
+} // namespace msg
+} // namespace stx
@@ -0,0 +1,104 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_MSG_COLUMNARMESSAGEENCODER_H
+#define _STX_MSG_COLUMNARMESSAGEENCODER_H
+#include <stx/stdtypes.h>
+#include <stx/buffer.h>
+#include <stx/util/binarymessagewriter.h>
+#include <stx/protobuf/MessageSchema.h>
+#include <stx/protobuf/MessageObject.h>
+
+/**
+ * Stores a batch of messages of the same schema column by column. Every leaf
+ * field is one column, named by its dotted path ("four.alpha"). Nesting is
+ * recorded with repetition and definition levels as in Dremel: the
+ * repetition level of an entry says at which repeated field of the path it
+ * repeats (0 = new record), the definition level how many fields of the
+ * path are present. Unlike Dremel, required fields count towards the
+ * definition level too, so that messages missing a required field survive
+ * a roundtrip.
+ *
+ *   <batch> :=
+ *       <varint>               // num records
+ *       <varint>               // num columns
+ *       { <column_ptr> }       // one column pointer for each column
+ *       { <column> }           // column data
+ *
+ *   <column_ptr> :=
+ *       <lenenc_string>        // column name
+ *       <varint>               // column data offset (from start of data)
+ *       <varint>               // column data size
+ *
+ *   <column> :=
+ *       <varint>               // num entries
+ *       <varint>               // num values (entries with a leaf value)
+ *       <varint> <bytes>       // repetition levels (BitPackEncoder, FIXED)
+ *       <varint> <bytes>       // definition levels (BitPackEncoder, FIXED)
+ *       <uint8_t>              // value encoding
+ *       <values>
+ *
+ *   <values> :=
+ *       { <varint> | <double> | <lenenc_string> }      // PLAIN
+ *     | <varint> <bytes>                               // BITPACK
+ *     | <varint> { <lenenc_string> } <varint> <bytes>  // DICTIONARY
+ *
+ * BITPACK stores UINT32 fields with the BITPACK encoding hint as a
+ * BitPackMode::FOR stream and booleans as one bit each. DICTIONARY stores
+ * the distinct strings once, followed by their bitpacked indexes; it is
+ * used for string columns unless more than half of the values are distinct.
+ */
+namespace stx {
+namespace msg {
+
+enum class ColumnEncoding : uint8_t {
+  PLAIN = 0,
+  BITPACK = 1,
+  DICTIONARY = 2
+};
+
+struct MessageColumn {
+  String name;
+  Vector<const MessageSchemaField*> path;
+  Vector<uint32_t> rlevels; // repetition level of each field in the path
+  uint32_t max_rlevel;
+  uint32_t max_dlevel;
+
+  const MessageSchemaField& field() const {
+    return *path.back();
+  }
+};
+
+class ColumnarMessageEncoder {
+public:
+
+  static void encode(
+      const Vector<MessageObject>& msgs,
+      const MessageSchema& schema,
+      Buffer* buf);
+
+  /**
+   * Returns the leaf columns of the schema. The returned columns point into
+   * the schema, which must outlive them.
+   */
+  static Vector<MessageColumn> columns(const MessageSchema& schema);
+
+protected:
+
+  static void findColumns(
+      const MessageSchema& schema,
+      MessageColumn prefix,
+      Vector<MessageColumn>* columns);
+
+};
+
+} // namespace msg
+} // namespace stx
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stx/protobuf/MessageEncoder.h>
+#include <stx/protobuf/MessageDecoder.h>
+#include <stx/test/benchmark.h>
+#include <stx/stringutil.h>
+
+using namespace stx;
+
+static const size_t kNumMessages = 10000;
+
+/**
+ * An event with 30 fields: ids, counters and timestamps, a few strings, a
+ * double and a flag, and a repeated nested item object
+ */
+static RefPtr<msg::MessageSchema> eventSchema() {
+  Vector<msg::MessageSchemaField> item_fields;
+  item_fields.emplace_back(1, "item_id", msg::FieldType::UINT64, 0, false, true);
+  item_fields.emplace_back(2, "position", msg::FieldType::UINT32, 0, false, true);
+  item_fields.emplace_back(3, "clicked", msg::FieldType::BOOLEAN, 0, false, true);
+
+  Vector<msg::MessageSchemaField> fields;
+  for (uint32_t i = 1; i <= 16; ++i) {
+    fields.emplace_back(
+        i,
+        StringUtil::format("counter$0", i),
+        i % 2 ? msg::FieldType::UINT32 : msg::FieldType::UINT64,
+        0,
+        false,
+        true);
+  }
+
+  for (uint32_t i = 17; i <= 22; ++i) {
+    fields.emplace_back(
+        i,
+        StringUtil::format("label$0", i),
+        msg::FieldType::STRING,
+        0,
+        false,
+        true);
+  }
+
+  for (uint32_t i = 23; i <= 26; ++i) {
+    fields.emplace_back(
+        i,
+        StringUtil::format("time$0", i),
+        msg::FieldType::DATETIME,
+        0,
+        false,
+        true);
+  }
+
+  fields.emplace_back(27, "score", msg::FieldType::DOUBLE, 0, false, true);
+  fields.emplace_back(28, "flag", msg::FieldType::BOOLEAN, 0, false, true);
+  fields.emplace_back(29, "tags", msg::FieldType::STRING, 0, true, true);
+  fields.emplace_back(
+      msg::MessageSchemaField::mkObjectField(
+          30,
+          "items",
+          true,
+          true,
+          new msg::MessageSchema("Item", item_fields)));
+
+  return new msg::MessageSchema("Event", fields);
+}
+
+static void buildEvent(size_t n, msg::MessageObject* obj) {
+  for (uint32_t i = 1; i <= 16; ++i) {
+    if (i % 2) {
+      obj->addChild(i, uint32_t(n * i % 100000));
+    } else {
+      obj->addChild(i, uint64_t(n * i * 0x10001));
+    }
+  }
+
+  for (uint32_t i = 17; i <= 22; ++i) {
+    obj->addChild(i, StringUtil::format("label-$0", n % (i * 10)));
+  }
+
+  for (uint32_t i = 23; i <= 26; ++i) {
+    obj->addChild(i, UnixTime(1430000000000000 + n * 1000 + i));
+  }
+
+  obj->addChild(27, double(n) / 7);
+  if (n % 2) {
+    obj->addChild(28, msg::TRUE);
+  } else {
+    obj->addChild(28, msg::FALSE);
+  }
+
+  obj->addChild(29, String("tag-a"));
+  obj->addChild(29, String("tag-b"));
+
+  for (uint32_t j = 0; j < 3; ++j) {
+    auto& item = obj->addChild(30);
+    item.addChild(1, uint64_t(n * 31 + j));
+    item.addChild(2, j);
+    item.addChild(3, msg::TRUE);
+  }
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  auto schema = eventSchema();
+
+  Vector<Buffer> msgs;
+  for (size_t n = 0; n < kNumMessages; ++n) {
+    msg::MessageObject obj;
+    buildEvent(n, &obj);
+    msgs.emplace_back();
+    msg::MessageEncoder::encode(obj, *schema, &msgs.back());
+  }
+
+  size_t nfields = 0;
+  auto result = Benchmark::benchmark([&]() {
+    for (const auto& buf : msgs) {
+      msg::MessageObject obj;
+      msg::MessageDecoder::decode(buf, *schema, &obj);
+      nfields += obj.asObject().size();
+    }
+  }, 10);
+
+  Benchmark::printResultTable(
+      "decode 30 field event",
+      Benchmark::BenchmarkResult(result.meanRuntimeNanos(), kNumMessages),
+      true);
+
+  if (nfields == 0) {
+    printf("no fields decoded\n");
+  }
+
+  return 0;
+}
@@ -26,30 +26,56 @@ void MessageDecoder::decode(
     const MessageSchema& schema,
     MessageObject* msg) {
   util::BinaryMessageReader reader(data, size);
+  decodeObject(&reader, size, schema, msg);
+}
+
+void MessageDecoder::decodeObject(
+    util::BinaryMessageReader* reader,
+    size_t size,
+    const MessageSchema& schema,
+    MessageObject* msg) {
+  const auto& compiled = schema.compiled();
+  auto end = reader->position() + size;
+
+  /* MessageObjects can't be moved, so growing the list of children copies
+     all of them. reserve room for every field of the schema, but no more
+     than fit into the data (every field takes at least two bytes) */
+  msg->asObject().reserve(std::min(size / 2, schema.fields().size()));
 
-  while (reader.remaining() > 0) {
-    auto fkey = reader.readVarUInt();
+  while (reader->position() < end) {
+    auto fkey = reader->readVarUInt();
     auto fid = fkey >> 3;
 
+    CompiledMessageSchema::Field field;
+    if (fid < compiled.fields.size()) {
+      field = compiled.fields[fid];
+    } else if (compiled.sparse && schema.hasField(fid)) {
+      field.known = true;
+      field.type = schema.fieldType(fid);
+      field.schema = schema.fieldSchema(fid).get();
+    } else {
+      field.known = false;
+    }
+
     /* skip unknown fields */
-    if (!schema.hasField(fid)) {
+    if (!field.known) {
       auto wire_type = (WireType) uint8_t(fkey & 0x7);
       switch (wire_type) {
 
         case WireType::VARINT:
-          reader.readVarUInt();
+          reader->readVarUInt();
           break;
 
         case WireType::LENENC:
-          reader.read(reader.readVarUInt());
+          reader->read(reader->readVarUInt());
           break;
 
         case WireType::FIXED32:
-          reader.readUInt32();
+          reader->readUInt32();
           break;
 
         case WireType::FIXED64:
-          reader.readUInt64();
+          reader->readUInt64();
           break;
 
         default:
@@ -61,45 +87,44 @@ void MessageDecoder::decode(
     }
 
     /* parse known fields */
-    switch (schema.fieldType(fid)) {
+    switch (field.type) {
       case FieldType::OBJECT: {
-        auto len = reader.readVarUInt();
+        auto len = reader->readVarUInt();
         auto nxt = &msg->addChild(fid);
-        if (len > reader.remaining()) {
+        if (len > end - reader->position()) {
           RAISE(kBufferOverflowError);
         }
 
-        auto obj_schema = schema.fieldSchema(fid);
-        decode(reader.read(len), len, *obj_schema, nxt);
+        decodeObject(reader, len, *field.schema, nxt);
         break;
       }
 
       case FieldType::UINT32: {
-        auto val = reader.readVarUInt();
+        auto val = reader->readVarUInt();
         msg->addChild(fid, (uint32_t) val);
         break;
       }
 
       case FieldType::UINT64: {
-        auto val = reader.readVarUInt();
+        auto val = reader->readVarUInt();
         msg->addChild(fid, (uint64_t) val);
         break;
       }
 
       case FieldType::DATETIME: {
-        auto val = reader.readVarUInt();
+        auto val = reader->readVarUInt();
         msg->addChild(fid, UnixTime(val));
         break;
       }
 
       case FieldType::DOUBLE: {
-        auto val = reader.readDouble();
+        auto val = reader->readDouble();
         msg->addChild(fid, val);
         break;
       }
 
       case FieldType::BOOLEAN: {
-        auto val = reader.readVarUInt();
+        auto val = reader->readVarUInt();
         if (val == 1) {
           msg->addChild(fid, msg::TRUE);
         } else {
@@ -109,16 +134,19 @@ void MessageDecoder::decode(
       }
 
       case FieldType::STRING: {
-        auto len = reader.readVarUInt();
-        auto val = reader.read(len);
+        auto len = reader->readVarUInt();
+        auto val = reader->read(len);
         msg->addChild(fid, String((const char*) val, len));
         break;
       }
 
     }
   }
-}
 
+  if (reader->position() != end) {
+    RAISE(kBufferOverflowError, "field exceeds object boundary");
+  }
+}
 
 } // namespace msg
 } // namespace stx
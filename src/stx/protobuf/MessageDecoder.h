@@ -32,7 +32,13 @@ public:
       const MessageSchema& schema,
       MessageObject* msg);
 
+protected:
 
+  static void decodeObject(
+      util::BinaryMessageReader* reader,
+      size_t size,
+      const MessageSchema& schema,
+      MessageObject* msg);
 
 };
 
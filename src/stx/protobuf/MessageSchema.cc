@@ -265,12 +265,13 @@ MessageSchemaField MessageSchemaField::mkObjectField(
   return field;
 }
 
-MessageSchema::MessageSchema(std::nullptr_t) {}
+MessageSchema::MessageSchema(std::nullptr_t) : compiled_(nullptr) {}
 
 MessageSchema::MessageSchema(
     const String& name,
     Vector<MessageSchemaField> fields) :
-    name_(name) {
+    name_(name),
+    compiled_(nullptr) {
   for (const auto& field : fields) {
     addField(field);
   }
@@ -281,7 +282,12 @@ MessageSchema::MessageSchema(const MessageSchema& other) :
     fields_(other.fields_),
     field_ids_(other.field_ids_),
     field_types_(other.field_types_),
-    field_names_(other.field_names_) {}
+    field_names_(other.field_names_),
+    compiled_(nullptr) {}
+
+MessageSchema::~MessageSchema() {
+  delete compiled_.load();
+}
 
 const String& MessageSchema::name() const {
   return name_;
@@ -361,7 +367,57 @@ RefPtr<MessageSchema> MessageSchema::fieldSchema(uint32_t id) const {
   RAISEF(kIndexError, "field not found: $0", id);
 }
 
+const CompiledMessageSchema& MessageSchema::compiled() const {
+  auto compiled = compiled_.load(std::memory_order_acquire);
+  if (compiled) {
+    return *compiled;
+  }
+
+  std::unique_lock<std::mutex> lk(compiled_mutex_);
+  compiled = compiled_.load(std::memory_order_relaxed);
+  if (compiled) {
+    return *compiled;
+  }
+
+  compiled = new CompiledMessageSchema();
+  compiled->sparse = false;
+
+  uint32_t max_id = 0;
+  for (const auto& field : fields_) {
+    if (field.id < CompiledMessageSchema::kMaxDenseFieldID) {
+      max_id = std::max(max_id, field.id);
+    } else {
+      compiled->sparse = true;
+    }
+  }
+
+  CompiledMessageSchema::Field unknown;
+  unknown.known = false;
+  unknown.type = FieldType::OBJECT;
+  unknown.schema = nullptr;
+  compiled->fields.resize(fields_.empty() ? 0 : max_id + 1, unknown);
+
+  for (const auto& field : fields_) {
+    if (field.id >= CompiledMessageSchema::kMaxDenseFieldID) {
+      continue;
+    }
+
+    auto& entry = compiled->fields[field.id];
+    entry.known = true;
+    entry.type = field.type;
+    entry.schema = field.schema.get();
+  }
+
+  compiled_.store(compiled, std::memory_order_release);
+  return *compiled;
+}
+
+void MessageSchema::resetCompiled() {
+  delete compiled_.exchange(nullptr);
+}
+
 void MessageSchema::addField(const MessageSchemaField& field) {
+  resetCompiled();
   field_ids_.emplace(field.name, field.id);
   field_types_.emplace(field.id, field.type);
   field_names_.emplace(field.id, field.name);
@@ -374,6 +430,7 @@ void MessageSchema::removeField(uint32_t id) {
       continue;
     }
 
+    resetCompiled();
     field_ids_.erase(f->name);
     field_types_.erase(f->id);
     field_names_.erase(f->id);
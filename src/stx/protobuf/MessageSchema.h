@@ -9,6 +9,8 @@
  */
 #ifndef _STX_MSG_MESSAGESCHEMA_H
 #define _STX_MSG_MESSAGESCHEMA_H
+#include <atomic>
+#include <mutex>
 #include <stx/stdtypes.h>
 #include <stx/exception.h>
 #include <stx/autoref.h>
@@ -84,6 +86,25 @@ struct MessageSchemaField {
   RefPtr<MessageSchema> schema;
 };
 
+/**
+ * A MessageSchema compiled into a flat table indexed by field id, so that a
+ * decoder can dispatch on each field without hashing. Only ids below
+ * kMaxDenseFieldID are in the table; if the schema has larger ids, it is
+ * marked as sparse and those must be looked up in the schema itself.
+ */
+struct CompiledMessageSchema {
+  static const uint32_t kMaxDenseFieldID = 4096;
+
+  struct Field {
+    bool known;
+    FieldType type;
+    const MessageSchema* schema; // OBJECT fields only
+  };
+
+  Vector<Field> fields;
+  bool sparse;
+};
+
 class MessageSchema : public RefCounted {
 public:
 
@@ -97,6 +118,7 @@ public:
   MessageSchema(std::nullptr_t);
 
   MessageSchema(const MessageSchema& other);
+  ~MessageSchema();
 
   const String& name() const;
   void setName(const String& name);
@@ -109,6 +131,13 @@ public:
   const String& fieldName(uint32_t id) const;
   RefPtr<MessageSchema> fieldSchema(uint32_t id) const;
 
+  /**
+   * Returns the compiled field table of this schema. It is built on first
+   * use and dropped whenever a field is added or removed, so it must not be
+   * used concurrently with changes to the schema.
+   */
+  const CompiledMessageSchema& compiled() const;
+
   Vector<Pair<String, MessageSchemaField>> columns() const;
   String toString() const;
 
@@ -132,11 +161,15 @@ protected:
       const String& prefix,
       Set<String>* columns);
 
+  void resetCompiled();
+
   String name_;
   Vector<MessageSchemaField> fields_;
   HashMap<String, uint32_t> field_ids_;
   HashMap<uint32_t, FieldType> field_types_;
   HashMap<uint32_t, String> field_names_;
+  mutable std::mutex compiled_mutex_;
+  mutable std::atomic<CompiledMessageSchema*> compiled_;
 };
 
 class MessageSchemaRepository {
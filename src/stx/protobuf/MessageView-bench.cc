@@ -0,0 +1,106 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stx/protobuf/MessageEncoder.h>
+#include <stx/protobuf/MessageDecoder.h>
+#include <stx/protobuf/MessageView.h>
+#include <stx/test/benchmark.h>
+#include <stx/stringutil.h>
+
+using namespace stx;
+
+static const size_t kNumMessages = 10000;
+
+/**
+ * A wide message: num_fields fields, alternating between integers and short
+ * strings, of which the consumer reads only a few
+ */
+static RefPtr<msg::MessageSchema> wideSchema(uint32_t num_fields) {
+  Vector<msg::MessageSchemaField> fields;
+  for (uint32_t i = 1; i <= num_fields; ++i) {
+    fields.emplace_back(
+        i,
+        StringUtil::format("field$0", i),
+        i % 2 ? msg::FieldType::UINT64 : msg::FieldType::STRING,
+        0,
+        false,
+        true);
+  }
+
+  return new msg::MessageSchema("Wide", fields);
+}
+
+static void benchmarkWide(uint32_t num_fields) {
+  auto schema = wideSchema(num_fields);
+
+  Vector<Buffer> msgs;
+  for (size_t n = 0; n < kNumMessages; ++n) {
+    msg::MessageObject obj;
+    for (uint32_t i = 1; i <= num_fields; ++i) {
+      if (i % 2) {
+        obj.addChild(i, uint64_t(n * i));
+      } else {
+        obj.addChild(i, StringUtil::format("value-$0-$1", n, i));
+      }
+    }
+
+    msgs.emplace_back();
+    msg::MessageEncoder::encode(obj, *schema, &msgs.back());
+  }
+
+  uint64_t checksum = 0;
+  auto decoder_result = Benchmark::benchmark([&]() {
+    for (const auto& buf : msgs) {
+      msg::MessageObject obj;
+      msg::MessageDecoder::decode(buf, *schema, &obj);
+      checksum += obj.getUInt64(1);
+      checksum += obj.getString(2).size();
+      checksum += obj.getUInt64(num_fields - 1);
+    }
+  }, 10);
+
+  auto view_result = Benchmark::benchmark([&]() {
+    for (const auto& buf : msgs) {
+      msg::MessageView view(buf.data(), buf.size(), *schema);
+      checksum += view.getUInt64(1);
+      checksum += view.getString(2).size;
+      checksum += view.getUInt64(num_fields - 1);
+    }
+  }, 10);
+
+  auto label = StringUtil::format("$0 fields, 3 read", num_fields);
+
+  Benchmark::printResultTable(
+      label + " decoder",
+      Benchmark::BenchmarkResult(
+          decoder_result.meanRuntimeNanos(),
+          kNumMessages),
+      true);
+
+  Benchmark::printResultTable(
+      label + " view",
+      Benchmark::BenchmarkResult(view_result.meanRuntimeNanos(), kNumMessages),
+      true);
+
+  if (checksum == 0) {
+    printf("unexpected checksum\n");
+  }
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  benchmarkWide(10);
+  benchmarkWide(100);
+  benchmarkWide(500);
+
+  return 0;
+}
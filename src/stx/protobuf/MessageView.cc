@@ -0,0 +1,304 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include <algorithm>
+#include <stx/protobuf/MessageView.h>
+#include <stx/exception.h>
+#include <stx/ieee754.h>
+#include <stx/inspect.h>
+
+namespace stx {
+namespace msg {
+
+namespace {
+
+inline const char* readVarUInt(
+    const char* cur,
+    const char* end,
+    uint64_t* value) {
+  uint64_t val = 0;
+  for (int shift = 0; cur < end && shift < 64; shift += 7) {
+    auto byte = (unsigned char) *cur++;
+    val |= (uint64_t) (byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *value = val;
+      return cur;
+    }
+  }
+
+  RAISE(kBufferOverflowError, "requested read exceeds message bounds");
+}
+
+} // namespace
+
+String StringRef::toString() const {
+  return String(data, size);
+}
+
+StringRef::operator String() const {
+  return toString();
+}
+
+bool StringRef::operator==(const StringRef& other) const {
+  return size == other.size && memcmp(data, other.data, size) == 0;
+}
+
+bool StringRef::operator==(const String& other) const {
+  return size == other.size() && memcmp(data, other.data(), size) == 0;
+}
+
+bool StringRef::operator!=(const String& other) const {
+  return !(*this == other);
+}
+
+MessageView::MessageView(
+    const void* data,
+    size_t size,
+    const MessageSchema& schema) :
+    MessageView((const char*) data, size, &schema, nullptr) {}
+
+MessageView::MessageView(
+    BufferRef buf,
+    const MessageSchema& schema) :
+    MessageView((const char*) buf->data(), buf->size(), &schema, buf) {}
+
+MessageView::MessageView(
+    const char* data,
+    size_t size,
+    const MessageSchema* schema,
+    BufferRef buf) :
+    data_(data),
+    size_(size),
+    schema_(schema),
+    buf_(buf),
+    indexed_(false) {}
+
+MessageView MessageView::getObject(uint32_t id) const {
+  return subView(findField(id, WireType::LENENC));
+}
+
+Vector<MessageView> MessageView::getObjects(uint32_t id) const {
+  Vector<MessageView> views;
+
+  auto range = findFields(id);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    views.emplace_back(subView(*iter));
+  }
+
+  return views;
+}
+
+size_t MessageView::fieldCount(uint32_t id) const {
+  auto range = findFields(id);
+  return range.second - range.first;
+}
+
+StringRef MessageView::getString(uint32_t id) const {
+  const auto& field = findField(id, WireType::LENENC);
+  return StringRef { field.data, field.value };
+}
+
+Vector<StringRef> MessageView::getStrings(uint32_t id) const {
+  Vector<StringRef> strs;
+
+  auto range = findFields(id);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (iter->wire_type != WireType::LENENC) {
+      RAISEF(kTypeError, "field $0 is not a string", id);
+    }
+
+    strs.emplace_back(StringRef { iter->data, iter->value });
+  }
+
+  return strs;
+}
+
+uint32_t MessageView::getUInt32(uint32_t id) const {
+  return findField(id, WireType::VARINT).value;
+}
+
+uint64_t MessageView::getUInt64(uint32_t id) const {
+  return findField(id, WireType::VARINT).value;
+}
+
+bool MessageView::getBool(uint32_t id) const {
+  return findField(id, WireType::VARINT).value > 0;
+}
+
+double MessageView::getDouble(uint32_t id) const {
+  return IEEE754::fromBytes(findField(id, WireType::FIXED64).value);
+}
+
+UnixTime MessageView::getUnixTime(uint32_t id) const {
+  return UnixTime(findField(id, WireType::VARINT).value);
+}
+
+bool MessageView::hasField(uint32_t id) const {
+  auto range = findFields(id);
+  return range.first != range.second;
+}
+
+const void* MessageView::data() const {
+  return data_;
+}
+
+size_t MessageView::size() const {
+  return size_;
+}
+
+const MessageSchema& MessageView::schema() const {
+  return *schema_;
+}
+
+void MessageView::buildIndex() const {
+  auto cur = data_;
+  auto end = data_ + size_;
+
+  // fields_ is only replaced once the whole message decoded, so that a
+  // failed attempt leaves no partial index behind
+  Vector<Field> fields;
+
+  while (cur < end) {
+    uint64_t fkey;
+    cur = readVarUInt(cur, end, &fkey);
+
+    Field field;
+    field.id = fkey >> 3;
+    field.wire_type = (WireType) uint8_t(fkey & 0x7);
+    field.data = nullptr;
+
+    switch (field.wire_type) {
+
+      case WireType::VARINT:
+        cur = readVarUInt(cur, end, &field.value);
+        break;
+
+      case WireType::LENENC:
+        cur = readVarUInt(cur, end, &field.value);
+        if (field.value > (uint64_t) (end - cur)) {
+          RAISE(kBufferOverflowError, "requested read exceeds message bounds");
+        }
+
+        field.data = cur;
+        cur += field.value;
+        break;
+
+      case WireType::FIXED32: {
+        uint32_t val;
+        if ((size_t) (end - cur) < sizeof(val)) {
+          RAISE(kBufferOverflowError, "requested read exceeds message bounds");
+        }
+
+        memcpy(&val, cur, sizeof(val));
+        field.value = val;
+        cur += sizeof(val);
+        break;
+      }
+
+      case WireType::FIXED64:
+        if ((size_t) (end - cur) < sizeof(field.value)) {
+          RAISE(kBufferOverflowError, "requested read exceeds message bounds");
+        }
+
+        memcpy(&field.value, cur, sizeof(field.value));
+        cur += sizeof(field.value);
+        break;
+
+      default:
+        RAISE(kRuntimeError, "invalid wire type");
+
+    }
+
+    fields.emplace_back(field);
+  }
+
+  // encoders write fields in schema order, so sorting is usually a no-op.
+  // the sort must be stable to keep the order of repeated fields
+  auto cmp = [] (const Field& a, const Field& b) { return a.id < b.id; };
+  if (!std::is_sorted(fields.begin(), fields.end(), cmp)) {
+    std::stable_sort(fields.begin(), fields.end(), cmp);
+  }
+
+  fields_.swap(fields);
+  indexed_ = true;
+}
+
+Pair<MessageView::FieldIter, MessageView::FieldIter> MessageView::findFields(
+    uint32_t id) const {
+  if (!indexed_) {
+    buildIndex();
+  }
+
+  /* fields that are not in the schema are skipped like by the decoder */
+  if (!schema_->hasField(id)) {
+    return std::make_pair(fields_.end(), fields_.end());
+  }
+
+  auto begin = std::lower_bound(
+      fields_.begin(),
+      fields_.end(),
+      id,
+      [] (const Field& f, uint32_t id) { return f.id < id; });
+
+  auto end = begin;
+  while (end != fields_.end() && end->id == id) {
+    ++end;
+  }
+
+  return std::make_pair(begin, end);
+}
+
+const MessageView::Field& MessageView::findField(uint32_t id) const {
+  auto range = findFields(id);
+  if (range.first == range.second) {
+    RAISEF(kIndexError, "no such field: $0", id);
+  }
+
+  return *range.first;
+}
+
+const MessageView::Field& MessageView::findField(
+    uint32_t id,
+    WireType wire_type) const {
+  const auto& field = findField(id);
+  if (field.wire_type != wire_type) {
+    RAISEF(
+        kTypeError,
+        "field $0 has wire type $1, expected $2",
+        id,
+        (int) field.wire_type,
+        (int) wire_type);
+  }
+
+  return field;
+}
+
+MessageView MessageView::subView(const Field& field) const {
+  if (field.wire_type != WireType::LENENC) {
+    RAISEF(kTypeError, "field $0 is not an object", field.id);
+  }
+
+  auto schema = schema_->fieldSchema(field.id);
+  if (schema.get() == nullptr) {
+    RAISEF(kTypeError, "field $0 is not an object", field.id);
+  }
+
+  /* the sub-schema is owned by our schema and lives as long as it does */
+  return MessageView(field.data, field.value, schema.get(), buf_);
+}
+
+} // namespace msg
+
+template <>
+std::string inspect(const msg::StringRef& str) {
+  return str.toString();
+}
+
+} // namespace stx
@@ -0,0 +1,113 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_MSG_MESSAGEVIEW_H
+#define _STX_MSG_MESSAGEVIEW_H
+#include <stx/stdtypes.h>
+#include <stx/buffer.h>
+#include <stx/UnixTime.h>
+#include <stx/protobuf/MessageSchema.h>
+#include <stx/protobuf/MessageObject.h>
+
+namespace stx {
+namespace msg {
+
+/**
+ * A string inside an encoded message. Points into the message data and is
+ * only valid as long as the data is.
+ */
+struct StringRef {
+  const char* data;
+  size_t size;
+
+  String toString() const;
+  operator String() const;
+
+  bool operator==(const StringRef& other) const;
+  bool operator==(const String& other) const;
+  bool operator!=(const String& other) const;
+};
+
+/**
+ * Read-only access to an encoded message without decoding it into a
+ * MessageObject tree. The fields are indexed on first access; nothing is
+ * copied, strings are returned as references into the message data and
+ * nested objects as views on their slice of it.
+ *
+ * A view constructed from a BufferRef keeps the buffer alive, including for
+ * all views returned by getObject/getObjects. Otherwise the data must outlive
+ * the view and everything returned from it. The schema must always outlive
+ * the view.
+ *
+ * Like MessageObject, a MessageView must not be shared between threads.
+ */
+class MessageView {
+public:
+
+  MessageView(
+      const void* data,
+      size_t size,
+      const MessageSchema& schema);
+
+  MessageView(
+      BufferRef buf,
+      const MessageSchema& schema);
+
+  MessageView getObject(uint32_t id) const;
+  Vector<MessageView> getObjects(uint32_t id) const;
+  size_t fieldCount(uint32_t id) const;
+  StringRef getString(uint32_t id) const;
+  Vector<StringRef> getStrings(uint32_t id) const;
+  uint32_t getUInt32(uint32_t id) const;
+  uint64_t getUInt64(uint32_t id) const;
+  bool getBool(uint32_t id) const;
+  double getDouble(uint32_t id) const;
+  UnixTime getUnixTime(uint32_t id) const;
+
+  bool hasField(uint32_t id) const;
+
+  const void* data() const;
+  size_t size() const;
+  const MessageSchema& schema() const;
+
+protected:
+
+  struct Field {
+    uint32_t id;
+    WireType wire_type;
+    const char* data; // LENENC only
+    uint64_t value; // the value, or the length for LENENC
+  };
+
+  typedef Vector<Field>::const_iterator FieldIter;
+
+  MessageView(
+      const char* data,
+      size_t size,
+      const MessageSchema* schema,
+      BufferRef buf);
+
+  void buildIndex() const;
+  Pair<FieldIter, FieldIter> findFields(uint32_t id) const;
+  const Field& findField(uint32_t id) const;
+  const Field& findField(uint32_t id, WireType wire_type) const;
+  MessageView subView(const Field& field) const;
+
+  const char* data_;
+  size_t size_;
+  const MessageSchema* schema_;
+  BufferRef buf_;
+  mutable bool indexed_;
+  mutable Vector<Field> fields_;
+};
+
+} // namespace msg
+} // namespace stx
+
+#endif
@@ -10,6 +10,11 @@
 #include "stx/HMAC.h"
 #include "stx/test/unittest.h"
 #include "stx/protobuf/DynamicMessage.h"
+#include "stx/protobuf/ColumnarMessageEncoder.h"
+#include "stx/protobuf/ColumnarMessageDecoder.h"
+#include "stx/protobuf/MessageEncoder.h"
+#include "stx/protobuf/MessageDecoder.h"
+#include "stx/protobuf/MessageView.h"
 
 using namespace stx;
 
@@ -139,3 +144,352 @@ TEST_CASE(ProtobufTest, TestNestedDynamicMessageFromJSON, [] () {
     EXPECT_EQ(json.toString(), orig_json);
   }
 });
+
+static String toJSONString(
+    RefPtr<msg::MessageSchema> schema,
+    const msg::MessageObject& obj) {
+  msg::DynamicMessage msg(schema);
+  msg.setData(obj);
+
+  Buffer json;
+  json::JSONOutputStream jsons(BufferOutputStream::fromBuffer(&json));
+  msg.toJSON(&jsons);
+  return json.toString();
+}
+
+TEST_CASE(ProtobufTest, TestColumnarRoundtrip, [] () {
+  auto schema = testSchema();
+
+  Vector<String> records;
+  records.emplace_back(
+      R"({"one": "fnord","two": 23.5,"three": ["blah","fubar"]})");
+  records.emplace_back(R"({})");
+  records.emplace_back(
+      R"({"one": "fnord","four": [{"alpha": "a","beta": 123.5},{"beta": 42.0}]})");
+  records.emplace_back(
+      R"({"three": ["x"],"four": [{},{"alpha": "b"},{"alpha": "a"}]})");
+  records.emplace_back(R"({"two": 1.0,"three": [],"four": []})");
+
+  Vector<msg::MessageObject> msgs;
+  for (const auto& r : records) {
+    msg::DynamicMessage msg(schema);
+    auto j = json::parseJSON(r);
+    msg.fromJSON(j.begin(), j.end());
+    msgs.emplace_back(msg.data());
+  }
+
+  Buffer buf;
+  msg::ColumnarMessageEncoder::encode(msgs, *schema, &buf);
+
+  Vector<msg::MessageObject> decoded;
+  msg::ColumnarMessageDecoder::decode(buf.data(), buf.size(), *schema, &decoded);
+
+  EXPECT_EQ(decoded.size(), records.size());
+  EXPECT_EQ(toJSONString(schema, decoded[0]), records[0]);
+  EXPECT_EQ(toJSONString(schema, decoded[1]), "{}");
+  EXPECT_EQ(toJSONString(schema, decoded[2]), records[2]);
+  EXPECT_EQ(toJSONString(schema, decoded[3]), records[3]);
+  EXPECT_EQ(toJSONString(schema, decoded[4]), R"({"two": 1.0})");
+});
+
+TEST_CASE(ProtobufTest, TestColumnarEncodings, [] () {
+  RefPtr<msg::MessageSchema> schema = new msg::MessageSchema(
+      "EncodingSchema",
+      Vector<msg::MessageSchemaField> {
+        msg::MessageSchemaField(
+            1,
+            "code",
+            msg::FieldType::UINT32,
+            0xffffffff,
+            true,
+            false,
+            msg::EncodingHint::BITPACK),
+        msg::MessageSchemaField(
+            2,
+            "flag",
+            msg::FieldType::BOOLEAN,
+            0,
+            false,
+            true),
+        msg::MessageSchemaField(
+            3,
+            "country",
+            msg::FieldType::STRING,
+            0,
+            false,
+            true),
+        msg::MessageSchemaField(
+            4,
+            "time",
+            msg::FieldType::DATETIME,
+            0,
+            false,
+            true),
+      });
+
+  Vector<msg::MessageObject> msgs;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    msgs.emplace_back();
+    auto& obj = msgs.back();
+    obj.addChild(1, i * 3);
+    obj.addChild(1, uint32_t(0xffffff00 + i % 7));
+    if (i % 2) {
+      obj.addChild(2, msg::TRUE);
+    } else {
+      obj.addChild(2, msg::FALSE);
+    }
+    obj.addChild(3, String(i % 3 ? "DE" : "US"));
+    obj.addChild(4, UnixTime(1430000000000000 + i));
+  }
+
+  Buffer buf;
+  msg::ColumnarMessageEncoder::encode(msgs, *schema, &buf);
+
+  Vector<msg::MessageObject> decoded;
+  msg::ColumnarMessageDecoder::decode(buf.data(), buf.size(), *schema, &decoded);
+
+  EXPECT_EQ(decoded.size(), 1000);
+  for (uint32_t i = 0; i < 1000; ++i) {
+    const auto& obj = decoded[i];
+    auto codes = obj.getObjects(1);
+    EXPECT_EQ(codes.size(), 2);
+    EXPECT_EQ(codes[0]->asUInt32(), i * 3);
+    EXPECT_EQ(codes[1]->asUInt32(), 0xffffff00 + i % 7);
+    EXPECT_EQ(obj.getObject(2).asBool(), i % 2 == 1);
+    EXPECT_EQ(obj.getString(3), i % 3 ? "DE" : "US");
+    EXPECT_EQ(obj.getUnixTime(4).unixMicros(), 1430000000000000 + i);
+  }
+});
+
+TEST_CASE(ProtobufTest, TestColumnarProjection, [] () {
+  Vector<msg::MessageSchemaField> fields;
+  for (uint32_t i = 1; i <= 40; ++i) {
+    fields.emplace_back(
+        i,
+        StringUtil::format("col$0", i),
+        msg::FieldType::UINT64,
+        0,
+        false,
+        true);
+  }
+
+  RefPtr<msg::MessageSchema> schema = new msg::MessageSchema("Wide", fields);
+
+  Vector<msg::MessageObject> msgs;
+  for (uint64_t n = 0; n < 100; ++n) {
+    msgs.emplace_back();
+    for (uint32_t i = 1; i <= 40; ++i) {
+      msgs.back().addChild(i, n * i);
+    }
+  }
+
+  Buffer buf;
+  msg::ColumnarMessageEncoder::encode(msgs, *schema, &buf);
+
+  Set<String> columns;
+  columns.emplace("col2");
+  columns.emplace("col5");
+
+  Vector<msg::MessageObject> decoded;
+  msg::ColumnarMessageDecoder::decode(
+      buf.data(),
+      buf.size(),
+      *schema,
+      columns,
+      &decoded);
+
+  EXPECT_EQ(decoded.size(), 100);
+  for (uint64_t n = 0; n < 100; ++n) {
+    EXPECT_EQ(decoded[n].asObject().size(), 2);
+    EXPECT_EQ(decoded[n].getUInt64(2), n * 2);
+    EXPECT_EQ(decoded[n].getUInt64(5), n * 5);
+  }
+
+  columns.emplace("col41");
+  EXPECT_EXCEPTION("unknown column: 'col41'", [&] () {
+    Vector<msg::MessageObject> out;
+    msg::ColumnarMessageDecoder::decode(
+        buf.data(),
+        buf.size(),
+        *schema,
+        columns,
+        &out);
+  });
+});
+
+TEST_CASE(ProtobufTest, TestMessageView, [] () {
+  auto schema = testSchema();
+
+  msg::DynamicMessage msg(schema);
+  auto j = json::parseJSON(
+      R"({"one": "fnord","two": 23.5,"three": ["blah","fubar"],"four": [{"alpha": "a","beta": 123.5},{"beta": 42.0}]})");
+  msg.fromJSON(j.begin(), j.end());
+
+  auto buf = mkRef(new Buffer());
+  msg::MessageEncoder::encode(msg.data(), *schema, buf.get());
+
+  msg::MessageView view(buf, *schema);
+  EXPECT_EQ(view.getString(1), "fnord");
+  EXPECT_EQ(view.getDouble(2), 23.5);
+  EXPECT_EQ(view.fieldCount(3), 2);
+  EXPECT_EQ(view.getStrings(3)[0], "blah");
+  EXPECT_EQ(view.getStrings(3)[1], "fubar");
+  EXPECT_FALSE(view.hasField(5));
+
+  /* strings point into the encoded buffer */
+  auto str = view.getString(1);
+  EXPECT_TRUE(str.data >= (const char*) buf->data());
+  EXPECT_TRUE(str.data + str.size <= (const char*) buf->data() + buf->size());
+
+  auto four = view.getObjects(4);
+  EXPECT_EQ(four.size(), 2);
+  EXPECT_EQ(four[0].getString(1), "a");
+  EXPECT_EQ(four[0].getDouble(2), 123.5);
+  EXPECT_FALSE(four[1].hasField(1));
+  EXPECT_EQ(four[1].getDouble(2), 42.0);
+  EXPECT_EQ(view.getObject(4).getString(1).toString(), "a");
+
+  EXPECT_EXCEPTION("no such field: 1", [&] () {
+    four[1].getString(1);
+  });
+
+  EXPECT_EXCEPTION("field 1 has wire type 2, expected 1", [&] () {
+    view.getDouble(1);
+  });
+});
+
+TEST_CASE(ProtobufTest, TestMessageViewScalars, [] () {
+  RefPtr<msg::MessageSchema> schema = new msg::MessageSchema(
+      "ScalarSchema",
+      Vector<msg::MessageSchemaField> {
+        msg::MessageSchemaField(
+            1,
+            "u32",
+            msg::FieldType::UINT32,
+            0xffffffff,
+            false,
+            false),
+        msg::MessageSchemaField(
+            2,
+            "u64",
+            msg::FieldType::UINT64,
+            0,
+            false,
+            false),
+        msg::MessageSchemaField(
+            3,
+            "flag",
+            msg::FieldType::BOOLEAN,
+            0,
+            false,
+            false),
+        msg::MessageSchemaField(
+            4,
+            "time",
+            msg::FieldType::DATETIME,
+            0,
+            false,
+            false),
+        msg::MessageSchemaField(
+            5,
+            "codes",
+            msg::FieldType::UINT32,
+            0xffffffff,
+            true,
+            false),
+      });
+
+  /* fields out of order and a field that is not in the schema */
+  msg::MessageObject obj;
+  obj.addChild(5, uint32_t(7));
+  obj.addChild(4, UnixTime(1430000000000000));
+  obj.addChild(2, uint64_t(0x123456789abcdef));
+  obj.addChild(5, uint32_t(8));
+  obj.addChild(1, uint32_t(0xffffffff));
+  obj.addChild(3, msg::TRUE);
+  obj.addChild(5, uint32_t(9));
+
+  Buffer buf;
+  msg::MessageEncoder::encode(obj, *schema, &buf);
+
+  msg::MessageView view(buf.data(), buf.size(), *schema);
+  EXPECT_EQ(view.getUInt32(1), 0xffffffff);
+  EXPECT_EQ(view.getUInt64(2), 0x123456789abcdef);
+  EXPECT_TRUE(view.getBool(3));
+  EXPECT_EQ(view.getUnixTime(4).unixMicros(), 1430000000000000);
+  EXPECT_EQ(view.fieldCount(5), 3);
+
+  EXPECT_EXCEPTION("requested read exceeds message bounds", [&] () {
+    msg::MessageView truncated(buf.data(), buf.size() - 1, *schema);
+    truncated.getUInt32(1);
+  });
+});
+
+TEST_CASE(ProtobufTest, TestDecodeWithCompiledSchema, [] () {
+  RefPtr<msg::MessageSchema> schema = new msg::MessageSchema(
+      "SparseSchema",
+      Vector<msg::MessageSchemaField> {
+        msg::MessageSchemaField(
+            1,
+            "one",
+            msg::FieldType::UINT32,
+            0xffffffff,
+            false,
+            false),
+        msg::MessageSchemaField(
+            100000,
+            "large_id",
+            msg::FieldType::STRING,
+            0,
+            false,
+            false),
+      });
+
+  msg::MessageObject obj;
+  obj.addChild(1, uint32_t(23));
+  obj.addChild(100000, String("fnord"));
+
+  Buffer buf;
+  msg::MessageEncoder::encode(obj, *schema, &buf);
+
+  EXPECT_EQ(schema->compiled().fields.size(), 2);
+  EXPECT_TRUE(schema->compiled().sparse);
+
+  {
+    msg::MessageObject decoded;
+    msg::MessageDecoder::decode(buf, *schema, &decoded);
+    EXPECT_EQ(decoded.getUInt32(1), 23);
+    EXPECT_EQ(decoded.getString(100000), "fnord");
+  }
+
+  /* fields removed from the schema are skipped */
+  schema->removeField(1);
+  EXPECT_FALSE(schema->compiled().fields[1].known);
+
+  {
+    msg::MessageObject decoded;
+    msg::MessageDecoder::decode(buf, *schema, &decoded);
+    EXPECT_EQ(decoded.asObject().size(), 1);
+    EXPECT_EQ(decoded.getString(100000), "fnord");
+  }
+
+  schema->addField(
+      msg::MessageSchemaField(
+          1,
+          "one",
+          msg::FieldType::UINT32,
+          0xffffffff,
+          false,
+          false));
+
+  {
+    msg::MessageObject decoded;
+    msg::MessageDecoder::decode(buf, *schema, &decoded);
+    EXPECT_EQ(decoded.asObject().size(), 2);
+  }
+
+  EXPECT_EXCEPTION("requested read exceeds message bounds", [&] () {
+    msg::MessageObject decoded;
+    msg::MessageDecoder::decode(buf.data(), buf.size() - 1, *schema, &decoded);
+  });
+});
@@ -0,0 +1,86 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <mutex>
+#include <thread>
+#include "stx/stats/stats.h"
+#include "stx/test/benchmark.h"
+#include "stx/stringutil.h"
+
+using namespace stx;
+using namespace stx::stats;
+
+static const size_t kOpsPerThread = 1000000;
+
+/**
+ * Runs fn kOpsPerThread times on each of num_threads threads at once
+ */
+static void benchmarkContended(
+    const String& label,
+    size_t num_threads,
+    Function<void (size_t i)> fn) {
+  auto result = Benchmark::benchmark([&]() {
+    Vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&fn] {
+        for (size_t i = 0; i < kOpsPerThread; ++i) {
+          fn(i);
+        }
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+  }, 1);
+
+  Benchmark::printResultTable(
+      StringUtil::format("$0 ($1 threads)", label, num_threads),
+      Benchmark::BenchmarkResult(
+          result.meanRuntimeNanos(),
+          kOpsPerThread * num_threads),
+      true);
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  for (size_t num_threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+    std::atomic<uint64_t> shared(0);
+    benchmarkContended("shared atomic", num_threads, [&shared] (size_t i) {
+      shared.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    Counter<uint64_t> counter;
+    benchmarkContended("Counter", num_threads, [&counter] (size_t i) {
+      counter.incr(1);
+    });
+
+    std::mutex mutex;
+    HashMap<uint64_t, uint64_t> locked_map;
+    benchmarkContended("locked map", num_threads, [&] (size_t i) {
+      std::unique_lock<std::mutex> lk(mutex);
+      locked_map[200 + i % 4] += 1;
+    });
+
+    MultiCounter<uint64_t, uint64_t> multi_counter("status");
+    benchmarkContended("MultiCounter", num_threads, [&] (size_t i) {
+      multi_counter.increment(1, 200 + i % 4);
+    });
+
+    Histogram histogram;
+    benchmarkContended("Histogram", num_threads, [&] (size_t i) {
+      histogram.addValue(100 + i % 1000);
+    });
+  }
+
+  return 0;
+}
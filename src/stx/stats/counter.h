@@ -13,11 +13,15 @@
 #include <stdint.h>
 #include "stx/UnixTime.h"
 #include "stx/hash.h"
+#include "stx/stats/shard.h"
 #include "stx/stats/stat.h"
 
 namespace stx {
 namespace stats {
 
+/**
+ * A counter that is sharded per thread, see ShardedCounter
+ */
 template <typename ValueType>
 class CounterStat : public Stat {
 public:
@@ -27,10 +31,19 @@ public:
   void decr(ValueType value);
   void set(ValueType value);
 
+  ValueType get() const;
+
   void exportAll(const String& path, StatsSink* sink) const override;
 
+  /**
+   * The shards must start on a cache line, which plain operator new does not
+   * guarantee for over-aligned types before C++17
+   */
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
 protected:
-  std::atomic<ValueType> value_;
+  ShardedCounter<ValueType> value_;
 };
 
 template <typename ValueType>
@@ -42,6 +55,8 @@ public:
   void decr(ValueType value);
   void set(ValueType value);
 
+  ValueType get() const;
+
   RefPtr<Stat> getStat() const override;
 
 protected:
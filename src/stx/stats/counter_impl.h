@@ -9,33 +9,54 @@
  */
 #ifndef _STX_STATS_COUNTER_IMPL_H
 #define _STX_STATS_COUNTER_IMPL_H
+#include <new>
 
 namespace stx {
 namespace stats {
 
 template <typename ValueType>
-CounterStat<ValueType>::CounterStat() : value_(0) {}
+CounterStat<ValueType>::CounterStat() {}
 
 template <typename ValueType>
 void CounterStat<ValueType>::exportAll(
     const String& path,
     StatsSink* sink) const {
-  sink->addStatValue(path, value_.load());
+  sink->addStatValue(path, value_.get());
 }
 
 template <typename ValueType>
 void CounterStat<ValueType>::incr(ValueType value) {
-  value_ += value;
+  value_.incr(value);
 }
 
 template <typename ValueType>
 void CounterStat<ValueType>::decr(ValueType value) {
-  value_ -= value;
+  value_.decr(value);
 }
 
 template <typename ValueType>
 void CounterStat<ValueType>::set(ValueType value) {
-  value_ = value;
+  value_.set(value);
+}
+
+template <typename ValueType>
+ValueType CounterStat<ValueType>::get() const {
+  return value_.get();
+}
+
+template <typename ValueType>
+void* CounterStat<ValueType>::operator new(size_t size) {
+  void* ptr;
+  if (posix_memalign(&ptr, kCacheLineSize, size) != 0) {
+    throw std::bad_alloc();
+  }
+
+  return ptr;
+}
+
+template <typename ValueType>
+void CounterStat<ValueType>::operator delete(void* ptr) {
+  free(ptr);
 }
 
 template <typename ValueType>
@@ -62,6 +83,11 @@ void Counter<ValueType>::set(ValueType value) {
   stat_->set(value);
 }
 
+template <typename ValueType>
+ValueType Counter<ValueType>::get() const {
+  return stat_->get();
+}
+
 }
 }
 #endif
@@ -0,0 +1,250 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <math.h>
+#include "stx/stringutil.h"
+#include "stx/MonotonicClock.h"
+#include "stx/stats/histogram.h"
+
+namespace stx {
+namespace stats {
+
+HistogramStat::Buckets::Buckets() : count(0), sum(0) {
+  for (auto& bucket : buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+HistogramStat::HistogramStat() {
+  for (auto& shard : shards_) {
+    shard.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+HistogramStat::~HistogramStat() {
+  for (auto& shard : shards_) {
+    delete shard.load();
+  }
+}
+
+void HistogramStat::addValue(uint64_t value) {
+  auto buckets = getBuckets();
+  buckets->count.fetch_add(1, std::memory_order_relaxed);
+  buckets->sum.fetch_add(value, std::memory_order_relaxed);
+  buckets->buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t HistogramStat::count() const {
+  uint64_t count = 0;
+  for (const auto& shard : shards_) {
+    auto buckets = shard.load(std::memory_order_acquire);
+    if (buckets) {
+      count += buckets->count.load(std::memory_order_relaxed);
+    }
+  }
+
+  return count;
+}
+
+uint64_t HistogramStat::sum() const {
+  uint64_t sum = 0;
+  for (const auto& shard : shards_) {
+    auto buckets = shard.load(std::memory_order_acquire);
+    if (buckets) {
+      sum += buckets->sum.load(std::memory_order_relaxed);
+    }
+  }
+
+  return sum;
+}
+
+Vector<uint64_t> HistogramStat::buckets() const {
+  Vector<uint64_t> counts(kNumBuckets, 0);
+
+  for (const auto& shard : shards_) {
+    auto buckets = shard.load(std::memory_order_acquire);
+    if (!buckets) {
+      continue;
+    }
+
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      counts[i] += buckets->buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  return counts;
+}
+
+uint64_t HistogramStat::percentile(double p) const {
+  return percentile(buckets(), p);
+}
+
+uint64_t HistogramStat::percentile(const Vector<uint64_t>& counts, double p) {
+  uint64_t total = 0;
+  for (auto c : counts) {
+    total += c;
+  }
+
+  if (total == 0) {
+    return 0;
+  }
+
+  uint64_t rank = ceil(total * std::min(std::max(p, 0.0), 100.0) / 100.0);
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return bucketUpperBound(i);
+    }
+  }
+
+  return bucketUpperBound(kNumBuckets - 1);
+}
+
+void HistogramStat::exportAll(const String& path, StatsSink* sink) const {
+  auto counts = buckets();
+
+  sink->addStatValue(path + "/count", count());
+  sink->addStatValue(path + "/sum", sum());
+
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    if (counts[i] == 0) {
+      continue;
+    }
+
+    StatsSink::Labels labels;
+    labels.emplace_back("bucket", StringUtil::toString(bucketLowerBound(i)));
+    sink->addStatValue(path, labels, counts[i]);
+  }
+}
+
+size_t HistogramStat::bucketIndex(uint64_t value) {
+  if (value < kSubBuckets) {
+    return value;
+  }
+
+  size_t exp = 63 - __builtin_clzll(value);
+  size_t shift = exp - kSubBucketBits;
+  return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+}
+
+uint64_t HistogramStat::bucketLowerBound(size_t idx) {
+  if (idx < kSubBuckets) {
+    return idx;
+  }
+
+  size_t shift = idx / kSubBuckets - 1;
+  return (uint64_t) (kSubBuckets + idx % kSubBuckets) << shift;
+}
+
+uint64_t HistogramStat::bucketUpperBound(size_t idx) {
+  if (idx < kSubBuckets) {
+    return idx;
+  }
+
+  size_t shift = idx / kSubBuckets - 1;
+  return bucketLowerBound(idx) + ((uint64_t(1) << shift) - 1);
+}
+
+HistogramStat::Buckets* HistogramStat::getBuckets() {
+  auto& shard = shards_[getShard()];
+
+  auto buckets = shard.load(std::memory_order_acquire);
+  if (buckets) {
+    return buckets;
+  }
+
+  auto new_buckets = new Buckets();
+  if (shard.compare_exchange_strong(
+          buckets,
+          new_buckets,
+          std::memory_order_acq_rel,
+          std::memory_order_acquire)) {
+    return new_buckets;
+  } else {
+    delete new_buckets;
+    return buckets;
+  }
+}
+
+HistogramPercentilesStat::HistogramPercentilesStat(
+    RefPtr<HistogramStat> histogram,
+    const Duration& window) :
+    histogram_(histogram),
+    window_(window),
+    window_start_(HistogramStat::kNumBuckets, 0),
+    next_window_start_(HistogramStat::kNumBuckets, 0),
+    next_window_time_(MonotonicClock::now()) {}
+
+Vector<uint64_t> HistogramPercentilesStat::buckets() const {
+  std::unique_lock<std::mutex> lk(mutex_);
+  auto counts = histogram_->buckets();
+  auto now = MonotonicClock::now();
+  if (now - next_window_time_ >= window_) {
+    window_start_.swap(next_window_start_);
+    next_window_start_ = counts;
+    next_window_time_ = now;
+  }
+
+  for (size_t i = 0; i < counts.size(); ++i) {
+    counts[i] -= window_start_[i];
+  }
+
+  return counts;
+}
+
+void HistogramPercentilesStat::exportAll(
+    const String& path,
+    StatsSink* sink) const {
+  auto counts = buckets();
+  sink->addStatValue(path + "/p50", HistogramStat::percentile(counts, 50));
+  sink->addStatValue(path + "/p99", HistogramStat::percentile(counts, 99));
+  sink->addStatValue(path + "/p999", HistogramStat::percentile(counts, 99.9));
+}
+
+HistogramPercentiles::HistogramPercentiles(
+    RefPtr<HistogramStat> histogram,
+    const Duration& window) :
+    stat_(new HistogramPercentilesStat(histogram, window)) {}
+
+RefPtr<Stat> HistogramPercentiles::getStat() const {
+  return RefPtr<Stat>(stat_.get());
+}
+
+Histogram::Histogram(
+    const Duration& window) :
+    stat_(new HistogramStat()),
+    percentiles_(stat_, window) {}
+
+void Histogram::addValue(uint64_t value) {
+  stat_->addValue(value);
+}
+
+uint64_t Histogram::count() const {
+  return stat_->count();
+}
+
+uint64_t Histogram::percentile(double p) const {
+  return stat_->percentile(p);
+}
+
+HistogramPercentiles* Histogram::percentiles() {
+  return &percentiles_;
+}
+
+RefPtr<Stat> Histogram::getStat() const {
+  return RefPtr<Stat>(stat_.get());
+}
+
+}
+}
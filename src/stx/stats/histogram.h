@@ -0,0 +1,157 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_STATS_HISTOGRAM_H
+#define _STX_STATS_HISTOGRAM_H
+#include <stdlib.h>
+#include <stdint.h>
+#include <mutex>
+#include "stx/stdtypes.h"
+#include "stx/Duration.h"
+#include "stx/MonotonicTime.h"
+#include "stx/stats/shard.h"
+#include "stx/stats/stat.h"
+
+namespace stx {
+namespace stats {
+
+/**
+ * A histogram of integer values, e.g. latencies in microseconds, with
+ * log-linear buckets like an HDR histogram: values below kSubBuckets have a
+ * bucket each and every power of two above is split into kSubBuckets equally
+ * wide buckets, so a bucket is never wider than 1/kSubBuckets of its lower
+ * bound. All uint64 values fit into the kNumBuckets buckets.
+ *
+ * Recording a value takes no locks. Every shard gets its own buckets, which
+ * are allocated when a thread of that shard records its first value.
+ *
+ * The count, the sum and the number of values in each non-empty bucket are
+ * exported, the latter with a "bucket" label that holds its lower bound.
+ * These only ever grow, so they can be exported as deltas.
+ */
+class HistogramStat : public Stat {
+public:
+  static const size_t kSubBucketBits = 4;
+  static const size_t kSubBuckets = 1 << kSubBucketBits;
+  static const size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  HistogramStat();
+  ~HistogramStat();
+
+  void addValue(uint64_t value);
+
+  uint64_t count() const;
+  uint64_t sum() const;
+
+  /**
+   * Returns the number of values in each bucket
+   */
+  Vector<uint64_t> buckets() const;
+
+  /**
+   * Returns the upper bound of the bucket that holds the given percentile
+   * (0-100) of the values or 0 if there are none
+   */
+  uint64_t percentile(double p) const;
+
+  /**
+   * Returns the upper bound of the bucket that holds the given percentile
+   * (0-100) of the values counted in counts, as returned by buckets()
+   */
+  static uint64_t percentile(const Vector<uint64_t>& counts, double p);
+
+  void exportAll(const String& path, StatsSink* sink) const override;
+
+  static size_t bucketIndex(uint64_t value);
+  static uint64_t bucketLowerBound(size_t idx);
+  static uint64_t bucketUpperBound(size_t idx);
+
+protected:
+
+  struct Buckets {
+    Buckets();
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> buckets[kNumBuckets];
+  };
+
+  Buckets* getBuckets();
+
+  std::atomic<Buckets*> shards_[kNumShards];
+};
+
+/**
+ * Exports the 50th, 99th and 99.9th percentile of the values that a
+ * histogram recorded in a recent window as path/p50, path/p99 and path/p999.
+ *
+ * The window starts at a snapshot of the buckets that is at least one window
+ * length old, so it is between one and two window lengths long no matter how
+ * often or by how many agents the stat is exported. These values go up and
+ * down, so they must be exported as values, not as deltas.
+ */
+class HistogramPercentilesStat : public Stat {
+public:
+  HistogramPercentilesStat(
+      RefPtr<HistogramStat> histogram,
+      const Duration& window);
+
+  /**
+   * Returns the number of values in each bucket that were recorded in the
+   * current window
+   */
+  Vector<uint64_t> buckets() const;
+
+  void exportAll(const String& path, StatsSink* sink) const override;
+
+protected:
+  RefPtr<HistogramStat> histogram_;
+  const Duration window_;
+  mutable std::mutex mutex_;
+  mutable Vector<uint64_t> window_start_;
+  mutable Vector<uint64_t> next_window_start_;
+  mutable MonotonicTime next_window_time_;
+};
+
+class HistogramPercentiles : public StatRef {
+public:
+  HistogramPercentiles(RefPtr<HistogramStat> histogram, const Duration& window);
+
+  RefPtr<Stat> getStat() const override;
+
+protected:
+  RefPtr<HistogramPercentilesStat> stat_;
+};
+
+class Histogram : public StatRef {
+public:
+  static const uint64_t kDefaultWindowMicros = 60 * kMicrosPerSecond;
+
+  Histogram(const Duration& window = Duration(kDefaultWindowMicros));
+
+  void addValue(uint64_t value);
+
+  uint64_t count() const;
+  uint64_t percentile(double p) const;
+
+  /**
+   * The windowed percentiles of this histogram, to be exported with
+   * ExportMode::EXPORT_VALUE next to the histogram itself
+   */
+  HistogramPercentiles* percentiles();
+
+  RefPtr<Stat> getStat() const override;
+
+protected:
+  RefPtr<HistogramStat> stat_;
+  HistogramPercentiles percentiles_;
+};
+
+}
+}
+#endif
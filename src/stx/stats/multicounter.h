@@ -12,28 +12,53 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include "stx/UnixTime.h"
-#include "stx/hash.h"
+#include <atomic>
 #include "stx/stats/stat.h"
 
 namespace stx {
 namespace stats {
 
+/**
+ * A counter per combination of label values. The combinations are kept in a
+ * fixed number of lock-free lists that are only ever prepended to, so
+ * looking up a known combination takes no locks and adding a new one takes a
+ * single compare-and-swap. Combinations are never removed, so the label
+ * values should come from a small set, like HTTP status codes.
+ *
+ * Unlike CounterStat, the per combination counters are not sharded: there
+ * may be many thousands of them, and the updates already spread over them.
+ */
 template <typename ValueType, typename... LabelTypes>
 class MultiCounterStat : public Stat {
 public:
   typedef std::tuple<LabelTypes...> LabelValuesType;
+  static const size_t kNumBuckets = 64;
 
   template <typename... LabelNameTypes>
   MultiCounterStat(LabelNameTypes... label_names);
+  ~MultiCounterStat();
 
-  void increment(ValueType value);
-  void set(ValueType value);
+  void increment(ValueType value, LabelTypes... labels);
+  void set(ValueType value, LabelTypes... labels);
+  ValueType get(LabelTypes... labels) const;
 
   void exportAll(const String& path, StatsSink* sink) const override;
 
 protected:
-  std::unordered_map<LabelValuesType, ValueType, hash<LabelValuesType>> values_;
-  mutable std::mutex mutex_;
+
+  struct Entry {
+    Entry(const LabelValuesType& _labels);
+    const LabelValuesType labels;
+    std::atomic<ValueType> value;
+    Entry* next;
+  };
+
+  Entry* findEntry(const LabelValuesType& labels) const;
+  Entry* getEntry(const LabelValuesType& labels);
+  static size_t hashLabels(const LabelValuesType& labels);
+
+  Vector<String> label_names_;
+  std::atomic<Entry*> buckets_[kNumBuckets];
 };
 
 template <typename ValueType, typename... LabelTypes>
@@ -43,8 +68,9 @@ public:
   template <typename... LabelNameTypes>
   MultiCounter(LabelNameTypes... label_names);
 
-  void increment(ValueType value);
-  void set(ValueType value);
+  void increment(ValueType value, LabelTypes... labels);
+  void set(ValueType value, LabelTypes... labels);
+  ValueType get(LabelTypes... labels) const;
 
   RefPtr<Stat> getStat() const override;
 
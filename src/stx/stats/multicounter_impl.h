@@ -9,31 +9,168 @@
  */
 #ifndef _STX_STATS_MULTICOUNTER_IMPL_H
 #define _STX_STATS_MULTICOUNTER_IMPL_H
+#include "stx/stringutil.h"
+#include "stx/reflect/indexsequence.h"
 
 namespace stx {
 namespace stats {
 
+template <typename... T, int... I>
+size_t hashTuple(const std::tuple<T...>& tuple, reflect::IndexSequence<I...>) {
+  size_t hash = 0;
+  size_t hashes[] = { 0, std::hash<T>()(std::get<I>(tuple))... };
+  for (auto h : hashes) {
+    hash = hash * 31 + h;
+  }
+
+  return hash;
+}
+
+template <typename... T, int... I>
+void labelsFromTuple(
+    const Vector<String>& names,
+    const std::tuple<T...>& values,
+    StatsSink::Labels* labels,
+    reflect::IndexSequence<I...>) {
+  String strs[] = { String(), StringUtil::toString(std::get<I>(values))... };
+  for (size_t i = 0; i < names.size(); ++i) {
+    labels->emplace_back(names[i], strs[i + 1]);
+  }
+}
+
 template <typename ValueType, typename... LabelTypes>
 template <typename... LabelNameTypes>
 MultiCounterStat<ValueType, LabelTypes...>::MultiCounterStat(
-    LabelNameTypes... label_names) {
+    LabelNameTypes... label_names) :
+    label_names_{ String(label_names)... } {
   static_assert(
       sizeof...(LabelTypes) == sizeof...(LabelNameTypes),
       "number labels names does not match number of label template types");
+
+  for (auto& bucket : buckets_) {
+    bucket.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+template <typename ValueType, typename... LabelTypes>
+MultiCounterStat<ValueType, LabelTypes...>::~MultiCounterStat() {
+  for (auto& bucket : buckets_) {
+    auto entry = bucket.load();
+    while (entry) {
+      auto next = entry->next;
+      delete entry;
+      entry = next;
+    }
+  }
+}
+
+template <typename ValueType, typename... LabelTypes>
+MultiCounterStat<ValueType, LabelTypes...>::Entry::Entry(
+    const LabelValuesType& _labels) :
+    labels(_labels),
+    value(0),
+    next(nullptr) {}
+
+template <typename ValueType, typename... LabelTypes>
+void MultiCounterStat<ValueType, LabelTypes...>::increment(
+    ValueType value,
+    LabelTypes... labels) {
+  getEntry(LabelValuesType(labels...))->value.fetch_add(
+      value,
+      std::memory_order_relaxed);
+}
+
+template <typename ValueType, typename... LabelTypes>
+void MultiCounterStat<ValueType, LabelTypes...>::set(
+    ValueType value,
+    LabelTypes... labels) {
+  getEntry(LabelValuesType(labels...))->value.store(
+      value,
+      std::memory_order_relaxed);
+}
+
+template <typename ValueType, typename... LabelTypes>
+ValueType MultiCounterStat<ValueType, LabelTypes...>::get(
+    LabelTypes... labels) const {
+  auto entry = findEntry(LabelValuesType(labels...));
+  return entry ? entry->value.load(std::memory_order_relaxed) : 0;
 }
 
 template <typename ValueType, typename... LabelTypes>
 void MultiCounterStat<ValueType, LabelTypes...>::exportAll(
     const String& path,
     StatsSink* sink) const {
-  ScopedLock<std::mutex> lk(mutex_);
+  for (const auto& bucket : buckets_) {
+    for (auto e = bucket.load(std::memory_order_acquire); e; e = e->next) {
+      StatsSink::Labels labels;
+      labelsFromTuple(
+          label_names_,
+          e->labels,
+          &labels,
+          typename reflect::MkIndexSequenceFor<LabelTypes...>::type());
+
+      sink->addStatValue(
+          path,
+          labels,
+          e->value.load(std::memory_order_relaxed));
+    }
+  }
+}
+
+template <typename ValueType, typename... LabelTypes>
+typename MultiCounterStat<ValueType, LabelTypes...>::Entry*
+    MultiCounterStat<ValueType, LabelTypes...>::findEntry(
+        const LabelValuesType& labels) const {
+  auto& bucket = buckets_[hashLabels(labels) % kNumBuckets];
+  for (auto e = bucket.load(std::memory_order_acquire); e; e = e->next) {
+    if (e->labels == labels) {
+      return e;
+    }
+  }
+
+  return nullptr;
+}
+
+template <typename ValueType, typename... LabelTypes>
+typename MultiCounterStat<ValueType, LabelTypes...>::Entry*
+    MultiCounterStat<ValueType, LabelTypes...>::getEntry(
+        const LabelValuesType& labels) {
+  auto& bucket = buckets_[hashLabels(labels) % kNumBuckets];
+  auto head = bucket.load(std::memory_order_acquire);
+  for (auto e = head; e; e = e->next) {
+    if (e->labels == labels) {
+      return e;
+    }
+  }
 
-  for (const auto& inst : values_) {
-    StatsSink::Labels labels;
-    sink->addStatValue(path, labels, inst.second);
+  ScopedPtr<Entry> entry(new Entry(labels));
+  for (;;) {
+    entry->next = head;
+    if (bucket.compare_exchange_weak(
+            head,
+            entry.get(),
+            std::memory_order_release,
+            std::memory_order_acquire)) {
+      return entry.release();
+    }
+
+    // another thread prepended to the list, so it may have added our labels
+    for (auto e = head; e != entry->next; e = e->next) {
+      if (e->labels == labels) {
+        return e;
+      }
+    }
   }
 }
 
+template <typename ValueType, typename... LabelTypes>
+size_t MultiCounterStat<ValueType, LabelTypes...>::hashLabels(
+    const LabelValuesType& labels) {
+  return hashTuple(
+      labels,
+      typename reflect::MkIndexSequenceFor<LabelTypes...>::type());
+}
+
 template <typename ValueType, typename... LabelTypes>
 template <typename... LabelNameTypes>
 MultiCounter<ValueType, LabelTypes...>::MultiCounter(
@@ -45,10 +182,25 @@ RefPtr<Stat> MultiCounter<ValueType, LabelTypes...>::getStat() const {
   return RefPtr<Stat>(stat_.get());
 }
 
-/*
-  void increment(ValueType value);
-  void set(ValueType value);
-*/
+template <typename ValueType, typename... LabelTypes>
+void MultiCounter<ValueType, LabelTypes...>::increment(
+    ValueType value,
+    LabelTypes... labels) {
+  stat_->increment(value, labels...);
+}
+
+template <typename ValueType, typename... LabelTypes>
+void MultiCounter<ValueType, LabelTypes...>::set(
+    ValueType value,
+    LabelTypes... labels) {
+  stat_->set(value, labels...);
+}
+
+template <typename ValueType, typename... LabelTypes>
+ValueType MultiCounter<ValueType, LabelTypes...>::get(
+    LabelTypes... labels) const {
+  return stat_->get(labels...);
+}
 
 }
 }
@@ -0,0 +1,27 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "stx/stats/shard.h"
+
+namespace stx {
+namespace stats {
+
+static std::atomic<size_t> next_shard(0);
+static thread_local size_t current_shard = kNumShards;
+
+size_t getShard() {
+  if (current_shard == kNumShards) {
+    current_shard = next_shard.fetch_add(1) % kNumShards;
+  }
+
+  return current_shard;
+}
+
+}
+}
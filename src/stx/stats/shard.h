@@ -0,0 +1,100 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_STATS_SHARD_H
+#define _STX_STATS_SHARD_H
+#include <stdlib.h>
+#include <stdint.h>
+#include <atomic>
+
+namespace stx {
+namespace stats {
+
+/**
+ * Stats that are updated from many threads are split into kNumShards
+ * shards that live on separate cache lines, so that threads running on
+ * different cores don't take turns owning the same line. The shards are
+ * summed up when the stat is read or exported.
+ */
+static const size_t kNumShards = 16;
+static const size_t kCacheLineSize = 64;
+
+/**
+ * Returns the shard of the calling thread. Threads are assigned to shards
+ * round robin when they first ask.
+ */
+size_t getShard();
+
+/**
+ * One shard, aligned to (and thus padded to a multiple of) a cache line.
+ * Objects that contain shards must be allocated with that alignment, too,
+ * see CounterStat::operator new
+ */
+template <typename T>
+struct alignas(kCacheLineSize) Shard {
+  T value;
+};
+
+template <typename ValueType>
+class ShardedCounter {
+public:
+  ShardedCounter();
+
+  void incr(ValueType value);
+  void decr(ValueType value);
+
+  /**
+   * Sets the counter to value. Increments that race with set() may be lost
+   */
+  void set(ValueType value);
+
+  ValueType get() const;
+
+protected:
+  Shard<std::atomic<ValueType>> shards_[kNumShards];
+};
+
+template <typename ValueType>
+ShardedCounter<ValueType>::ShardedCounter() {
+  for (auto& shard : shards_) {
+    shard.value.store(0, std::memory_order_relaxed);
+  }
+}
+
+template <typename ValueType>
+void ShardedCounter<ValueType>::incr(ValueType value) {
+  shards_[getShard()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+template <typename ValueType>
+void ShardedCounter<ValueType>::decr(ValueType value) {
+  shards_[getShard()].value.fetch_sub(value, std::memory_order_relaxed);
+}
+
+template <typename ValueType>
+void ShardedCounter<ValueType>::set(ValueType value) {
+  shards_[0].value.store(value, std::memory_order_relaxed);
+  for (size_t i = 1; i < kNumShards; ++i) {
+    shards_[i].value.store(0, std::memory_order_relaxed);
+  }
+}
+
+template <typename ValueType>
+ValueType ShardedCounter<ValueType>::get() const {
+  ValueType value = 0;
+  for (const auto& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+
+  return value;
+}
+
+}
+}
+#endif
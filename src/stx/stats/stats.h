@@ -10,5 +10,7 @@
 #ifndef _STX_STATS_H
 #define _STX_STATS_H
 #include "stx/stats/counter.h"
+#include "stx/stats/histogram.h"
+#include "stx/stats/multicounter.h"
 #include "stx/stats/statsrepository.h"
 #endif
@@ -0,0 +1,279 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "stx/stats/stats.h"
+#include "stx/stats/statsdagent.h"
+#include "stx/test/unittest.h"
+
+using namespace stx;
+using namespace stx::stats;
+
+UNIT_TEST(StatsTest);
+
+static HashMap<String, double> exportValues(const StatRef& stat) {
+  BufferStatsSinkStatsSink sink;
+  stat.getStat()->exportAll("/test", &sink);
+
+  HashMap<String, double> values;
+  for (const auto& v : sink.values()) {
+    values[v.first] = v.second;
+  }
+
+  return values;
+}
+
+TEST_CASE(StatsTest, TestShardedCounter, [] () {
+  Counter<uint64_t> counter;
+  Vector<std::thread> threads;
+
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&counter] {
+      for (int i = 0; i < 10000; ++i) {
+        counter.incr(3);
+        counter.decr(1);
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter.get(), 8 * 10000 * 2);
+  EXPECT_EQ(exportValues(counter)["/test"], 8 * 10000 * 2);
+
+  counter.set(42);
+  EXPECT_EQ(counter.get(), 42);
+});
+
+typedef MultiCounter<uint64_t, uint64_t, String> StatusCounter;
+
+TEST_CASE(StatsTest, TestMultiCounter, [] () {
+  StatusCounter counter("status", "method");
+  Vector<std::thread> threads;
+
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&counter] {
+      for (uint64_t i = 0; i < 1000; ++i) {
+        counter.increment(1, 200 + i % 4, "GET");
+        counter.increment(2, 500, "POST");
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter.get(200, "GET"), 8 * 250);
+  EXPECT_EQ(counter.get(203, "GET"), 8 * 250);
+  EXPECT_EQ(counter.get(500, "POST"), 8 * 1000 * 2);
+  EXPECT_EQ(counter.get(500, "GET"), 0);
+
+  auto values = exportValues(counter);
+  EXPECT_EQ(values.size(), 5);
+  EXPECT_EQ(values["/test/status/201/method/GET"], 8 * 250);
+  EXPECT_EQ(values["/test/status/500/method/POST"], 8 * 1000 * 2);
+
+  counter.set(7, 404, "GET");
+  EXPECT_EQ(counter.get(404, "GET"), 7);
+});
+
+TEST_CASE(StatsTest, TestHistogramBuckets, [] () {
+  for (uint64_t v = 0; v < 100000; ++v) {
+    auto idx = HistogramStat::bucketIndex(v);
+    EXPECT_TRUE(HistogramStat::bucketLowerBound(idx) <= v);
+    EXPECT_TRUE(HistogramStat::bucketUpperBound(idx) >= v);
+  }
+
+  for (size_t idx = 1; idx < HistogramStat::kNumBuckets; ++idx) {
+    EXPECT_EQ(
+        HistogramStat::bucketLowerBound(idx),
+        HistogramStat::bucketUpperBound(idx - 1) + 1);
+  }
+
+  EXPECT_EQ(HistogramStat::bucketIndex(15), 15);
+  EXPECT_EQ(HistogramStat::bucketIndex(16), 16);
+  EXPECT_EQ(HistogramStat::bucketIndex(33), 32);
+  EXPECT_EQ(
+      HistogramStat::bucketIndex(uint64_t(-1)),
+      HistogramStat::kNumBuckets - 1);
+  EXPECT_EQ(
+      HistogramStat::bucketUpperBound(HistogramStat::kNumBuckets - 1),
+      uint64_t(-1));
+});
+
+TEST_CASE(StatsTest, TestHistogram, [] () {
+  Histogram histogram;
+  Vector<std::thread> threads;
+
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram] {
+      for (uint64_t v = 1; v <= 1000; ++v) {
+        histogram.addValue(v);
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(histogram.count(), 4000);
+
+  // buckets are at most 1/16th of their lower bound wide
+  auto p50 = histogram.percentile(50);
+  auto p99 = histogram.percentile(99);
+  EXPECT_TRUE(p50 >= 500 && p50 <= 500 * 17 / 16);
+  EXPECT_TRUE(p99 >= 990 && p99 <= 990 * 17 / 16);
+  EXPECT_EQ(histogram.percentile(100), 1023);
+  EXPECT_EQ(histogram.percentile(0), 1);
+
+  auto values = exportValues(histogram);
+  EXPECT_EQ(values["/test/count"], 4000);
+  EXPECT_EQ(values["/test/sum"], 4 * 500500);
+  EXPECT_EQ(values["/test/bucket/1"], 4);
+  EXPECT_EQ(values["/test/bucket/512"], 4 * 32);
+});
+
+TEST_CASE(StatsTest, TestHistogramPercentiles, [] () {
+  Histogram histogram(Duration(100000));
+  for (int i = 0; i < 1000; ++i) {
+    histogram.addValue(100);
+  }
+
+  auto values = exportValues(*histogram.percentiles());
+  EXPECT_EQ(values["/test/p50"], 103);
+  EXPECT_EQ(values["/test/p99"], 103);
+  EXPECT_EQ(values["/test/p999"], 103);
+
+  // the first window starts when the histogram is created
+  usleep(150000);
+  values = exportValues(*histogram.percentiles());
+  EXPECT_EQ(values["/test/p50"], 103);
+
+  for (int i = 0; i < 1000; ++i) {
+    histogram.addValue(10000);
+  }
+
+  usleep(150000);
+  values = exportValues(*histogram.percentiles());
+  EXPECT_TRUE(values["/test/p50"] >= 10000);
+  EXPECT_TRUE(values["/test/p50"] <= 10000 * 17 / 16);
+  EXPECT_EQ(values["/test/p50"], values["/test/p999"]);
+});
+
+class TestStatsdAgent : public StatsdAgent {
+public:
+  using StatsdAgent::StatsdAgent;
+  using StatsdAgent::report;
+};
+
+/**
+ * Binds a UDP socket on localhost and returns the address it listens on
+ */
+static int bindStatsdReceiver(String* addr) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+  struct sockaddr_in saddr;
+  memset(&saddr, 0, sizeof(saddr));
+  saddr.sin_family = AF_INET;
+  saddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(fd, (struct sockaddr*) &saddr, sizeof(saddr));
+
+  socklen_t len = sizeof(saddr);
+  getsockname(fd, (struct sockaddr*) &saddr, &len);
+  *addr = StringUtil::format("127.0.0.1:$0", ntohs(saddr.sin_port));
+  return fd;
+}
+
+static Set<String> receiveStatsdLines(int fd) {
+  Set<String> lines;
+  char buf[StatsdAgent::kMaxPacketSize];
+
+  ssize_t len;
+  while ((len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+    for (const auto& line : StringUtil::split(String(buf, len), "\n")) {
+      if (!line.empty()) {
+        lines.emplace(line);
+      }
+    }
+  }
+
+  return lines;
+}
+
+typedef MultiCounter<uint64_t, uint64_t> StatusCodeCounter;
+
+TEST_CASE(StatsTest, TestStatsdAgent, [] () {
+  String addr;
+  auto fd = bindStatsdReceiver(&addr);
+
+  StatsRepository repo;
+  Counter<uint64_t> requests;
+  Counter<uint64_t> connections;
+  StatusCodeCounter status_codes("http_status");
+  repo.exportStat("/http/requests", &requests, ExportMode::EXPORT_DELTA);
+  repo.exportStat("/http/connections", &connections, ExportMode::EXPORT_VALUE);
+  repo.exportStat("/http/status", &status_codes, ExportMode::EXPORT_DELTA);
+
+  TestStatsdAgent agent(InetAddr::resolve(addr), Duration(0), &repo);
+
+  requests.incr(5);
+  connections.incr(3);
+  status_codes.increment(4, 200);
+  agent.report();
+
+  auto lines = receiveStatsdLines(fd);
+  EXPECT_EQ(lines.size(), 3);
+  EXPECT_EQ(lines.count("/http/requests:5"), 1);
+  EXPECT_EQ(lines.count("/http/connections:3"), 1);
+  EXPECT_EQ(lines.count("/http/status/http_status/200:4"), 1);
+
+  // a new series is exported ahead of the cached ones
+  requests.incr(2);
+  status_codes.increment(1, 200);
+  status_codes.increment(6, 404);
+  agent.report();
+
+  lines = receiveStatsdLines(fd);
+  EXPECT_EQ(lines.size(), 4);
+  EXPECT_EQ(lines.count("/http/requests:2"), 1);
+  EXPECT_EQ(lines.count("/http/status/http_status/200:1"), 1);
+  EXPECT_EQ(lines.count("/http/status/http_status/404:6"), 1);
+
+  requests.set(1);
+  agent.setFormat(StatsdFormat::DOGSTATSD);
+  agent.report();
+
+  lines = receiveStatsdLines(fd);
+  EXPECT_EQ(lines.count("/http/requests:1|c"), 1);
+  EXPECT_EQ(lines.count("/http/connections:3|g"), 1);
+  EXPECT_EQ(lines.count("/http/status:5|c|#http_status:200"), 1);
+
+  agent.report();
+  lines = receiveStatsdLines(fd);
+  EXPECT_EQ(lines.count("/http/requests:0|c"), 1);
+  EXPECT_EQ(lines.count("/http/status:0|c|#http_status:200"), 1);
+
+  requests.set(0);
+  agent.report();
+  lines = receiveStatsdLines(fd);
+  EXPECT_EQ(lines.count("/http/requests:-1|c"), 1);
+
+  close(fd);
+});
@@ -0,0 +1,89 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "stx/stats/stats.h"
+#include "stx/stats/statsdagent.h"
+#include "stx/test/benchmark.h"
+#include "stx/stringutil.h"
+
+using namespace stx;
+using namespace stx::stats;
+
+static const size_t kNumStats = 50;
+static const size_t kSeriesPerStat = 1000;
+
+class BenchmarkStatsdAgent : public StatsdAgent {
+public:
+  using StatsdAgent::StatsdAgent;
+  using StatsdAgent::report;
+};
+
+/**
+ * Binds a UDP socket on localhost that swallows the reports
+ */
+static int bindReceiver(unsigned* port) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+  struct sockaddr_in saddr;
+  memset(&saddr, 0, sizeof(saddr));
+  saddr.sin_family = AF_INET;
+  saddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(fd, (struct sockaddr*) &saddr, sizeof(saddr));
+
+  socklen_t len = sizeof(saddr);
+  getsockname(fd, (struct sockaddr*) &saddr, &len);
+  *port = ntohs(saddr.sin_port);
+  return fd;
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  unsigned port;
+  auto fd = bindReceiver(&port);
+
+  StatsRepository repo;
+  Vector<ScopedPtr<MultiCounter<uint64_t, uint64_t, String>>> counters;
+  for (size_t i = 0; i < kNumStats; ++i) {
+    counters.emplace_back(
+        new MultiCounter<uint64_t, uint64_t, String>("status", "method"));
+
+    for (size_t j = 0; j < kSeriesPerStat; ++j) {
+      counters.back()->increment(j, 100 + j / 2, j % 2 ? "GET" : "POST");
+    }
+
+    repo.exportStat(
+        StringUtil::format("/bench/server$0/requests", i),
+        counters.back().get(),
+        ExportMode::EXPORT_DELTA);
+  }
+
+  BenchmarkStatsdAgent agent(
+      InetAddr::resolve(StringUtil::format("127.0.0.1:$0", port)),
+      Duration(kMicrosPerSecond),
+      &repo);
+
+  auto result = Benchmark::benchmark([&]() {
+    agent.report();
+  }, 20);
+
+  Benchmark::printResultTable(
+      StringUtil::format("report $0 series", kNumStats * kSeriesPerStat),
+      Benchmark::BenchmarkResult(result.meanRuntimeNanos(), 1),
+      true);
+
+  close(fd);
+  return 0;
+}
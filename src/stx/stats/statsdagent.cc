@@ -8,6 +8,7 @@
  * <http://www.gnu.org/licenses/>.
  */
 #include <unistd.h>
+#include <algorithm>
 #include "stx/logging.h"
 #include "stx/stats/statsdagent.h"
 #include "stx/wallclock.h"
@@ -15,6 +16,35 @@
 namespace stx {
 namespace stats {
 
+namespace {
+
+const StatsSink::Labels kNoLabels;
+
+/**
+ * Writes the decimal digits of value to the end of buf and returns the
+ * number of digits
+ */
+size_t formatDigits(uint64_t value, char* buf_end) {
+  auto cur = buf_end;
+  do {
+    *--cur = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+
+  return buf_end - cur;
+}
+
+/**
+ * The separators of a DogStatsD line can't be escaped
+ */
+String tagValue(String str) {
+  std::replace(str.begin(), str.end(), '|', '_');
+  std::replace(str.begin(), str.end(), ',', '_');
+  return str;
+}
+
+} // namespace
+
 StatsdAgent::StatsdAgent(
     InetAddr addr,
     Duration report_interval) :
@@ -27,7 +57,9 @@ StatsdAgent::StatsdAgent(
     addr_(addr),
     stats_repo_(stats_repo),
     report_interval_(report_interval),
-    running_(false) {}
+    running_(false),
+    format_(StatsdFormat::STATSD),
+    npackets_(0) {}
 
 StatsdAgent::~StatsdAgent() {
   if (running_) {
@@ -35,6 +67,11 @@ StatsdAgent::~StatsdAgent() {
   }
 }
 
+void StatsdAgent::setFormat(StatsdFormat format) {
+  format_ = format;
+  caches_.clear();
+}
+
 void StatsdAgent::start() {
   running_ = true;
 
@@ -64,74 +101,219 @@ void StatsdAgent::stop() {
 }
 
 void StatsdAgent::report() {
-  Vector<String> lines;
+  npackets_ = 0;
 
-  stats_repo_->forEachStat([this, &lines] (const ExportedStat& stat) {
-    switch (stat.export_mode) {
+  // stats are only ever appended to the repository, so their position
+  // identifies them
+  size_t idx = 0;
+  stats_repo_->forEachStat([this, &idx] (const ExportedStat& stat) {
+    if (idx == caches_.size()) {
+      caches_.emplace_back(stat.stat);
+    } else if (caches_[idx].stat != stat.stat) {
+      caches_[idx] = SeriesCache(stat.stat);
+    }
 
-      case ExportMode::EXPORT_VALUE:
-        reportValue(stat.path, stat.stat, &lines);
-        break;
+    reportStat(stat, &caches_[idx++]);
+  });
 
-      case ExportMode::EXPORT_DELTA:
-        reportDelta(stat.path, stat.stat, &lines);
-        break;
+  flushPackets();
+}
 
-      case ExportMode::EXPORT_NONE:
-        break;
+void StatsdAgent::reportStat(const ExportedStat& stat, SeriesCache* cache) {
+  switch (stat.export_mode) {
 
+    case ExportMode::EXPORT_VALUE: {
+      ReportSink sink(this, cache, false);
+      stat.stat->exportAll(stat.path, &sink);
+      sink.finish();
+      break;
     }
-  });
 
-  sendToStatsd(lines);
+    case ExportMode::EXPORT_DELTA: {
+      ReportSink sink(this, cache, true);
+      stat.stat->exportAll(stat.path, &sink);
+      sink.finish();
+      break;
+    }
+
+    case ExportMode::EXPORT_NONE:
+      break;
+
+  }
 }
 
-void StatsdAgent::reportValue(
-    const String& path,
-    Stat* stat,
-    Vector<String>* out) {
-  BufferStatsSinkStatsSink stats_sink;
-  stat->exportAll(path,&stats_sink);
+void StatsdAgent::formatSeries(Series* series, bool delta) const {
+  switch (format_) {
+
+    case StatsdFormat::STATSD:
+      series->prefix = StatsSink::labeledPath(series->path, series->labels);
+      series->prefix += ":";
+      break;
+
+    case StatsdFormat::DOGSTATSD:
+      series->prefix = series->path + ":";
+      series->suffix = delta ? "|c" : "|g";
+
+      for (size_t i = 0; i < series->labels.size(); ++i) {
+        series->suffix += i == 0 ? "|#" : ",";
+        series->suffix += tagValue(series->labels[i].first);
+        series->suffix += ":";
+        series->suffix += tagValue(series->labels[i].second);
+      }
+
+      break;
 
-  for (const auto& pair : stats_sink.values()) {
-    out->emplace_back(StringUtil::format("$0:$1", pair.first, pair.second));
   }
 }
 
-void StatsdAgent::reportDelta(
+void StatsdAgent::addLine(
+    const Series& series,
+    const char* value,
+    size_t value_len) {
+  auto line_len = series.prefix.size() + value_len + series.suffix.size() + 1;
+
+  if (npackets_ == 0 ||
+      packets_[npackets_ - 1].size() + line_len > kMaxPacketSize) {
+    if (npackets_ == kPacketBatchSize) {
+      flushPackets();
+    }
+
+    if (npackets_ == packets_.size()) {
+      packets_.emplace_back();
+      packets_.back().reserve(kMaxPacketSize);
+    }
+
+    packets_[npackets_++].clear();
+  }
+
+  auto& packet = packets_[npackets_ - 1];
+  packet.append(series.prefix);
+  packet.append(value, value_len);
+  packet.append(series.suffix);
+  packet.append('\n');
+}
+
+void StatsdAgent::flushPackets() {
+  if (npackets_ > 0) {
+    sock_.sendTo(packets_.data(), npackets_, addr_);
+    npackets_ = 0;
+  }
+}
+
+StatsdAgent::SeriesCache::SeriesCache(Stat* s) : stat(s) {}
+
+StatsdAgent::ReportSink::ReportSink(
+    StatsdAgent* agent,
+    SeriesCache* cache,
+    bool delta) :
+    agent_(agent),
+    cache_(cache),
+    delta_(delta),
+    cursor_(0),
+    reordered_(false) {
+  order_.reserve(cache->series.size());
+}
+
+void StatsdAgent::ReportSink::addStatValue(
+    const String& path,
+    uint64_t value) {
+  addStatValue(path, kNoLabels, value);
+}
+
+void StatsdAgent::ReportSink::addStatValue(
     const String& path,
-    Stat* stat,
-    Vector<String>* out) {
-  BufferStatsSinkStatsSink stats_sink;
-  stat->exportAll(path,&stats_sink);
-
-  for (const auto& pair : stats_sink.values()) {
-    auto delta = pair.second - last_values_[pair.first];
-    last_values_[pair.first] = pair.second;
-    out->emplace_back(StringUtil::format("$0:$1", pair.first, delta));
+    const Labels& labels,
+    uint64_t value) {
+  auto series = getSeries(path, labels);
+
+  char buf[24];
+  auto buf_end = buf + sizeof(buf);
+  size_t len;
+
+  if (delta_) {
+    auto delta = (int64_t) (value - series->last_value);
+    series->last_value = value;
+
+    if (delta < 0) {
+      len = formatDigits(-(uint64_t) delta, buf_end);
+      buf_end[-(++len)] = '-';
+    } else {
+      len = formatDigits(delta, buf_end);
+    }
+  } else {
+    len = formatDigits(value, buf_end);
   }
+
+  agent_->addLine(*series, buf_end - len, len);
 }
 
-void StatsdAgent::sendToStatsd(const Vector<String>& lines) {
-  Vector<Buffer> pkts;
+StatsdAgent::Series* StatsdAgent::ReportSink::getSeries(
+    const String& path,
+    const Labels& labels) {
+  auto& series = cache_->series;
+
+  // most stats export the same series in the same order every time
+  size_t idx = cursor_;
+  if (idx >= series.size() ||
+      series[idx].path != path ||
+      series[idx].labels != labels) {
+    reordered_ = true;
 
-  for (const auto& line : lines) {
-    if (pkts.size() == 0 ||
-        pkts.back().size() + line.length() + 2 >= kMaxPacketSize) {
-      pkts.emplace_back();
+    auto key = StatsSink::labeledPath(path, labels);
+    auto iter = cache_->index.find(key);
+    if (iter == cache_->index.end()) {
+      idx = series.size();
+      series.emplace_back();
+      series.back().path = path;
+      series.back().labels = labels;
+      series.back().last_value = 0;
+      agent_->formatSeries(&series.back(), delta_);
+      cache_->index.emplace(key, idx);
+    } else {
+      idx = iter->second;
     }
+  }
+
+  cursor_ = idx + 1;
+  order_.emplace_back(idx);
+  return &series[idx];
+}
 
-    pkts.back().append(line);
-    pkts.back().append("\n");
+void StatsdAgent::ReportSink::finish() {
+  if (!reordered_) {
+    return;
   }
 
-  for (const auto& pkt : pkts) {
-    sendToStatsd(pkt);
+  auto& series = cache_->series;
+  bool in_order = order_.size() == series.size();
+  for (size_t i = 0; in_order && i < order_.size(); ++i) {
+    in_order = order_[i] == i;
+  }
+
+  if (in_order) {
+    return;
+  }
+
+  // series that were not exported this time are dropped
+  Vector<Series> ordered;
+  Vector<bool> moved(series.size(), false);
+  ordered.reserve(order_.size());
+  cache_->index.clear();
+
+  for (auto idx : order_) {
+    if (moved[idx]) {
+      continue;
+    }
+
+    moved[idx] = true;
+    cache_->index.emplace(
+        StatsSink::labeledPath(series[idx].path, series[idx].labels),
+        ordered.size());
+
+    ordered.emplace_back(std::move(series[idx]));
   }
-}
 
-void StatsdAgent::sendToStatsd(const Buffer& packet) {
-  sock_.sendTo(packet, addr_);
+  series.swap(ordered);
 }
 
 }
@@ -21,9 +21,30 @@
 namespace stx {
 namespace stats {
 
+/**
+ * The line format of the reports. Plain statsd lines carry the labels of a
+ * stat in the path, e.g. /http/status_codes/http_status/200:42, while
+ * DogStatsD lines are typed and carry them as tags, e.g.
+ * /http/status_codes:42|c|#http_status:200
+ */
+enum class StatsdFormat {
+  STATSD,
+  DOGSTATSD
+};
+
+/**
+ * Periodically reports all stats of a StatsRepository to a statsd server.
+ *
+ * The formatted prefix of every series and the last value of every delta
+ * series are cached per exported stat, in the order the stat exports them,
+ * so a report mostly appends the new values to the datagrams. Datagrams are
+ * filled up to kMaxPacketSize and sent kPacketBatchSize at a time while the
+ * repository is still being walked.
+ */
 class StatsdAgent {
 public:
   static const size_t kMaxPacketSize = 1024 * 48; // 48k
+  static const size_t kPacketBatchSize = 32;
 
   StatsdAgent(
       InetAddr addr,
@@ -36,16 +57,67 @@ public:
 
   ~StatsdAgent();
 
+  /**
+   * Must be called before start(). The series are reported as new
+   * afterwards, i.e. with their full values as deltas
+   */
+  void setFormat(StatsdFormat format);
+
   void start();
   void stop();
 
 protected:
+
+  struct Series {
+    String path;
+    StatsSink::Labels labels;
+    String prefix;
+    String suffix;
+    uint64_t last_value;
+  };
+
+  struct SeriesCache {
+    SeriesCache(Stat* s);
+    Stat* stat;
+    Vector<Series> series;
+    HashMap<String, size_t> index;
+  };
+
+  class ReportSink : public StatsSink {
+  public:
+    ReportSink(StatsdAgent* agent, SeriesCache* cache, bool delta);
+
+    void addStatValue(
+        const String& path,
+        uint64_t value) override;
+
+    void addStatValue(
+        const String& path,
+        const Labels& labels,
+        uint64_t value) override;
+
+    /**
+     * Restores the export order of the cached series if it changed
+     */
+    void finish();
+
+  protected:
+    Series* getSeries(const String& path, const Labels& labels);
+
+    StatsdAgent* agent_;
+    SeriesCache* cache_;
+    bool delta_;
+    size_t cursor_;
+    Vector<size_t> order_;
+    bool reordered_;
+  };
+
   void report();
-  void reportValue(const String& path, Stat* stat, Vector<String>* out);
-  void reportDelta(const String& path, Stat* stat, Vector<String>* out);
+  void reportStat(const ExportedStat& stat, SeriesCache* cache);
 
-  void sendToStatsd(const Vector<String>& lines);
-  void sendToStatsd(const Buffer& packet);
+  void formatSeries(Series* series, bool delta) const;
+  void addLine(const Series& series, const char* value, size_t value_len);
+  void flushPackets();
 
   net::UDPSocket sock_;
   InetAddr addr_;
@@ -53,11 +125,13 @@ protected:
   std::thread thread_;
   StatsRepository* stats_repo_;
   Duration report_interval_;
+  StatsdFormat format_;
 
-  HashMap<String, double> last_values_;
+  Vector<SeriesCache> caches_;
+  Vector<Buffer> packets_;
+  size_t npackets_;
 };
 
-
 }
 }
 #endif
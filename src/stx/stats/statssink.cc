@@ -13,6 +13,18 @@
 namespace stx {
 namespace stats {
 
+String StatsSink::labeledPath(const String& path, const Labels& labels) {
+  auto labeled_path = path;
+  for (const auto& label : labels) {
+    labeled_path += "/";
+    labeled_path += label.first;
+    labeled_path += "/";
+    labeled_path += label.second;
+  }
+
+  return labeled_path;
+}
+
 TextStatsSink::TextStatsSink(
     Function<void (const String& line)> callback) :
     callback_(callback) {}
@@ -27,6 +39,7 @@ void TextStatsSink::addStatValue(
     const String& path,
     const Labels& labels,
     uint64_t value) {
+  callback_(StringUtil::format("$0:$1", labeledPath(path, labels), value));
 }
 
 void BufferStatsSinkStatsSink::addStatValue(
@@ -39,6 +52,7 @@ void BufferStatsSinkStatsSink::addStatValue(
     const String& path,
     const Labels& labels,
     uint64_t value) {
+  values_.emplace_back(labeledPath(path, labels), value);
 }
 
 const Vector<Pair<String, double>>& BufferStatsSinkStatsSink::values() const {
@@ -30,6 +30,11 @@ public:
       const String& path,
       const Labels& labels,
       uint64_t value) = 0;
+
+  /**
+   * Appends the labels to the path, e.g. /http/status_codes/http_status/200
+   */
+  static String labeledPath(const String& path, const Labels& labels);
 };
 
 class TextStatsSink : public StatsSink {
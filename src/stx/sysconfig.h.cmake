@@ -36,6 +36,9 @@
 
 #cmakedefine STX_ENABLE_NOEXCEPT
 
+// Builds the epoll/timerfd/eventfd based LinuxScheduler
+#cmakedefine STX_ENABLE_LINUX_SCHEDULER
+
 // Builds with support for opportunistic write() calls to client sockets
 #cmakedefine STX_OPPORTUNISTIC_WRITE 1
 
@@ -43,6 +46,9 @@
 // header tests
 
 #cmakedefine HAVE_SYS_INOTIFY_H
+#cmakedefine HAVE_SYS_EPOLL_H
+#cmakedefine HAVE_SYS_TIMERFD_H
+#cmakedefine HAVE_SYS_EVENTFD_H
 #cmakedefine HAVE_SYS_SENDFILE_H
 #cmakedefine HAVE_SYS_RESOURCE_H
 #cmakedefine HAVE_SYS_LIMITS_H
@@ -59,6 +65,8 @@
 #cmakedefine HAVE_LIBAIO_H
 #cmakedefine HAVE_ZLIB_H
 #cmakedefine HAVE_BZLIB_H
+#cmakedefine HAVE_BROTLI_ENCODE_H
+#cmakedefine HAVE_ZSTD_H
 #cmakedefine HAVE_GNUTLS_H
 #cmakedefine HAVE_LUA_H
 #cmakedefine HAVE_PCRE_H
@@ -81,6 +89,7 @@
 #cmakedefine HAVE_CHROOT
 #cmakedefine HAVE_PATHCONF
 #cmakedefine HAVE_SENDFILE
+#cmakedefine HAVE_SENDMMSG
 #cmakedefine HAVE_POSIX_FADVISE
 #cmakedefine HAVE_READAHEAD
 #cmakedefine HAVE_PREAD
@@ -11,6 +11,8 @@
 #define _STX_TEST_BENCHMARK_H
 #include <stdlib.h>
 #include <stdint.h>
+#include <functional>
+#include <string>
 #include "stx/UnixTime.h"
 
 namespace stx {
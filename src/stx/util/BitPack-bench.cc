@@ -0,0 +1,123 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stx/util/BitPackEncoder.h>
+#include <stx/util/BitPackDecoder.h>
+#include <stx/test/benchmark.h>
+#include <stx/stringutil.h>
+
+using namespace stx;
+using namespace stx::util;
+
+static const size_t kNumValues = 1000000;
+
+static const char* modeName(BitPackMode mode) {
+  switch (mode) {
+    case BitPackMode::FIXED: return "fixed";
+    case BitPackMode::PACKED: return "packed";
+    case BitPackMode::FOR: return "for";
+    case BitPackMode::DELTA: return "delta";
+  }
+
+  return "";
+}
+
+static void benchmarkCodec(
+    const String& name,
+    const Vector<uint32_t>& values,
+    BitPackMode mode) {
+  uint32_t max_val = 0;
+  for (auto v : values) {
+    max_val = std::max(max_val, v);
+  }
+
+  auto encoder = [&] () {
+    return mode == BitPackMode::FIXED ?
+        BitPackEncoder(max_val) :
+        BitPackEncoder(mode);
+  };
+
+  auto enc_result = Benchmark::benchmark([&]() {
+    auto enc = encoder();
+    for (auto v : values) {
+      enc.encode(v);
+    }
+    enc.flush();
+  }, 10);
+
+  auto enc = encoder();
+  for (auto v : values) {
+    enc.encode(v);
+  }
+  enc.flush();
+
+  auto dec_result = Benchmark::benchmark([&]() {
+    auto dec = mode == BitPackMode::FIXED ?
+        BitPackDecoder(enc.data(), enc.size(), max_val) :
+        BitPackDecoder(enc.data(), enc.size(), mode);
+
+    uint32_t block[BitPackEncoder::kBlockSize];
+    for (size_t i = 0; i < dec.numBlocks(); ++i) {
+      dec.decodeBlock(i, block);
+    }
+  }, 10);
+
+  auto label = StringUtil::format(
+      "$0 $1 ($2 bits/value)",
+      name,
+      modeName(mode),
+      StringUtil::toString(enc.size() * 8.0 / values.size()).substr(0, 5));
+
+  Benchmark::printResultTable(
+      label + " enc",
+      Benchmark::BenchmarkResult(enc_result.meanRuntimeNanos(), values.size()),
+      true);
+
+  Benchmark::printResultTable(
+      label + " dec",
+      Benchmark::BenchmarkResult(dec_result.meanRuntimeNanos(), values.size()),
+      true);
+}
+
+int main() {
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  // second resolution timestamps with small, irregular gaps
+  Vector<uint32_t> timestamps;
+  uint32_t ts = 1430000000;
+  for (size_t i = 0; i < kNumValues; ++i) {
+    ts += (i * 7919) % 5;
+    timestamps.emplace_back(ts);
+  }
+
+  // sparse, ascending ids
+  Vector<uint32_t> ids;
+  uint32_t id = 0;
+  for (size_t i = 0; i < kNumValues; ++i) {
+    id += 1 + (i * 104729) % 200;
+    ids.emplace_back(id);
+  }
+
+  // small unsorted values, e.g. enum or status codes
+  Vector<uint32_t> codes;
+  for (size_t i = 0; i < kNumValues; ++i) {
+    codes.emplace_back(uint32_t(i * 2654435761u) >> 28);
+  }
+
+  for (auto mode : { BitPackMode::FIXED, BitPackMode::PACKED,
+      BitPackMode::FOR, BitPackMode::DELTA }) {
+    benchmarkCodec("timestamps", timestamps, mode);
+    benchmarkCodec("ids", ids, mode);
+    benchmarkCodec("codes", codes, mode);
+  }
+
+  return 0;
+}
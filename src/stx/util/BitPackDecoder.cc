@@ -7,6 +7,8 @@
  * copy of the GNU General Public License along with this program. If not, see
  * <http://www.gnu.org/licenses/>.
  */
+#include <string.h>
+#include <algorithm>
 #include <stx/util/BitPackDecoder.h>
 #include <stx/exception.h>
 #include <3rdparty/simdcomp/simdcomp.h>
@@ -14,15 +16,54 @@
 namespace stx {
 namespace util {
 
+namespace {
+
+inline const char* readVarUInt32(
+    const char* cur,
+    const char* end,
+    uint32_t* value) {
+  uint32_t val = 0;
+  for (int shift = 0; cur < end && shift < 35; shift += 7) {
+    auto byte = (unsigned char) *cur++;
+    val |= (uint32_t) (byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *value = val;
+      return cur;
+    }
+  }
+
+  RAISE(kBufferOverflowError, "read exceeds buffer boundary");
+}
+
+} // namespace
+
 BitPackDecoder::BitPackDecoder(
     void* data,
     size_t size,
     uint32_t max_val) :
     data_(data),
     size_(size),
+    mode_(BitPackMode::FIXED),
     maxbits_(max_val > 0 ? bits(max_val) : 0),
-    pos_(0),
-    outbuf_pos_(128) {}
+    next_block_(0),
+    outbuf_pos_(0),
+    outbuf_size_(0) {}
+
+BitPackDecoder::BitPackDecoder(
+    void* data,
+    size_t size,
+    BitPackMode mode) :
+    data_(data),
+    size_(size),
+    mode_(mode),
+    maxbits_(0),
+    next_block_(0),
+    outbuf_pos_(0),
+    outbuf_size_(0) {
+  if (mode_ != BitPackMode::FIXED) {
+    buildIndex();
+  }
+}
 
 uint32_t BitPackDecoder::next() {
   return fetch(true);
@@ -33,36 +74,184 @@ uint32_t BitPackDecoder::peek() {
 }
 
 uint32_t BitPackDecoder::fetch(bool advance) {
-  if (maxbits_ == 0) {
+  if (mode_ == BitPackMode::FIXED && maxbits_ == 0) {
     return 0;
   }
 
-  if (outbuf_pos_ == 128) {
-#ifndef STX_NODEBUG
-    auto new_pos = pos_ + 16 * maxbits_;
-    if (new_pos > size_) {
+  if (outbuf_pos_ == outbuf_size_) {
+    if (next_block_ >= numBlocks()) {
       if (!advance) {
         return 0;
       }
 
       RAISE(kBufferOverflowError, "read exceeds buffer boundary");
     }
-#endif
 
-    simdunpack((__m128i*) (((char *) data_) + pos_), outbuf_, maxbits_);
-    pos_ = new_pos;
-    outbuf_pos_ = advance ? 1 : 0;
-    return outbuf_[0];
+    outbuf_size_ = decodeBlock(next_block_++, outbuf_);
+    outbuf_pos_ = 0;
+  }
+
+  if (advance) {
+    return outbuf_[outbuf_pos_++];
   } else {
-    if (advance) {
-      return outbuf_[outbuf_pos_++];
-    } else {
-      return outbuf_[outbuf_pos_];
+    return outbuf_[outbuf_pos_];
+  }
+}
+
+void BitPackDecoder::skipTo(size_t n) {
+  if (mode_ == BitPackMode::FIXED && maxbits_ == 0) {
+    return;
+  }
+
+  size_t block;
+  size_t first_value;
+  if (mode_ == BitPackMode::FIXED) {
+    block = n / BitPackEncoder::kBlockSize;
+    first_value = block * BitPackEncoder::kBlockSize;
+  } else {
+    auto iter = std::upper_bound(
+        blocks_.begin(),
+        blocks_.end(),
+        n,
+        [] (size_t n, const BlockInfo& b) { return n < b.first_value; });
+
+    if (iter == blocks_.begin()) {
+      RAISE(kIndexError, "value index out of bounds");
     }
+
+    block = (iter - blocks_.begin()) - 1;
+    first_value = blocks_[block].first_value;
+  }
+
+  if (block >= numBlocks()) {
+    RAISE(kIndexError, "value index out of bounds");
+  }
+
+  outbuf_size_ = decodeBlock(block, outbuf_);
+  outbuf_pos_ = n - first_value;
+  next_block_ = block + 1;
+
+  if (outbuf_pos_ > outbuf_size_) {
+    RAISE(kIndexError, "value index out of bounds");
   }
 }
 
+size_t BitPackDecoder::numBlocks() const {
+  if (mode_ == BitPackMode::FIXED) {
+    return maxbits_ > 0 ? size_ / (16 * maxbits_) : 0;
+  } else {
+    return blocks_.size();
+  }
 }
+
+size_t BitPackDecoder::decodeBlock(size_t idx, uint32_t* out) const {
+  if (idx >= numBlocks()) {
+    RAISE(kIndexError, "block index out of bounds");
+  }
+
+  auto begin = (const char*) data_;
+  if (mode_ == BitPackMode::FIXED) {
+    simdunpack((__m128i*) (begin + idx * 16 * maxbits_), out, maxbits_);
+    return BitPackEncoder::kBlockSize;
+  }
+
+  // block bounds were checked when building the index
+  auto cur = begin + blocks_[idx].offset;
+  auto end = begin + size_;
+  uint8_t hdr = *cur++;
+  uint8_t count = BitPackEncoder::kBlockSize;
+  if (hdr == BitPackEncoder::kTailMarker) {
+    count = *cur++;
+  }
+
+  uint32_t base = 0;
+  if (mode_ != BitPackMode::PACKED) {
+    memcpy(&base, cur, sizeof(base));
+    cur += sizeof(base);
+  }
+
+  if (hdr == BitPackEncoder::kTailMarker) {
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t value;
+      cur = readVarUInt32(cur, end, &value);
+
+      switch (mode_) {
+        case BitPackMode::FOR:
+          value += base;
+          break;
+        case BitPackMode::DELTA:
+          value += base;
+          base = value;
+          break;
+        default:
+          break;
+      }
+
+      out[i] = value;
+    }
+
+    return count;
+  }
+
+  switch (mode_) {
+
+    case BitPackMode::DELTA:
+      simdunpackd1(base, (const __m128i*) cur, out, hdr);
+      break;
+
+    case BitPackMode::FOR:
+      simdunpack((const __m128i*) cur, out, hdr);
+      for (size_t i = 0; i < BitPackEncoder::kBlockSize; ++i) {
+        out[i] += base;
+      }
+      break;
+
+    default:
+      simdunpack((const __m128i*) cur, out, hdr);
+      break;
+
+  }
+
+  return BitPackEncoder::kBlockSize;
 }
 
+void BitPackDecoder::buildIndex() {
+  auto begin = (const char*) data_;
+  auto end = begin + size_;
+  size_t base_size = mode_ == BitPackMode::PACKED ? 0 : sizeof(uint32_t);
+  size_t nvalues = 0;
+
+  for (auto cur = begin; cur < end; ) {
+    blocks_.emplace_back(BlockInfo { (size_t) (cur - begin), nvalues });
+
+    uint8_t hdr = *cur++;
+    if (hdr == BitPackEncoder::kTailMarker) {
+      if (cur + 1 + base_size > end) {
+        RAISE(kBufferOverflowError, "read exceeds buffer boundary");
+      }
+
+      uint8_t count = *cur++;
+      cur += base_size;
+      for (size_t i = 0; i < count; ++i) {
+        uint32_t value;
+        cur = readVarUInt32(cur, end, &value);
+      }
+
+      nvalues += count;
+    } else {
+      if (hdr > 32) {
+        RAISEF(kIllegalStateError, "invalid bit width: $0", hdr);
+      }
+
+      cur += base_size + 16 * hdr;
+      if (cur > end) {
+        RAISE(kBufferOverflowError, "read exceeds buffer boundary");
+      }
 
+      nvalues += BitPackEncoder::kBlockSize;
+    }
+  }
+}
+
+}
+}
@@ -12,7 +12,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include <stx/buffer.h>
+#include <stx/util/BitPackEncoder.h>
 
 namespace stx {
 namespace util {
@@ -20,21 +22,53 @@ namespace util {
 class BitPackDecoder {
 public:
 
+  /**
+   * Creates a decoder for a FIXED stream of values up to max_val
+   */
   BitPackDecoder(void* data, size_t size, uint32_t max_val);
 
+  /**
+   * Creates a decoder for a stream written in the given (non-FIXED) mode.
+   * Walks the block headers once to allow random access.
+   */
+  BitPackDecoder(void* data, size_t size, BitPackMode mode);
+
   uint32_t next();
   uint32_t peek();
 
+  /**
+   * Positions the decoder so that the next call to next() returns the n-th
+   * value of the stream
+   */
+  void skipTo(size_t n);
+
+  size_t numBlocks() const;
+
+  /**
+   * Decodes the block with the given index into out, which must have room
+   * for BitPackEncoder::kBlockSize values. Returns the number of values.
+   */
+  size_t decodeBlock(size_t idx, uint32_t* out) const;
+
 protected:
 
+  struct BlockInfo {
+    size_t offset;
+    size_t first_value;
+  };
+
   uint32_t fetch(bool advance);
+  void buildIndex();
 
   void* data_;
   size_t size_;
+  BitPackMode mode_;
   size_t maxbits_;
-  size_t pos_;
-  uint32_t outbuf_[128];
+  std::vector<BlockInfo> blocks_;
+  size_t next_block_;
+  alignas(16) uint32_t outbuf_[BitPackEncoder::kBlockSize];
   size_t outbuf_pos_;
+  size_t outbuf_size_;
 };
 
 }
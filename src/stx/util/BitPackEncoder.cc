@@ -7,6 +7,7 @@
  * copy of the GNU General Public License along with this program. If not, see
  * <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <3rdparty/simdcomp/simdcomp.h>
 #include <stx/inspect.h>
 #include <stx/util/BitPackEncoder.h>
@@ -14,21 +15,29 @@
 namespace stx {
 namespace util {
 
-
 BitPackEncoder::BitPackEncoder(
     uint32_t max_val) :
+    mode_(BitPackMode::FIXED),
+    inbuf_size_(0),
     maxbits_(max_val > 0 ? bits(max_val) : 0),
-    inbuf_size_(0) {}
+    last_value_(0) {}
+
+BitPackEncoder::BitPackEncoder(
+    BitPackMode mode) :
+    mode_(mode),
+    inbuf_size_(0),
+    maxbits_(0),
+    last_value_(0) {}
 
 void BitPackEncoder::encode(uint32_t value) {
-  if (maxbits_ == 0) {
+  if (mode_ == BitPackMode::FIXED && maxbits_ == 0) {
     return;
   }
 
   inbuf_[inbuf_size_++] = value;
 
-  if (inbuf_size_ == 128) {
-    flush();
+  if (inbuf_size_ == kBlockSize) {
+    writeBlock();
   }
 }
 
@@ -37,12 +46,122 @@ void BitPackEncoder::flush() {
     return;
   }
 
-  while (inbuf_size_ < 128) {
+  if (mode_ != BitPackMode::FIXED) {
+    writeTail();
+    return;
+  }
+
+  while (inbuf_size_ < kBlockSize) {
     inbuf_[inbuf_size_++] = 0;
   }
 
-  simdpackwithoutmask(inbuf_, (__m128i *) outbuf_, maxbits_);
-  buf_.append(outbuf_, 16 * maxbits_);
+  writeBlock();
+}
+
+void BitPackEncoder::writeBlock() {
+  uint32_t base = 0;
+  uint32_t nbits;
+
+  switch (mode_) {
+
+    case BitPackMode::FIXED:
+      simdpackwithoutmask(inbuf_, (__m128i *) outbuf_, maxbits_);
+      buf_.append(outbuf_, 16 * maxbits_);
+      inbuf_size_ = 0;
+      return;
+
+    case BitPackMode::PACKED:
+      nbits = maxbits(inbuf_);
+      simdpackwithoutmask(inbuf_, (__m128i *) outbuf_, nbits);
+      break;
+
+    case BitPackMode::FOR:
+      base = inbuf_[0];
+      for (size_t i = 1; i < kBlockSize; ++i) {
+        base = std::min(base, inbuf_[i]);
+      }
+
+      for (size_t i = 0; i < kBlockSize; ++i) {
+        inbuf_[i] -= base;
+      }
+
+      nbits = maxbits(inbuf_);
+      simdpackwithoutmask(inbuf_, (__m128i *) outbuf_, nbits);
+      break;
+
+    case BitPackMode::DELTA:
+      base = last_value_;
+      nbits = simdmaxbitsd1(base, inbuf_);
+      simdpackwithoutmaskd1(base, inbuf_, (__m128i *) outbuf_, nbits);
+      last_value_ = inbuf_[kBlockSize - 1];
+      break;
+
+  }
+
+  uint8_t hdr = nbits;
+  buf_.append(&hdr, sizeof(hdr));
+  if (mode_ != BitPackMode::PACKED) {
+    buf_.append(&base, sizeof(base));
+  }
+
+  buf_.append(outbuf_, 16 * nbits);
+  inbuf_size_ = 0;
+}
+
+void BitPackEncoder::writeTail() {
+  uint32_t base = 0;
+
+  switch (mode_) {
+
+    case BitPackMode::FIXED:
+    case BitPackMode::PACKED:
+      break;
+
+    case BitPackMode::FOR:
+      base = inbuf_[0];
+      for (size_t i = 1; i < inbuf_size_; ++i) {
+        base = std::min(base, inbuf_[i]);
+      }
+      break;
+
+    case BitPackMode::DELTA:
+      base = last_value_;
+      last_value_ = inbuf_[inbuf_size_ - 1];
+      break;
+
+  }
+
+  uint8_t hdr[2] = { kTailMarker, (uint8_t) inbuf_size_ };
+  buf_.append(hdr, sizeof(hdr));
+  if (mode_ != BitPackMode::PACKED) {
+    buf_.append(&base, sizeof(base));
+  }
+
+  uint32_t prev = base;
+  for (size_t i = 0; i < inbuf_size_; ++i) {
+    uint32_t value = inbuf_[i];
+    switch (mode_) {
+      case BitPackMode::FOR:
+        value -= base;
+        break;
+      case BitPackMode::DELTA:
+        value -= prev;
+        prev = inbuf_[i];
+        break;
+      default:
+        break;
+    }
+
+    unsigned char varint[5];
+    size_t len = 0;
+    for (; value > 0x7f; value >>= 7) {
+      varint[len++] = (value & 0x7f) | 0x80;
+    }
+
+    varint[len++] = value;
+    buf_.append(varint, len);
+  }
+
   inbuf_size_ = 0;
 }
 
@@ -56,4 +175,3 @@ size_t BitPackEncoder::size() const {
 
 }
 }
-
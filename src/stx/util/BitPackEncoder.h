@@ -17,21 +17,66 @@
 namespace stx {
 namespace util {
 
+/**
+ * The layout of a bitpacked stream.
+ *
+ * FIXED packs every block of 128 values with the same bit width, derived from
+ * a known maximum value. All other modes choose the bit width per block and
+ * prefix each block with a small header, so that the stream can be walked
+ * and accessed by block:
+ *
+ *   full block: <bits:u8> [<base:u32>] <16 * bits bytes>
+ *   tail block: <0xff:u8> <count:u8> [<base:u32>] <count varints>
+ *
+ * PACKED stores the values as they are, FOR ("frame of reference") stores
+ * them relative to the block's minimum (the base) and DELTA stores the
+ * differences between consecutive values, starting at the base, which is
+ * the last value of the previous block. DELTA is meant for sorted values
+ * like timestamps or ids but is lossless for any input.
+ */
+enum class BitPackMode : uint8_t {
+  FIXED = 0,
+  PACKED = 1,
+  FOR = 2,
+  DELTA = 3
+};
+
 class BitPackEncoder {
 public:
+  static const size_t kBlockSize = 128;
+  static const uint8_t kTailMarker = 0xff;
+
+  /**
+   * Creates a FIXED encoder for values up to max_val
+   */
   BitPackEncoder(uint32_t max_val);
 
+  /**
+   * Creates an encoder that picks the bit width for each block
+   */
+  BitPackEncoder(BitPackMode mode);
+
   void encode(uint32_t value);
+
+  /**
+   * Writes out the pending values. A FIXED encoder pads them to a full block
+   * with zeros, all other modes write a variable length tail block.
+   */
   void flush();
 
   void* data() const;
   size_t size() const;
 
 protected:
-  uint32_t inbuf_[128];
-  uint32_t outbuf_[128];
+  void writeBlock();
+  void writeTail();
+
+  BitPackMode mode_;
+  alignas(16) uint32_t inbuf_[kBlockSize];
+  alignas(16) uint32_t outbuf_[kBlockSize];
   size_t inbuf_size_;
   size_t maxbits_;
+  uint32_t last_value_;
   Buffer buf_;
 };
 
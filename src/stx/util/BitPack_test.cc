@@ -0,0 +1,128 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "stx/test/unittest.h"
+#include "stx/util/BitPackEncoder.h"
+#include "stx/util/BitPackDecoder.h"
+
+using namespace stx;
+using namespace stx::util;
+
+UNIT_TEST(BitPackTest);
+
+static Vector<uint32_t> timestamps(size_t n) {
+  Vector<uint32_t> values;
+  uint32_t ts = 1430000000;
+  for (size_t i = 0; i < n; ++i) {
+    ts += 1 + (i * 7919) % 13;
+    values.emplace_back(ts);
+  }
+
+  return values;
+}
+
+static void testRoundtrip(BitPackMode mode, const Vector<uint32_t>& values) {
+  BitPackEncoder enc(mode);
+  for (auto v : values) {
+    enc.encode(v);
+  }
+  enc.flush();
+
+  BitPackDecoder dec(enc.data(), enc.size(), mode);
+  for (auto v : values) {
+    EXPECT_EQ(dec.next(), v);
+  }
+
+  EXPECT_EQ(dec.numBlocks(), (values.size() + 127) / 128);
+}
+
+TEST_CASE(BitPackTest, TestFixed, [] () {
+  BitPackEncoder enc(1000);
+  for (uint32_t i = 0; i < 300; ++i) {
+    enc.encode(i * 3);
+  }
+  enc.flush();
+
+  EXPECT_EQ(enc.size(), 3 * 16 * 10);
+
+  BitPackDecoder dec(enc.data(), enc.size(), 1000);
+  for (uint32_t i = 0; i < 300; ++i) {
+    EXPECT_EQ(dec.peek(), i * 3);
+    EXPECT_EQ(dec.next(), i * 3);
+  }
+
+  dec.skipTo(129);
+  EXPECT_EQ(dec.next(), 129 * 3);
+});
+
+TEST_CASE(BitPackTest, TestAdaptiveRoundtrip, [] () {
+  auto ts = timestamps(1000);
+
+  Vector<uint32_t> mixed;
+  for (size_t i = 0; i < 1000; ++i) {
+    mixed.emplace_back(i < 500 ? i % 7 : 0xffffffff - i);
+  }
+
+  for (auto mode : { BitPackMode::PACKED, BitPackMode::FOR,
+      BitPackMode::DELTA }) {
+    testRoundtrip(mode, ts);
+    testRoundtrip(mode, mixed);
+    testRoundtrip(mode, Vector<uint32_t>{ 42 });
+    testRoundtrip(mode, Vector<uint32_t>(256, 0));
+  }
+});
+
+TEST_CASE(BitPackTest, TestDeltaCompression, [] () {
+  auto ts = timestamps(128 * 100);
+
+  BitPackEncoder packed(BitPackMode::PACKED);
+  BitPackEncoder delta(BitPackMode::DELTA);
+  for (auto v : ts) {
+    packed.encode(v);
+    delta.encode(v);
+  }
+
+  // all but the first delta are < 16, i.e. 4 bits per value
+  EXPECT_EQ(delta.size(), (1 + 4 + 16 * 31) + 99 * (1 + 4 + 16 * 4));
+  EXPECT_TRUE(delta.size() * 6 < packed.size());
+});
+
+TEST_CASE(BitPackTest, TestRandomAccess, [] () {
+  auto ts = timestamps(1000);
+
+  for (auto mode : { BitPackMode::PACKED, BitPackMode::FOR,
+      BitPackMode::DELTA }) {
+    BitPackEncoder enc(mode);
+    for (size_t i = 0; i < 1000; ++i) {
+      enc.encode(ts[i]);
+      if (i == 200) {
+        enc.flush(); // a tail in the middle of the stream
+      }
+    }
+    enc.flush();
+
+    BitPackDecoder dec(enc.data(), enc.size(), mode);
+    for (size_t n : { 999, 0, 130, 201, 202, 500, 128 }) {
+      dec.skipTo(n);
+      EXPECT_EQ(dec.next(), ts[n]);
+    }
+
+    uint32_t block[128];
+    auto nblocks = dec.numBlocks();
+    EXPECT_EQ(dec.decodeBlock(nblocks - 1, block), (1000 - 201) % 128);
+    EXPECT_EQ(block[0], ts[201 + (nblocks - 3) * 128]);
+
+    EXPECT_EXCEPTION("value index out of bounds", [&dec] () {
+      dec.skipTo(1001);
+    });
+  }
+});
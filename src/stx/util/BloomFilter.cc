@@ -0,0 +1,153 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stx/exception.h>
+#include <stx/util/BloomFilter.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace stx {
+namespace util {
+
+namespace {
+
+// odd multipliers, one per word of a block
+const uint32_t kSalts[8] = {
+  0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+  0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+const size_t kWordsPerBlock = BloomFilter::kBlockSize / sizeof(uint32_t);
+
+inline uint32_t bitMask(uint32_t h, size_t word) {
+  return 1U << ((h * kSalts[word]) >> 27);
+}
+
+bool probeScalar(const uint32_t* block, uint32_t h) {
+  for (size_t i = 0; i < kWordsPerBlock; ++i) {
+    auto mask = bitMask(h, i);
+    if ((block[i] & mask) != mask) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2")))
+bool probeAVX2(const uint32_t* block, uint32_t h) {
+  auto salts = _mm256_loadu_si256((const __m256i*) kSalts);
+  auto bits = _mm256_srli_epi32(
+      _mm256_mullo_epi32(_mm256_set1_epi32(h), salts),
+      27);
+
+  auto mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+  auto words = _mm256_load_si256((const __m256i*) block);
+  return _mm256_testc_si256(words, mask);
+}
+
+const bool kHaveAVX2 = __builtin_cpu_supports("avx2");
+#endif
+
+} // namespace
+
+size_t BloomFilter::sizeFor(size_t nkeys, size_t bits_per_key) {
+  auto nbits = std::max(nkeys, size_t(1)) * bits_per_key;
+  auto nblocks = (nbits + kBlockSize * 8 - 1) / (kBlockSize * 8);
+  return nblocks * kBlockSize;
+}
+
+BloomFilter::BloomFilter(
+    size_t size) :
+    nblocks_((size + kBlockSize - 1) / kBlockSize),
+    owned_(true) {
+  if (nblocks_ == 0) {
+    nblocks_ = 1;
+  }
+
+  void* data;
+  if (posix_memalign(&data, 64, nblocks_ * kBlockSize) != 0) {
+    RAISE(kMallocError, "posix_memalign() failed");
+  }
+
+  blocks_ = (uint32_t*) data;
+  clear();
+}
+
+BloomFilter::BloomFilter(
+    void* data,
+    size_t size) :
+    blocks_((uint32_t*) data),
+    nblocks_(size / kBlockSize),
+    owned_(false) {
+  if (nblocks_ == 0 || size % kBlockSize != 0) {
+    RAISE(kIllegalArgumentError, "invalid bloom filter size");
+  }
+
+  if (((uintptr_t) data) % kBlockSize != 0) {
+    RAISE(kIllegalArgumentError, "bloom filter data must be 32 byte aligned");
+  }
+}
+
+BloomFilter::~BloomFilter() {
+  if (owned_) {
+    free(blocks_);
+  }
+}
+
+void BloomFilter::insert(const SHA1Hash& hash) {
+  insert(key(hash));
+}
+
+void BloomFilter::insert(uint64_t key) {
+  auto words = block(key);
+
+  for (size_t i = 0; i < kWordsPerBlock; ++i) {
+    auto mask = bitMask(key, i);
+    if ((__atomic_load_n(words + i, __ATOMIC_RELAXED) & mask) != mask) {
+      __atomic_fetch_or(words + i, mask, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+bool BloomFilter::mayContain(const SHA1Hash& hash) const {
+  return mayContain(key(hash));
+}
+
+bool BloomFilter::mayContain(uint64_t key) const {
+#if defined(__x86_64__)
+  if (kHaveAVX2) {
+    return probeAVX2(block(key), key);
+  }
+#endif
+
+  return probeScalar(block(key), key);
+}
+
+void BloomFilter::prefetch(const SHA1Hash& hash) const {
+  __builtin_prefetch(block(key(hash)));
+}
+
+void BloomFilter::clear() {
+  memset(blocks_, 0, nblocks_ * kBlockSize);
+}
+
+void* BloomFilter::data() const {
+  return blocks_;
+}
+
+size_t BloomFilter::size() const {
+  return nblocks_ * kBlockSize;
+}
+
+}
+}
@@ -0,0 +1,101 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef _STX_UTIL_BLOOMFILTER_H
+#define _STX_UTIL_BLOOMFILTER_H
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stx/SHA1.h>
+
+namespace stx {
+namespace util {
+
+/**
+ * A blocked bloom filter for keys that are already uniformly distributed,
+ * such as SHA1 hashes.
+ *
+ * Each key maps to one 32 byte block (which never straddles a cache line)
+ * and sets one bit in each of the block's eight 32 bit words, so a probe
+ * reads a single cache line. With the default of 10 bits per key about 1%
+ * of the probes for absent keys return a false positive.
+ *
+ * The filter either owns its memory or works on a caller provided region,
+ * e.g. a memory mapped file. insert() is safe to call concurrently with
+ * other inserts and probes.
+ */
+class BloomFilter {
+public:
+  static const size_t kBlockSize = 32;
+  static const size_t kDefaultBitsPerKey = 10;
+
+  /**
+   * Returns the size in bytes of a filter for the given number of keys
+   */
+  static size_t sizeFor(
+      size_t nkeys,
+      size_t bits_per_key = kDefaultBitsPerKey);
+
+  /**
+   * Creates a new, empty filter of the given size in bytes (rounded up to a
+   * multiple of kBlockSize)
+   */
+  BloomFilter(size_t size);
+
+  /**
+   * Creates a filter on top of an existing memory region of the given size,
+   * which must be a multiple of kBlockSize. The memory is not owned.
+   */
+  BloomFilter(void* data, size_t size);
+
+  BloomFilter(const BloomFilter& other) = delete;
+  BloomFilter& operator=(const BloomFilter& other) = delete;
+  ~BloomFilter();
+
+  void insert(const SHA1Hash& key);
+  void insert(uint64_t key);
+
+  /**
+   * Returns false if the key was never inserted, true if it probably was
+   */
+  bool mayContain(const SHA1Hash& key) const;
+  bool mayContain(uint64_t key) const;
+
+  void prefetch(const SHA1Hash& key) const;
+
+  void clear();
+
+  void* data() const;
+  size_t size() const;
+
+  /**
+   * Returns the first eight bytes of the hash, which are used as the key
+   */
+  static inline uint64_t key(const SHA1Hash& hash) {
+    uint64_t key;
+    memcpy(&key, hash.data(), sizeof(key));
+    return key;
+  }
+
+protected:
+
+  inline uint32_t* block(uint64_t key) const {
+    auto idx = ((key >> 32) * nblocks_) >> 32;
+    return blocks_ + idx * (kBlockSize / sizeof(uint32_t));
+  }
+
+  uint32_t* blocks_;
+  size_t nblocks_;
+  bool owned_;
+};
+
+}
+}
+
+#endif
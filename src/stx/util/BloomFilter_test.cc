@@ -0,0 +1,71 @@
+/**
+ * This file is part of the "libstx" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * libstx is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "stx/test/unittest.h"
+#include "stx/util/BloomFilter.h"
+
+using namespace stx;
+using namespace stx::util;
+
+UNIT_TEST(BloomFilterTest);
+
+TEST_CASE(BloomFilterTest, TestNoFalseNegatives, [] () {
+  BloomFilter bloom(BloomFilter::sizeFor(10000));
+
+  for (int i = 0; i < 10000; ++i) {
+    bloom.insert(SHA1::compute(StringUtil::toString(i)));
+  }
+
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(bloom.mayContain(SHA1::compute(StringUtil::toString(i))));
+  }
+});
+
+TEST_CASE(BloomFilterTest, TestFalsePositiveRate, [] () {
+  const int n = 100000;
+  BloomFilter bloom(BloomFilter::sizeFor(n));
+
+  for (int i = 0; i < n; ++i) {
+    bloom.insert(SHA1::compute(StringUtil::toString(i)));
+  }
+
+  int false_positives = 0;
+  for (int i = n; i < 2 * n; ++i) {
+    if (bloom.mayContain(SHA1::compute(StringUtil::toString(i)))) {
+      ++false_positives;
+    }
+  }
+
+  // ~1% expected with 10 bits per key
+  EXPECT_TRUE(false_positives < n * 0.02);
+});
+
+TEST_CASE(BloomFilterTest, TestExternalMemory, [] () {
+  const size_t size = BloomFilter::sizeFor(1000);
+  void* data;
+  EXPECT_EQ(posix_memalign(&data, 64, size), 0);
+  memset(data, 0, size);
+
+  {
+    BloomFilter bloom(data, size);
+    EXPECT_EQ(bloom.size(), size);
+    bloom.insert(SHA1::compute("0x42424242"));
+  }
+
+  // the bits stay in the memory region
+  BloomFilter bloom(data, size);
+  EXPECT_TRUE(bloom.mayContain(SHA1::compute("0x42424242")));
+
+  bloom.clear();
+  EXPECT_FALSE(bloom.mayContain(SHA1::compute("0x42424242")));
+  free(data);
+});
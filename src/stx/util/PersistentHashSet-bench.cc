@@ -0,0 +1,101 @@
+/**
+ * This file is part of the "libfnord" project
+ *   Copyright (c) 2015 Paul Asmuth
+ *
+ * FnordMetric is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License v3.0. You should have received a
+ * copy of the GNU General Public License along with this program. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stx/util/PersistentHashSet.h>
+#include <stx/io/fileutil.h>
+#include <stx/test/benchmark.h>
+#include <stx/stringutil.h>
+
+using namespace stx;
+
+/**
+ * Inserts n record ids and then looks them up again, one at a time and in
+ * batches, and looks up n / 10 absent ids. Pass the number of ids as the first argument, e.g. 100000000 for
+ * the large case (needs ~8GB of disk for the final table).
+ */
+int main(int argc, char** argv) {
+  const size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+  const size_t batch_size = 1024;
+  const String fpath = argc > 2 ? argv[2] : "/tmp/_fnord_benchrecidset.idx";
+
+  FileUtil::rm(fpath);
+  FileUtil::rm(fpath + "~");
+
+  Vector<SHA1Hash> ids;
+  ids.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    ids.emplace_back(SHA1::compute(StringUtil::toString(i)));
+  }
+
+  printf("%-40s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+
+  PersistentHashSet recset(fpath);
+
+  auto insert = Benchmark::benchmark([&]() {
+    for (const auto& id : ids) {
+      recset.addRecordID(id);
+    }
+  }, 1);
+
+  Benchmark::printResultTable(
+      StringUtil::format("addRecordID ($0 ids)", n),
+      Benchmark::BenchmarkResult(insert.meanRuntimeNanos(), n), true);
+
+  auto lookup = Benchmark::benchmark([&]() {
+    for (const auto& id : ids) {
+      if (!recset.hasRecordID(id)) {
+        abort();
+      }
+    }
+  }, 1);
+
+  Benchmark::printResultTable(
+      StringUtil::format("hasRecordID ($0 ids)", n),
+      Benchmark::BenchmarkResult(lookup.meanRuntimeNanos(), n), true);
+
+  Vector<SHA1Hash> absent_ids;
+  for (size_t i = 0; i < n / 10; ++i) {
+    absent_ids.emplace_back(SHA1::compute(StringUtil::toString(n + i)));
+  }
+
+  auto miss = Benchmark::benchmark([&]() {
+    for (const auto& id : absent_ids) {
+      if (recset.hasRecordID(id)) {
+        abort();
+      }
+    }
+  }, 1);
+
+  Benchmark::printResultTable(
+      StringUtil::format("hasRecordID, absent ($0 ids)", absent_ids.size()),
+      Benchmark::BenchmarkResult(miss.meanRuntimeNanos(), absent_ids.size()),
+      true);
+
+  auto batch_lookup = Benchmark::benchmark([&]() {
+    Vector<SHA1Hash> batch;
+    Vector<bool> found;
+    for (size_t i = 0; i < n; i += batch_size) {
+      batch.assign(
+          ids.begin() + i,
+          ids.begin() + std::min(i + batch_size, n));
+
+      recset.hasRecordIDs(batch, &found);
+    }
+  }, 1);
+
+  Benchmark::printResultTable(
+      StringUtil::format("hasRecordIDs ($0 ids)", n),
+      Benchmark::BenchmarkResult(batch_lookup.meanRuntimeNanos(), n), true);
+
+  FileUtil::rm(fpath);
+  FileUtil::rm(fpath + ".bloom");
+  return 0;
+}
@@ -7,8 +7,10 @@
  * copy of the GNU General Public License along with this program. If not, see
  * <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <string.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <stx/util/PersistentHashSet.h>
 #include <stx/io/fileutil.h>
 #include <stx/io/mmappedfile.h>
@@ -20,59 +22,141 @@ const size_t PersistentHashSet::kVersion = 1;
 const double PersistentHashSet::kMaxFillFactor = 0.5f;
 const double PersistentHashSet::kGrowthFactor = 2.0f;
 const size_t PersistentHashSet::kInitialSlots = 512;
-const size_t PersistentHashSet::kFetchIOBatchSize = 200;
-const size_t PersistentHashSet::kProbeIOBatchSize = 25;
+const size_t PersistentHashSet::kRehashStep = 16;
+const size_t PersistentHashSet::kPrefetchDistance = 8;
 
-#define IS_SLOT_EMPTY(slot) (\
-    *((uint64_t*) (slot)) == 0 && \
-    memcmp( \
-        (slot), \
-        (slot) + sizeof(uint64_t), \
-        SHA1Hash::kSize - sizeof(uint64_t)) == 0)
+namespace {
 
-PersistentHashSet::PersistentHashSet(
-    const String& filepath) :
-    fpath_(filepath),
-    nslots_(0),
-    nslots_used_(-1) {
-  if (FileUtil::exists(filepath)) {
-    auto file = File::openFile(fpath_, File::O_READ);
-
-    FileHeader hdr;
-    if (file.read(&hdr, sizeof(hdr)) != sizeof(hdr)) {
-      RAISE(kRuntimeError, "error while reading file header");
+class TableLock {
+public:
+  TableLock(pthread_rwlock_t* lock, bool exclusive) : lock_(lock) {
+    if (exclusive) {
+      pthread_rwlock_wrlock(lock_);
+    } else {
+      pthread_rwlock_rdlock(lock_);
     }
+  }
+
+  ~TableLock() {
+    pthread_rwlock_unlock(lock_);
+  }
+
+protected:
+  pthread_rwlock_t* lock_;
+};
+
+const char kEmptySlot[SHA1Hash::kSize] = { 0 };
+
+inline bool isSlotEmpty(const char* slot) {
+  return memcmp(slot, kEmptySlot, SHA1Hash::kSize) == 0;
+}
+
+// empty slots are claimed by swapping in the first word of the record id
+inline uint32_t claimWord(const void* record_id) {
+  uint32_t word;
+  memcpy(&word, record_id, sizeof(word));
+  return word;
+}
+
+} // namespace
+
+PersistentHashSet::Table::Table(
+    File&& file,
+    File&& bloom_file,
+    bool rebuild_bloom) :
+    mmap(std::move(file)),
+    bloom_mmap(std::move(bloom_file)) {
+  FileHeader hdr;
+  if (mmap.size() < sizeof(hdr)) {
+    RAISE(kRuntimeError, "error while reading file header");
+  }
+
+  memcpy(&hdr, mmap.data(), sizeof(hdr));
+  if (hdr.version != kVersion) {
+    RAISEF(kRuntimeError, "invalid version $0", hdr.version);
+  }
+
+  if (mmap.size() != sizeof(FileHeader) + SHA1Hash::kSize * hdr.nslots) {
+    RAISE(kRuntimeError, "invalid file size");
+  }
+
+  slots = (char*) mmap.data() + sizeof(FileHeader);
+  nslots = hdr.nslots;
 
-    if (hdr.version != kVersion) {
-      RAISEF(kRuntimeError, "invalid version $0", hdr.version);
+  bloom = mkScoped(
+      new util::BloomFilter(
+          (char*) bloom_mmap.data() + kBloomOffset,
+          bloom_mmap.size() - kBloomOffset));
+
+  if (rebuild_bloom) {
+    for (size_t idx = 0; idx < nslots; ++idx) {
+      auto s = slot(idx);
+      if (!isSlotEmpty(s)) {
+        bloom->insert(SHA1Hash(s, SHA1Hash::kSize));
+      }
     }
+  }
+
+  // the filter can only be trusted if it was closed before the table was
+  // last modified; the cleared flag must reach the disk before any insert
+  // does, or a crash could leave a stale filter marked as clean
+  ((BloomFileHeader*) bloom_mmap.data())->clean = 0;
+  msync(
+      bloom_mmap.data(),
+      std::min(bloom_mmap.size(), (size_t) getpagesize()),
+      MS_SYNC);
+}
 
-    auto file_size = file.size();
-    if (file_size != sizeof(FileHeader) + SHA1Hash::kSize * hdr.nslots) {
-      RAISE(kRuntimeError, "invalid file size");
+PersistentHashSet::Table::~Table() {
+  msync(bloom_mmap.data(), bloom_mmap.size(), MS_SYNC);
+  ((BloomFileHeader*) bloom_mmap.data())->clean = 1;
+}
+
+char* PersistentHashSet::Table::slot(size_t idx) const {
+  return slots + idx * SHA1Hash::kSize;
+}
+
+PersistentHashSet::PersistentHashSet(
+    const String& filepath) :
+    fpath_(filepath),
+    nslots_used_(0),
+    rehash_cursor_(0),
+    rehash_done_(0) {
+  pthread_rwlock_init(&table_lock_, nullptr);
+
+  // a table left behind by an unfinished grow holds the newest ids; move the
+  // remaining ones over before using it
+  auto tmp_fpath = fpath_ + "~";
+  if (FileUtil::exists(tmp_fpath)) {
+    if (FileUtil::size(tmp_fpath) < sizeof(FileHeader)) {
+      FileUtil::rm(tmp_fpath);
+    } else {
+      table_ = openTable(tmp_fpath);
+      if (FileUtil::exists(fpath_)) {
+        prev_table_ = openTable(fpath_);
+        completeRehash();
+      } else {
+        moveTable(tmp_fpath, fpath_);
+      }
     }
+  }
 
-    nslots_ = hdr.nslots;
+  if (!table_.get() && FileUtil::exists(fpath_)) {
+    table_ = openTable(fpath_);
   }
 }
 
-bool PersistentHashSet::addRecordID(const SHA1Hash& record_id) {
-  std::unique_lock<std::mutex> lk(write_mutex_);
-  auto file = File::openFile(
-      fpath_,
-      File::O_WRITE | File::O_READ | File::O_CREATEOROPEN);
+PersistentHashSet::~PersistentHashSet() {
+  pthread_rwlock_destroy(&table_lock_);
+}
 
-  return insert(&file, record_id);
+bool PersistentHashSet::addRecordID(const SHA1Hash& record_id) {
+  return add(record_id, hash(record_id));
 }
 
 void PersistentHashSet::addRecordIDs(Set<SHA1Hash>* record_ids) {
-  std::unique_lock<std::mutex> lk(write_mutex_);
-  auto file = File::openFile(
-      fpath_,
-      File::O_WRITE | File::O_READ | File::O_CREATEOROPEN);
-
   for (auto cur = record_ids->begin(); cur != record_ids->end(); ) {
-    if (insert(&file, *cur)) {
+    if (add(*cur, hash(*cur))) {
       ++cur;
     } else {
       cur = record_ids->erase(cur);
@@ -80,177 +164,396 @@ void PersistentHashSet::addRecordIDs(Set<SHA1Hash>* record_ids) {
   }
 }
 
-bool PersistentHashSet::insert(File* file, const SHA1Hash& record_id) {
-  if (nslots_used_ == size_t(-1)) {
-    nslots_used_ = 0;
-    if (nslots_ > 0) {
-      scan(file, nslots_, [this] (void* slot) {++nslots_used_; });
-    }
+bool PersistentHashSet::hasRecordID(const SHA1Hash& record_id) {
+  auto h = hash(record_id);
+  TableLock lk(&table_lock_, false);
+  return contains(record_id, h);
+}
+
+void PersistentHashSet::hasRecordIDs(
+    const Vector<SHA1Hash>& record_ids,
+    Vector<bool>* found) {
+  Vector<uint64_t> hashes;
+  hashes.reserve(record_ids.size());
+  for (const auto& record_id : record_ids) {
+    hashes.emplace_back(hash(record_id));
   }
 
-  if (nslots_used_ + 1 > nslots_ * kMaxFillFactor) {
-    grow(file);
+  found->resize(record_ids.size());
+
+  TableLock lk(&table_lock_, false);
+  for (size_t i = 0; i < record_ids.size() && i < kPrefetchDistance; ++i) {
+    prefetch(record_ids[i], hashes[i]);
   }
 
-  size_t insert_idx = 0;
-  if (lookup(file, nslots_, record_id, &insert_idx)) {
-    return false;
-  } else {
-    file->seekTo(sizeof(FileHeader) + insert_idx * SHA1Hash::kSize);
-    file->write(record_id.data(), SHA1Hash::kSize);
-    ++nslots_used_;
-    return true;
+  for (size_t i = 0; i < record_ids.size(); ++i) {
+    if (i + kPrefetchDistance < record_ids.size()) {
+      prefetch(
+          record_ids[i + kPrefetchDistance],
+          hashes[i + kPrefetchDistance]);
+    }
+
+    (*found)[i] = contains(record_ids[i], hashes[i]);
   }
 }
 
-bool PersistentHashSet::hasRecordID(const SHA1Hash& record_id) {
-  std::unique_lock<std::mutex> lk(read_mutex_);
-  auto nslots = nslots_;
-  if (nslots == 0) {
-    return false;
+Set<SHA1Hash> PersistentHashSet::fetchRecordIDs() {
+  Set<SHA1Hash> ids;
+
+  // exclusive so that we never see a half-written slot
+  TableLock lk(&table_lock_, true);
+  for (const Table* table : { table_.get(), prev_table_.get() }) {
+    if (!table) {
+      continue;
+    }
+
+    for (size_t idx = 0; idx < table->nslots; ++idx) {
+      auto slot = table->slot(idx);
+      if (!isSlotEmpty(slot)) {
+        ids.emplace(SHA1Hash(slot, SHA1Hash::kSize));
+      }
+    }
   }
 
-  auto file = File::openFile(fpath_, File::O_READ);
-  lk.unlock();
+  return ids;
+}
+
+ScopedPtr<PersistentHashSet::Table> PersistentHashSet::createTable(
+    const String& fpath,
+    size_t nslots) {
+  auto file = File::openFile(
+      fpath,
+      File::O_CREATEOROPEN | File::O_WRITE | File::O_READ | File::O_TRUNCATE);
+
+  FileHeader hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.version = kVersion;
+  hdr.nslots = nslots;
 
-  return lookup(&file, nslots, record_id);
+  // the slots are left as a hole, which reads as zeros (i.e. empty)
+  file.write(&hdr, sizeof(hdr));
+  file.truncate(sizeof(hdr) + nslots * SHA1Hash::kSize);
+
+  bool rebuild_bloom;
+  auto bloom_file = openBloomFile(fpath, nslots, true, &rebuild_bloom);
+
+  return mkScoped(new Table(std::move(file), std::move(bloom_file), false));
 }
 
-Set<SHA1Hash> PersistentHashSet::fetchRecordIDs() {
-  Set<SHA1Hash> ids;
+ScopedPtr<PersistentHashSet::Table> PersistentHashSet::openTable(
+    const String& fpath) {
+  auto file = File::openFile(fpath, File::O_READ | File::O_WRITE);
 
-  std::unique_lock<std::mutex> lk(read_mutex_);
-  auto nslots = nslots_;
-  if (nslots_ == 0) {
-    return ids;
+  FileHeader hdr;
+  if (file.read(&hdr, sizeof(hdr)) != sizeof(hdr)) {
+    RAISE(kRuntimeError, "error while reading file header");
   }
 
-  auto file = File::openFile(fpath_, File::O_READ);
-  lk.unlock();
+  bool rebuild_bloom;
+  auto bloom_file = openBloomFile(fpath, hdr.nslots, false, &rebuild_bloom);
 
-  scan(&file, nslots, [&ids] (void* slot) {
-    ids.emplace(SHA1Hash(slot, SHA1Hash::kSize));
-  });
+  return mkScoped(
+      new Table(std::move(file), std::move(bloom_file), rebuild_bloom));
+}
 
-  return ids;
+File PersistentHashSet::openBloomFile(
+    const String& fpath,
+    size_t nslots,
+    bool truncate,
+    bool* rebuild) {
+  auto bloom_size = util::BloomFilter::sizeFor(nslots * kMaxFillFactor);
+  auto file = File::openFile(
+      bloomPath(fpath),
+      File::O_CREATEOROPEN | File::O_WRITE | File::O_READ |
+      (truncate ? File::O_TRUNCATE : 0));
+
+  *rebuild = false;
+  if (file.size() == kBloomOffset + bloom_size) {
+    BloomFileHeader hdr;
+    if (file.read(&hdr, sizeof(hdr)) == sizeof(hdr) &&
+        hdr.version == kVersion &&
+        hdr.clean == 1 &&
+        hdr.size == bloom_size) {
+      return file;
+    }
+  }
+
+  // missing, stale or not closed properly: start over from an empty filter
+  // and (for an existing table) re-add all ids
+  BloomFileHeader hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.version = kVersion;
+  hdr.size = bloom_size;
+
+  file.truncate(0);
+  file.seekTo(0);
+  file.write(&hdr, sizeof(hdr));
+  file.truncate(kBloomOffset + bloom_size);
+  *rebuild = !truncate;
+  return file;
 }
 
-// preconditions: no locks required
+String PersistentHashSet::bloomPath(const String& fpath) {
+  return fpath + ".bloom";
+}
+
+void PersistentHashSet::moveTable(const String& src, const String& dst) {
+  FileUtil::mv(src, dst);
+  FileUtil::mv(bloomPath(src), bloomPath(dst));
+}
+
+uint64_t PersistentHashSet::hash(const SHA1Hash& record_id) {
+  FNV<uint64_t> fnv;
+  return fnv.hash(record_id.data(), record_id.size());
+}
+
+// preconditions: must hold table lock (shared)
 bool PersistentHashSet::lookup(
-    File* file,
-    size_t nslots,
+    const Table* table,
     const SHA1Hash& record_id,
-    size_t* insert_idx /* = nullptr */) {
-  FNV<uint64_t> fnv;
-  auto h = fnv.hash(record_id.data(), record_id.size());
+    uint64_t h) {
+  if (!table->bloom->mayContain(record_id)) {
+    return false;
+  }
 
-  Buffer buf(kProbeIOBatchSize * SHA1Hash::kSize);
-  size_t buf_offset = -1;
-  size_t buf_size = 0;
+  auto idx = h % table->nslots;
 
-  for (size_t i = 0; i < nslots; ++i) {
-    auto idx = (h + i) % nslots;
+  for (size_t i = 0; i < table->nslots; ++i) {
+    auto slot = table->slot(idx);
 
-    if (!buf_size || idx >= buf_offset + buf_size || idx < buf_offset) {
-      file->seekTo(sizeof(FileHeader) + idx * SHA1Hash::kSize);
-      auto nread = file->read(buf.data(), buf.size());
-      if (nread < SHA1Hash::kSize) {
-        RAISE(kRuntimeError, "error while reading from file");;
-      }
+    if (memcmp(slot, record_id.data(), SHA1Hash::kSize) == 0) {
+      return true;
+    }
 
-      buf_offset = idx;
-      buf_size = nread / SHA1Hash::kSize;
+    if (isSlotEmpty(slot)) {
+      return false;
     }
 
-    auto slot = (char *) buf.data() + (idx - buf_offset) * SHA1Hash::kSize;
+    if (++idx == table->nslots) {
+      idx = 0;
+    }
+  }
+
+  return false;
+}
+
+// preconditions: must hold table lock (exclusive if exclusive is set) and
+// must be the only one inserting this record id
+bool PersistentHashSet::insert(
+    Table* table,
+    const SHA1Hash& record_id,
+    uint64_t h,
+    bool exclusive) {
+  // set the bits first so that a lookup that finds the slot also passes
+  // the filter
+  table->bloom->insert(record_id);
+
+  auto idx = h % table->nslots;
+
+  for (size_t i = 0; i < table->nslots; ++i) {
+    auto slot = table->slot(idx);
 
     if (memcmp(slot, record_id.data(), SHA1Hash::kSize) == 0) {
-      return true;
+      return false;
     }
 
-    if (IS_SLOT_EMPTY(slot)) {
-      if (insert_idx) {
-        *insert_idx = idx;
+    if (isSlotEmpty(slot)) {
+      if (exclusive) {
+        memcpy(slot, record_id.data(), SHA1Hash::kSize);
+        return true;
       }
 
-      return false;
+      // slots are 4-byte aligned as the header is 12 bytes long
+      uint32_t expected = 0;
+      auto claim = reinterpret_cast<std::atomic<uint32_t>*>(slot);
+      if (claim->compare_exchange_strong(
+            expected,
+            claimWord(record_id.data()))) {
+        memcpy(
+            slot + sizeof(uint32_t),
+            (const char*) record_id.data() + sizeof(uint32_t),
+            SHA1Hash::kSize - sizeof(uint32_t));
+
+        return true;
+      }
+
+      // lost the slot to a concurrent insert of a different record id
+    }
+
+    if (++idx == table->nslots) {
+      idx = 0;
     }
   }
 
   RAISE(kIllegalStateError, "set is full");
 }
 
-// preconditions: no locks required
-void PersistentHashSet::scan(
-    File* file,
-    size_t nslots,
-    Function<void (void* slot)> fn) {
-  file->seekTo(sizeof(FileHeader));
-
-  Buffer buf(kFetchIOBatchSize * SHA1Hash::kSize);
-  auto nbatches = (nslots + kFetchIOBatchSize - 1) / kFetchIOBatchSize;
-  for (size_t b = 0; b < nbatches; ++b) {
-    auto nread = file->read(buf.data(), buf.size());
-    if (nread == -1) {
-      break;
+// preconditions: must hold table lock (shared)
+void PersistentHashSet::prefetch(
+    const SHA1Hash& record_id,
+    uint64_t h) const {
+  for (const Table* table : { table_.get(), prev_table_.get() }) {
+    if (table) {
+      auto slot = table->slot(h % table->nslots);
+      table->bloom->prefetch(record_id);
+      __builtin_prefetch(slot);
+      __builtin_prefetch(slot + SHA1Hash::kSize - 1);
     }
+  }
+}
+
+// preconditions: must hold table lock (shared)
+bool PersistentHashSet::contains(const SHA1Hash& record_id, uint64_t h) const {
+  return
+      (table_.get() && lookup(table_.get(), record_id, h)) ||
+      (prev_table_.get() && lookup(prev_table_.get(), record_id, h));
+}
+
+// preconditions: no locks required
+bool PersistentHashSet::add(const SHA1Hash& record_id, uint64_t h) {
+  std::call_once(count_once_, [this] { countSlotsUsed(); });
+
+  // a record id with a zero first word can't claim a slot, so it is inserted
+  // with all other inserts locked out
+  bool exclusive = claimWord(record_id.data()) == 0;
+  bool inserted = false;
+  bool rehashed = false;
+
+  for (;;) {
+    {
+      TableLock lk(&table_lock_, exclusive);
+
+      if (table_.get() &&
+          nslots_used_ + 1 <= table_->nslots * kMaxFillFactor) {
+        {
+          std::unique_lock<std::mutex> stripe_lk(
+              stripes_[(h >> 32) % kLockStripes]);
+
+          // ids in the previous table are only ever moved, never inserted
+          if (!(prev_table_.get() &&
+                lookup(prev_table_.get(), record_id, h))) {
+            inserted = insert(table_.get(), record_id, h, exclusive);
+          }
+        }
+
+        if (inserted) {
+          ++nslots_used_;
+        }
+
+        if (prev_table_.get()) {
+          rehashStep();
+          rehashed = rehash_done_ >= prev_table_->nslots;
+        }
 
-    for (size_t pos = 0; pos < SHA1Hash::kSize * kFetchIOBatchSize;
-        pos += SHA1Hash::kSize) {
-      auto slot = static_cast<char*>(buf.data()) + pos;
-      if (IS_SLOT_EMPTY(slot)) {
-        continue;
+        break;
       }
+    }
+
+    grow();
+  }
+
+  if (rehashed) {
+    finishRehash();
+  }
 
-      fn(slot);
+  return inserted;
+}
+
+// preconditions: called once before the first insert
+void PersistentHashSet::countSlotsUsed() {
+  TableLock lk(&table_lock_, true);
+  if (!table_.get()) {
+    return;
+  }
+
+  size_t nslots_used = 0;
+  for (size_t idx = 0; idx < table_->nslots; ++idx) {
+    if (!isSlotEmpty(table_->slot(idx))) {
+      ++nslots_used;
     }
   }
+
+  nslots_used_ = nslots_used;
 }
 
-// preconditions: must hold write lock
-void PersistentHashSet::grow(File* file) {
-  size_t new_nslots = nslots_ == 0 ? kInitialSlots : nslots_ * kGrowthFactor;
+// preconditions: must hold table lock (shared), prev_table_ must be set
+void PersistentHashSet::rehashStep() {
+  auto begin = rehash_cursor_.fetch_add(kRehashStep);
+  if (begin >= prev_table_->nslots) {
+    return;
+  }
+
+  auto end = std::min(begin + kRehashStep, prev_table_->nslots);
+  for (auto idx = begin; idx < end; ++idx) {
+    auto slot = prev_table_->slot(idx);
+    if (isSlotEmpty(slot)) {
+      continue;
+    }
+
+    SHA1Hash record_id(slot, SHA1Hash::kSize);
+    if (claimWord(slot) == 0) {
+      std::unique_lock<std::mutex> lk(deferred_mutex_);
+      deferred_.emplace_back(record_id);
+      continue;
+    }
 
-  Buffer new_data(new_nslots * SHA1Hash::kSize);
-  memset(new_data.data(), 0, new_data.size());
+    if (insert(table_.get(), record_id, hash(record_id), false)) {
+      ++nslots_used_;
+    }
+  }
 
-  if (nslots_ > 0) {
-    scan(file, nslots_, [this, &new_nslots, &new_data] (void* old_slot) {
-      FNV<uint64_t> fnv;
-      auto h = fnv.hash(old_slot, SHA1Hash::kSize);
+  rehash_done_ += end - begin;
+}
 
-      for (size_t i = 0; i < new_nslots; ++i) {
-        size_t idx = (h + i) % new_nslots;
-        auto slot = (char *) new_data.data() + idx * SHA1Hash::kSize;
+// preconditions: no locks required
+void PersistentHashSet::grow() {
+  TableLock lk(&table_lock_, true);
 
-        if (IS_SLOT_EMPTY(slot)) {
-          memcpy(slot, old_slot, SHA1Hash::kSize);
-          break;
-        }
-      }
-    });
+  if (table_.get() && nslots_used_ + 1 <= table_->nslots * kMaxFillFactor) {
+    return; // somebody else grew the table in the meantime
   }
 
-  {
-    auto new_file = File::openFile(
-        fpath_ + "~",
-        File::O_CREATEOROPEN | File::O_WRITE | File::O_READ | File::O_TRUNCATE);
+  if (!table_.get()) {
+    table_ = createTable(fpath_, kInitialSlots);
+    return;
+  }
 
-    FileHeader hdr;
-    memset(&hdr, 0, sizeof(hdr));
+  if (prev_table_.get()) {
+    completeRehash();
+  }
 
-    hdr.version = kVersion;
-    hdr.nslots = new_nslots;
+  auto new_table = createTable(fpath_ + "~", table_->nslots * kGrowthFactor);
+  prev_table_ = std::move(table_);
+  table_ = std::move(new_table);
+  nslots_used_ = 0;
+  rehash_cursor_ = 0;
+  rehash_done_ = 0;
+}
 
-    new_file.write(&hdr, sizeof(hdr));
-    new_file.write(new_data.data(), new_data.size());
-    *file = std::move(new_file);
+// preconditions: no locks required
+void PersistentHashSet::finishRehash() {
+  TableLock lk(&table_lock_, true);
+
+  if (prev_table_.get() && rehash_done_ >= prev_table_->nslots) {
+    completeRehash();
+  }
+}
+
+// preconditions: must hold table lock (exclusive), prev_table_ must be set
+void PersistentHashSet::completeRehash() {
+  while (rehash_cursor_ < prev_table_->nslots) {
+    rehashStep();
   }
 
-  std::unique_lock<std::mutex> lk(read_mutex_);
-  FileUtil::mv(fpath_ + "~", fpath_);
-  nslots_ = new_nslots;
+  for (const auto& record_id : deferred_) {
+    if (insert(table_.get(), record_id, hash(record_id), true)) {
+      ++nslots_used_;
+    }
+  }
+
+  deferred_.clear();
+  prev_table_.reset(nullptr);
+  moveTable(fpath_ + "~", fpath_);
 }
 
 } // namespace stx
-
@@ -8,26 +8,57 @@
  * <http://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <atomic>
+#include <mutex>
+#include <pthread.h>
 #include <stx/stdtypes.h>
 #include <stx/io/file.h>
+#include <stx/io/mmappedfile.h>
 #include <stx/option.h>
 #include <stx/SHA1.h>
 #include <stx/util/binarymessagereader.h>
 #include <stx/util/binarymessagewriter.h>
+#include <stx/util/BloomFilter.h>
 #include <stx/random.h>
 
 namespace stx {
 
+/**
+ * A set of SHA1 record ids, stored as an open-addressed (linear probing)
+ * hash table in a memory mapped file.
+ *
+ * All methods are safe to call concurrently. Inserts of different record ids
+ * proceed in parallel; lookups never block on inserts. Once the table is half
+ * full it grows into a new file of twice the size, and the existing ids are
+ * moved over incrementally by subsequent inserts, while lookups consult both
+ * tables.
+ *
+ * Each table is fronted by a bloom filter over the record ids it contains,
+ * persisted as "<file>.bloom", so that most lookups of absent ids are
+ * answered from a single cache line without touching the table.
+ */
 class PersistentHashSet {
 public:
 
   PersistentHashSet(const String& fpath);
+  ~PersistentHashSet();
 
   bool addRecordID(const SHA1Hash& record_id);
   void addRecordIDs(Set<SHA1Hash>* record_ids);
 
   bool hasRecordID(const SHA1Hash& record_id);
 
+  /**
+   * Looks up many record ids at once, prefetching the slots of upcoming ids
+   * while probing the current one.
+   *
+   * @param record_ids the record ids to look up
+   * @param found set to whether or not each of the record ids is contained
+   */
+  void hasRecordIDs(
+      const Vector<SHA1Hash>& record_ids,
+      Vector<bool>* found);
+
   Set<SHA1Hash> fetchRecordIDs();
 
 protected:
@@ -35,8 +66,9 @@ protected:
   static const double kMaxFillFactor;
   static const double kGrowthFactor;
   static const size_t kInitialSlots;
-  static const size_t kFetchIOBatchSize;
-  static const size_t kProbeIOBatchSize;
+  static const size_t kRehashStep;
+  static const size_t kPrefetchDistance;
+  static const size_t kLockStripes = 64;
 
   struct  __attribute__((packed)) FileHeader {
     uint8_t version;
@@ -44,29 +76,74 @@ protected:
     uint64_t nslots;
   };
 
-  void scan(
-      File* file,
-      size_t nslots,
-      Function<void (void* slot)> fn);
+  struct  __attribute__((packed)) BloomFileHeader {
+    uint8_t version;
+    uint8_t clean;
+    uint8_t unused[6];
+    uint64_t size;
+  };
+
+  static const size_t kBloomOffset = 64;
+
+  struct Table {
+    Table(File&& file, File&& bloom_file, bool rebuild_bloom);
+    ~Table();
 
-  bool lookup(
-      File* file,
+    char* slot(size_t idx) const;
+
+    io::MmappedFile mmap;
+    char* slots;
+    size_t nslots;
+    io::MmappedFile bloom_mmap;
+    ScopedPtr<util::BloomFilter> bloom;
+  };
+
+  static ScopedPtr<Table> createTable(const String& fpath, size_t nslots);
+  static ScopedPtr<Table> openTable(const String& fpath);
+
+  static File openBloomFile(
+      const String& fpath,
       size_t nslots,
+      bool truncate,
+      bool* rebuild);
+
+  static String bloomPath(const String& fpath);
+  static void moveTable(const String& src, const String& dst);
+
+  static uint64_t hash(const SHA1Hash& record_id);
+
+  static bool lookup(
+      const Table* table,
       const SHA1Hash& record_id,
-      size_t* insert_idx = nullptr);
+      uint64_t h);
 
-  void grow(File* file);
+  static bool insert(
+      Table* table,
+      const SHA1Hash& record_id,
+      uint64_t h,
+      bool exclusive);
 
-  bool insert(
-      File* file,
-      const SHA1Hash& record_id);
+  void prefetch(const SHA1Hash& record_id, uint64_t h) const;
+  bool contains(const SHA1Hash& record_id, uint64_t h) const;
+  bool add(const SHA1Hash& record_id, uint64_t h);
+
+  void countSlotsUsed();
+  void rehashStep();
+  void grow();
+  void finishRehash();
+  void completeRehash();
 
   String fpath_;
-  size_t nslots_;
-  size_t nslots_used_;
-  mutable std::mutex write_mutex_;
-  mutable std::mutex read_mutex_;
+  ScopedPtr<Table> table_;
+  ScopedPtr<Table> prev_table_;
+  std::atomic<size_t> nslots_used_;
+  std::atomic<size_t> rehash_cursor_;
+  std::atomic<size_t> rehash_done_;
+  std::once_flag count_once_;
+  Vector<SHA1Hash> deferred_;
+  std::mutex deferred_mutex_;
+  std::mutex stripes_[kLockStripes];
+  mutable pthread_rwlock_t table_lock_;
 };
 
 } // namespace stx
-
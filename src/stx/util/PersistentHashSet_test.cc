@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <thread>
 #include "stx/test/unittest.h"
 #include "stx/util/PersistentHashSet.h"
 
@@ -123,3 +124,137 @@ TEST_CASE(RecordIDSetTest, TestInsert10kRows, [] () {
   }
 });
 
+
+TEST_CASE(RecordIDSetTest, TestBatchLookup, [] () {
+  FileUtil::rm("/tmp/_fnord_testrecidset.idx");
+  PersistentHashSet recset("/tmp/_fnord_testrecidset.idx");
+
+  Vector<SHA1Hash> ids;
+  for (int i = 0; i < 2000; ++i) {
+    ids.emplace_back(SHA1::compute(StringUtil::toString(i)));
+    if (i % 2 == 0) {
+      recset.addRecordID(ids.back());
+    }
+  }
+
+  Vector<bool> found;
+  recset.hasRecordIDs(ids, &found);
+  EXPECT_EQ(found.size(), 2000);
+  for (int i = 0; i < 2000; ++i) {
+    EXPECT_EQ(bool(found[i]), i % 2 == 0);
+  }
+});
+
+TEST_CASE(RecordIDSetTest, TestReopenWhileGrowing, [] () {
+  FileUtil::rm("/tmp/_fnord_testrecidset.idx");
+
+  // 257 ids overflow the initial 512 slots, but leave most of the old
+  // table to be moved over
+  {
+    PersistentHashSet recset("/tmp/_fnord_testrecidset.idx");
+    for (int i = 0; i < 257; ++i) {
+      recset.addRecordID(SHA1::compute(StringUtil::toString(i)));
+    }
+
+    EXPECT_TRUE(FileUtil::exists("/tmp/_fnord_testrecidset.idx~"));
+    for (int i = 0; i < 257; ++i) {
+      EXPECT_TRUE(recset.hasRecordID(SHA1::compute(StringUtil::toString(i))));
+    }
+  }
+
+  {
+    PersistentHashSet recset("/tmp/_fnord_testrecidset.idx");
+    EXPECT_FALSE(FileUtil::exists("/tmp/_fnord_testrecidset.idx~"));
+
+    auto ids = recset.fetchRecordIDs();
+    EXPECT_EQ(ids.size(), 257);
+    for (int i = 0; i < 257; ++i) {
+      EXPECT_EQ(ids.count(SHA1::compute(StringUtil::toString(i))), 1);
+    }
+  }
+});
+
+TEST_CASE(RecordIDSetTest, TestZeroPrefixRecordIDs, [] () {
+  FileUtil::rm("/tmp/_fnord_testrecidset.idx");
+  PersistentHashSet recset("/tmp/_fnord_testrecidset.idx");
+
+  Vector<SHA1Hash> ids;
+  for (int i = 0; i < 1000; ++i) {
+    char buf[SHA1Hash::kSize];
+    memcpy(buf, SHA1::compute(StringUtil::toString(i)).data(), sizeof(buf));
+    if (i % 3 == 0) {
+      memset(buf, 0, sizeof(uint32_t));
+    }
+
+    SHA1Hash id(buf, sizeof(buf));
+    ids.emplace_back(id);
+    EXPECT_TRUE(recset.addRecordID(id));
+    EXPECT_FALSE(recset.addRecordID(id));
+  }
+
+  for (const auto& id : ids) {
+    EXPECT_TRUE(recset.hasRecordID(id));
+  }
+
+  EXPECT_EQ(recset.fetchRecordIDs().size(), 1000);
+});
+
+TEST_CASE(RecordIDSetTest, TestConcurrentInserts, [] () {
+  FileUtil::rm("/tmp/_fnord_testrecidset.idx");
+  FileUtil::rm("/tmp/_fnord_testrecidset.idx~");
+  PersistentHashSet recset("/tmp/_fnord_testrecidset.idx");
+
+  const int kThreads = 4;
+  const int kIDs = 20000;
+  std::atomic<int> inserted(0);
+
+  // every thread inserts all ids, so each id is contended by all threads
+  Vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&recset, &inserted, t] () {
+      for (int i = 0; i < kIDs; ++i) {
+        auto id = SHA1::compute(StringUtil::toString((i + t * 997) % kIDs));
+        if (recset.addRecordID(id)) {
+          ++inserted;
+        }
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(inserted.load(), kIDs);
+
+  auto ids = recset.fetchRecordIDs();
+  EXPECT_EQ(ids.size(), kIDs);
+  for (int i = 0; i < kIDs; ++i) {
+    EXPECT_EQ(ids.count(SHA1::compute(StringUtil::toString(i))), 1);
+  }
+});
+
+TEST_CASE(RecordIDSetTest, TestRebuildBloomFilter, [] () {
+  FileUtil::rm("/tmp/_fnord_testrecidset.idx");
+
+  {
+    PersistentHashSet recset("/tmp/_fnord_testrecidset.idx");
+    for (int i = 0; i < 1000; ++i) {
+      recset.addRecordID(SHA1::compute(StringUtil::toString(i)));
+    }
+  }
+
+  // a missing filter is rebuilt from the table
+  FileUtil::rm("/tmp/_fnord_testrecidset.idx.bloom");
+
+  {
+    PersistentHashSet recset("/tmp/_fnord_testrecidset.idx");
+    for (int i = 0; i < 2000; ++i) {
+      EXPECT_EQ(
+          recset.hasRecordID(SHA1::compute(StringUtil::toString(i))),
+          i < 1000);
+    }
+  }
+
+  EXPECT_TRUE(FileUtil::exists("/tmp/_fnord_testrecidset.idx.bloom"));
+});
@@ -42,19 +42,20 @@ void const* BinaryMessageReader::read(size_t size) {
 }
 
 uint64_t BinaryMessageReader::readVarUInt() {
+  auto begin = static_cast<const unsigned char*>(ptr_);
   uint64_t value = 0;
 
-  for (int i = 0; ; ++i) {
-    auto b = *((const unsigned char*) read(1));
+  for (int i = 0; pos_ < size_; ++i) {
+    auto b = begin[pos_++];
 
     value |= (b & 0x7fULL) << (7 * i);
 
     if (!(b & 0x80U)) {
-      break;
+      return value;
     }
   }
 
-  return value;
+  RAISE(kBufferOverflowError, "requested read exceeds message bounds");
 }
 
 template <>